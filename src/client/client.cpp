@@ -43,12 +43,28 @@ struct ClientChannel::Impl : public pva::ChannelRequester,
     listeners_t listeners;
     bool listeners_inprogress;
     epicsEvent listeners_done;
+    // const after connect()
+    std::tr1::weak_ptr<Executor> executor;
 
     static size_t num_instances;
 
     Impl() :listeners_inprogress(false) {REFTRACE_INCREMENT(num_instances);}
     virtual ~Impl() {REFTRACE_DECREMENT(num_instances);}
 
+    void connect(const std::tr1::shared_ptr<pva::ChannelProvider>& provider,
+                 const std::string& name,
+                 const Options& opt)
+    {
+        if(name.empty())
+            THROW_EXCEPTION2(std::logic_error, "empty channel name not allowed");
+        if(!provider)
+            THROW_EXCEPTION2(std::logic_error, "NULL ChannelProvider");
+        channel = provider->createChannel(name, internal_shared_from_this(),
+                                          opt.priority, opt.address);
+        if(!channel)
+            throw std::runtime_error("ChannelProvider failed to create Channel");
+    }
+
     // called automatically via wrapped_shared_from_this
     void cancel()
     {
@@ -66,7 +82,33 @@ struct ClientChannel::Impl : public pva::ChannelRequester,
 
     virtual void channelCreated(const pvd::Status& status, pva::Channel::shared_pointer const & channel) OVERRIDE FINAL {}
 
+    struct NotifyJob : public Executor::Job
+    {
+        const std::tr1::shared_ptr<ClientChannel::Impl> self;
+        const ConnectEvent evt;
+        NotifyJob(const std::tr1::shared_ptr<ClientChannel::Impl>& self, const ConnectEvent& evt) :self(self), evt(evt) {}
+        virtual ~NotifyJob() {}
+        virtual void run() OVERRIDE FINAL { self->notifyListeners(evt); }
+    };
+
     virtual void channelStateChange(pva::Channel::shared_pointer const & channel, pva::Channel::ConnectionState connectionState) OVERRIDE FINAL
+    {
+        ConnectEvent evt;
+        evt.connected = connectionState==pva::Channel::CONNECTED;
+        if(evt.connected)
+            evt.peerName = channel->getRemoteAddress();
+
+        std::tr1::shared_ptr<Executor> exec(executor.lock());
+        if(exec) {
+            // same key as operations on this channel, so connection events are ordered with their callbacks
+            std::tr1::shared_ptr<Executor::Job> job(new NotifyJob(internal_shared_from_this(), evt));
+            exec->submit(this, job);
+        } else {
+            notifyListeners(evt);
+        }
+    }
+
+    void notifyListeners(const ConnectEvent& evt)
     {
         listeners_t notify;
         {
@@ -75,10 +117,6 @@ struct ClientChannel::Impl : public pva::ChannelRequester,
             listeners_inprogress = true;
         }
         try {
-            ConnectEvent evt;
-            evt.connected = connectionState==pva::Channel::CONNECTED;
-            if(evt.connected)
-                evt.peerName = channel->getRemoteAddress();
             for(listeners_t::const_iterator it=notify.begin(), end=notify.end(); it!=end; ++it)
             {
                 try {
@@ -143,14 +181,7 @@ ClientChannel::ClientChannel(const std::tr1::shared_ptr<pva::ChannelProvider>& p
                   const Options& opt)
     :impl(Impl::build())
 {
-    if(name.empty())
-        THROW_EXCEPTION2(std::logic_error, "empty channel name not allowed");
-    if(!provider)
-        THROW_EXCEPTION2(std::logic_error, "NULL ChannelProvider");
-    impl->channel = provider->createChannel(name, impl->internal_shared_from_this(),
-                                            opt.priority, opt.address);
-    if(!impl->channel)
-        throw std::runtime_error("ChannelProvider failed to create Channel");
+    impl->connect(provider, name, opt);
 }
 
 ClientChannel::~ClientChannel() {}
@@ -213,6 +244,12 @@ void ClientChannel::show(std::ostream& strm) const
     }
 }
 
+void ClientChannel::stats(pva::ChannelStats& s) const
+{
+    if(!impl) throw std::logic_error("Dead Channel");
+    impl->channel->getStats(s);
+}
+
 static
 void register_reftrack()
 {
@@ -232,6 +269,10 @@ std::tr1::shared_ptr<epics::pvAccess::Channel>
 ClientChannel::getChannel()
 { return impl->channel; }
 
+std::tr1::shared_ptr<Executor>
+ClientChannel::getExecutor()
+{ return impl->executor.lock(); }
+
 struct ClientProvider::Impl
 {
     static size_t num_instances;
@@ -241,6 +282,7 @@ struct ClientProvider::Impl
     pva::ChannelProvider::shared_pointer provider;
 
     epicsMutex mutex;
+    Executor::shared_pointer executor;
     typedef std::map<std::pair<std::string, ClientChannel::Options>, std::tr1::weak_ptr<ClientChannel::Impl> > channels_t;
     channels_t channels;
 };
@@ -308,11 +350,190 @@ ClientProvider::connect(const std::string& name,
             impl->channels.erase(it); // remove stale
     }
     // cache miss
-    ClientChannel ret(impl->provider, name, conf);
+    std::tr1::shared_ptr<ClientChannel::Impl> chan(ClientChannel::Impl::build());
+    // set before connecting so that the first connection event is also queued
+    chan->executor = impl->executor;
+    chan->connect(impl->provider, name, conf);
+    ClientChannel ret(chan);
     impl->channels[K] = ret.impl;
     return ret;
 }
 
+std::vector<ClientChannel>
+ClientProvider::connect(const std::vector<std::string>& names,
+                        const ClientChannel::Options& conf)
+{
+    if(!impl) throw std::logic_error("Dead Provider");
+    for(size_t i=0; i<names.size(); i++) {
+        if(names[i].empty())
+            THROW_EXCEPTION2(std::logic_error, "empty channel name not allowed");
+    }
+
+    std::vector<ClientChannel> ret(names.size());
+
+    std::vector<std::string> tocreate;
+    std::vector<pva::ChannelRequester::shared_pointer> requesters;
+    std::vector<std::tr1::shared_ptr<ClientChannel::Impl> > created;
+
+    Guard G(impl->mutex);
+
+    for(size_t i=0; i<names.size(); i++) {
+        Impl::channels_t::key_type K(names[i], conf);
+        Impl::channels_t::iterator it(impl->channels.find(K));
+        if(it!=impl->channels.end()) {
+            // cache hit, or duplicate name
+            std::tr1::shared_ptr<ClientChannel::Impl> chan(it->second.lock());
+            if(chan) {
+                ret[i] = ClientChannel(chan);
+                continue;
+            } else {
+                impl->channels.erase(it); // remove stale
+            }
+        }
+        // cache miss
+        std::tr1::shared_ptr<ClientChannel::Impl> chan(ClientChannel::Impl::build());
+        chan->executor = impl->executor;
+        impl->channels[K] = chan;
+        ret[i] = ClientChannel(chan);
+
+        tocreate.push_back(names[i]);
+        requesters.push_back(chan->internal_shared_from_this());
+        created.push_back(chan);
+    }
+
+    if(!tocreate.empty()) {
+        std::vector<pva::Channel::shared_pointer> channels;
+        impl->provider->createChannels(tocreate, requesters, conf.priority, conf.address, channels);
+
+        if(channels.size()!=created.size())
+            throw std::logic_error("ChannelProvider::createChannels() returned wrong number of Channels");
+
+        for(size_t i=0; i<created.size(); i++) {
+            if(!channels[i])
+                throw std::runtime_error("ChannelProvider failed to create Channel");
+            created[i]->channel = channels[i];
+        }
+    }
+
+    return ret;
+}
+
+namespace {
+// Gathers the results of ChannelProvider::getMany() or putMany()
+struct MultiWait : public pva::ChannelMultiRequester
+{
+    epicsMutex mutex;
+    epicsEvent event;
+    size_t pending;
+    std::vector<GetEvent> results;
+
+    explicit MultiWait(size_t count)
+        :pending(count)
+        ,results(count)
+    {
+        for(size_t i=0; i<count; i++) {
+            results[i].event = GetEvent::Fail;
+            results[i].message = "Timeout";
+        }
+    }
+    virtual ~MultiWait() {}
+
+    virtual std::string getRequesterName() OVERRIDE FINAL { return "pvac::ClientProvider"; }
+
+    virtual void getManyDone(size_t index,
+                             const pvd::Status& status,
+                             pvd::PVStructure::shared_pointer const & value,
+                             pvd::BitSet::shared_pointer const & changed) OVERRIDE FINAL
+    {
+        bool last;
+        {
+            Guard G(mutex);
+            if(index>=results.size())
+                return;
+            GetEvent& evt = results[index];
+            evt.event = status.isSuccess() ? GetEvent::Success : GetEvent::Fail;
+            evt.message = status.getMessage();
+            evt.value = value;
+            evt.valid = changed;
+            last = --pending==0u;
+        }
+        if(last)
+            event.signal();
+    }
+
+    virtual void putManyDone(size_t index, const pvd::Status& status) OVERRIDE FINAL
+    {
+        getManyDone(index, status, pvd::PVStructure::shared_pointer(), pvd::BitSet::shared_pointer());
+    }
+
+    void wait(double timeout)
+    {
+        Guard G(mutex);
+        if(pending) {
+            UnGuard U(G);
+            event.wait(timeout);
+        }
+    }
+};
+
+} // namespace
+
+std::vector<GetEvent>
+ClientProvider::getMany(const std::vector<ClientChannel>& channels,
+                        double timeout,
+                        pvd::PVStructure::const_shared_pointer pvRequest)
+{
+    if(!impl) throw std::logic_error("Dead Provider");
+    if(!pvRequest)
+        pvRequest = pvd::createRequest("field()");
+
+    std::vector<pva::Channel::shared_pointer> chans(channels.size());
+    for(size_t i=0; i<channels.size(); i++) {
+        if(!channels[i].impl || !channels[i].impl->channel)
+            THROW_EXCEPTION2(std::logic_error, "Dead Channel");
+        chans[i] = channels[i].impl->channel;
+    }
+
+    std::tr1::shared_ptr<MultiWait> waiter(new MultiWait(chans.size()));
+    impl->provider->getMany(chans, std::tr1::const_pointer_cast<pvd::PVStructure>(pvRequest), waiter);
+    waiter->wait(timeout);
+
+    Guard G(waiter->mutex);
+    return waiter->results;
+}
+
+std::vector<PutEvent>
+ClientProvider::putMany(const std::vector<ClientChannel>& channels,
+                        const std::vector<pvd::PVStructure::const_shared_pointer>& values,
+                        double timeout,
+                        pvd::PVStructure::const_shared_pointer pvRequest)
+{
+    if(!impl) throw std::logic_error("Dead Provider");
+    if(values.size()!=channels.size())
+        THROW_EXCEPTION2(std::logic_error, "putMany() requires one value per channel");
+    if(!pvRequest)
+        pvRequest = pvd::createRequest("field()");
+
+    std::vector<pva::Channel::shared_pointer> chans(channels.size());
+    for(size_t i=0; i<channels.size(); i++) {
+        if(!channels[i].impl || !channels[i].impl->channel)
+            THROW_EXCEPTION2(std::logic_error, "Dead Channel");
+        chans[i] = channels[i].impl->channel;
+    }
+
+    std::vector<pvd::PVStructure::shared_pointer> tosend(values.size());
+    for(size_t i=0; i<values.size(); i++)
+        tosend[i] = std::tr1::const_pointer_cast<pvd::PVStructure>(values[i]);
+
+    std::tr1::shared_ptr<MultiWait> waiter(new MultiWait(chans.size()));
+    impl->provider->putMany(chans, std::tr1::const_pointer_cast<pvd::PVStructure>(pvRequest),
+                            tosend, std::vector<pvd::BitSet::shared_pointer>(), waiter);
+    waiter->wait(timeout);
+
+    Guard G(waiter->mutex);
+    return std::vector<PutEvent>(waiter->results.begin(), waiter->results.end());
+}
+
 bool ClientProvider::disconnect(const std::string& name,
                                     const ClientChannel::Options& conf)
 {
@@ -333,6 +554,21 @@ void ClientProvider::disconnect()
     impl->channels.clear();
 }
 
+void ClientProvider::setExecutor(const std::tr1::shared_ptr<Executor>& executor)
+{
+    if(!impl) throw std::logic_error("Dead Provider");
+    Guard G(impl->mutex);
+    impl->executor = executor;
+}
+
+std::tr1::shared_ptr<Executor>
+ClientProvider::getExecutor() const
+{
+    if(!impl) throw std::logic_error("Dead Provider");
+    Guard G(impl->mutex);
+    return impl->executor;
+}
+
 ::std::ostream& operator<<(::std::ostream& strm, const Operation& op)
 {
     if(op.impl) {
@@ -0,0 +1,185 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <map>
+#include <deque>
+#include <vector>
+#include <sstream>
+
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+#include <epicsEvent.h>
+#include <epicsThread.h>
+
+#include <pv/sharedPtr.h>
+
+#define epicsExportSharedSymbols
+#include "pv/logger.h"
+#include "clientpvt.h"
+
+namespace {
+
+/* Jobs are kept in one strand per key.
+ * A strand with queued jobs, and which is not being run, is listed in 'ready'.
+ * An idle worker takes the first ready strand and runs one of its jobs,
+ * then moves the strand to the back of 'ready' if more jobs remain.
+ */
+struct PoolExecutor : public pvac::Executor,
+                      public epicsThreadRunable
+{
+    typedef std::deque<std::tr1::shared_ptr<Job> > jobs_t;
+    struct strand_t {
+        jobs_t jobs;
+        bool busy;
+        strand_t() :busy(false) {}
+    };
+    typedef std::map<const void*, strand_t> strands_t;
+
+    mutable epicsMutex mutex;
+    epicsEvent wakeup;
+
+    strands_t strands;
+    std::deque<const void*> ready;
+    bool stopping;
+
+    size_t queued, maxQueued, executed;
+
+    std::vector<std::tr1::shared_ptr<epicsThread> > workers;
+
+    PoolExecutor(size_t nthreads, const std::string& name)
+        :stopping(false)
+        ,queued(0u)
+        ,maxQueued(0u)
+        ,executed(0u)
+    {
+        if(nthreads==0u)
+            nthreads = 1u;
+        workers.reserve(nthreads);
+        for(size_t i=0; i<nthreads; i++) {
+            std::ostringstream tname;
+            tname<<name;
+            if(nthreads>1u)
+                tname<<i;
+            std::tr1::shared_ptr<epicsThread> worker(new epicsThread(*this, tname.str().c_str(),
+                                                                    epicsThreadGetStackSize(epicsThreadStackBig),
+                                                                    epicsThreadPriorityMedium));
+            workers.push_back(worker);
+        }
+        for(size_t i=0; i<workers.size(); i++)
+            workers[i]->start();
+    }
+
+    virtual ~PoolExecutor()
+    {
+        {
+            Guard G(mutex);
+            stopping = true;
+        }
+        wakeup.signal();
+        // workers drain remaining jobs before exiting
+        for(size_t i=0; i<workers.size(); i++)
+            workers[i]->exitWait();
+    }
+
+    virtual void submit(const void* key, const std::tr1::shared_ptr<Job>& job) OVERRIDE FINAL
+    {
+        bool wake;
+        {
+            Guard G(mutex);
+            strand_t& S = strands[key];
+            wake = !S.busy && S.jobs.empty();
+            S.jobs.push_back(job);
+            if(wake)
+                ready.push_back(key);
+            if(++queued > maxQueued)
+                maxQueued = queued;
+        }
+        if(wake)
+            wakeup.signal();
+    }
+
+    virtual void stats(Stats& s) const OVERRIDE FINAL
+    {
+        Guard G(mutex);
+        s.queued = queued;
+        s.maxQueued = maxQueued;
+        s.executed = executed;
+        s.threads = workers.size();
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        Guard G(mutex);
+        while(true) {
+            if(ready.empty()) {
+                if(stopping)
+                    break;
+                UnGuard U(G);
+                wakeup.wait();
+                continue;
+            }
+
+            const void *key = ready.front();
+            ready.pop_front();
+            if(!ready.empty())
+                wakeup.signal(); // pass on to another idle worker
+
+            strands_t::iterator it(strands.find(key));
+            std::tr1::shared_ptr<Job> job;
+            job.swap(it->second.jobs.front());
+            it->second.jobs.pop_front();
+            it->second.busy = true;
+            queued--;
+
+            {
+                UnGuard U(G);
+                try {
+                    job->run();
+                }catch(std::exception& e){
+                    LOG(pva::logLevelError, "Unhandled exception from Executor job: %s", e.what());
+                }
+                job.reset(); // may release the last reference to an operation
+            }
+            executed++;
+
+            it = strands.find(key);
+            it->second.busy = false;
+            if(it->second.jobs.empty())
+                strands.erase(it);
+            else
+                ready.push_back(key);
+        }
+        // wake the next worker to exit
+        wakeup.signal();
+    }
+};
+
+} // namespace
+
+namespace pvac {
+
+Executor::Job::~Job() {}
+
+Executor::Stats::Stats()
+    :queued(0u)
+    ,maxQueued(0u)
+    ,executed(0u)
+    ,threads(0u)
+{}
+
+Executor::~Executor() {}
+
+Executor::shared_pointer Executor::createThread(const std::string& name)
+{
+    return createPool(1u, name);
+}
+
+Executor::shared_pointer Executor::createPool(size_t nthreads, const std::string& name)
+{
+    shared_pointer ret(new PoolExecutor(nthreads, name));
+    return ret;
+}
+
+} // namespace pvac
@@ -25,7 +25,8 @@ using pvac::detail::CallbackUse;
 struct Getter : public pvac::detail::CallbackStorage,
                 public pva::ChannelGetRequester,
                 public pvac::Operation::Impl,
-                public pvac::detail::wrapped_shared_from_this<Getter>
+                public pvac::detail::wrapped_shared_from_this<Getter>,
+                public pvac::detail::CallbackQueue<Getter, pvac::ClientChannel::GetCallback, pvac::GetEvent>
 {
     operation_type::shared_pointer op;
 
@@ -50,7 +51,14 @@ struct Getter : public pvac::detail::CallbackStorage,
         event.event = evt;
         pvac::ClientChannel::GetCallback *C=cb;
         cb = 0;
+        if(evt!=pvac::GetEvent::Cancel && defer(C, event))
+            return;
         CallbackUse U(G);
+        deliver(C, event);
+    }
+
+    void deliver(pvac::ClientChannel::GetCallback *C, const pvac::GetEvent& event)
+    {
         try {
             C->getDone(event);
         } catch(std::exception& e) {
@@ -71,6 +79,7 @@ struct Getter : public pvac::detail::CallbackStorage,
         std::tr1::shared_ptr<Getter> keepalive(internal_shared_from_this());
         CallbackGuard G(*this);
         if(op) op->cancel();
+        clearDeferred();
         callEvent(G, pvac::GetEvent::Cancel);
         G.wait();
     }
@@ -156,6 +165,10 @@ ClientChannel::get(ClientChannel::GetCallback* cb,
         pvRequest = pvd::createRequest("field()");
 
     std::tr1::shared_ptr<Getter> ret(Getter::build(cb));
+    if(!dynamic_cast<detail::InlineCallback*>(cb)) {
+        ret->executor = getExecutor();
+        ret->key = impl.get();
+    }
 
     {
         Guard G(ret->mutex);
@@ -25,7 +25,8 @@ using pvac::detail::CallbackUse;
 struct Infoer : public pvac::detail::CallbackStorage,
                 public pva::GetFieldRequester,
                 public pvac::Operation::Impl,
-                public pvac::detail::wrapped_shared_from_this<Infoer>
+                public pvac::detail::wrapped_shared_from_this<Infoer>,
+                public pvac::detail::CallbackQueue<Infoer, pvac::ClientChannel::InfoCallback, pvac::InfoEvent>
 {
     pvac::ClientChannel::InfoCallback *cb;
     const pva::Channel::shared_pointer channel;
@@ -61,10 +62,20 @@ struct Infoer : public pvac::detail::CallbackStorage,
             evt.event = status.isSuccess() ? pvac::InfoEvent::Success : pvac::InfoEvent::Fail;
             evt.message = status.getMessage();
             evt.type = field;
+            if(defer(C, evt))
+                return;
             CallbackUse U(G);
+            deliver(C, evt);
+        }
+    }
+
+    void deliver(pvac::ClientChannel::InfoCallback *C, const pvac::InfoEvent& evt)
+    {
+        try {
             C->infoDone(evt);
+        }catch(std::exception& e){
+            LOG(pva::logLevelError, "Unhandled exception in ClientChannel::InfoCallback::infoDone(): %s", e.what());
         }
-        pvac::InfoEvent evt;
     }
 
     virtual std::string name() const OVERRIDE FINAL { return channel->getChannelName(); }
@@ -72,6 +83,7 @@ struct Infoer : public pvac::detail::CallbackStorage,
     virtual void cancel() OVERRIDE FINAL {
         CallbackGuard G(*this);
         // we can't actually cancel a getField
+        clearDeferred();
         pvac::ClientChannel::InfoCallback *C(cb);
         cb = 0;
         if(C) {
@@ -101,6 +113,10 @@ Operation ClientChannel::info(InfoCallback *cb, const std::string& subfld)
     if(!impl) throw std::logic_error("Dead Channel");
 
     std::tr1::shared_ptr<Infoer> ret(Infoer::build(cb, getChannel()));
+    if(!dynamic_cast<detail::InlineCallback*>(cb)) {
+        ret->executor = getExecutor();
+        ret->key = impl.get();
+    }
 
     {
         Guard G(ret->mutex);
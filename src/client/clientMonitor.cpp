@@ -24,7 +24,8 @@ using pvac::detail::CallbackUse;
 
 struct Monitor::Impl : public pvac::detail::CallbackStorage,
                        public pva::MonitorRequester,
-                       public pvac::detail::wrapped_shared_from_this<Monitor::Impl>
+                       public pvac::detail::wrapped_shared_from_this<Monitor::Impl>,
+                       public pvac::detail::CallbackQueue<Monitor::Impl, ClientChannel::MonitorCallback, MonitorEvent>
 {
     pva::Channel::shared_pointer chan;
     operation_type::shared_pointer op;
@@ -60,6 +61,14 @@ struct Monitor::Impl : public pvac::detail::CallbackStorage,
         if(evt==MonitorEvent::Fail || evt==MonitorEvent::Cancel)
             this->cb = 0; // last event
 
+        if(evt!=MonitorEvent::Cancel) {
+            // one Data event already queued will poll() everything
+            if(evt==MonitorEvent::Data && !deferred.empty() && deferred.back().event.event==MonitorEvent::Data)
+                return;
+            if(defer(cb, event))
+                return;
+        }
+
         try {
             CallbackUse U(G);
             cb->monitorEvent(event);
@@ -83,6 +92,27 @@ struct Monitor::Impl : public pvac::detail::CallbackStorage,
         }
     }
 
+    // through Executor
+    void deliver(ClientChannel::MonitorCallback *cb, const MonitorEvent& evt)
+    {
+        try {
+            cb->monitorEvent(evt);
+        }catch(std::exception& e){
+            Guard G(mutex);
+            if(this->cb!=cb || evt.event==MonitorEvent::Fail) {
+                LOG(pva::logLevelError, "Unhandled exception in ClientChannel::MonitorCallback::monitorEvent(): %s", e.what());
+            } else {
+                // end subscription with an error, as for inline callbacks
+                this->cb = 0;
+                MonitorEvent fail;
+                fail.event = MonitorEvent::Fail;
+                fail.message = e.what();
+                deferred.clear();
+                deferred.push_back(entry_t(cb, fail));
+            }
+        }
+    }
+
     // called automatically via wrapped_shared_from_this
     void cancel()
     {
@@ -101,6 +131,7 @@ struct Monitor::Impl : public pvac::detail::CallbackStorage,
             }
             temp.swap(op);
 
+            clearDeferred();
             callEvent(G, MonitorEvent::Cancel);
             G.wait();
         }
@@ -250,6 +281,10 @@ ClientChannel::monitor(MonitorCallback *cb,
 
     std::tr1::shared_ptr<Monitor::Impl> ret(Monitor::Impl::build(cb));
     ret->chan = getChannel();
+    if(!dynamic_cast<detail::InlineCallback*>(cb)) {
+        ret->executor = getExecutor();
+        ret->key = impl.get();
+    }
 
     {
         Guard G(ret->mutex);
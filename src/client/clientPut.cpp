@@ -25,7 +25,8 @@ using pvac::detail::CallbackUse;
 struct Putter : public pvac::detail::CallbackStorage,
                 public pva::ChannelPutRequester,
                 public pvac::Operation::Impl,
-                public pvac::detail::wrapped_shared_from_this<Putter>
+                public pvac::detail::wrapped_shared_from_this<Putter>,
+                public pvac::detail::CallbackQueue<Putter, pvac::ClientChannel::PutCallback, pvac::GetEvent>
 {
     const bool getcurrent;
 
@@ -54,7 +55,14 @@ struct Putter : public pvac::detail::CallbackStorage,
         event.event = evt;
         pvac::ClientChannel::PutCallback *C=cb;
         cb = 0;
+        if(evt!=pvac::GetEvent::Cancel && defer(C, event))
+            return;
         CallbackUse U(G);
+        deliver(C, event);
+    }
+
+    void deliver(pvac::ClientChannel::PutCallback *C, const pvac::GetEvent& event)
+    {
         try {
             C->putDone(event);
         } catch(std::exception& e) {
@@ -75,6 +83,7 @@ struct Putter : public pvac::detail::CallbackStorage,
         std::tr1::shared_ptr<Putter> keepalive(internal_shared_from_this());
         CallbackGuard G(*this);
         if(started && op) op->cancel();
+        clearDeferred();
         callEvent(G, pvac::GetEvent::Cancel);
         G.wait();
     }
@@ -217,6 +226,10 @@ ClientChannel::put(PutCallback* cb,
         pvRequest = pvd::createRequest("field()");
 
     std::tr1::shared_ptr<Putter> ret(Putter::build(cb, getprevious));
+    if(!dynamic_cast<detail::InlineCallback*>(cb)) {
+        ret->executor = getExecutor();
+        ret->key = impl.get();
+    }
 
     {
         Guard G(ret->mutex);
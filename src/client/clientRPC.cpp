@@ -24,7 +24,8 @@ using pvac::detail::CallbackUse;
 struct RPCer : public pvac::detail::CallbackStorage,
                public pva::ChannelRPCRequester,
                public pvac::Operation::Impl,
-               public pvac::detail::wrapped_shared_from_this<RPCer>
+               public pvac::detail::wrapped_shared_from_this<RPCer>,
+               public pvac::detail::CallbackQueue<RPCer, pvac::ClientChannel::GetCallback, pvac::GetEvent>
 {
     bool started;
     operation_type::shared_pointer op;
@@ -56,10 +57,16 @@ struct RPCer : public pvac::detail::CallbackStorage,
 
         this->cb = 0;
 
+        if(evt!=pvac::GetEvent::Cancel && defer(cb, event))
+            return;
+        CallbackUse U(G);
+        deliver(cb, event);
+    }
+
+    void deliver(pvac::ClientChannel::GetCallback *cb, const pvac::GetEvent& event)
+    {
         try {
-            CallbackUse U(G);
             cb->getDone(event);
-            return;
         }catch(std::exception& e){
             LOG(pva::logLevelError, "Unhandled exception in ClientChannel::RPCCallback::requestDone(): %s", e.what());
         }
@@ -77,6 +84,7 @@ struct RPCer : public pvac::detail::CallbackStorage,
         std::tr1::shared_ptr<RPCer> keepalive(internal_shared_from_this());
         CallbackGuard G(*this);
         if(started && op) op->cancel();
+        clearDeferred();
         callEvent(G, pvac::GetEvent::Cancel);
     }
 
@@ -164,6 +172,10 @@ ClientChannel::rpc(GetCallback* cb,
         pvRequest = pvd::createRequest("field()");
 
     std::tr1::shared_ptr<RPCer> ret(RPCer::build(cb, arguments));
+    if(!dynamic_cast<detail::InlineCallback*>(cb)) {
+        ret->executor = getExecutor();
+        ret->key = impl.get();
+    }
 
     {
         Guard G(ret->mutex);
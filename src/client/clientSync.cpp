@@ -16,6 +16,7 @@
 #include "pv/logger.h"
 #include "pva/client.h"
 #include "pv/pvAccess.h"
+#include "clientpvt.h"
 
 namespace pvd = epics::pvData;
 namespace pva = epics::pvAccess;
@@ -23,7 +24,7 @@ typedef epicsGuard<epicsMutex> Guard;
 typedef epicsGuardRelease<epicsMutex> UnGuard;
 
 namespace {
-struct WaitCommon
+struct WaitCommon : public pvac::detail::InlineCallback
 {
     epicsMutex mutex;
     epicsEvent event;
@@ -279,7 +280,8 @@ void PutBuilder::exec(double timeout)
 
 } // namespace detail
 
-struct MonitorSync::SImpl : public ClientChannel::MonitorCallback
+struct MonitorSync::SImpl : public ClientChannel::MonitorCallback,
+                            public detail::InlineCallback
 {
     const bool ourevent;
     epicsEvent * const event;
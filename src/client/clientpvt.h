@@ -2,6 +2,7 @@
 #define CLIENTPVT_H
 
 #include <utility>
+#include <deque>
 
 #include <epicsEvent.h>
 #include <epicsThread.h>
@@ -169,6 +170,79 @@ struct CallbackUse {
 };
 
 
+/* Marks the completion callbacks used by the blocking methods (eg. ClientChannel::get(double)).
+ * These only wake a waiting thread, and are always called inline.
+ * Queueing them to an Executor could deadlock a blocking call made from a callback.
+ */
+struct InlineCallback {
+    virtual ~InlineCallback() {}
+};
+
+template<typename Derived>
+struct DeferredJob : public Executor::Job {
+    const std::tr1::shared_ptr<Derived> self;
+    explicit DeferredJob(const std::tr1::shared_ptr<Derived>& self) :self(self) {}
+    virtual ~DeferredJob() {}
+    virtual void run() { self->runDeferred(); }
+};
+
+/* Callbacks of one operation waiting to be run through an Executor.
+ * Guarded by the CallbackStorage::mutex of Derived, which must provide
+ * internal_shared_from_this() and deliver(CB*, const Event&).
+ *
+ * Only one job per operation is queued at a time.  It delivers all pending events.
+ */
+template<typename Derived, typename CB, typename Event>
+struct CallbackQueue {
+    // weak so that the Executor is never destroyed from one of its own workers
+    std::tr1::weak_ptr<Executor> executor;
+    const void *key;
+
+    struct entry_t {
+        CB *cb;
+        Event event;
+        entry_t(CB *cb, const Event& event) :cb(cb), event(event) {}
+    };
+    typedef std::deque<entry_t> deferred_t;
+    deferred_t deferred;
+
+    CallbackQueue() :key(0) {}
+
+    // call with CallbackGuard locked.
+    // returns false if the caller should deliver inline.
+    bool defer(CB *cb, const Event& event) {
+        std::tr1::shared_ptr<Executor> exec(executor.lock());
+        if(!exec) return false;
+        bool wasempty = deferred.empty();
+        deferred.push_back(entry_t(cb, event));
+        if(wasempty) {
+            std::tr1::shared_ptr<Executor::Job> job(new DeferredJob<Derived>(static_cast<Derived*>(this)->internal_shared_from_this()));
+            exec->submit(key, job);
+        }
+        return true;
+    }
+
+    // call with CallbackGuard locked.  Drop events not yet delivered
+    void clearDeferred() { deferred.clear(); }
+
+    void runDeferred() {
+        Derived *self = static_cast<Derived*>(this);
+        CallbackGuard G(*self);
+        while(true) {
+            // wait for any in-progress callback (eg. Cancel) before
+            // checking whether events remain.
+            G.wait();
+            if(deferred.empty())
+                break;
+            entry_t ent(deferred.front());
+            deferred.pop_front();
+            CallbackUse U(G);
+            self->deliver(ent.cb, ent.event);
+        }
+    }
+};
+
+
 void registerRefTrack();
 void registerRefTrackGet();
 void registerRefTrackPut();
@@ -51,6 +51,7 @@ MonitorFIFO::MonitorFIFO(const std::tr1::shared_ptr<MonitorRequester> &requester
     ,needClosed(false)
     ,freeHighLevel(0u)
     ,flowCount(0)
+    ,noverrun(0u)
 {
     REFTRACE_INCREMENT(num_instances);
 
@@ -265,34 +266,65 @@ void MonitorFIFO::post(const pvData::PVStructure& value,
     if(state!=Opened || finished) return;
     assert(!empty.empty() || !inuse.empty());
 
-    const bool use_empty = !empty.empty();
+    if(conf.dropEmptyUpdates && !changed.logical_and(mapper.requestedMask()))
+        return; // drop empty update
 
-    MonitorElementPtr elem;
+    MonitorElement& elem = _postTarget();
 
-    if(use_empty) {
-        // space in window, or entering overflow, fill an empty element
+    scratch.clear();
+    mapper.copyBaseToRequested(value, changed, *elem.pvStructurePtr, scratch);
+    oscratch.clear();
+    mapper.maskBaseToRequested(overrun, oscratch);
 
-        assert(!empty.empty());
+    _postCommit();
+}
 
-        elem = empty.front();
+void MonitorFIFO::postMapped(const pvData::PVStructure& value,
+                             const pvd::BitSet& changed,
+                             const pvd::BitSet& overrun)
+{
+    Guard G(mutex);
+
+    if(state!=Opened || finished) return;
+    assert(!empty.empty() || !inuse.empty());
+
+    // usually the same instance as the type cache of FieldCreate de-duplicates
+    if(value.getStructure()!=mapper.requested() && *value.getStructure()!=*mapper.requested())
+        throw std::logic_error("postMapped() type mis-match");
+
+    if(conf.dropEmptyUpdates && changed.isEmpty())
+        return; // drop empty update
+
+    MonitorElement& elem = _postTarget();
+
+    elem.pvStructurePtr->copyUnchecked(value, changed);
+    scratch = changed;
+    oscratch = overrun;
+
+    _postCommit();
+}
+
+MonitorElement& MonitorFIFO::_postTarget()
+{
+    if(!empty.empty()) {
+        // space in window, or entering overflow, fill an empty element
+        return *empty.front();
 
     } else {
         // window full and already in overflow
         // squash with last element
         assert(!inuse.empty());
-        elem = inuse.back();
+        return *inuse.back();
     }
+}
 
-    if(conf.dropEmptyUpdates && !changed.logical_and(mapper.requestedMask()))
-        return; // drop empty update
-
-    scratch.clear();
-    mapper.copyBaseToRequested(value, changed, *elem->pvStructurePtr, scratch);
+void MonitorFIFO::_postCommit()
+{
+    if(!empty.empty()) {
+        MonitorElementPtr& elem = empty.front();
 
-    if(use_empty) {
         *elem->changedBitSet = scratch;
-        elem->overrunBitSet->clear();
-        mapper.maskBaseToRequested(overrun, *elem->overrunBitSet);
+        *elem->overrunBitSet = oscratch;
 
         if(inuse.empty() && running)
             needEvent = true;
@@ -303,13 +335,14 @@ void MonitorFIFO::post(const pvData::PVStructure& value,
             flowCount--;
 
     } else {
+        MonitorElementPtr& elem = inuse.back();
+
         // in overflow
         // squash
         elem->overrunBitSet->or_and(*elem->changedBitSet, scratch);
         *elem->changedBitSet |= scratch;
-        oscratch.clear();
-        mapper.maskBaseToRequested(overrun, oscratch);
         elem->overrunBitSet->or_and(oscratch, scratch);
+        noverrun++;
 
         // leave as inuse.back()
     }
@@ -464,6 +497,7 @@ void MonitorFIFO::getStats(Stats& s) const
     s.nempty = empty.size() + returned.size();
     s.nfilled = inuse.size();
     s.noutstanding = conf.actualCount - s.nempty - s.nfilled;
+    s.noverrun = noverrun;
 }
 
 void MonitorFIFO::reportRemoteQueueStatus(pvd::int32 nfree)
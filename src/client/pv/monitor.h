@@ -101,10 +101,13 @@ class epicsShareClass Monitor : public virtual Destroyable{
         size_t nfilled; //!< # of elements ready to be poll()d
         size_t noutstanding; //!< # of elements poll()d but not released()d
         size_t nempty; //!< # of elements available for new remote data
+        size_t noverrun; //!< # of updates squashed into an earlier element since creation
+        size_t nbytes; //!< array storage held by all elements.  Storage shared by several elements is counted once.
+        Stats() :nfilled(0u), noutstanding(0u), nempty(0u), noverrun(0u), nbytes(0u) {}
     };
 
     virtual void getStats(Stats& s) const {
-        s.nfilled = s.noutstanding = s.nempty = 0;
+        s.nfilled = s.noutstanding = s.nempty = s.noverrun = s.nbytes = 0;
     }
 
     /**
@@ -326,6 +329,21 @@ public:
     void post(const pvData::PVStructure& value,
               const epics::pvData::BitSet& changed,
               const epics::pvData::BitSet& overrun = epics::pvData::BitSet());
+    /** Like post(), for an update which has already been mapped to the requested type.
+     *
+     * Allows a producer with many subscribers using equivalent pvRequests
+     * to run one PVRequestMapper per update, instead of one per subscriber.
+     *
+     * @param value An instance of the requested type, as from PVRequestMapper::buildRequested()
+     *              of a mapper computed with the same type, pvRequest, and mode as open().
+     * @param changed Bit offsets of value
+     * @param overrun Bit offsets of value
+     * @throws std::logic_error if value is not of the requested type
+     * @since >7.1.0
+     */
+    void postMapped(const pvData::PVStructure& value,
+                    const epics::pvData::BitSet& changed,
+                    const epics::pvData::BitSet& overrun = epics::pvData::BitSet());
     //! Call after calling any other upstream interface methods (open()/close()/finish()/post()/...)
     //! when no upstream mutexes are locked.
     //! Do not call from Source::freeHighMark().  This is done automatically.
@@ -344,6 +362,11 @@ public:
     size_t freeCount() const;
 private:
     size_t _freeCount() const;
+    // post() helpers, call with mutex locked.
+    // element to be filled from scratch/oscratch
+    MonitorElement& _postTarget();
+    // queue, or squash, the element from _postTarget()
+    void _postCommit();
 
     friend void providerRegInit(void*);
     static size_t num_instances;
@@ -399,6 +422,7 @@ private:
 
     size_t freeHighLevel;
     epicsInt32 flowCount;
+    size_t noverrun; // post() squashed
 
     epics::pvData::PVRequestMapper mapper;
 
@@ -588,6 +588,12 @@ public:
      * ChannelPutRequester::putDone() or ChannelPutRequester::channelDisconnect()
      * is called.
      *
+     * With pvRequest option record._options.pipeline=true, the 'pva' provider
+     * copies the data before returning, and allows up to record._options.queueSize
+     * (default 4) puts to be in flight.  putDone() is called once for each put, in order.
+     * A put beyond this window fails immediately.
+     * Servers without pipeline support reduce the window to 1.
+     *
      * @param pvPutStructure The PVStructure that holds the putData.
      * @param putBitSet putPVStructure bit-set (selects what fields to put).
      */
@@ -847,6 +853,40 @@ public:
 
 class ChannelRequester;
 
+/**
+ * Timing of the operations of a Channel, summed over all get, put and monitor operations.
+ * Only collected by some providers, and only when enabled.
+ * eg. by the "pva" client provider when $EPICS_PVA_CLIENT_STATS=YES
+ */
+struct epicsShareClass ChannelStats {
+    //! Counts of times, in log2 microseconds.
+    //! bucket[i] counts times < 2^i us, and the last bucket all longer times.
+    struct epicsShareClass Histogram {
+        enum { nbuckets = 20 };
+        size_t bucket[nbuckets];
+        Histogram();
+        //! Count one time, in seconds
+        void add(double seconds);
+        //! Total of all buckets
+        size_t count() const;
+        //! Upper bound, in seconds, of the bucket holding the given fraction (0.0 - 1.0) of all counts
+        double percentile(double fraction) const;
+    };
+
+    bool enabled; //!< false when not collected.  All else is zero.
+    Histogram getLatency; //!< time from sending a get request until its reply is received
+    Histogram putLatency; //!< time from sending a put request until its reply is received
+    Histogram decode; //!< time spent deserializing replies and monitor updates
+    epics::pvData::uint64 nrxBytes; //!< payload bytes of replies and monitor updates
+    size_t nupdates; //!< monitor updates received
+    double updatePeriod; //!< mean time, in seconds, between monitor updates of one subscription
+    double updateJitter; //!< standard deviation, in seconds, of the time between monitor updates
+    size_t noverrun; //!< monitor updates squashed into an earlier update
+
+    ChannelStats();
+    void show(std::ostream& out) const;
+};
+
 /**
  * The interface through which Operations (get, put, monitor, ...) are initiated.
  *
@@ -1063,6 +1103,12 @@ public:
      *
      * @return A non-NULL Monitor unless monitorConnect() called with an Error
      *
+     * With the 'pva' provider, pvRequest option record._options.adaptive=true,
+     * together with pipeline=true, reports the rate at which the consumer releases
+     * elements to the server.  When the consumer falls behind, the server keeps only enough updates
+     * in flight to cover one round trip, and squashes the rest rather than filling the client queue.
+     * See Monitor::getStats().
+     *
      * @note The default implementation yields a not implemented error
      */
     virtual Monitor::shared_pointer createMonitor(
@@ -1105,6 +1151,13 @@ public:
      * @param out the output stream.
      */
     virtual void printInfo(std::ostream& out) {}
+
+    typedef ChannelStats Stats;
+
+    /** Fetch the present values of the operation statistics.
+     *  The default implementation yields Stats::enabled==false
+     */
+    virtual void getStats(Stats& s) const;
 };
 
 
@@ -1190,6 +1243,40 @@ struct epicsShareClass DefaultChannelRequester : public ChannelRequester
     static ChannelRequester::shared_pointer build();
 };
 
+/**
+ * Requester for ChannelProvider::getMany() and ChannelProvider::putMany().
+ *
+ * One of getManyDone() or putManyDone() is called exactly once for each
+ * index into the list of channels.  Calls for different indices may come
+ * from different threads, and in any order.
+ */
+class epicsShareClass ChannelMultiRequester : public virtual epics::pvData::Requester
+{
+public:
+    POINTER_DEFINITIONS(ChannelMultiRequester);
+
+    virtual ~ChannelMultiRequester() {}
+
+    /**
+     * Result of getMany() for one channel.
+     * @param index Position in the list of channels.
+     * @param status Completion status.
+     * @param value The data or nullptr if the request failed.
+     * @param changed Marks the fields of value which are valid, or nullptr if the request failed.
+     */
+    virtual void getManyDone(size_t index,
+                             const epics::pvData::Status& status,
+                             epics::pvData::PVStructure::shared_pointer const & value,
+                             epics::pvData::BitSet::shared_pointer const & changed) {}
+
+    /**
+     * Result of putMany() for one channel.
+     * @param index Position in the list of channels.
+     * @param status Completion status.
+     */
+    virtual void putManyDone(size_t index, const epics::pvData::Status& status) {}
+};
+
 /**
  * @brief The FlushStrategy enum
  */
@@ -1288,6 +1375,64 @@ public:
      */
     virtual Channel::shared_pointer createChannel(std::string const & name,ChannelRequester::shared_pointer const & requester,
             short priority, std::string const & address) = 0;
+
+    /**
+     * Request several Channels.
+     *
+     * Equivalent to calling createChannel() for each name, but allows a provider
+     * to share the work of creating, and searching for, many channels at once.
+     * The default implementation calls createChannel() for each name.
+     *
+     * @param names The names of the channels.
+     * @param requesters One requester for each name.
+     * @param priority channel priority, as for createChannel().
+     * @param address as for createChannel().  Applies to all channels.
+     * @param channels Appended with one entry per name.  An entry may be NULL as for createChannel().
+     * @since >6.1.0
+     */
+    virtual void createChannels(std::vector<std::string> const & names,
+                                std::vector<ChannelRequester::shared_pointer> const & requesters,
+                                short priority, std::string const & address,
+                                std::vector<Channel::shared_pointer>& channels);
+
+    /**
+     * Get the current value of several Channels.
+     *
+     * Equivalent to a one-shot ChannelGet on each channel, but allows a provider
+     * to gather the requests for channels of one server into a single round trip.
+     * The default implementation creates a ChannelGet for each channel.
+     *
+     * @param channels Channels created by this provider.
+     * @param pvRequest Applies to all channels.
+     * @param requester Receives ChannelMultiRequester::getManyDone() for each channel.
+     * @since >6.1.0
+     */
+    virtual void getMany(std::vector<Channel::shared_pointer> const & channels,
+                         epics::pvData::PVStructure::shared_pointer const & pvRequest,
+                         ChannelMultiRequester::shared_pointer const & requester);
+
+    /**
+     * Put a value to each of several Channels.
+     *
+     * Equivalent to a one-shot ChannelPut on each channel, as for getMany().
+     * Each value must have the type of the put structure for its channel,
+     * as from ChannelPutRequester::channelPutConnect() with the same pvRequest,
+     * otherwise that channel fails.
+     * The default implementation creates a ChannelPut for each channel.
+     *
+     * @param channels Channels created by this provider.
+     * @param pvRequest Applies to all channels.
+     * @param values One value for each channel.
+     * @param changed One BitSet for each channel, marking the fields of the value to be sent.
+     *        A NULL entry, or an empty list, sends the whole structure.
+     * @param requester Receives ChannelMultiRequester::putManyDone() for each channel.
+     * @since >6.1.0
+     */
+    virtual void putMany(std::vector<Channel::shared_pointer> const & channels,
+                         epics::pvData::PVStructure::shared_pointer const & pvRequest,
+                         std::vector<epics::pvData::PVStructure::shared_pointer> const & values,
+                         std::vector<epics::pvData::BitSet::shared_pointer> const & changed,
+                         ChannelMultiRequester::shared_pointer const & requester);
 };
 
 /**
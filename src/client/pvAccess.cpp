@@ -48,6 +48,84 @@ Channel::ConnectionState Channel::getConnectionState() { return CONNECTED; }
 
 bool Channel::isConnected() { return getConnectionState()==CONNECTED; }
 
+ChannelStats::Histogram::Histogram()
+{
+    for(size_t i=0; i<size_t(nbuckets); i++)
+        bucket[i] = 0u;
+}
+
+void ChannelStats::Histogram::add(double seconds)
+{
+    const double usec = seconds*1e6;
+    size_t i = 0u;
+    while(i+1u < size_t(nbuckets) && usec >= double(1u<<i))
+        i++;
+    bucket[i]++;
+}
+
+size_t ChannelStats::Histogram::count() const
+{
+    size_t total = 0u;
+    for(size_t i=0; i<size_t(nbuckets); i++)
+        total += bucket[i];
+    return total;
+}
+
+double ChannelStats::Histogram::percentile(double fraction) const
+{
+    const size_t target = size_t(fraction*count());
+    size_t sum = 0u;
+    for(size_t i=0; i<size_t(nbuckets); i++) {
+        sum += bucket[i];
+        if(sum > target)
+            return double(1u<<i)*1e-6;
+    }
+    return double(1u<<(nbuckets-1))*1e-6;
+}
+
+ChannelStats::ChannelStats()
+    :enabled(false)
+    ,nrxBytes(0u)
+    ,nupdates(0u)
+    ,updatePeriod(0.0)
+    ,updateJitter(0.0)
+    ,noverrun(0u)
+{}
+
+namespace {
+void showHistogram(std::ostream& out, const char *name, const ChannelStats::Histogram& hist)
+{
+    out<<name<<hist.count();
+    if(hist.count())
+        out<<" (ms) p50 < "<<hist.percentile(0.50)*1e3
+           <<" p90 < "<<hist.percentile(0.90)*1e3
+           <<" p99 < "<<hist.percentile(0.99)*1e3;
+    out<<std::endl;
+}
+}
+
+void ChannelStats::show(std::ostream& out) const
+{
+    if(!enabled) {
+        out<<"STATS    : disabled"<<std::endl;
+        return;
+    }
+    showHistogram(out, "GET      : ", getLatency);
+    showHistogram(out, "PUT      : ", putLatency);
+    showHistogram(out, "DECODE   : ", decode);
+    out<<"RX BYTES : "<<nrxBytes<<std::endl;
+    out<<"UPDATES  : "<<nupdates;
+    if(nupdates>1u)
+        out<<" period "<<updatePeriod*1e3<<" ms, jitter "<<updateJitter*1e3<<" ms";
+    out<<std::endl;
+    out<<"OVERRUNS : "<<noverrun<<std::endl;
+}
+
+void Channel::getStats(Stats& s) const
+{
+    s = Stats();
+}
+
 void Channel::getField(GetFieldRequester::shared_pointer const & requester,std::string const & subField)
 {
     requester->getDone(pvd::Status(pvd::Status::STATUSTYPE_FATAL, "Not Implemented")
@@ -475,3 +553,230 @@ ChannelFind::shared_pointer ChannelFind::buildDummy(const ChannelProvider::share
 }
 
 }} // namespace epics::pvAccess
+
+namespace {
+namespace pva = epics::pvAccess;
+
+typedef epicsGuard<epicsMutex> Guard;
+
+/* One-shot get or put of one channel on behalf of getMany() or putMany().
+ * Keeps itself, and its operation, alive until complete().
+ */
+template<typename Op>
+struct MultiOne
+{
+    const pva::ChannelMultiRequester::shared_pointer requester;
+    const size_t index;
+
+    epicsMutex mutex;
+    // Note: reference loops, broken in complete()
+    std::tr1::shared_ptr<void> self;
+    typename Op::shared_pointer op;
+
+    MultiOne(const pva::ChannelMultiRequester::shared_pointer& requester, size_t index)
+        :requester(requester), index(index)
+    {}
+
+    void started(const typename Op::shared_pointer& o)
+    {
+        Guard G(mutex);
+        if(self)
+            op = o;
+        // else already complete()
+    }
+
+    // returns false if already complete
+    bool complete(std::tr1::shared_ptr<void>& keep, typename Op::shared_pointer& cleanup)
+    {
+        Guard G(mutex);
+        if(!self)
+            return false;
+        keep.swap(self);
+        cleanup.swap(op);
+        return true;
+    }
+};
+
+struct MultiGetOne : public pva::ChannelGetRequester,
+                     public MultiOne<pva::ChannelGet>
+{
+    POINTER_DEFINITIONS(MultiGetOne);
+
+    MultiGetOne(const pva::ChannelMultiRequester::shared_pointer& requester, size_t index)
+        :MultiOne<pva::ChannelGet>(requester, index)
+    {}
+    virtual ~MultiGetOne() {}
+
+    static void start(const pva::Channel::shared_pointer& channel,
+                      const pvd::PVStructure::shared_pointer& pvRequest,
+                      const pva::ChannelMultiRequester::shared_pointer& requester,
+                      size_t index)
+    {
+        shared_pointer one(new MultiGetOne(requester, index));
+        one->self = one;
+        try {
+            one->started(channel->createChannelGet(one, pvRequest));
+        }catch(std::exception& e){
+            one->done(pvd::Status(pvd::Status::STATUSTYPE_ERROR, e.what()));
+        }
+    }
+
+    void done(const pvd::Status& sts,
+              const pvd::PVStructure::shared_pointer& value = pvd::PVStructure::shared_pointer(),
+              const pvd::BitSet::shared_pointer& changed = pvd::BitSet::shared_pointer())
+    {
+        std::tr1::shared_ptr<void> keep;
+        pva::ChannelGet::shared_pointer cleanup;
+        if(complete(keep, cleanup))
+            requester->getManyDone(index, sts, value, changed);
+    }
+
+    virtual std::string getRequesterName() OVERRIDE FINAL { return requester->getRequesterName(); }
+
+    virtual void channelGetConnect(const pvd::Status& status,
+                                   pva::ChannelGet::shared_pointer const & channelGet,
+                                   pvd::Structure::const_shared_pointer const & structure) OVERRIDE FINAL
+    {
+        if(!status.isSuccess()) {
+            done(status);
+        } else {
+            channelGet->lastRequest();
+            channelGet->get();
+        }
+    }
+
+    virtual void getDone(const pvd::Status& status,
+                         pva::ChannelGet::shared_pointer const & channelGet,
+                         pvd::PVStructure::shared_pointer const & pvStructure,
+                         pvd::BitSet::shared_pointer const & bitSet) OVERRIDE FINAL
+    {
+        done(status, pvStructure, bitSet);
+    }
+
+    virtual void channelDisconnect(bool destroy) OVERRIDE FINAL
+    {
+        done(pvd::Status(pvd::Status::STATUSTYPE_ERROR, destroy ? "Channel destroyed" : "Channel disconnected"));
+    }
+};
+
+struct MultiPutOne : public pva::ChannelPutRequester,
+                     public MultiOne<pva::ChannelPut>
+{
+    POINTER_DEFINITIONS(MultiPutOne);
+
+    const pvd::PVStructure::shared_pointer value;
+    const pvd::BitSet::shared_pointer changed;
+
+    MultiPutOne(const pva::ChannelMultiRequester::shared_pointer& requester, size_t index,
+                const pvd::PVStructure::shared_pointer& value,
+                const pvd::BitSet::shared_pointer& changed)
+        :MultiOne<pva::ChannelPut>(requester, index)
+        ,value(value)
+        ,changed(changed)
+    {}
+    virtual ~MultiPutOne() {}
+
+    static void start(const pva::Channel::shared_pointer& channel,
+                      const pvd::PVStructure::shared_pointer& pvRequest,
+                      const pva::ChannelMultiRequester::shared_pointer& requester,
+                      size_t index,
+                      const pvd::PVStructure::shared_pointer& value,
+                      const pvd::BitSet::shared_pointer& changed)
+    {
+        shared_pointer one(new MultiPutOne(requester, index, value, changed));
+        one->self = one;
+        try {
+            one->started(channel->createChannelPut(one, pvRequest));
+        }catch(std::exception& e){
+            one->done(pvd::Status(pvd::Status::STATUSTYPE_ERROR, e.what()));
+        }
+    }
+
+    void done(const pvd::Status& sts)
+    {
+        std::tr1::shared_ptr<void> keep;
+        pva::ChannelPut::shared_pointer cleanup;
+        if(complete(keep, cleanup))
+            requester->putManyDone(index, sts);
+    }
+
+    virtual std::string getRequesterName() OVERRIDE FINAL { return requester->getRequesterName(); }
+
+    virtual void channelPutConnect(const pvd::Status& status,
+                                   pva::ChannelPut::shared_pointer const & channelPut,
+                                   pvd::Structure::const_shared_pointer const & structure) OVERRIDE FINAL
+    {
+        if(!status.isSuccess()) {
+            done(status);
+        } else if(!(*structure == *value->getStructure())) {
+            done(pvd::Status(pvd::Status::STATUSTYPE_ERROR, "incompatible put structure"));
+        } else {
+            channelPut->lastRequest();
+            channelPut->put(value, changed);
+        }
+    }
+
+    virtual void putDone(const pvd::Status& status,
+                         pva::ChannelPut::shared_pointer const & channelPut) OVERRIDE FINAL
+    {
+        done(status);
+    }
+
+    virtual void getDone(const pvd::Status& status,
+                         pva::ChannelPut::shared_pointer const & channelPut,
+                         pvd::PVStructure::shared_pointer const & pvStructure,
+                         pvd::BitSet::shared_pointer const & bitSet) OVERRIDE FINAL
+    {}
+
+    virtual void channelDisconnect(bool destroy) OVERRIDE FINAL
+    {
+        done(pvd::Status(pvd::Status::STATUSTYPE_ERROR, destroy ? "Channel destroyed" : "Channel disconnected"));
+    }
+};
+
+} // namespace
+
+namespace epics {namespace pvAccess {
+
+void ChannelProvider::getMany(std::vector<Channel::shared_pointer> const & channels,
+                              pvd::PVStructure::shared_pointer const & pvRequest,
+                              ChannelMultiRequester::shared_pointer const & requester)
+{
+    if(!requester)
+        throw std::logic_error("getMany() requires a requester");
+
+    for(size_t i=0; i<channels.size(); i++) {
+        if(!channels[i])
+            requester->getManyDone(i, pvd::Status(pvd::Status::STATUSTYPE_ERROR, "NULL Channel"),
+                                   pvd::PVStructure::shared_pointer(), pvd::BitSet::shared_pointer());
+        else
+            MultiGetOne::start(channels[i], pvRequest, requester, i);
+    }
+}
+
+void ChannelProvider::putMany(std::vector<Channel::shared_pointer> const & channels,
+                              pvd::PVStructure::shared_pointer const & pvRequest,
+                              std::vector<pvd::PVStructure::shared_pointer> const & values,
+                              std::vector<pvd::BitSet::shared_pointer> const & changed,
+                              ChannelMultiRequester::shared_pointer const & requester)
+{
+    if(!requester)
+        throw std::logic_error("putMany() requires a requester");
+    else if(values.size()!=channels.size() || (!changed.empty() && changed.size()!=channels.size()))
+        throw std::logic_error("putMany() requires one value, and optionally one BitSet, per channel");
+
+    for(size_t i=0; i<channels.size(); i++) {
+        if(!channels[i] || !values[i]) {
+            requester->putManyDone(i, pvd::Status(pvd::Status::STATUSTYPE_ERROR, "NULL Channel or value"));
+        } else {
+            pvd::BitSet::shared_pointer mask(changed.empty() ? pvd::BitSet::shared_pointer() : changed[i]);
+            if(!mask) {
+                mask.reset(new pvd::BitSet);
+                mask->set(0);
+            }
+            MultiPutOne::start(channels[i], pvRequest, requester, i, values[i], mask);
+        }
+    }
+}
+
+}} // namespace epics::pvAccess
@@ -8,6 +8,7 @@
 #include <ostream>
 #include <stdexcept>
 #include <list>
+#include <vector>
 
 #include <epicsMutex.h>
 
@@ -19,6 +20,7 @@ class epicsEvent;
 namespace epics {namespace pvAccess {
 class ChannelProvider;
 class Channel;
+struct ChannelStats;
 class Monitor;
 class Configuration;
 }}//namespace epics::pvAccess
@@ -245,6 +247,63 @@ struct Timeout : public std::runtime_error
     Timeout();
 };
 
+/** Runs user callbacks away from the network threads.
+ *
+ * By default, callbacks are made from the thread which receives the server response.
+ * So one slow callback delays all other channels using the same server connection.
+ * When a ClientProvider is given an Executor, then completion and monitor callbacks,
+ * and connection state listeners, are instead queued to the Executor.
+ *
+ * Jobs submitted with the same key (one key per ClientChannel)
+ * are run in order, and never concurrently.
+ *
+ * @see ClientProvider::setExecutor()
+ * @since >6.1.0
+ */
+class epicsShareClass Executor
+{
+public:
+    typedef std::tr1::shared_ptr<Executor> shared_pointer;
+
+    struct epicsShareClass Job {
+        virtual ~Job();
+        virtual void run() =0;
+    };
+
+    struct epicsShareClass Stats {
+        //! Number of jobs waiting to run
+        size_t queued;
+        //! High water mark of queued
+        size_t maxQueued;
+        //! Number of jobs run
+        size_t executed;
+        //! Number of worker threads
+        size_t threads;
+        Stats();
+    };
+
+    virtual ~Executor();
+
+    /** Queue a job.
+     *
+     * May be called with internal locks held.  So must not run the job before returning.
+     */
+    virtual void submit(const void* key, const std::tr1::shared_ptr<Job>& job) =0;
+
+    virtual void stats(Stats& s) const =0;
+
+    //! A single dedicated thread.  Callbacks for all channels are serialized.
+    static shared_pointer createThread(const std::string& name = "pvacCB");
+
+    /** A pool of worker threads.
+     *
+     * Jobs with different keys run concurrently when a worker is idle.
+     * So a callback blocking one ClientChannel only delays other channels
+     * when all workers are busy.
+     */
+    static shared_pointer createPool(size_t nthreads, const std::string& name = "pvacCB");
+};
+
 namespace detail {
 class PutBuilder;
 void registerRefTrack();
@@ -452,8 +511,17 @@ public:
     void removeConnectListener(ConnectCallback*);
 
     void show(std::ostream& strm) const;
+
+    /** Timing of the operations of this channel.
+     *
+     * Collected by the "pva" provider when $EPICS_PVA_CLIENT_STATS=YES.
+     * Otherwise s.enabled==false
+     * @see epics::pvAccess::Channel::getStats()
+     */
+    void stats(epics::pvAccess::ChannelStats& s) const;
 private:
     std::tr1::shared_ptr<epics::pvAccess::Channel> getChannel();
+    std::tr1::shared_ptr<Executor> getExecutor();
 };
 
 namespace detail {
@@ -543,6 +611,55 @@ public:
     ClientChannel connect(const std::string& name,
                           const ClientChannel::Options& conf = ClientChannel::Options());
 
+    /** Get several Channels at once
+     *
+     * Equivalent to calling connect() for each name, but new channels are created
+     * by one epics::pvAccess::ChannelProvider::createChannels() call.
+     * For the "pva" provider, this searches for all new channels together.
+     *
+     * Does not block.
+     * @return One ClientChannel per name, in the same order.
+     * @since >6.1.0
+     */
+    std::vector<ClientChannel> connect(const std::vector<std::string>& names,
+                                       const ClientChannel::Options& conf = ClientChannel::Options());
+
+    /** Block and retrieve the current values of several Channels
+     *
+     * Uses epics::pvAccess::ChannelProvider::getMany().
+     * For the "pva" provider, the channels connected to one server are read
+     * with a single request and response, where the server supports this.
+     *
+     * @param channels Channels from connect().
+     * @param timeout in seconds.  Applies to the whole request.
+     * @param pvRequest if NULL defaults to "field()".  Applies to all channels.
+     * @return One GetEvent per channel, in the same order.
+     *         A channel which fails, or does not complete before the timeout, has event==Fail.
+     * @since >6.1.0
+     */
+    std::vector<GetEvent> getMany(const std::vector<ClientChannel>& channels,
+                                  double timeout = 3.0,
+                                  epics::pvData::PVStructure::const_shared_pointer pvRequest = epics::pvData::PVStructure::const_shared_pointer());
+
+    /** Block and put a value to each of several Channels
+     *
+     * Uses epics::pvAccess::ChannelProvider::putMany(), as for getMany().
+     * The whole of each value is sent.  Each value must have the type of the channel's
+     * put structure for this pvRequest.  eg. a value from getMany() with the same pvRequest.
+     *
+     * @param channels Channels from connect().
+     * @param values One value per channel.
+     * @param timeout in seconds.  Applies to the whole request.
+     * @param pvRequest if NULL defaults to "field()".  Applies to all channels.
+     * @return One PutEvent per channel, in the same order.
+     *         A channel which fails, or does not complete before the timeout, has event==Fail.
+     * @since >6.1.0
+     */
+    std::vector<PutEvent> putMany(const std::vector<ClientChannel>& channels,
+                                  const std::vector<epics::pvData::PVStructure::const_shared_pointer>& values,
+                                  double timeout = 3.0,
+                                  epics::pvData::PVStructure::const_shared_pointer pvRequest = epics::pvData::PVStructure::const_shared_pointer());
+
     //! Remove from channel cache
     bool disconnect(const std::string& name,
                     const ClientChannel::Options& conf = ClientChannel::Options());
@@ -550,6 +667,22 @@ public:
     //! Clear channel cache
     void disconnect();
 
+    /** Run callbacks of channels created after this call through an Executor.
+     *
+     * Pass NULL (the default) to make callbacks inline from the network threads.
+     *
+     * The ClientProvider keeps a reference to the Executor.
+     * Operations only hold a weak reference, and fall back to inline callbacks
+     * once the Executor is destroyed.
+     *
+     * @note PutCallback::putBuild() is always called inline.
+     *       Callbacks used internally by the blocking methods (eg. ClientChannel::get(double))
+     *       are also inline, so blocking methods may be used from within a callback.
+     * @since >6.1.0
+     */
+    void setExecutor(const std::tr1::shared_ptr<Executor>& executor);
+    std::tr1::shared_ptr<Executor> getExecutor() const;
+
     bool valid() const { return !!impl; }
 
 #if __cplusplus>=201103L
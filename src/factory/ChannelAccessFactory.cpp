@@ -32,6 +32,7 @@ using std::string;
 
 namespace pvas {
 void registerRefTrackServer();
+void registerRefTrackGateway();
 }
 
 namespace epics {
@@ -226,6 +227,7 @@ void providerRegInit(void*)
     registerRefCounter("ResponseHandler (ABC)", &ResponseHandler::num_instances);
     registerRefCounter("MonitorFIFO", &MonitorFIFO::num_instances);
     pvas::registerRefTrackServer();
+    pvas::registerRefTrackGateway();
     registerRefCounter("pvas::SharedChannel", &pvas::detail::SharedChannel::num_instances);
     registerRefCounter("pvas::SharedPut", &pvas::detail::SharedPut::num_instances);
     registerRefCounter("pvas::SharedRPC", &pvas::detail::SharedRPC::num_instances);
@@ -265,6 +267,20 @@ ChannelProvider::createChannel(std::string const & name,
     return createChannel(name, requester, priority, "");
 }
 
+void
+ChannelProvider::createChannels(std::vector<std::string> const & names,
+                                std::vector<ChannelRequester::shared_pointer> const & requesters,
+                                short priority, std::string const & address,
+                                std::vector<Channel::shared_pointer>& channels)
+{
+    if(names.size()!=requesters.size())
+        throw std::logic_error("createChannels() requires one requester per name");
+
+    channels.reserve(channels.size()+names.size());
+    for(size_t i=0; i<names.size(); i++)
+        channels.push_back(createChannel(names[i], requesters[i], priority, address));
+}
+
 }
 }
 
@@ -31,6 +31,7 @@
 #include <pv/pvAccess.h>
 #include <pv/serverContext.h>
 #include <pv/iocshelper.h>
+#include <pv/pvAccessMB.h>
 
 #include <epicsExport.h>
 
@@ -103,6 +104,26 @@ void pvasr(int lvl)
     }
 }
 
+void pvamb(int lvl)
+{
+    try {
+        // trace points are recorded only when built WITH_MICROBENCH
+        if(lvl<=0)
+            MB_pvAccess.stats(std::cout);
+        else if(lvl==1)
+            MB_pvAccess.print(std::cout);
+        else
+            MB_pvAccess.csvExport(std::cout);
+    }catch(std::exception& e){
+        std::cout<<"Error: "<<e.what()<<"\n";
+    }
+}
+
+void pvambReset()
+{
+    MB_pvAccess.reset();
+}
+
 void pva_server_cleanup(void *)
 {
     stopPVAServer();
@@ -125,6 +146,8 @@ void registerStartPVAServer(void)
     epics::iocshRegister<const char*, &startPVAServer>("startPVAServer", "provider names");
     epics::iocshRegister<&stopPVAServer>("stopPVAServer");
     epics::iocshRegister<int, &pvasr>("pvasr", "detail");
+    epics::iocshRegister<int, &pvamb>("pvamb", "detail");
+    epics::iocshRegister<&pvambReset>("pvambReset");
     initHookRegister(&initStartPVAServer);
 }
 
@@ -7,7 +7,232 @@
 #ifndef _PVACCESSMB_H_
 #define _PVACCESSMB_H_
 
-/* this header is deprecated */
+/* Micro-benchmark trace points.
+ *
+ * The MB_* macros expand to nothing unless WITH_MICROBENCH is defined.
+ * Set WITH_MICROBENCH=YES in configure/CONFIG_SITE.local to enable
+ * the trace points built into pvAccess, which are recorded in MB_pvAccess
+ * at these stages:
+ *
+ *  0 "receive"   - codec has a complete message header (new auto id)
+ *  1 "dispatch"  - client or server response handler selects the command handler
+ *  2 "serialize" - codec begins a TransportSender::send() (new auto id)
+ *  3 "send"      - codec writes a buffer to the socket
+ *
+ * Auto ids are per thread, so a stage is compared with the preceding stage
+ * of the same id on the same thread.  Only stages recorded by one thread
+ * are correlated: 0 and 1 on the receive thread, 2 and 3 on the send thread.
+ * There is no point for ChannelProvider callbacks, which run on threads
+ * of the provider with unrelated auto ids.
+ *
+ * @code
+ *   MB_DECLARE(myloop, 4096); // file scope
+ *   ...
+ *   MB_INC_AUTO_ID(myloop);
+ *   MB_POINT(myloop, 0, "start");
+ *   ...
+ *   MB_POINT(myloop, 1, "end");
+ *   ...
+ *   MB_STATS(myloop, std::cout);
+ * @endcode
+ */
+
+#include <ostream>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include <shareLib.h>
+#include <epicsTypes.h>
+#include <epicsMutex.h>
+#include <epicsThread.h>
+#include <epicsTime.h>
+#include <epicsVersion.h>
+
+#ifdef EPICS_VERSION_INT
+#if EPICS_VERSION_INT>=VERSION_INT(3,15,1,0)
+#include <epicsAtomic.h>
+#define PVA_MB_USE_ATOMIC
+#endif
+#endif
+
+/* GCC and clang provide the rdtsc builtin without <x86intrin.h>,
+ * which would otherwise be pulled into every user of this header.
+ */
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define PVA_MB_TSC
+#endif
+
+namespace epics {
+namespace pvAccess {
+
+//! One trace point sample
+struct MBSample {
+    epicsUInt64 id;
+    epicsUInt64 ticks;
+    epicsUInt8 stage;
+};
+
+//! Samples of one thread.  Only the owning thread writes.
+struct MBThreadBuffer {
+    std::vector<MBSample> samples; // size is a power of 2
+    size_t mask;
+    size_t head; // # of samples ever written
+    size_t base; // value of head at the last reset().  guarded by MBEntity::mutex
+    epicsUInt64 autoId;
+    unsigned index;
+    std::string name;
+};
+
+/** A named collection of trace point samples.
+ *
+ * Each thread recording to an MBEntity is given a ring buffer of
+ * a fixed number of samples on first use.  Recording takes no locks.
+ * When full, the oldest samples of that thread are overwritten.
+ *
+ * Reporting may be done while recording continues,
+ * though samples being overwritten at that moment may be inconsistent.
+ */
+class epicsShareClass MBEntity {
+public:
+    /**
+     * @param name Used in reports
+     * @param size Samples kept per thread.  Rounded up to a power of 2.
+     */
+    MBEntity(const char *name, size_t size);
+    ~MBEntity();
+
+    //! Time in "ticks".  The TSC on x86, otherwise nanoseconds.
+    static inline epicsUInt64 ticks()
+    {
+#ifdef PVA_MB_TSC
+        return __builtin_ia32_rdtsc();
+#else
+        epicsTimeStamp now;
+        epicsTimeGetCurrent(&now);
+        return epicsUInt64(now.secPastEpoch)*1000000000u + now.nsec;
+#endif
+    }
+
+    //! Calibrate ticks().  Called automatically before the first report.
+    static void init();
+    //! Ticks per micro-second
+    static double ticksPerUS();
+
+    inline void point(epicsUInt64 id, unsigned stage, const char *desc)
+    {
+        MBThreadBuffer *buf = static_cast<MBThreadBuffer*>(epicsThreadPrivateGet(local));
+        if(!buf)
+            buf = attach();
+        MBSample& S = buf->samples[buf->head & buf->mask];
+        S.id = id;
+        S.stage = epicsUInt8(stage);
+        S.ticks = ticks();
+        if(!stages[S.stage])
+            stages[S.stage] = desc;
+#ifdef PVA_MB_USE_ATOMIC
+        epicsAtomicIncrSizeT(&buf->head);
+#else
+        buf->head++;
+#endif
+    }
+
+    //! Record with the current auto id of this thread
+    inline void point(unsigned stage, const char *desc)
+    {
+        MBThreadBuffer *buf = static_cast<MBThreadBuffer*>(epicsThreadPrivateGet(local));
+        if(!buf)
+            buf = attach();
+        point(buf->autoId, stage, desc);
+    }
+
+    //! Begin a new auto id for this thread
+    inline void incAutoId()
+    {
+        MBThreadBuffer *buf = static_cast<MBThreadBuffer*>(epicsThreadPrivateGet(local));
+        if(!buf)
+            buf = attach();
+        buf->autoId++;
+    }
+
+    //! In print() and csvExport(), show times relative to the first sample of each id
+    void normalize();
+
+    /** Summary of the time between consecutive stages of each id.
+     * @param stageOnly Show only this stage, or all stages if <0
+     * @param skip Ignore the first 'skip' ids of each thread (warm up)
+     */
+    void stats(std::ostream& strm, int stageOnly=-1, size_t skip=0u) const;
+    //! Every sample, one per line
+    void print(std::ostream& strm, int stageOnly=-1, size_t skip=0u) const;
+    //! Lines of "thread,id,stage,usec"
+    void csvExport(std::ostream& strm, int stageOnly=-1, size_t skip=0u) const;
+    //! Add samples read from csvExport() output, as one additional thread.
+    void csvImport(std::istream& strm);
+
+    /** Discard all samples recorded so far.
+     *
+     * May be called while other threads are recording.  Nothing is written
+     * to the per-thread buffers, a sample being recorded concurrently
+     * may or may not be kept.
+     */
+    void reset();
+
+    const std::string name;
+
+private:
+    MBThreadBuffer* attach();
+    MBThreadBuffer* allocate(const std::string& tname);
+
+    struct Entry;
+    void snapshot(std::vector<Entry>& entries, int stageOnly, size_t skip) const;
+
+    const size_t size;
+    epicsThreadPrivateId local;
+
+    mutable epicsMutex mutex;
+    std::vector<MBThreadBuffer*> buffers; // guarded by mutex
+    bool normalized;
+
+    // stage descriptions.  Set when first recorded
+    const char * volatile stages[256];
+
+    MBEntity(const MBEntity&);
+    MBEntity& operator=(const MBEntity&);
+};
+
+}} // namespace epics::pvAccess
+
+//! Trace points within pvAccess
+epicsShareExtern epics::pvAccess::MBEntity MB_pvAccess;
+
+#ifdef WITH_MICROBENCH
+
+#define MB_DECLARE(NAME, SIZE) ::epics::pvAccess::MBEntity MB_##NAME(#NAME, SIZE)
+#define MB_DECLARE_EXTERN(NAME) extern ::epics::pvAccess::MBEntity MB_##NAME
+
+#define MB_POINT_ID(NAME, STAGE, STAGE_DESC, ID) MB_##NAME.point(ID, STAGE, STAGE_DESC)
+
+#define MB_INC_AUTO_ID(NAME) MB_##NAME.incAutoId()
+#define MB_POINT(NAME, STAGE, STAGE_DESC) MB_##NAME.point(STAGE, STAGE_DESC)
+
+#define MB_POINT_CONDITIONAL(NAME, STAGE, STAGE_DESC, COND) do { if(COND) MB_POINT(NAME, STAGE, STAGE_DESC); } while(0)
+
+#define MB_NORMALIZE(NAME) MB_##NAME.normalize()
+
+#define MB_STATS(NAME, STREAM) MB_##NAME.stats(STREAM)
+#define MB_STATS_OPT(NAME, STAGE_ONLY, SKIP_FIRST_N_SAMPLES, STREAM) MB_##NAME.stats(STREAM, STAGE_ONLY, SKIP_FIRST_N_SAMPLES)
+
+#define MB_CSV_EXPORT(NAME, STREAM) MB_##NAME.csvExport(STREAM)
+#define MB_CSV_EXPORT_OPT(NAME, STAGE_ONLY, SKIP_FIRST_N_SAMPLES, STREAM) MB_##NAME.csvExport(STREAM, STAGE_ONLY, SKIP_FIRST_N_SAMPLES)
+#define MB_CSV_IMPORT(NAME, STREAM) MB_##NAME.csvImport(STREAM)
+
+#define MB_PRINT(NAME, STREAM) MB_##NAME.print(STREAM)
+#define MB_PRINT_OPT(NAME, STAGE_ONLY, SKIP_FIRST_N_SAMPLES, STREAM) MB_##NAME.print(STREAM, STAGE_ONLY, SKIP_FIRST_N_SAMPLES)
+
+#define MB_INIT ::epics::pvAccess::MBEntity::init()
+
+#else // WITH_MICROBENCH
 
 #define MB_DECLARE(NAME, SIZE)
 #define MB_DECLARE_EXTERN(NAME)
@@ -33,4 +258,6 @@
 
 #define MB_INIT
 
+#endif // WITH_MICROBENCH
+
 #endif
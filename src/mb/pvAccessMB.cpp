@@ -0,0 +1,348 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+
+#include <epicsGuard.h>
+#include <epicsThread.h>
+#include <epicsTime.h>
+
+#define epicsExportSharedSymbols
+#include <pv/pvAccessMB.h>
+
+typedef epicsGuard<epicsMutex> Guard;
+
+epics::pvAccess::MBEntity MB_pvAccess("pvAccess", 16384u);
+
+namespace {
+
+epicsThreadOnceId calibrateOnce = EPICS_THREAD_ONCE_INIT;
+double ticksPerUSec = 1e3; // nanosecond ticks
+
+void calibrate(void *)
+{
+#ifdef PVA_MB_TSC
+    // count TSC ticks over a short sleep
+    epicsTimeStamp start, end;
+    epicsTimeGetCurrent(&start);
+    epicsUInt64 tstart = epics::pvAccess::MBEntity::ticks();
+    epicsThreadSleep(0.05);
+    epicsUInt64 tend = epics::pvAccess::MBEntity::ticks();
+    epicsTimeGetCurrent(&end);
+
+    double usec = epicsTimeDiffInSeconds(&end, &start)*1e6;
+    if(usec>0.0 && tend>tstart)
+        ticksPerUSec = double(tend-tstart)/usec;
+#endif
+}
+
+size_t readHead(const epics::pvAccess::MBThreadBuffer& buf)
+{
+#ifdef PVA_MB_USE_ATOMIC
+    return epicsAtomicGetSizeT(&buf.head);
+#else
+    return buf.head;
+#endif
+}
+
+} // namespace
+
+namespace epics {
+namespace pvAccess {
+
+struct MBEntity::Entry {
+    unsigned thread;
+    epicsUInt64 id;
+    epicsUInt64 ticks;
+    unsigned stage;
+
+    bool operator<(const Entry& o) const {
+        if(thread!=o.thread) return thread<o.thread;
+        if(id!=o.id) return id<o.id;
+        return ticks<o.ticks;
+    }
+};
+
+MBEntity::MBEntity(const char *name, size_t size)
+    :name(name)
+    ,size(size)
+    ,local(epicsThreadPrivateCreate())
+    ,normalized(false)
+{
+    for(size_t i=0; i<256u; i++)
+        stages[i] = 0;
+}
+
+MBEntity::~MBEntity()
+{
+    // threads may still be recording, so the buffers and TLS key are leaked
+}
+
+void MBEntity::init()
+{
+    epicsThreadOnce(&calibrateOnce, &calibrate, 0);
+}
+
+double MBEntity::ticksPerUS()
+{
+    init();
+    return ticksPerUSec;
+}
+
+MBThreadBuffer* MBEntity::allocate(const std::string& tname)
+{
+    size_t cap = 1u;
+    while(cap < size)
+        cap <<= 1u;
+
+    MBThreadBuffer *buf = new MBThreadBuffer;
+    buf->samples.resize(cap);
+    buf->mask = cap-1u;
+    buf->head = 0u;
+    buf->base = 0u;
+    buf->autoId = 0u;
+    buf->name = tname;
+
+    Guard G(mutex);
+    buf->index = buffers.size();
+    buffers.push_back(buf);
+    return buf;
+}
+
+MBThreadBuffer* MBEntity::attach()
+{
+    MBThreadBuffer *buf = allocate(epicsThreadGetNameSelf());
+    epicsThreadPrivateSet(local, buf);
+    return buf;
+}
+
+void MBEntity::normalize()
+{
+    Guard G(mutex);
+    normalized = true;
+}
+
+void MBEntity::reset()
+{
+    // only the owning thread writes head, so move the start instead
+    Guard G(mutex);
+    for(size_t i=0; i<buffers.size(); i++)
+        buffers[i]->base = readHead(*buffers[i]);
+}
+
+void MBEntity::snapshot(std::vector<Entry>& entries, int stageOnly, size_t skip) const
+{
+    entries.clear();
+    {
+        Guard G(mutex);
+        for(size_t b=0; b<buffers.size(); b++) {
+            const MBThreadBuffer& buf = *buffers[b];
+            const size_t head = readHead(buf);
+            const size_t count = std::min(head - buf.base, buf.samples.size());
+
+            for(size_t i=head-count; i<head; i++) {
+                const MBSample& S = buf.samples[i & buf.mask];
+                Entry E;
+                E.thread = buf.index;
+                E.id = S.id;
+                E.ticks = S.ticks;
+                E.stage = S.stage;
+                entries.push_back(E);
+            }
+        }
+    }
+
+    std::sort(entries.begin(), entries.end());
+
+    if(skip) {
+        // drop the first 'skip' ids of each thread
+        std::vector<Entry> keep;
+        keep.reserve(entries.size());
+        size_t nids = 0u;
+        for(size_t i=0; i<entries.size(); i++) {
+            if(i==0 || entries[i].thread!=entries[i-1].thread)
+                nids = 0u;
+            if(i==0 || entries[i].thread!=entries[i-1].thread || entries[i].id!=entries[i-1].id)
+                nids++;
+            if(nids>skip)
+                keep.push_back(entries[i]);
+        }
+        entries.swap(keep);
+    }
+
+    if(stageOnly>=0) {
+        // keep the preceding sample of each id so that deltas can be computed
+        std::vector<Entry> keep;
+        for(size_t i=0; i<entries.size(); i++) {
+            if(entries[i].stage!=unsigned(stageOnly))
+                continue;
+            if(i>0 && entries[i-1].thread==entries[i].thread && entries[i-1].id==entries[i].id)
+                keep.push_back(entries[i-1]);
+            keep.push_back(entries[i]);
+        }
+        entries.swap(keep);
+    }
+}
+
+namespace {
+struct StageStats {
+    size_t count, ndelta;
+    double min, max, sum, sum2;
+    StageStats() :count(0u), ndelta(0u), min(0.0), max(0.0), sum(0.0), sum2(0.0) {}
+    void add(double usec) {
+        if(ndelta==0u || usec<min) min = usec;
+        if(ndelta==0u || usec>max) max = usec;
+        sum += usec;
+        sum2 += usec*usec;
+        ndelta++;
+    }
+};
+}
+
+void MBEntity::stats(std::ostream& strm, int stageOnly, size_t skip) const
+{
+    std::vector<Entry> entries;
+    snapshot(entries, stageOnly, skip);
+
+    const double scale = 1.0/ticksPerUS();
+    std::vector<StageStats> stats(256u);
+
+    for(size_t i=0; i<entries.size(); i++) {
+        const Entry& E = entries[i];
+        if(stageOnly>=0 && E.stage!=unsigned(stageOnly))
+            continue;
+        StageStats& S = stats[E.stage];
+        S.count++;
+        if(i>0 && entries[i-1].thread==E.thread && entries[i-1].id==E.id)
+            S.add(double(E.ticks - entries[i-1].ticks)*scale);
+    }
+
+    strm<<name<<": "<<entries.size()<<" samples.  Times in usec since the previous stage of the same id\n"
+          "stage description        count   ndelta      min     mean      max   stddev\n";
+    for(size_t i=0; i<stats.size(); i++) {
+        const StageStats& S = stats[i];
+        if(!S.count)
+            continue;
+        const char *desc = stages[i];
+        strm<<std::setw(5)<<i<<' '<<std::left<<std::setw(16)<<(desc ? desc : "")<<std::right
+            <<std::setw(8)<<S.count<<' '<<std::setw(8)<<S.ndelta;
+        if(S.ndelta) {
+            double mean = S.sum/S.ndelta;
+            double var = S.sum2/S.ndelta - mean*mean;
+            strm<<std::fixed<<std::setprecision(2)
+                <<' '<<std::setw(8)<<S.min
+                <<' '<<std::setw(8)<<mean
+                <<' '<<std::setw(8)<<S.max
+                <<' '<<std::setw(8)<<(var>0.0 ? std::sqrt(var) : 0.0);
+            strm.unsetf(std::ios_base::floatfield);
+        }
+        strm<<'\n';
+    }
+}
+
+void MBEntity::print(std::ostream& strm, int stageOnly, size_t skip) const
+{
+    std::vector<Entry> entries;
+    snapshot(entries, stageOnly, skip);
+
+    const double scale = 1.0/ticksPerUS();
+    bool norm;
+    std::vector<std::string> tnames;
+    {
+        Guard G(mutex);
+        norm = normalized;
+        for(size_t i=0; i<buffers.size(); i++)
+            tnames.push_back(buffers[i]->name);
+    }
+
+    epicsUInt64 base = 0u;
+    for(size_t i=0; i<entries.size(); i++) {
+        const Entry& E = entries[i];
+        bool first = i==0 || entries[i-1].thread!=E.thread || entries[i-1].id!=E.id;
+        if(first)
+            base = E.ticks;
+        if(first && i!=0)
+            strm<<'\n';
+        const char *desc = stages[E.stage];
+        strm<<tnames[E.thread]<<" #"<<E.id<<" stage "<<E.stage<<" "<<(desc ? desc : "")
+            <<std::fixed<<std::setprecision(3)
+            <<" @"<<double(norm ? E.ticks-base : E.ticks)*scale<<" us";
+        if(!first)
+            strm<<" (+"<<double(E.ticks-entries[i-1].ticks)*scale<<")";
+        strm.unsetf(std::ios_base::floatfield);
+        strm<<'\n';
+    }
+}
+
+void MBEntity::csvExport(std::ostream& strm, int stageOnly, size_t skip) const
+{
+    std::vector<Entry> entries;
+    snapshot(entries, stageOnly, skip);
+
+    const double scale = 1.0/ticksPerUS();
+    bool norm;
+    {
+        Guard G(mutex);
+        norm = normalized;
+    }
+
+    epicsUInt64 base = 0u;
+    for(size_t i=0; i<entries.size(); i++) {
+        const Entry& E = entries[i];
+        if(i==0 || entries[i-1].thread!=E.thread || entries[i-1].id!=E.id)
+            base = E.ticks;
+        strm<<E.thread<<','<<E.id<<','<<E.stage<<','
+            <<std::fixed<<std::setprecision(3)<<double(norm ? E.ticks-base : E.ticks)*scale<<'\n';
+        strm.unsetf(std::ios_base::floatfield);
+    }
+}
+
+void MBEntity::csvImport(std::istream& strm)
+{
+    const double tpus = ticksPerUS();
+
+    typedef std::map<unsigned, std::vector<MBSample> > threads_t;
+    threads_t threads;
+
+    std::string line;
+    while(std::getline(strm, line)) {
+        std::istringstream lstrm(line);
+        unsigned thread, stage;
+        epicsUInt64 id;
+        double usec;
+        char c1, c2, c3;
+        if(!(lstrm>>thread>>c1>>id>>c2>>stage>>c3>>usec) || c1!=',' || c2!=',' || c3!=',' || stage>255u)
+            continue; // ignore malformed lines
+        MBSample S;
+        S.id = id;
+        S.stage = epicsUInt8(stage);
+        S.ticks = epicsUInt64(usec*tpus);
+        threads[thread].push_back(S);
+    }
+
+    // each imported thread is added as a new thread
+    for(threads_t::iterator it(threads.begin()), end(threads.end()); it!=end; ++it) {
+        std::vector<MBSample>& samples = it->second;
+
+        std::ostringstream tname;
+        tname<<"import"<<it->first;
+        MBThreadBuffer *buf = allocate(tname.str());
+
+        if(samples.size() > buf->samples.size())
+            samples.erase(samples.begin(), samples.end()-buf->samples.size());
+        for(size_t i=0; i<samples.size(); i++)
+            buf->samples[i] = samples[i];
+
+        Guard G(mutex);
+        buf->head = samples.size();
+    }
+}
+
+}} // namespace epics::pvAccess
@@ -58,9 +58,22 @@ const epics::pvData::int32 MAX_UDP_RECV = 65487;
 /** TCP maximum receive message size. */
 const epics::pvData::int32 MAX_TCP_RECV = 1024*16;
 
+/** Default limit on the growth of TCP send and receive buffers. */
+const epics::pvData::int32 MAX_TCP_BUFFER = 1024*1024*4;
+
 /** Maximum number of search requests in one search message. */
 const epics::pvData::int32 MAX_SEARCH_BATCH_COUNT = 0x7FFF;  // 32767
 
+/** Default maximum number of server connections being validated at once. */
+const epics::pvData::int32 MAX_PENDING_HANDSHAKES = 64;
+
+/** Time in seconds a server waits for all results of a CMD_MULTI_GET or CMD_MULTI_PUT. */
+const double MULTI_REQUEST_SERVER_TIMEOUT = 20.0;
+
+/** Time in seconds a client waits for the response to a CMD_MULTI_GET or CMD_MULTI_PUT.
+ *  Longer than MULTI_REQUEST_SERVER_TIMEOUT, so that a server reports which entries timed out. */
+const double MULTI_REQUEST_CLIENT_TIMEOUT = 30.0;
+
 /** Default priority (corresponds to POSIX SCHED_OTHER) */
 const epics::pvData::int16 PVA_DEFAULT_PRIORITY = 0;
 
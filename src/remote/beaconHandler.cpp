@@ -16,13 +16,15 @@ namespace epics {
 namespace pvAccess {
 
 BeaconHandler::BeaconHandler(Context::shared_pointer const & context,
-                             const osiSockAddr* responseFrom) :
+                             const osiSockAddr* responseFrom,
+                             NameCache::shared_pointer const & nameCache) :
     _context(Context::weak_pointer(context)),
     _responseFrom(*responseFrom),
     _mutex(),
     _serverGUID(),
     _serverChangeCount(-1),
-    _first(true)
+    _first(true),
+    _nameCache(nameCache)
 {
 
 }
@@ -31,17 +33,17 @@ BeaconHandler::~BeaconHandler()
 {
 }
 
-void BeaconHandler::beaconNotify(osiSockAddr* /*from*/, int8 remoteTransportRevision,
+void BeaconHandler::beaconNotify(osiSockAddr* from, int8 remoteTransportRevision,
                                  TimeStamp* timestamp, ServerGUID const & guid, int16 sequentalID,
                                  int16 changeCount,
                                  PVFieldPtr /*data*/)
 {
-    bool networkChanged = updateBeacon(remoteTransportRevision, timestamp, guid, sequentalID, changeCount);
+    bool networkChanged = updateBeacon(from, remoteTransportRevision, timestamp, guid, sequentalID, changeCount);
     if (networkChanged)
         changedTransport();
 }
 
-bool BeaconHandler::updateBeacon(int8 /*remoteTransportRevision*/, TimeStamp* /*timestamp*/,
+bool BeaconHandler::updateBeacon(osiSockAddr* from, int8 /*remoteTransportRevision*/, TimeStamp* /*timestamp*/,
                                  ServerGUID const & guid, int16 /*sequentalID*/, int16 changeCount)
 {
     Lock guard(_mutex);
@@ -52,6 +54,10 @@ bool BeaconHandler::updateBeacon(int8 /*remoteTransportRevision*/, TimeStamp* /*
         _serverGUID = guid;
         _serverChangeCount = changeCount;
 
+        // drop names remembered from a previous server instance
+        if (_nameCache && from)
+            _nameCache->invalidate(*from, guid);
+
         // new server up..
         _context.lock()->newServerDetected();
 
@@ -65,6 +71,10 @@ bool BeaconHandler::updateBeacon(int8 /*remoteTransportRevision*/, TimeStamp* /*
         _serverGUID = guid;
         _serverChangeCount = changeCount;
 
+        // server restarted
+        if (_nameCache && from)
+            _nameCache->invalidate(*from, guid);
+
         _context.lock()->newServerDetected();
 
         return true;
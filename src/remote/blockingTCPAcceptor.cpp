@@ -17,12 +17,39 @@
 #include <pv/remote.h>
 #include <pv/logger.h>
 
+#ifdef PVA_UNIX_SOCKET
+#  include <unistd.h>
+#  include <sys/un.h>
+#endif
+
 using std::ostringstream;
 using namespace epics::pvData;
 
+// Connections waiting to be accepted.  Keep a reconnecting crowd
+// of clients in the kernel queue instead of having them retry.
+#ifndef SOMAXCONN
+#  define SOMAXCONN 128
+#endif
+
 namespace epics {
 namespace pvAccess {
 
+namespace {
+// Returns a handshake slot unless it was handed to a transport
+struct HandshakeSlot {
+    detail::HandshakeLimit *limit;
+    explicit HandshakeSlot(detail::HandshakeLimit *limit) :limit(limit) {}
+    ~HandshakeSlot() {
+        if(limit)
+            limit->release();
+    }
+    void handoff() { limit = 0; }
+private:
+    HandshakeSlot(const HandshakeSlot&);
+    HandshakeSlot& operator=(const HandshakeSlot&);
+};
+} // namespace
+
 BlockingTCPAcceptor::BlockingTCPAcceptor(
     Context::shared_pointer const & context,
     ResponseHandler::shared_pointer const & responseHandler,
@@ -34,6 +61,7 @@ BlockingTCPAcceptor::BlockingTCPAcceptor(
     _serverSocketChannel(INVALID_SOCKET),
     _receiveBufferSize(receiveBufferSize),
     _destroyed(false),
+    _handshakes(new detail::HandshakeLimit(MAX_PENDING_HANDSHAKES)),
     _thread(*this, "TCP-acceptor",
             epicsThreadGetStackSize(
                 epicsThreadStackMedium),
@@ -55,6 +83,7 @@ BlockingTCPAcceptor::BlockingTCPAcceptor(Context::shared_pointer const & context
     _serverSocketChannel(INVALID_SOCKET),
     _receiveBufferSize(receiveBufferSize),
     _destroyed(false),
+    _handshakes(new detail::HandshakeLimit(MAX_PENDING_HANDSHAKES)),
     _thread(*this, "TCP-acceptor",
             epicsThreadGetStackSize(
                 epicsThreadStackMedium),
@@ -64,6 +93,25 @@ BlockingTCPAcceptor::BlockingTCPAcceptor(Context::shared_pointer const & context
     initialize();
 }
 
+BlockingTCPAcceptor::BlockingTCPAcceptor(Context::shared_pointer const & context,
+        ResponseHandler::shared_pointer const & responseHandler,
+        const std::string& unixPath, int receiveBufferSize) :
+    _context(context),
+    _responseHandler(responseHandler),
+    _bindAddress(),
+    _unixPath(unixPath),
+    _serverSocketChannel(INVALID_SOCKET),
+    _receiveBufferSize(receiveBufferSize),
+    _destroyed(false),
+    _handshakes(new detail::HandshakeLimit(MAX_PENDING_HANDSHAKES)),
+    _thread(*this, "UNIX-acceptor",
+            epicsThreadGetStackSize(
+                epicsThreadStackMedium),
+            epicsThreadPriorityMedium)
+{
+    initializeUnix();
+}
+
 BlockingTCPAcceptor::~BlockingTCPAcceptor() {
     destroy();
 }
@@ -131,7 +179,7 @@ int BlockingTCPAcceptor::initialize() {
                     }
                 }
 
-                retval = ::listen(_serverSocketChannel, 4);
+                retval = ::listen(_serverSocketChannel, SOMAXCONN);
                 if(retval<0) {
                     epicsSocketConvertErrnoToString(strBuffer, sizeof(strBuffer));
                     ostringstream temp;
@@ -154,11 +202,55 @@ int BlockingTCPAcceptor::initialize() {
     THROW_BASE_EXCEPTION(temp.str().c_str());
 }
 
+void BlockingTCPAcceptor::initializeUnix() {
+#ifdef PVA_UNIX_SOCKET
+    if(!unixSocketAddress(_unixPath, &_bindAddress)) {
+        THROW_BASE_EXCEPTION(("Invalid AF_UNIX socket path: "+_unixPath).c_str());
+    }
+
+    char strBuffer[64];
+
+    LOG(logLevelDebug, "Creating acceptor to unix:%s.", _unixPath.c_str());
+
+    _serverSocketChannel = epicsSocketCreate(AF_UNIX, SOCK_STREAM, 0);
+    if(_serverSocketChannel==INVALID_SOCKET) {
+        epicsSocketConvertErrnoToString(strBuffer, sizeof(strBuffer));
+        ostringstream temp;
+        temp<<"Socket create error: "<<strBuffer;
+        LOG(logLevelError, "%s", temp.str().c_str());
+        THROW_BASE_EXCEPTION(temp.str().c_str());
+    }
+
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, _unixPath.c_str(), sizeof(addr.sun_path)-1);
+
+    // remove left over from a previous (crashed) server
+    ::unlink(_unixPath.c_str());
+
+    if(::bind(_serverSocketChannel, (sockaddr*)&addr, sizeof(addr))<0
+            || ::listen(_serverSocketChannel, SOMAXCONN)<0) {
+        epicsSocketConvertErrnoToString(strBuffer, sizeof(strBuffer));
+        epicsSocketDestroy(_serverSocketChannel);
+        _serverSocketChannel = INVALID_SOCKET;
+        ostringstream temp;
+        temp<<"Failed to create acceptor to unix:"<<_unixPath<<" : "<<strBuffer;
+        LOG(logLevelError, "%s", temp.str().c_str());
+        THROW_BASE_EXCEPTION(temp.str().c_str());
+    }
+
+    _thread.start();
+#else
+    THROW_BASE_EXCEPTION("AF_UNIX sockets not supported on this target");
+#endif
+}
+
 void BlockingTCPAcceptor::run() {
     // rise level if port is assigned dynamically
-    char ipAddrStr[48];
-    ipAddrToDottedIP(&_bindAddress.ia, ipAddrStr, sizeof(ipAddrStr));
-    LOG(logLevelDebug, "Accepting connections at %s.", ipAddrStr);
+    const bool isUnix = !_unixPath.empty();
+    std::string peerName(inetAddressToString(_bindAddress, !isUnix));
+    LOG(logLevelDebug, "Accepting connections at %s.", peerName.c_str());
 
     bool socketOpen = true;
     char strBuffer[64];
@@ -173,28 +265,42 @@ void BlockingTCPAcceptor::run() {
             sock = _serverSocketChannel;
         }
 
+        // leave further clients in the backlog while too many are validating
+        if(!_handshakes->acquire())
+            break;
+        HandshakeSlot slot(_handshakes.get());
+
         osiSockAddr address;
         osiSocklen_t len = sizeof(sockaddr);
 
         SOCKET newClient = epicsSocketAccept(sock, &address.sa, &len);
         if(newClient!=INVALID_SOCKET) {
             // accept succeeded
-            ipAddrToDottedIP(&address.ia, ipAddrStr, sizeof(ipAddrStr));
+            // AF_UNIX peers are anonymous, keep the listening path as name
+            if(!isUnix) {
+                char ipAddrStr[48];
+                ipAddrToDottedIP(&address.ia, ipAddrStr, sizeof(ipAddrStr));
+                peerName = ipAddrStr;
+            }
+            const char *ipAddrStr = peerName.c_str();
             LOG(logLevelDebug, "Accepted connection from PVA client: %s.", ipAddrStr);
 
-            // enable TCP_NODELAY (disable Nagle's algorithm)
             int optval = 1; // true
-            int retval = ::setsockopt(newClient, IPPROTO_TCP, TCP_NODELAY, (char *)&optval, sizeof(int));
-            if(retval<0) {
-                epicsSocketConvertErrnoToString(strBuffer, sizeof(strBuffer));
-                LOG(logLevelDebug, "Error setting TCP_NODELAY: %s.", strBuffer);
-            }
+            int retval;
+            if(!isUnix) {
+                // enable TCP_NODELAY (disable Nagle's algorithm)
+                retval = ::setsockopt(newClient, IPPROTO_TCP, TCP_NODELAY, (char *)&optval, sizeof(int));
+                if(retval<0) {
+                    epicsSocketConvertErrnoToString(strBuffer, sizeof(strBuffer));
+                    LOG(logLevelDebug, "Error setting TCP_NODELAY: %s.", strBuffer);
+                }
 
-            // enable TCP_KEEPALIVE
-            retval = ::setsockopt(newClient, SOL_SOCKET, SO_KEEPALIVE, (char *)&optval, sizeof(int));
-            if(retval<0) {
-                epicsSocketConvertErrnoToString(strBuffer, sizeof(strBuffer));
-                LOG(logLevelDebug, "Error setting SO_KEEPALIVE: %s.", strBuffer);
+                // enable TCP_KEEPALIVE
+                retval = ::setsockopt(newClient, SOL_SOCKET, SO_KEEPALIVE, (char *)&optval, sizeof(int));
+                if(retval<0) {
+                    epicsSocketConvertErrnoToString(strBuffer, sizeof(strBuffer));
+                    LOG(logLevelDebug, "Error setting SO_KEEPALIVE: %s.", strBuffer);
+                }
             }
 
             // do NOT tune socket buffer sizes, this will disable auto-tunning
@@ -208,47 +314,41 @@ void BlockingTCPAcceptor::run() {
                 LOG(logLevelDebug, "Error getting SO_SNDBUF: %s.", strBuffer);
             }
 
-            /**
-             * Create transport, it registers itself to the registry.
-             */
-            detail::BlockingServerTCPTransportCodec::shared_pointer transport =
-                detail::BlockingServerTCPTransportCodec::create(
+            detail::BlockingServerTCPTransportCodec::shared_pointer transport;
+            try {
+                /**
+                 * Create transport, it registers itself to the registry.
+                 */
+                transport = detail::BlockingServerTCPTransportCodec::create(
                     _context,
                     newClient,
                     _responseHandler,
                     _socketSendBufferSize,
                     _receiveBufferSize);
 
-            // validate connection
-            if(!validateConnection(transport, ipAddrStr)) {
-                // TODO
-                // wait for negative response to be sent back and
-                // hold off the client for retrying at very high rate
-                epicsThreadSleep(1.0);
-
-                transport->close();
-                LOG(
-                    logLevelDebug,
-                    "Connection to PVA client %s failed to be validated, closing it.",
-                    ipAddrStr);
-                continue;
+                // validate connection.  From here the transport releases the
+                // handshake slot, also when closed, so continue accepting
+                slot.handoff();
+                transport->startVerify(5.0, _handshakes);
+
+            } catch(std::exception& e) {
+                LOG(logLevelError, "Failed to serve PVA client %s: %s", ipAddrStr, e.what());
+                if(transport)
+                    transport->close();
+                else
+                    epicsSocketDestroy(newClient);
             }
 
-            LOG(logLevelDebug, "Serving to PVA client: %s.", ipAddrStr);
-
         }// accept succeeded
-        else
+        else {
             socketOpen = false;
+        }
     } // while
 }
 
-bool BlockingTCPAcceptor::validateConnection(Transport::shared_pointer const & transport, const char* address) {
-    try {
-        return transport->verify(5000);
-    } catch(...) {
-        LOG(logLevelDebug, "Validation of %s failed.", address);
-        return false;
-    }
+void BlockingTCPAcceptor::setMaxHandshakes(size_t limit)
+{
+    _handshakes->setLimit(limit);
 }
 
 void BlockingTCPAcceptor::destroy() {
@@ -262,10 +362,11 @@ void BlockingTCPAcceptor::destroy() {
         _serverSocketChannel = INVALID_SOCKET;
     }
 
+    // wake acceptor if waiting for a handshake slot
+    _handshakes->interrupt();
+
     if(sock!=INVALID_SOCKET) {
-        char ipAddrStr[48];
-        ipAddrToDottedIP(&_bindAddress.ia, ipAddrStr, sizeof(ipAddrStr));
-        LOG(logLevelDebug, "Stopped accepting connections at %s.", ipAddrStr);
+        LOG(logLevelDebug, "Stopped accepting connections at %s.", inetAddressToString(_bindAddress).c_str());
 
         switch(epicsSocketSystemCallInterruptMechanismQuery())
         {
@@ -281,6 +382,11 @@ void BlockingTCPAcceptor::destroy() {
             _thread.exitWait();
             break;
         }
+
+#ifdef PVA_UNIX_SOCKET
+        if(!_unixPath.empty())
+            ::unlink(_unixPath.c_str());
+#endif
     }
 }
 
@@ -5,6 +5,7 @@
  */
 
 #include <sstream>
+#include <string.h>
 #include <sys/types.h>
 
 #include <osiSock.h>
@@ -16,11 +17,58 @@
 #include <pv/logger.h>
 #include <pv/codec.h>
 
+#ifdef PVA_UNIX_SOCKET
+#  include <sys/un.h>
+#endif
+
 using namespace epics::pvData;
 
 namespace epics {
 namespace pvAccess {
 
+namespace {
+/* connect() with a bounded wait.  The socket is left in blocking mode.
+ * Returns zero, or the socket error.  SOCK_ETIMEDOUT if not connected within timeout (ms).
+ */
+int connectTimeout(SOCKET socket, const osiSockAddr& address, int timeout)
+{
+    osiSockIoctl_t nonblock = 1;
+    if(socketIoctl(socket, FIONBIO, &nonblock))
+        return SOCKERRNO;
+
+    int err = 0;
+    if(::connect(socket, &address.sa, sizeof(sockaddr))!=0) {
+        err = SOCKERRNO;
+        if(err==SOCK_EINPROGRESS || err==SOCK_EWOULDBLOCK) {
+            fd_set wfds, efds;
+            FD_ZERO(&wfds);
+            FD_ZERO(&efds);
+            FD_SET(socket, &wfds);
+            FD_SET(socket, &efds); // winsock reports failure here
+            timeval tmo;
+            tmo.tv_sec = timeout/1000;
+            tmo.tv_usec = (timeout%1000)*1000;
+
+            int ret = ::select(int(socket)+1, 0, &wfds, &efds, &tmo);
+            if(ret<0) {
+                err = SOCKERRNO;
+            } else if(ret==0) {
+                err = SOCK_ETIMEDOUT;
+            } else {
+                osiSocklen_t len = sizeof(err);
+                if(::getsockopt(socket, SOL_SOCKET, SO_ERROR, (char*)&err, &len))
+                    err = SOCKERRNO;
+            }
+        }
+    }
+
+    nonblock = 0;
+    if(err==0 && socketIoctl(socket, FIONBIO, &nonblock))
+        err = SOCKERRNO;
+    return err;
+}
+} // namespace
+
 BlockingTCPConnector::BlockingTCPConnector(
     Context::shared_pointer const & context,
     int receiveBufferSize,
@@ -33,6 +81,11 @@ BlockingTCPConnector::BlockingTCPConnector(
 
 SOCKET BlockingTCPConnector::tryConnect(osiSockAddr& address, int tries) {
 
+#ifdef PVA_UNIX_SOCKET
+    if(address.sa.sa_family==AF_UNIX)
+        return tryConnectUnix(address);
+#endif
+
     char strBuffer[64];
     ipAddrToDottedIP(&address.ia, strBuffer, sizeof(strBuffer));
 
@@ -51,12 +104,15 @@ SOCKET BlockingTCPConnector::tryConnect(osiSockAddr& address, int tries) {
             THROW_EXCEPTION2(std::runtime_error, temp.str());
         }
         else {
-            // TODO: use non-blocking connect() to have controllable timeout
-            if(::connect(socket, &address.sa, sizeof(sockaddr))==0) {
+            int err = connectTimeout(socket, address, CONNECT_TIMEOUT);
+            if(err==0) {
                 return socket;
             }
             else {
-                epicsSocketConvertErrnoToString(strBuffer, sizeof(strBuffer));
+                if(err==SOCK_ETIMEDOUT)
+                    strcpy(strBuffer, "timeout");
+                else
+                    epicsSocketConvertErrorToString(strBuffer, sizeof(strBuffer), err);
                 char saddr[32];
                 sockAddrToDottedIP(&address.sa, saddr, sizeof(saddr));
                 epicsSocketDestroy (socket);
@@ -69,14 +125,50 @@ SOCKET BlockingTCPConnector::tryConnect(osiSockAddr& address, int tries) {
     return INVALID_SOCKET;
 }
 
+SOCKET BlockingTCPConnector::tryConnectUnix(const osiSockAddr& address) {
+#ifdef PVA_UNIX_SOCKET
+    const std::string path(unixSocketPath(address));
+
+    LOG(logLevelDebug, "Opening socket to PVA server unix:%s.", path.c_str());
+
+    char strBuffer[64];
+    SOCKET socket = epicsSocketCreate(AF_UNIX, SOCK_STREAM, 0);
+    if (socket == INVALID_SOCKET)
+    {
+        epicsSocketConvertErrnoToString(strBuffer, sizeof(strBuffer));
+        std::ostringstream temp;
+        temp<<"Socket create error: "<<strBuffer;
+        THROW_EXCEPTION2(std::runtime_error, temp.str());
+    }
+
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path)-1);
+
+    if(path.empty() || ::connect(socket, (sockaddr*)&addr, sizeof(addr))!=0) {
+        epicsSocketConvertErrnoToString(strBuffer, sizeof(strBuffer));
+        epicsSocketDestroy (socket);
+        std::ostringstream temp;
+        temp<<"error connecting to unix:"<<path<<" : "<<strBuffer;
+        throw std::runtime_error(temp.str());
+    }
+    return socket;
+#else
+    (void)address;
+    THROW_EXCEPTION2(std::runtime_error, "AF_UNIX sockets not supported on this target");
+#endif
+}
+
 Transport::shared_pointer BlockingTCPConnector::connect(std::tr1::shared_ptr<ClientChannelImpl> const & client,
         ResponseHandler::shared_pointer const & responseHandler, osiSockAddr& address,
         int8 transportRevision, int16 priority) {
 
     SOCKET socket = INVALID_SOCKET;
 
-    char ipAddrStr[64];
-    ipAddrToDottedIP(&address.ia, ipAddrStr, sizeof(ipAddrStr));
+    const bool isUnix = address.sa.sa_family==AF_UNIX;
+    const std::string addressStr(inetAddressToString(address));
+    const char *ipAddrStr = addressStr.c_str();
 
     Context::shared_pointer context = _context.lock();
 
@@ -102,24 +194,27 @@ Transport::shared_pointer BlockingTCPConnector::connect(std::tr1::shared_ptr<Cli
 
         LOG(logLevelDebug, "Socket connected to PVA server: %s.", ipAddrStr);
 
-        // enable TCP_NODELAY (disable Nagle's algorithm)
         int optval = 1; // true
-        int retval = ::setsockopt(socket, IPPROTO_TCP, TCP_NODELAY,
+        int retval;
+        if(!isUnix) {
+            // enable TCP_NODELAY (disable Nagle's algorithm)
+            retval = ::setsockopt(socket, IPPROTO_TCP, TCP_NODELAY,
                                   (char *)&optval, sizeof(int));
-        if(retval<0) {
-            char errStr[64];
-            epicsSocketConvertErrnoToString(errStr, sizeof(errStr));
-            LOG(logLevelWarn, "Error setting TCP_NODELAY: %s.", errStr);
-        }
+            if(retval<0) {
+                char errStr[64];
+                epicsSocketConvertErrnoToString(errStr, sizeof(errStr));
+                LOG(logLevelWarn, "Error setting TCP_NODELAY: %s.", errStr);
+            }
 
-        // enable TCP_KEEPALIVE
-        retval = ::setsockopt(socket, SOL_SOCKET, SO_KEEPALIVE,
-                              (char *)&optval, sizeof(int));
-        if(retval<0)
-        {
-            char errStr[64];
-            epicsSocketConvertErrnoToString(errStr, sizeof(errStr));
-            LOG(logLevelWarn, "Error setting SO_KEEPALIVE: %s.", errStr);
+            // enable TCP_KEEPALIVE
+            retval = ::setsockopt(socket, SOL_SOCKET, SO_KEEPALIVE,
+                                  (char *)&optval, sizeof(int));
+            if(retval<0)
+            {
+                char errStr[64];
+                epicsSocketConvertErrnoToString(errStr, sizeof(errStr));
+                LOG(logLevelWarn, "Error setting SO_KEEPALIVE: %s.", errStr);
+            }
         }
 
         // TODO tune buffer sizes?! Win32 defaults are 8k, which is OK
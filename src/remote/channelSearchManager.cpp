@@ -72,6 +72,20 @@ static const int MAX_FALLBACK_COUNT_VALUE = (1 << 7) + 1;
 static const int MAX_FRAMES_AT_ONCE = 10;
 static const int DELAY_BETWEEN_FRAMES_MS = 50;
 
+struct ChannelSearchManager::BatchSearch : public epics::pvData::TimerCallback
+{
+    const ChannelSearchManager::weak_pointer manager;
+    explicit BatchSearch(const ChannelSearchManager::shared_pointer& manager) :manager(manager) {}
+    virtual ~BatchSearch() {}
+    virtual void callback() OVERRIDE FINAL
+    {
+        ChannelSearchManager::shared_pointer M(manager.lock());
+        if(M)
+            M->searchPending();
+    }
+    virtual void timerStopped() OVERRIDE FINAL {}
+};
+
 
 ChannelSearchManager::ChannelSearchManager(Context::shared_pointer const & context) :
     m_context(context),
@@ -80,6 +94,8 @@ ChannelSearchManager::ChannelSearchManager(Context::shared_pointer const & conte
     m_sequenceNumber(0),
     m_sendBuffer(MAX_UDP_UNFRAGMENTED_SEND),
     m_channels(),
+    m_senders(),
+    m_pending(),
     m_lastTimeSent(),
     m_channelMutex(),
     m_userValueMutex(),
@@ -96,6 +112,8 @@ void ChannelSearchManager::activate()
     // initialize send buffer
     initializeSendBuffer();
 
+    m_batchSearch.reset(new BatchSearch(shared_from_this()));
+
     // add some jitter so that all the clients do not send at the same time
     double period = ATOMIC_PERIOD + double(rand())/RAND_MAX*PERIOD_JITTER_MS;
 
@@ -121,8 +139,11 @@ void ChannelSearchManager::cancel()
     m_canceled.set();
 
     Context::shared_pointer context(m_context.lock());
-    if (context)
+    if (context) {
         context->getTimer()->cancel(shared_from_this());
+        if (m_batchSearch)
+            context->getTimer()->cancel(m_batchSearch);
+    }
 }
 
 int32_t ChannelSearchManager::registeredCount()
@@ -153,6 +174,59 @@ void ChannelSearchManager::registerSearchInstance(SearchInstance::shared_pointer
         callback();
 }
 
+void ChannelSearchManager::registerSearchInstances(std::vector<SearchInstance::shared_pointer> const & channels)
+{
+    if (m_canceled.get() || channels.empty())
+        return;
+
+    bool schedule;
+    {
+        Lock guard(m_channelMutex);
+        Lock guard2(m_userValueMutex);
+
+        schedule = m_pending.empty();
+        m_pending.reserve(m_pending.size() + channels.size());
+
+        for (size_t i = 0; i < channels.size(); i++)
+        {
+            const SearchInstance::shared_pointer& channel = channels[i];
+            m_channels[channel->getSearchInstanceID()] = channel;
+            channel->getUserValue() = DEFAULT_USER_VALUE;
+            m_pending.push_back(channel);
+        }
+    }
+
+    // search for the new channels, packed into as few frames as possible,
+    // rather than waiting for the next period.  Sending is paced, so do
+    // this from the timer thread, not the caller's.
+    Context::shared_pointer context(m_context.lock());
+    if (schedule && context && m_batchSearch)
+        context->getTimer()->scheduleAfterDelay(m_batchSearch, 0.0);
+}
+
+void ChannelSearchManager::searchPending()
+{
+    if (m_canceled.get())
+        return;
+
+    vector<SearchInstance::weak_pointer> pending;
+    {
+        Lock guard(m_channelMutex);
+        pending.swap(m_pending);
+    }
+
+    vector<SearchInstance::shared_pointer> toSend;
+    toSend.reserve(pending.size());
+    for (size_t i = 0; i < pending.size(); i++)
+    {
+        SearchInstance::shared_pointer inst(pending[i].lock());
+        if (inst)
+            toSend.push_back(inst);
+    }
+
+    search(toSend);
+}
+
 void ChannelSearchManager::unregisterSearchInstance(SearchInstance::shared_pointer const & channel)
 {
     Lock guard(m_channelMutex);
@@ -197,6 +271,12 @@ void ChannelSearchManager::newServerDetected()
     callback();
 }
 
+void ChannelSearchManager::addSearchSender(SearchSender::shared_pointer const & sender)
+{
+    Lock guard(m_channelMutex);
+    m_senders.push_back(sender);
+}
+
 void ChannelSearchManager::initializeSendBuffer()
 {
     // for now OK, since it is only set here
@@ -249,6 +329,16 @@ void ChannelSearchManager::flushSendBuffer()
     initializeSendBuffer();
 }
 
+bool ChannelSearchManager::hasSendAddresses()
+{
+    Context::shared_pointer context(m_context.lock());
+    if (!context)
+        return false;
+
+    BlockingUDPTransport::shared_pointer ut = std::tr1::static_pointer_cast<BlockingUDPTransport>(context->getSearchTransport());
+    return ut && !ut->getSendAddresses().empty();
+}
+
 
 bool ChannelSearchManager::generateSearchRequestMessage(SearchInstance::shared_pointer const & channel,
         ByteBuffer* requestMessage, TransportSendControl* control)
@@ -330,9 +420,6 @@ void ChannelSearchManager::callback()
     }
 
 
-    int count = 0;
-    int frameSent = 0;
-
     vector<SearchInstance::shared_pointer> toSend;
     {
         Lock guard(m_channelMutex);
@@ -347,7 +434,24 @@ void ChannelSearchManager::callback()
         }
     }
 
-    vector<SearchInstance::shared_pointer>::iterator siter = toSend.begin();
+    search(toSend);
+}
+
+void ChannelSearchManager::search(std::vector<SearchInstance::shared_pointer> const & toSend)
+{
+    int count = 0;
+    int frameSent = 0;
+
+    // with only name servers configured, don't bother building (and pacing) UDP frames
+    const bool udp = hasSendAddresses();
+
+    m_senders_t senders;
+    {
+        Lock guard(m_channelMutex);
+        senders = m_senders;
+    }
+
+    vector<SearchInstance::shared_pointer>::const_iterator siter = toSend.begin();
     for (; siter != toSend.end(); siter++)
     {
         bool skip;
@@ -368,6 +472,12 @@ void ChannelSearchManager::callback()
 
         count++;
 
+        for (m_senders_t::const_iterator it = senders.begin(); it != senders.end(); ++it)
+            (*it)->search(*siter);
+
+        if (!udp)
+            continue;
+
         if (generateSearchRequestMessage(*siter, true, false))
             frameSent++;
         if (frameSent == MAX_FRAMES_AT_ONCE)
@@ -378,7 +488,13 @@ void ChannelSearchManager::callback()
     }
 
     if (count > 0)
-        flushSendBuffer();
+    {
+        if (udp)
+            flushSendBuffer();
+
+        for (m_senders_t::const_iterator it = senders.begin(); it != senders.end(); ++it)
+            (*it)->flush();
+    }
 }
 
 bool ChannelSearchManager::isPowerOfTwo(int32_t x)
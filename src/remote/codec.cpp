@@ -35,12 +35,18 @@
 #include <pv/serializationHelper.h>
 #include <pv/serverChannelImpl.h>
 #include <pv/clientContextImpl.h>
+#include <pv/pvAccessMB.h>
+
+#ifdef PVA_UNIX_SOCKET
+#  include <sys/un.h>
+#endif
 
 using namespace std;
 using namespace epics::pvData;
 using namespace epics::pvAccess;
 
 typedef epicsGuard<epicsMutex> Guard;
+typedef epicsGuardRelease<epicsMutex> UnGuard;
 
 namespace {
 struct BreakTransport : TransportSender
@@ -76,6 +82,7 @@ const std::size_t AbstractCodec::MAX_ENSURE_SIZE = 1024;
 const std::size_t AbstractCodec::MAX_ENSURE_DATA_SIZE = MAX_ENSURE_SIZE/2;
 const std::size_t AbstractCodec::MAX_ENSURE_BUFFER_SIZE = MAX_ENSURE_SIZE;
 const std::size_t AbstractCodec::MAX_ENSURE_DATA_BUFFER_SIZE = 1024;
+const double AbstractCodec::BUFFER_SHRINK_DELAY = 30.0;
 
 static
 size_t bufSizeSelect(size_t request)
@@ -83,6 +90,16 @@ size_t bufSizeSelect(size_t request)
     return std::max(request, size_t(MAX_TCP_RECV + AbstractCodec::MAX_ENSURE_DATA_BUFFER_SIZE));
 }
 
+// double the current size until 'required' fits, but not beyond 'limit'
+static
+size_t bufSizeGrow(size_t current, size_t required, size_t limit)
+{
+    size_t size = current;
+    while(size < required && size < limit)
+        size *= 2u;
+    return std::min(size, limit);
+}
+
 AbstractCodec::AbstractCodec(
     bool serverFlag,
     size_t sendBufferSize,
@@ -91,34 +108,45 @@ AbstractCodec::AbstractCodec(
     bool blockingProcessQueue):
     //PROTECTED
     _readMode(NORMAL), _version(0), _flags(0), _command(0), _payloadSize(0),
-    _remoteTransportSocketReceiveBufferSize(MAX_TCP_RECV), _totalBytesSent(0),
+    _remoteTransportSocketReceiveBufferSize(MAX_TCP_RECV), _socketReceiveBufferSize(0), _totalBytesSent(0),
     _senderThread(0),
     _writeMode(PROCESS_SEND_QUEUE),
     _writeOpReady(false),_lowLatency(false),
-    _socketBuffer(bufSizeSelect(receiveBufferSize)),
-    _sendBuffer(bufSizeSelect(sendBufferSize)),
+    _socketBuffer(new ByteBuffer(bufSizeSelect(receiveBufferSize))),
+    _sendBuffer(new ByteBuffer(bufSizeSelect(sendBufferSize))),
     //PRIVATE
     _storedPayloadSize(0), _storedPosition(0), _startPosition(0),
-    _maxSendPayloadSize(_sendBuffer.getSize() - 2*PVA_MESSAGE_HEADER_SIZE),    // start msg + control
+    _maxSendPayloadSize(_sendBuffer->getSize() - 2*PVA_MESSAGE_HEADER_SIZE),    // start msg + control
     _lastMessageStartPosition(std::numeric_limits<size_t>::max()),_lastSegmentedMessageType(0),
     _lastSegmentedMessageCommand(0), _nextMessagePayloadOffset(0),
     _byteOrderFlag(EPICS_BYTE_ORDER == EPICS_ENDIAN_BIG ? 0x80 : 0x00),
     _clientServerFlag(serverFlag ? 0x40 : 0x00),
-    _socketSendBufferSize(socketSendBufferSize)
+    _socketSendBufferSize(socketSendBufferSize),
+    _rxMessageBytes(0), _rxSegments(0), _receiveBufferResizeTo(0),
+    _txMessageBytes(0), _txSegments(0), _txSplit(false), _sendBufferResizeTo(0),
+    _initialReceiveBufferSize(_socketBuffer->getSize()),
+    _initialSendBufferSize(_sendBuffer->getSize()),
+    // no growth unless enabled
+    _maxReceiveBufferSize(_socketBuffer->getSize()),
+    _maxSendBufferSize(_sendBuffer->getSize()),
+    _receiveGrowth(false),
+    _bufferShrinkDelay(BUFFER_SHRINK_DELAY)
 {
-    if (_socketBuffer.getSize() < 2*MAX_ENSURE_SIZE)
+    memset(&_stats, 0, sizeof(_stats));
+
+    if (_socketBuffer->getSize() < 2*MAX_ENSURE_SIZE)
         throw std::invalid_argument(
             "receiveBuffer.capacity() < 2*MAX_ENSURE_SIZE");
 
-    if (_sendBuffer.getSize() < 2*MAX_ENSURE_SIZE)
+    if (_sendBuffer->getSize() < 2*MAX_ENSURE_SIZE)
         throw std::invalid_argument("sendBuffer() < 2*MAX_ENSURE_SIZE");
 
     // initialize to be empty
-    _socketBuffer.setPosition(_socketBuffer.getLimit());
-    _startPosition = _socketBuffer.getPosition();
+    _socketBuffer->setPosition(_socketBuffer->getLimit());
+    _startPosition = _socketBuffer->getPosition();
 
     // clear send
-    _sendBuffer.clear();
+    _sendBuffer->clear();
 }
 
 
@@ -144,19 +172,19 @@ void AbstractCodec::processHeader() {
     Guard G(_mutex); // guards access to _version et al.
 
     // magic code
-    int8_t magicCode = _socketBuffer.getByte();
+    int8_t magicCode = _socketBuffer->getByte();
 
     // version
-    _version = _socketBuffer.getByte();
+    _version = _socketBuffer->getByte();
 
     // flags
-    _flags = _socketBuffer.getByte();
+    _flags = _socketBuffer->getByte();
 
     // command
-    _command = _socketBuffer.getByte();
+    _command = _socketBuffer->getByte();
 
     // read payload size
-    _payloadSize = _socketBuffer.getInt();
+    _payloadSize = _socketBuffer->getInt();
 
     // check magic code
     if (magicCode != PVA_MAGIC)
@@ -169,6 +197,45 @@ void AbstractCodec::processHeader() {
         throw invalid_data_stream_exception("invalid header received");
     }
 
+    _stats.nrxBytes += PVA_MESSAGE_HEADER_SIZE;
+    if(_flags & 0x01)
+        return; // control message, no payload
+
+    if(!(_flags & 0x20)) {
+        // first, or only, segment
+        _rxMessageBytes = 0u;
+        _rxSegments = 0u;
+        _stats.nrxMessages++;
+    }
+    _rxSegments++;
+    _stats.nrxSegments++;
+    _stats.maxRxSegments = std::max(_stats.maxRxSegments, _rxSegments);
+    if(_payloadSize > 0) {
+        _rxMessageBytes += size_t(_payloadSize);
+        _stats.nrxBytes += size_t(_payloadSize);
+    }
+
+    // would this message fit in one buffer?
+    const size_t required = MAX_ENSURE_SIZE + PVA_MESSAGE_HEADER_SIZE + _rxMessageBytes;
+    const size_t current = _socketBuffer->getSize();
+    if(required > current && current < _maxReceiveBufferSize) {
+        Guard G(_mutex);
+        if(_receiveGrowth) {
+            // also room for as much as the socket may hold, to be taken in one read()
+            const size_t target = std::max(required, _socketReceiveBufferSize);
+            _receiveBufferResizeTo = std::max(_receiveBufferResizeTo,
+                                              bufSizeGrow(current, target, _maxReceiveBufferSize));
+        }
+    }
+
+    // shrink back after a while without large messages
+    if(required > _initialReceiveBufferSize) {
+        _rxLargeTime = epicsTime::getCurrent();
+    } else if(current > _initialReceiveBufferSize && !_receiveBufferResizeTo) {
+        Guard G(_mutex);
+        if(epicsTime::getCurrent() - _rxLargeTime >= _bufferShrinkDelay)
+            _receiveBufferResizeTo = _initialReceiveBufferSize;
+    }
 }
 
 
@@ -186,8 +253,8 @@ void AbstractCodec::processReadNormal()  {
             }
 
             /*
-            hexDump("Header", (const int8*)_socketBuffer.getArray(),
-                    _socketBuffer.getPosition(), PVA_MESSAGE_HEADER_SIZE);
+            hexDump("Header", (const int8*)_socketBuffer->getArray(),
+                    _socketBuffer->getPosition(), PVA_MESSAGE_HEADER_SIZE);
 
             */
 
@@ -218,9 +285,12 @@ void AbstractCodec::processReadNormal()  {
                 }
 
                 _storedPayloadSize = _payloadSize;
-                _storedPosition = _socketBuffer.getPosition();
-                _storedLimit = _socketBuffer.getLimit();
-                _socketBuffer.setLimit(std::min(_storedPosition + _storedPayloadSize, _storedLimit));
+                _storedPosition = _socketBuffer->getPosition();
+                _storedLimit = _socketBuffer->getLimit();
+                _socketBuffer->setLimit(std::min(_storedPosition + _storedPayloadSize, _storedLimit));
+                MB_INC_AUTO_ID(pvAccess);
+                MB_POINT(pvAccess, 0, "receive");
+
                 bool postProcess = true;
                 try
                 {
@@ -282,13 +352,13 @@ void AbstractCodec::postProcessApplicationMessage()
 
             // we only handle unused alignment bytes
             int bytesNotRead =
-                newPosition - _socketBuffer.getPosition();
+                newPosition - _socketBuffer->getPosition();
             assert(bytesNotRead>=0);
 
             if (bytesNotRead==0)
             {
                 // reveal currently existing padding
-                _socketBuffer.setLimit(_storedLimit);
+                _socketBuffer->setLimit(_storedLimit);
                 continue;
             }
 
@@ -301,8 +371,8 @@ void AbstractCodec::postProcessApplicationMessage()
             throw invalid_data_stream_exception(
                 "unprocessed read buffer");
         }
-        _socketBuffer.setLimit(_storedLimit);
-        _socketBuffer.setPosition(newPosition);
+        _socketBuffer->setLimit(_storedLimit);
+        _socketBuffer->setPosition(newPosition);
         break;
     }
 }
@@ -354,8 +424,12 @@ bool AbstractCodec::readToBuffer(
     std::size_t requiredBytes,
     bool persistent)  {
 
+    // !persistent only between messages, when the buffer may be replaced
+    if (!persistent && _receiveBufferResizeTo)
+        resizeReceiveBuffer();
+
     // do we already have requiredBytes available?
-    std::size_t remainingBytes = _socketBuffer.getRemaining();
+    std::size_t remainingBytes = _socketBuffer->getRemaining();
     if (remainingBytes >= requiredBytes) {
         return true;
     }
@@ -375,17 +449,17 @@ bool AbstractCodec::readToBuffer(
     std::size_t endPosition = _startPosition + remainingBytes;
 
     for (std::size_t i = _startPosition; i < endPosition; i++)
-        _socketBuffer.putByte(i, _socketBuffer.getByte());
+        _socketBuffer->putByte(i, _socketBuffer->getByte());
 
     // update buffer to the new position
-    _socketBuffer.setLimit(_socketBuffer.getSize());
-    _socketBuffer.setPosition(endPosition);
+    _socketBuffer->setLimit(_socketBuffer->getSize());
+    _socketBuffer->setPosition(endPosition);
 
     // read at least requiredBytes bytes
     std::size_t requiredPosition = _startPosition + requiredBytes;
-    while (_socketBuffer.getPosition() < requiredPosition)
+    while (_socketBuffer->getPosition() < requiredPosition)
     {
-        int bytesRead = read(&_socketBuffer);
+        int bytesRead = read(_socketBuffer.get());
 
         if (bytesRead < 0)
         {
@@ -400,8 +474,8 @@ bool AbstractCodec::readToBuffer(
             else
             {
                 // set pointers (aka flip)
-                _socketBuffer.setLimit(_socketBuffer.getPosition());
-                _socketBuffer.setPosition(_startPosition);
+                _socketBuffer->setLimit(_socketBuffer->getPosition());
+                _socketBuffer->setPosition(_startPosition);
 
                 return false;
             }
@@ -409,17 +483,48 @@ bool AbstractCodec::readToBuffer(
     }
 
     // set pointers (aka flip)
-    _socketBuffer.setLimit(_socketBuffer.getPosition());
-    _socketBuffer.setPosition(_startPosition);
+    _socketBuffer->setLimit(_socketBuffer->getPosition());
+    _socketBuffer->setPosition(_startPosition);
 
     return true;
 }
 
 
+void AbstractCodec::resizeReceiveBuffer()
+{
+    const std::size_t size = _receiveBufferResizeTo;
+    const std::size_t current = _socketBuffer->getSize();
+    if (size == current) {
+        _receiveBufferResizeTo = 0u;
+        return;
+    }
+
+    // keep unread bytes, at the start position used by readToBuffer()
+    const std::size_t remaining = _socketBuffer->getRemaining();
+    if (MAX_ENSURE_SIZE + remaining > size)
+        return; // can't shrink yet, try again after the next message
+    _receiveBufferResizeTo = 0u;
+
+    epics::auto_ptr<ByteBuffer> buf(new ByteBuffer(size, bufferByteOrder()));
+    buf->setPosition(MAX_ENSURE_SIZE);
+    buf->put(_socketBuffer->getBuffer(), _socketBuffer->getPosition(), remaining);
+    buf->setLimit(MAX_ENSURE_SIZE + remaining);
+    buf->setPosition(MAX_ENSURE_SIZE);
+    _startPosition = MAX_ENSURE_SIZE;
+
+    Guard G(_mutex);
+    _socketBuffer.reset(buf.release());
+    if (size > current)
+        _stats.ngrow++;
+    else
+        _stats.nshrink++;
+}
+
+
 void AbstractCodec::ensureData(std::size_t size) {
 
     // enough of data?
-    if (_socketBuffer.getRemaining() >= size)
+    if (_socketBuffer->getRemaining() >= size)
         return;
 
     // to large for buffer...
@@ -436,7 +541,7 @@ void AbstractCodec::ensureData(std::size_t size) {
     {
 
         // subtract what was already processed
-        std::size_t pos = _socketBuffer.getPosition();
+        std::size_t pos = _socketBuffer->getPosition();
         _storedPayloadSize -= pos - _storedPosition;
 
         // SPLIT message case
@@ -452,9 +557,9 @@ void AbstractCodec::ensureData(std::size_t size) {
             _readMode = SPLIT;
             readToBuffer(size, true);
             _readMode = storedMode;
-            _storedPosition = _socketBuffer.getPosition();
-            _storedLimit = _socketBuffer.getLimit();
-            _socketBuffer.setLimit(
+            _storedPosition = _socketBuffer->getPosition();
+            _storedLimit = _socketBuffer->getLimit();
+            _socketBuffer->setLimit(
                 std::min<std::size_t>(
                     _storedPosition + _storedPayloadSize, _storedLimit));
 
@@ -475,13 +580,13 @@ void AbstractCodec::ensureData(std::size_t size) {
             //[0 to MAX_ENSURE_DATA_BUFFER_SIZE/2), if any
             // remaining is relative to payload since buffer is
             //bounded from outside
-            std::size_t remainingBytes = _socketBuffer.getRemaining();
+            std::size_t remainingBytes = _socketBuffer->getRemaining();
             for (std::size_t i = 0; i < remainingBytes; i++)
-                _socketBuffer.putByte(i, _socketBuffer.getByte());
+                _socketBuffer->putByte(i, _socketBuffer->getByte());
 
             // restore limit (there might be some data already present
             //and readToBuffer needs to know real limit)
-            _socketBuffer.setLimit(_storedLimit);
+            _socketBuffer->setLimit(_storedLimit);
 
             // we expect segmented message, we expect header
             // that (and maybe some control packets) needs to be "removed"
@@ -496,21 +601,21 @@ void AbstractCodec::ensureData(std::size_t size) {
 
             // SPLIT cannot mess with this, since start of the message,
             //i.e. current position, is always aligned
-            _socketBuffer.setPosition(
-                _socketBuffer.getPosition());
+            _socketBuffer->setPosition(
+                _socketBuffer->getPosition());
 
             // copy before position (i.e. start of the payload)
             for (int32_t i = remainingBytes - 1,
-                    j = _socketBuffer.getPosition() - 1; i >= 0; i--, j--)
-                _socketBuffer.putByte(j, _socketBuffer.getByte(i));
+                    j = _socketBuffer->getPosition() - 1; i >= 0; i--, j--)
+                _socketBuffer->putByte(j, _socketBuffer->getByte(i));
 
-            _startPosition = _socketBuffer.getPosition() - remainingBytes;
-            _socketBuffer.setPosition(_startPosition);
+            _startPosition = _socketBuffer->getPosition() - remainingBytes;
+            _socketBuffer->setPosition(_startPosition);
 
             _storedPayloadSize += remainingBytes;
             _storedPosition = _startPosition;
-            _storedLimit = _socketBuffer.getLimit();
-            _socketBuffer.setLimit(
+            _storedLimit = _socketBuffer->getLimit();
+            _socketBuffer->setLimit(
                 std::min<std::size_t>(
                     _storedPosition + _storedPayloadSize, _storedLimit));
 
@@ -542,23 +647,23 @@ std::size_t AbstractCodec::alignedValue(
 void AbstractCodec::alignData(std::size_t alignment) {
 
     std::size_t k = (alignment - 1);
-    std::size_t pos = _socketBuffer.getPosition();
+    std::size_t pos = _socketBuffer->getPosition();
     std::size_t newpos = (pos + k) & (~k);
     if (pos == newpos)
         return;
 
-    std::size_t diff = _socketBuffer.getLimit() - newpos;
+    std::size_t diff = _socketBuffer->getLimit() - newpos;
     if (diff > 0)
     {
-        _socketBuffer.setPosition(newpos);
+        _socketBuffer->setPosition(newpos);
         return;
     }
 
     ensureData(diff);
 
     // position has changed, recalculate
-    newpos = (_socketBuffer.getPosition() + k) & (~k);
-    _socketBuffer.setPosition(newpos);
+    newpos = (_socketBuffer->getPosition() + k) & (~k);
+    _socketBuffer->setPosition(newpos);
 }
 
 static const char PADDING_BYTES[] =
@@ -576,14 +681,14 @@ static const char PADDING_BYTES[] =
 void AbstractCodec::alignBuffer(std::size_t alignment) {
 
     std::size_t k = (alignment - 1);
-    std::size_t pos = _sendBuffer.getPosition();
+    std::size_t pos = _sendBuffer->getPosition();
     std::size_t newpos = (pos + k) & (~k);
     if (pos == newpos)
         return;
 
     // for safety reasons we really pad (override previous message data)
     std::size_t padCount = newpos - pos;
-    _sendBuffer.put(PADDING_BYTES, 0, padCount);
+    _sendBuffer->put(PADDING_BYTES, 0, padCount);
 }
 
 
@@ -595,18 +700,18 @@ void AbstractCodec::startMessage(
         std::numeric_limits<size_t>::max();		// TODO revise this
     ensureBuffer(
         PVA_MESSAGE_HEADER_SIZE + ensureCapacity + _nextMessagePayloadOffset);
-    _lastMessageStartPosition = _sendBuffer.getPosition();
-    _sendBuffer.putByte(PVA_MAGIC);
-    _sendBuffer.putByte(PVA_VERSION);
-    _sendBuffer.putByte(
+    _lastMessageStartPosition = _sendBuffer->getPosition();
+    _sendBuffer->putByte(PVA_MAGIC);
+    _sendBuffer->putByte(PVA_VERSION);
+    _sendBuffer->putByte(
         (_lastSegmentedMessageType | _byteOrderFlag | _clientServerFlag));	// data message
-    _sendBuffer.putByte(command);	// command
-    _sendBuffer.putInt(payloadSize);
+    _sendBuffer->putByte(command);	// command
+    _sendBuffer->putInt(payloadSize);
 
     // apply offset
     if (_nextMessagePayloadOffset > 0)
-        _sendBuffer.setPosition(
-            _sendBuffer.getPosition() + _nextMessagePayloadOffset);
+        _sendBuffer->setPosition(
+            _sendBuffer->getPosition() + _nextMessagePayloadOffset);
 }
 
 
@@ -617,11 +722,11 @@ void AbstractCodec::putControlMessage(
     _lastMessageStartPosition =
         std::numeric_limits<size_t>::max();		// TODO revise this
     ensureBuffer(PVA_MESSAGE_HEADER_SIZE);
-    _sendBuffer.putByte(PVA_MAGIC);
-    _sendBuffer.putByte(PVA_VERSION);
-    _sendBuffer.putByte((0x01 | _byteOrderFlag | _clientServerFlag));	// control message
-    _sendBuffer.putByte(command);	// command
-    _sendBuffer.putInt(data);		// data
+    _sendBuffer->putByte(PVA_MAGIC);
+    _sendBuffer->putByte(PVA_VERSION);
+    _sendBuffer->putByte((0x01 | _byteOrderFlag | _clientServerFlag));	// control message
+    _sendBuffer->putByte(command);	// command
+    _sendBuffer->putInt(data);		// data
 }
 
 
@@ -634,14 +739,18 @@ void AbstractCodec::endMessage(bool hasMoreSegments) {
 
     if (_lastMessageStartPosition != std::numeric_limits<size_t>::max())
     {
-        std::size_t lastPayloadBytePosition = _sendBuffer.getPosition();
+        std::size_t lastPayloadBytePosition = _sendBuffer->getPosition();
 
         // set paylaod size (non-aligned)
         std::size_t payloadSize =
             lastPayloadBytePosition -
             _lastMessageStartPosition - PVA_MESSAGE_HEADER_SIZE;
 
-        _sendBuffer.putInt(_lastMessageStartPosition + 4, payloadSize);
+        _sendBuffer->putInt(_lastMessageStartPosition + 4, payloadSize);
+
+        _txMessageBytes += payloadSize;
+        if (hasMoreSegments)
+            _txSegments++;
 
         // set segmented bit
         if (hasMoreSegments) {
@@ -649,13 +758,13 @@ void AbstractCodec::endMessage(bool hasMoreSegments) {
             if (_lastSegmentedMessageType == 0)
             {
                 std::size_t flagsPosition = _lastMessageStartPosition + 2;
-                epics::pvData::int8 type = _sendBuffer.getByte(flagsPosition);
+                epics::pvData::int8 type = _sendBuffer->getByte(flagsPosition);
                 // set first segment bit
-                _sendBuffer.putByte(flagsPosition, (type | 0x10));
+                _sendBuffer->putByte(flagsPosition, (type | 0x10));
                 // first + last segment bit == in-between segment
                 _lastSegmentedMessageType = type | 0x30;
                 _lastSegmentedMessageCommand =
-                    _sendBuffer.getByte(flagsPosition + 1);
+                    _sendBuffer->getByte(flagsPosition + 1);
             }
             _nextMessagePayloadOffset = 0;
         }
@@ -666,7 +775,7 @@ void AbstractCodec::endMessage(bool hasMoreSegments) {
             {
                 std::size_t flagsPosition = _lastMessageStartPosition + 2;
                 // set last segment bit (by clearing first segment bit)
-                _sendBuffer.putByte(flagsPosition,
+                _sendBuffer->putByte(flagsPosition,
                                      (_lastSegmentedMessageType & 0xEF));
                 _lastSegmentedMessageType = 0;
             }
@@ -696,7 +805,7 @@ void AbstractCodec::endMessage(bool hasMoreSegments) {
 
 void AbstractCodec::ensureBuffer(std::size_t size) {
 
-    if (_sendBuffer.getRemaining() >= size)
+    if (_sendBuffer->getRemaining() >= size)
         return;
 
     // too large for buffer...
@@ -710,7 +819,7 @@ void AbstractCodec::ensureBuffer(std::size_t size) {
         throw std::invalid_argument(s);
     }
 
-    while (_sendBuffer.getRemaining() < size)
+    while (_sendBuffer->getRemaining() < size)
         flush(false);
 }
 
@@ -721,10 +830,10 @@ void AbstractCodec::flushSerializeBuffer() {
 
 void AbstractCodec::flushSendBuffer() {
 
-    _sendBuffer.flip();
+    _sendBuffer->flip();
 
     try {
-        send(&_sendBuffer);
+        send(_sendBuffer.get());
     } catch (io_exception &) {
         try {
             if (isOpen())
@@ -735,13 +844,17 @@ void AbstractCodec::flushSendBuffer() {
         throw connection_closed_exception("Failed to send buffer.");
     }
 
-    _sendBuffer.clear();
+    _sendBuffer->clear();
 
     _lastMessageStartPosition = std::numeric_limits<size_t>::max();
 }
 
 void AbstractCodec::flush(bool lastMessageCompleted) {
 
+    // message did not fit in the buffer
+    if (!lastMessageCompleted)
+        _txSplit = true;
+
     // automatic end
     endMessage(!lastMessageCompleted);
 
@@ -790,7 +903,10 @@ void AbstractCodec::send(ByteBuffer *buffer)
         buffer->setLimit(buffer->getPosition() + bytesToSend);
     }
 
+    MB_POINT(pvAccess, 3, "send");
+
     int tries = 0;
+    std::size_t totalSent = 0u;
     while (buffer->getRemaining() > 0)
     {
 
@@ -818,6 +934,7 @@ void AbstractCodec::send(ByteBuffer *buffer)
         }
 
         _totalBytesSent += bytesSent;
+        totalSent += bytesSent;
 
         // readjust limit
         if (bytesToSend == maxBytesToSend)
@@ -831,6 +948,9 @@ void AbstractCodec::send(ByteBuffer *buffer)
         }
         tries = 0;
     }
+
+    Guard G(_mutex);
+    _stats.ntxBytes += totalSent;
 }
 
 
@@ -846,7 +966,7 @@ void AbstractCodec::processSendQueue()
             if (sender.get() == 0)
             {
                 // flush
-                if (_sendBuffer.getPosition() > 0)
+                if (_sendBuffer->getPosition() > 0)
                     flush(true);
 
                 sendCompleted();	// do not schedule sending
@@ -860,7 +980,7 @@ void AbstractCodec::processSendQueue()
             try {
                 processSender(sender);
             } catch(...) {
-                if (_sendBuffer.getPosition() > 0)
+                if (_sendBuffer->getPosition() > 0)
                     flush(true);
                 sendCompleted();
                 throw;
@@ -869,14 +989,14 @@ void AbstractCodec::processSendQueue()
     }
 
     // flush
-    if (_sendBuffer.getPosition() > 0)
+    if (_sendBuffer->getPosition() > 0)
         flush(true);
 }
 
 
 void AbstractCodec::enqueueSendRequest(
     TransportSender::shared_pointer const & sender) {
-    _sendQueue.push_back(sender);
+    _sendQueue.push_back(sender, sender->getSendPriority()==SEND_PRIORITY_BULK);
     scheduleSend();
 }
 
@@ -893,13 +1013,41 @@ void AbstractCodec::processSender(
 
     ScopedLock lock(sender);
 
+    MB_INC_AUTO_ID(pvAccess);
+    MB_POINT(pvAccess, 2, "serialize");
+
     try {
-        _lastMessageStartPosition = _sendBuffer.getPosition();
+        if (_sendBufferResizeTo)
+            resizeSendBuffer();
 
-        sender->send(&_sendBuffer, this);
+        _txMessageBytes = 0u;
+        _txSegments = 1u;
+        _txSplit = false;
+
+        _lastMessageStartPosition = _sendBuffer->getPosition();
+
+        sender->send(_sendBuffer.get(), this);
 
         // automatic end (to set payload size)
         endMessage(false);
+
+        Guard G(_mutex);
+        _stats.ntxMessages++;
+        _stats.ntxSegments += _txSegments;
+        _stats.maxTxSegments = std::max(_stats.maxTxSegments, _txSegments);
+
+        const size_t required = 2*PVA_MESSAGE_HEADER_SIZE + MAX_ENSURE_SIZE + _txMessageBytes;
+        const size_t current = _sendBuffer->getSize();
+        if (_txSplit && required > current && current < _maxSendBufferSize)
+            _sendBufferResizeTo = std::max(_sendBufferResizeTo,
+                                           bufSizeGrow(current, required, _maxSendBufferSize));
+
+        // shrink back after a while without large messages
+        if (required > _initialSendBufferSize)
+            _txLargeTime = epicsTime::getCurrent();
+        else if (current > _initialSendBufferSize && !_sendBufferResizeTo
+                 && epicsTime::getCurrent() - _txLargeTime >= _bufferShrinkDelay)
+            _sendBufferResizeTo = _initialSendBufferSize;
     }
     catch (connection_closed_exception & ) {
         throw;
@@ -923,16 +1071,79 @@ void AbstractCodec::processSender(
 }
 
 
+void AbstractCodec::resizeSendBuffer()
+{
+    // the previous sender may have left data in the buffer
+    if (_sendBuffer->getPosition() > 0)
+        flush(true);
+
+    const std::size_t size = _sendBufferResizeTo;
+    const std::size_t current = _sendBuffer->getSize();
+    _sendBufferResizeTo = 0u;
+    if (size == current)
+        return;
+
+    Guard G(_mutex);
+    _sendBuffer.reset(new ByteBuffer(size, bufferByteOrder()));
+    _sendBuffer->clear();
+    _maxSendPayloadSize = _sendBuffer->getSize() - 2*PVA_MESSAGE_HEADER_SIZE;
+    if (size > current)
+        _stats.ngrow++;
+    else
+        _stats.nshrink++;
+}
+
+void AbstractCodec::setMaxReceiveBufferSize(std::size_t size)
+{
+    Guard G(_mutex);
+    _maxReceiveBufferSize = size;
+}
+
+std::size_t AbstractCodec::getMaxReceiveBufferSize() const
+{
+    Guard G(_mutex);
+    return std::max(_maxReceiveBufferSize, _socketBuffer->getSize());
+}
+
+void AbstractCodec::allowReceiveBufferGrowth()
+{
+    Guard G(_mutex);
+    _receiveGrowth = true;
+}
+
+void AbstractCodec::setMaxSendBufferSize(std::size_t size)
+{
+    Guard G(_mutex);
+    _maxSendBufferSize = size;
+}
+
+void AbstractCodec::setBufferShrinkDelay(double seconds)
+{
+    Guard G(_mutex);
+    _bufferShrinkDelay = seconds;
+}
+
+void AbstractCodec::getBufferStats(BufferStats& stats) const
+{
+    Guard G(_mutex);
+    stats = _stats;
+    stats.receiveBufferSize = _socketBuffer->getSize();
+    stats.maxReceiveBufferSize = std::max(_maxReceiveBufferSize, stats.receiveBufferSize);
+    stats.sendBufferSize = _sendBuffer->getSize();
+    stats.maxSendBufferSize = std::max(_maxSendBufferSize, stats.sendBufferSize);
+}
+
+
 void AbstractCodec::enqueueSendRequest(
     TransportSender::shared_pointer const & sender,
     std::size_t requiredBufferSize) {
 
     if (_senderThread == epicsThreadGetIdSelf() &&
             _sendQueue.empty() &&
-            _sendBuffer.getRemaining() >= requiredBufferSize)
+            _sendBuffer->getRemaining() >= requiredBufferSize)
     {
         processSender(sender);
-        if (_sendBuffer.getPosition() > 0)
+        if (_sendBuffer->getPosition() > 0)
         {
             if (_lowLatency)
                 flush(true);
@@ -952,9 +1163,10 @@ void AbstractCodec::setRecipient(osiSockAddr const & sendTo) {
 
 void AbstractCodec::setByteOrder(int byteOrder)
 {
-    _socketBuffer.setEndianess(byteOrder);
+    Guard G(_mutex); // vs. buffer growth
+    _socketBuffer->setEndianess(byteOrder);
     // TODO sync
-    _sendBuffer.setEndianess(byteOrder);
+    _sendBuffer->setEndianess(byteOrder);
     _byteOrderFlag = EPICS_ENDIAN_BIG == byteOrder ? 0x80 : 0x00;
 }
 
@@ -1222,6 +1434,7 @@ BlockingTCPTransportCodec::BlockingTCPTransportCodec(bool serverFlag, const Cont
     ,_channel(channel)
     ,_context(context), _responseHandler(responseHandler)
     ,_remoteTransportReceiveBufferSize(MAX_TCP_RECV)
+    ,_maxBufferSize(context->getMaxBufferSize())
     ,_priority(priority)
     ,_verified(false)
 {
@@ -1229,17 +1442,61 @@ BlockingTCPTransportCodec::BlockingTCPTransportCodec(bool serverFlag, const Cont
 
     _isOpen.getAndSet(true);
 
+    {
+        int rcvbuf = 0;
+        osiSocklen_t intLen = sizeof(rcvbuf);
+        if(getsockopt(_channel, SOL_SOCKET, SO_RCVBUF, (char *)&rcvbuf, &intLen)==0 && rcvbuf>0)
+            _socketReceiveBufferSize = size_t(rcvbuf);
+    }
+
+    // The receive buffer grows when large messages arrive, once verified.
+    // The send buffer only after the peer advertises its limit.
+    setMaxReceiveBufferSize(_maxBufferSize);
+
+    if(context->isHandlerTimingEnabled()) {
+        _handlerStats.reset(new HandlerStats);
+        memset(_handlerStats.get(), 0, sizeof(HandlerStats));
+    }
+
     // get remote address
-    osiSocklen_t saSize = sizeof(sockaddr);
-    int retval = getpeername(_channel, &(_socketAddress.sa), &saSize);
+    union {
+        osiSockAddr ip;
+#ifdef PVA_UNIX_SOCKET
+        sockaddr_un un;
+#endif
+    } peer;
+    memset(&peer, 0, sizeof(peer));
+    osiSocklen_t saSize = sizeof(peer);
+    int retval = getpeername(_channel, &peer.ip.sa, &saSize);
     if(unlikely(retval<0)) {
         char errStr[64];
         epicsSocketConvertErrnoToString(errStr, sizeof(errStr));
         LOG(logLevelError,
             "Error fetching socket remote address: %s.",
             errStr);
+        _socketAddress = peer.ip;
         _socketName = "<unknown>:0";
+#ifdef PVA_UNIX_SOCKET
+    } else if(peer.ip.sa.sa_family==AF_UNIX) {
+        // client side sees the server socket path.
+        // server side peer is anonymous, so use our listening path
+        // plus a sequence number to keep TransportRegistry keys unique.
+        std::string path(peer.un.sun_path);
+        epicsUInt16 seq = 0;
+        if(path.empty()) {
+            static size_t nextUnixPeer;
+            seq = epicsUInt16(1u + epics::atomic::increment(nextUnixPeer)%0xfffeu);
+            memset(&peer, 0, sizeof(peer));
+            saSize = sizeof(peer);
+            if(getsockname(_channel, &peer.ip.sa, &saSize)==0)
+                path = peer.un.sun_path;
+        }
+        unixSocketAddress(path, &_socketAddress);
+        _socketAddress.ia.sin_port = htons(seq);
+        _socketName = inetAddressToString(_socketAddress);
+#endif
     } else {
+        _socketAddress = peer.ip;
         char ipAddrStr[64];
         ipAddrToDottedIP(&_socketAddress.ia, ipAddrStr, sizeof(ipAddrStr));
         _socketName = ipAddrStr;
@@ -1334,6 +1591,65 @@ int BlockingTCPTransportCodec::read(epics::pvData::ByteBuffer* dst) {
 }
 
 
+void BlockingTCPTransportCodec::setRemoteTransportReceiveBufferSize(std::size_t remoteTransportReceiveBufferSize)
+{
+    _remoteTransportReceiveBufferSize = remoteTransportReceiveBufferSize;
+
+    // Peers advertise the limit of their receive buffer,
+    // older peers its current size.  Either way, don't send
+    // segments larger than the peer can take in one buffer.
+    setMaxSendBufferSize(std::min(_maxBufferSize, remoteTransportReceiveBufferSize));
+}
+
+void BlockingTCPTransportCodec::processApplicationMessage()
+{
+    // _handlerStats is only set by the ctor
+    if(!_handlerStats.get()) {
+        _responseHandler->handleResponse(&_socketAddress, shared_from_this(),
+                                         _version, _command, _payloadSize, _socketBuffer.get());
+        return;
+    }
+
+    const int8 command = _command;
+    epicsTimeStamp start, end;
+    epicsTimeGetCurrent(&start);
+
+    _responseHandler->handleResponse(&_socketAddress, shared_from_this(),
+                                     _version, _command, _payloadSize, _socketBuffer.get());
+
+    epicsTimeGetCurrent(&end);
+    const double usec = epicsTimeDiffInSeconds(&end, &start)*1e6;
+
+    if(command<0 || command>=int8(HandlerStats::ncommands))
+        return;
+
+    size_t bucket = 0u;
+    while(bucket+1u < size_t(HandlerStats::nbuckets) && usec >= double(1u<<bucket))
+        bucket++;
+
+    Guard G(_mutex);
+    _handlerStats->latency[command][bucket]++;
+}
+
+bool BlockingTCPTransportCodec::getHandlerStats(HandlerStats& stats) const
+{
+    Guard G(_mutex);
+    if(!_handlerStats.get())
+        return false;
+    stats = *_handlerStats;
+    return true;
+}
+
+bool BlockingTCPTransportCodec::takeHandlerStats(HandlerStats& stats)
+{
+    Guard G(_mutex);
+    if(!_handlerStats.get())
+        return false;
+    stats = *_handlerStats;
+    memset(_handlerStats.get(), 0, sizeof(HandlerStats));
+    return true;
+}
+
 bool BlockingTCPTransportCodec::verify(epics::pvData::int32 timeoutMs) {
     return _verifiedEvent.wait(timeoutMs/1000.0) && _verified;
 }
@@ -1350,6 +1666,9 @@ void BlockingTCPTransportCodec::verified(epics::pvData::Status const & status) {
         Guard G(_mutex);
         _verified = status.isSuccess();
     }
+    // only a verified peer may make us grow the receive buffer
+    if (status.isSuccess())
+        allowReceiveBufferGrowth();
     _verifiedEvent.signal();
 }
 
@@ -1399,6 +1718,92 @@ void BlockingTCPTransportCodec::sendSecurityPluginMessage(epics::pvData::PVStruc
 
 
 
+HandshakeLimit::HandshakeLimit(size_t limit)
+    :_limit(limit)
+    ,_pending(0u)
+    ,_interrupted(false)
+{
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+bool HandshakeLimit::acquire()
+{
+    Guard G(_mutex);
+    if(!_interrupted && _limit && _pending>=_limit)
+        _stats.nwaited++;
+    while(!_interrupted && _limit && _pending>=_limit) {
+        UnGuard U(G);
+        _wakeup.wait();
+    }
+    if(_interrupted)
+        return false;
+    _pending++;
+    _stats.nacquired++;
+    if(_stats.maxPending < _pending)
+        _stats.maxPending = _pending;
+    return true;
+}
+
+void HandshakeLimit::release()
+{
+    {
+        Guard G(_mutex);
+        assert(_pending>0u);
+        _pending--;
+    }
+    _wakeup.signal();
+}
+
+void HandshakeLimit::interrupt()
+{
+    {
+        Guard G(_mutex);
+        _interrupted = true;
+    }
+    _wakeup.signal();
+}
+
+void HandshakeLimit::setLimit(size_t limit)
+{
+    {
+        Guard G(_mutex);
+        _limit = limit;
+    }
+    _wakeup.signal();
+}
+
+size_t HandshakeLimit::pending() const
+{
+    Guard G(_mutex);
+    return _pending;
+}
+
+void HandshakeLimit::stats(Stats& ret) const
+{
+    Guard G(_mutex);
+    ret = _stats;
+    ret.pending = _pending;
+}
+
+// Validation timeout, and hold off before closing a failed connection
+struct HandshakeTimer : public epics::pvData::TimerCallback
+{
+    const std::tr1::weak_ptr<BlockingServerTCPTransportCodec> transport;
+
+    explicit HandshakeTimer(const std::tr1::shared_ptr<BlockingServerTCPTransportCodec>& transport)
+        :transport(transport)
+    {}
+    virtual ~HandshakeTimer() {}
+
+    virtual void callback() OVERRIDE FINAL
+    {
+        std::tr1::shared_ptr<BlockingServerTCPTransportCodec> T(transport.lock());
+        if(T)
+            T->handshakeTimeout();
+    }
+    virtual void timerStopped() OVERRIDE FINAL {}
+};
+
 BlockingServerTCPTransportCodec::BlockingServerTCPTransportCodec(
     Context::shared_pointer const & context,
     SOCKET channel,
@@ -1410,6 +1815,8 @@ BlockingServerTCPTransportCodec::BlockingServerTCPTransportCodec(
     ,_lastChannelSID(0)
     ,_verificationStatus(pvData::Status::fatal("Uninitialized error"))
     ,_verifyOrVerified(false)
+    ,_asyncVerify(false)
+    ,_handshakeDone(false)
 {
     // NOTE: priority not yet known, default priority is used to
     //register/unregister
@@ -1470,6 +1877,18 @@ size_t BlockingServerTCPTransportCodec::getChannelCount() const {
     return _channels.size();
 }
 
+void BlockingServerTCPTransportCodec::setMonitorGroup(std::tr1::shared_ptr<ServerMonitorGroup> const & group)
+{
+    Guard G(_mutex);
+    _monitorGroup = group;
+}
+
+std::tr1::shared_ptr<ServerMonitorGroup> BlockingServerTCPTransportCodec::getMonitorGroup() const
+{
+    Guard G(_mutex);
+    return _monitorGroup;
+}
+
 void BlockingServerTCPTransportCodec::getChannels(std::vector<ServerChannel::shared_pointer>& channels) const
 {
     Lock lock(_channelsMutex);
@@ -1506,8 +1925,8 @@ void BlockingServerTCPTransportCodec::send(ByteBuffer* buffer,
         //
         control->startMessage(CMD_CONNECTION_VALIDATION, 4+2);
 
-        // receive buffer size
-        buffer->putInt(static_cast<int32>(getReceiveBufferSize()));
+        // max. payload size, the limit of our receive buffer
+        buffer->putInt(static_cast<int32>(getMaxReceiveBufferSize()));
 
         // server introspection registy max size
         // TODO
@@ -1563,12 +1982,109 @@ void BlockingServerTCPTransportCodec::send(ByteBuffer* buffer,
         }
         sts.serialize(buffer, control);
 
+        // trailing feature flags, skipped by older clients
+        control->ensureBuffer(2);
+        buffer->putShort((int16)SERVER_FEATURE_MULTI_REQUEST);
+
         // send immediately
         control->flush(true);
 
     }
 }
 
+void BlockingServerTCPTransportCodec::startVerify(double timeout, HandshakeLimit::shared_pointer const & slot)
+{
+    {
+        // take the slot first, so that close() releases it should the following throw
+        Guard G(_mutex);
+        _handshakeSlot = slot;
+    }
+    if(!isOpen()) {
+        // peer already gone
+        releaseHandshake();
+        return;
+    }
+
+    TimerCallbackPtr timer(new HandshakeTimer(std::tr1::static_pointer_cast<BlockingServerTCPTransportCodec>(shared_from_this())));
+    {
+        Guard G(_mutex);
+        _asyncVerify = true;
+        _handshakeTimer = timer;
+    }
+
+    _context->getTimer()->scheduleAfterDelay(timer, timeout);
+
+    // send validation request
+    TransportSender::shared_pointer transportSender =
+        std::tr1::dynamic_pointer_cast<TransportSender>(shared_from_this());
+    enqueueSendRequest(transportSender);
+}
+
+void BlockingServerTCPTransportCodec::verified(epics::pvData::Status const & status)
+{
+    bool notify;
+    TimerCallbackPtr timer;
+    {
+        Guard G(_mutex);
+        _verificationStatus = status;
+        notify = _asyncVerify && !_handshakeDone;
+        if(notify) {
+            _handshakeDone = true;
+            timer = _handshakeTimer;
+        }
+    }
+    BlockingTCPTransportCodec::verified(status);
+
+    if(!notify)
+        return;
+
+    // send validated message
+    TransportSender::shared_pointer transportSender =
+        std::tr1::dynamic_pointer_cast<TransportSender>(shared_from_this());
+    enqueueSendRequest(transportSender);
+
+    releaseHandshake();
+
+    TimerWheel::shared_pointer T(_context->getTimer());
+    T->cancel(timer);
+    if(status.isSuccess()) {
+        LOG(logLevelDebug, "Serving to PVA client: %s.", _socketName.c_str());
+
+    } else {
+        // hold off the client from retrying at a very high rate
+        T->scheduleAfterDelay(timer, 1.0);
+    }
+}
+
+void BlockingServerTCPTransportCodec::handshakeTimeout()
+{
+    bool expired;
+    {
+        Guard G(_mutex);
+        expired = !_handshakeDone;
+    }
+
+    if(expired) {
+        LOG(logLevelDebug, "Connection to PVA client %s failed to be validated, closing it.", _socketName.c_str());
+        // sends the failure, and re-schedules us to close
+        verified(pvData::Status::error("Connection validation timeout"));
+
+    } else {
+        close();
+    }
+}
+
+void BlockingServerTCPTransportCodec::releaseHandshake()
+{
+    HandshakeLimit::shared_pointer slot;
+    {
+        Guard G(_mutex);
+        slot.swap(_handshakeSlot);
+    }
+    if(slot)
+        slot->release();
+}
+
 void BlockingServerTCPTransportCodec::destroyAllChannels() {
     Lock lock(_channelsMutex);
     if(_channels.size()==0) return;
@@ -1590,8 +2106,22 @@ void BlockingServerTCPTransportCodec::destroyAllChannels() {
 
 void BlockingServerTCPTransportCodec::internalClose() {
     Transport::shared_pointer thisSharedPtr = shared_from_this();
+    // while still in the registry, so statistics don't miss us
+    _context->transportClosed(thisSharedPtr);
     BlockingTCPTransportCodec::internalClose();
     destroyAllChannels();
+
+    TimerCallbackPtr timer;
+    std::tr1::shared_ptr<ServerMonitorGroup> group;
+    {
+        Guard G(_mutex);
+        _handshakeDone = true;
+        timer.swap(_handshakeTimer);
+        group.swap(_monitorGroup);
+    }
+    if(timer)
+        _context->getTimer()->cancel(timer);
+    releaseHandshake();
 }
 
 void BlockingServerTCPTransportCodec::authenticationCompleted(epics::pvData::Status const & status,
@@ -1677,7 +2207,8 @@ BlockingClientTCPTransportCodec::BlockingClientTCPTransportCodec(
                               sendBufferSize, receiveBufferSize, priority),
     _connectionTimeout(heartbeatInterval*1000),
     _unresponsiveTransport(false),
-    _verifyOrEcho(true)
+    _verifyOrEcho(true),
+    _serverFeatures(0)
 {
     // initialize owners list, send queue
     acquire(client);
@@ -1868,15 +2399,15 @@ void BlockingClientTCPTransportCodec::send(ByteBuffer* buffer,
 
         control->startMessage(CMD_CONNECTION_VALIDATION, 4+2+2);
 
-        // receive buffer size
-        buffer->putInt(static_cast<int32>(getReceiveBufferSize()));
+        // max. payload size, the limit of our receive buffer
+        buffer->putInt(static_cast<int32>(getMaxReceiveBufferSize()));
 
         // max introspection registry size
         // TODO
         buffer->putShort(0x7FFF);
 
-        // QoS (aka connection priority)
-        buffer->putShort(getPriority());
+        // QoS (aka connection priority) and flags
+        buffer->putShort((int16)(getPriority() | CONNECTION_QOS_MULTIPLE_DATA));
 
         std::string pluginName;
         AuthenticationSession::shared_pointer session;
@@ -1980,6 +2511,18 @@ void BlockingClientTCPTransportCodec::verified(epics::pvData::Status const & sta
     this->BlockingTCPTransportCodec::verified(status);
 }
 
+void BlockingClientTCPTransportCodec::setServerFeatures(epics::pvData::int16 features)
+{
+    Guard G(_mutex);
+    _serverFeatures = features;
+}
+
+epics::pvData::int16 BlockingClientTCPTransportCodec::getServerFeatures() const
+{
+    Guard G(_mutex);
+    return _serverFeatures;
+}
+
 }
 }
 }
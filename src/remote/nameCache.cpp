@@ -0,0 +1,287 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <string.h>
+#include <errno.h>
+
+#if !defined(_WIN32) && !defined(vxWorks) && !defined(__rtems__)
+#  define PVA_NAME_CACHE_MMAP
+#  include <sys/types.h>
+#  include <sys/stat.h>
+#  include <sys/mman.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+
+#include <epicsGuard.h>
+
+#define epicsExportSharedSymbols
+#include <pv/nameCache.h>
+#include <pv/logger.h>
+
+typedef epicsGuard<epicsMutex> Guard;
+
+namespace epics {
+namespace pvAccess {
+
+namespace {
+const char cacheMagic[8] = {'P', 'V', 'A', 'N', 'A', 'M', 'E', 'S'};
+const epicsUInt32 cacheVersion = 1u;
+
+// slot hash values with special meaning
+const epicsUInt32 slotEmpty = 0u;
+const epicsUInt32 slotRemoved = 1u;
+
+// limit linear probing.  A full neighbourhood evicts.
+const size_t maxProbe = 16u;
+
+epicsUInt32 hashName(const std::string& name)
+{
+    // FNV-1a
+    epicsUInt32 hash = 2166136261u;
+    for(size_t i=0; i<name.size(); i++) {
+        hash ^= epicsUInt8(name[i]);
+        hash *= 16777619u;
+    }
+    if(hash<=slotRemoved)
+        hash += 2u;
+    return hash;
+}
+}
+
+struct NameCache::Header {
+    char magic[8];
+    epicsUInt32 version;
+    epicsUInt32 nslots;
+    epicsUInt32 slotSize;
+    epicsUInt32 reserved[3];
+};
+
+struct NameCache::Slot {
+    // written last when storing.  Also slotEmpty or slotRemoved
+    epicsUInt32 hash;
+    // IPv4 address and port in network byte order
+    epicsUInt32 addr;
+    epicsUInt16 port;
+    epicsUInt8 guid[12];
+    char name[MAX_NAME_LENGTH];
+};
+
+NameCache::shared_pointer NameCache::open(const std::string& path, size_t nslots)
+{
+    shared_pointer ret;
+#ifdef PVA_NAME_CACHE_MMAP
+    int fd = ::open(path.c_str(), O_RDWR|O_CREAT, 0644);
+    if(fd<0) {
+        LOG(logLevelWarn, "Unable to open name cache '%s' : %s", path.c_str(), strerror(errno));
+        return ret;
+    }
+
+    // adopt the size of an existing cache
+    Header existing;
+    struct stat info;
+    if(fstat(fd, &info)==0 && size_t(info.st_size)>=sizeof(existing) &&
+            pread(fd, &existing, sizeof(existing), 0)==ssize_t(sizeof(existing)) &&
+            memcmp(existing.magic, cacheMagic, sizeof(cacheMagic))==0 &&
+            existing.version==cacheVersion &&
+            existing.slotSize==sizeof(Slot) &&
+            existing.nslots>0u &&
+            size_t(info.st_size)==sizeof(Header)+existing.nslots*sizeof(Slot))
+    {
+        nslots = existing.nslots;
+
+    } else {
+        if(nslots==0u)
+            nslots = 1u;
+        // (re)initialize.  Truncate first to zero any old content.
+        if(ftruncate(fd, 0)!=0 || ftruncate(fd, sizeof(Header)+nslots*sizeof(Slot))!=0) {
+            LOG(logLevelWarn, "Unable to size name cache '%s' : %s", path.c_str(), strerror(errno));
+            ::close(fd);
+            return ret;
+        }
+        Header head;
+        memset(&head, 0, sizeof(head));
+        memcpy(head.magic, cacheMagic, sizeof(cacheMagic));
+        head.version = cacheVersion;
+        head.nslots = epicsUInt32(nslots);
+        head.slotSize = sizeof(Slot);
+        if(pwrite(fd, &head, sizeof(head), 0)!=ssize_t(sizeof(head))) {
+            LOG(logLevelWarn, "Unable to initialize name cache '%s' : %s", path.c_str(), strerror(errno));
+            ::close(fd);
+            return ret;
+        }
+    }
+
+    size_t length = sizeof(Header)+nslots*sizeof(Slot);
+    void *base = mmap(0, length, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd); // mapping holds a reference
+    if(base==MAP_FAILED) {
+        LOG(logLevelWarn, "Unable to map name cache '%s' : %s", path.c_str(), strerror(errno));
+        return ret;
+    }
+
+    ret.reset(new NameCache(path, base, length));
+#else
+    LOG(logLevelWarn, "Name cache not supported on this target.  Ignoring '%s'", path.c_str());
+#endif
+    return ret;
+}
+
+NameCache::NameCache(const std::string& path, void* base, size_t length)
+    :_path(path)
+    ,_base(base)
+    ,_length(length)
+    ,_slots(reinterpret_cast<Slot*>(static_cast<char*>(base)+sizeof(Header)))
+    ,_nslots((length-sizeof(Header))/sizeof(Slot))
+{
+    for(size_t i=0; i<_nslots; i++) {
+        if(_slots[i].hash>slotRemoved)
+            indexAdd(&_slots[i]);
+    }
+}
+
+void NameCache::indexAdd(const Slot* slot)
+{
+    _index[server_t(slot->addr, slot->port)].insert(size_t(slot-_slots));
+}
+
+void NameCache::indexRemove(const Slot* slot)
+{
+    index_t::iterator it(_index.find(server_t(slot->addr, slot->port)));
+    if(it==_index.end())
+        return;
+    it->second.erase(size_t(slot-_slots));
+    if(it->second.empty())
+        _index.erase(it);
+}
+
+NameCache::~NameCache()
+{
+#ifdef PVA_NAME_CACHE_MMAP
+    munmap(_base, _length);
+#endif
+}
+
+NameCache::Slot* NameCache::find(const std::string& name, epicsUInt32 hash)
+{
+    size_t home = hash%_nslots;
+    for(size_t i=0; i<maxProbe && i<_nslots; i++) {
+        Slot *slot = &_slots[(home+i)%_nslots];
+        if(slot->hash==slotEmpty)
+            break;
+        if(slot->hash==hash && strncmp(slot->name, name.c_str(), sizeof(slot->name))==0)
+            return slot;
+    }
+    return 0;
+}
+
+bool NameCache::lookup(const std::string& name, osiSockAddr& addr, ServerGUID& guid)
+{
+    if(name.size()>=size_t(MAX_NAME_LENGTH))
+        return false;
+    epicsUInt32 hash = hashName(name);
+
+    Guard G(_mutex);
+    Slot *slot = find(name, hash);
+    if(!slot)
+        return false;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.ia.sin_family = AF_INET;
+    addr.ia.sin_addr.s_addr = slot->addr;
+    addr.ia.sin_port = slot->port;
+    memcpy(guid.value, slot->guid, sizeof(guid.value));
+
+    // re-check in case another process replaced this entry while copying
+    return slot->hash==hash;
+}
+
+void NameCache::store(const std::string& name, const osiSockAddr& addr, const ServerGUID& guid)
+{
+    if(name.size()>=size_t(MAX_NAME_LENGTH) || addr.sa.sa_family!=AF_INET)
+        return;
+    epicsUInt32 hash = hashName(name);
+
+    Guard G(_mutex);
+    Slot *slot = find(name, hash);
+    if(!slot) {
+        // first free slot in the neighbourhood, or evict the first entry
+        size_t home = hash%_nslots;
+        slot = &_slots[home];
+        for(size_t i=0; i<maxProbe && i<_nslots; i++) {
+            Slot *cand = &_slots[(home+i)%_nslots];
+            if(cand->hash==slotEmpty || cand->hash==slotRemoved) {
+                slot = cand;
+                break;
+            }
+        }
+    } else if(slot->addr==addr.ia.sin_addr.s_addr && slot->port==addr.ia.sin_port &&
+              memcmp(slot->guid, guid.value, sizeof(slot->guid))==0) {
+        return; // no change, avoid dirtying the page
+    }
+
+    indexRemove(slot); // evicted, or previous server
+    slot->hash = slotRemoved;
+    slot->addr = addr.ia.sin_addr.s_addr;
+    slot->port = addr.ia.sin_port;
+    memcpy(slot->guid, guid.value, sizeof(slot->guid));
+    memset(slot->name, 0, sizeof(slot->name));
+    memcpy(slot->name, name.c_str(), name.size());
+    slot->hash = hash;
+    indexAdd(slot);
+}
+
+void NameCache::remove(const std::string& name)
+{
+    if(name.size()>=size_t(MAX_NAME_LENGTH))
+        return;
+    epicsUInt32 hash = hashName(name);
+
+    Guard G(_mutex);
+    Slot *slot = find(name, hash);
+    if(slot) {
+        indexRemove(slot);
+        slot->hash = slotRemoved;
+    }
+}
+
+size_t NameCache::invalidate(const osiSockAddr& addr, const ServerGUID& guid)
+{
+    if(addr.sa.sa_family!=AF_INET)
+        return 0u;
+
+    size_t count = 0u;
+    Guard G(_mutex);
+    index_t::iterator it(_index.find(server_t(addr.ia.sin_addr.s_addr, addr.ia.sin_port)));
+    if(it==_index.end())
+        return 0u;
+
+    std::set<size_t>& slots = it->second;
+    for(std::set<size_t>::iterator sit(slots.begin()), end(slots.end()); sit!=end;) {
+        Slot *slot = &_slots[*sit];
+        if(slot->hash>slotRemoved &&
+                slot->addr==addr.ia.sin_addr.s_addr &&
+                slot->port==addr.ia.sin_port &&
+                memcmp(slot->guid, guid.value, sizeof(slot->guid))==0) {
+            ++sit; // current
+            continue;
+        }
+        // restarted server, or replaced by another process
+        if(slot->hash>slotRemoved &&
+                slot->addr==addr.ia.sin_addr.s_addr &&
+                slot->port==addr.ia.sin_port) {
+            slot->hash = slotRemoved;
+            count++;
+        }
+        slots.erase(sit++);
+    }
+    if(slots.empty())
+        _index.erase(it);
+    return count;
+}
+
+}
+}
@@ -25,6 +25,7 @@
 #include <pv/pvaDefs.h>
 #include <pv/remote.h>
 #include <pv/pvAccess.h>
+#include <pv/nameCache.h>
 
 namespace epics {
 namespace pvAccess {
@@ -39,15 +40,17 @@ public:
 
     /**
      * Constructor.
+     * @param nameCache if not NULL, entries are invalidated when the server GUID changes.
      */
     BeaconHandler(Context::shared_pointer const & context,
-                  const osiSockAddr* responseFrom);
+                  const osiSockAddr* responseFrom,
+                  NameCache::shared_pointer const & nameCache = NameCache::shared_pointer());
 
     virtual ~BeaconHandler();
 
     /**
      * Update beacon period and do analitical checks (server restared, routing problems, etc.)
-     * @param from who is notifying.
+     * @param from server (TCP) address announced by the beacon.
      * @param remoteTransportRevision encoded (major, minor) revision.
      * @param guid server GUID.
      * @param sequentalID sequential ID.
@@ -86,9 +89,14 @@ private:
      * First beacon flag.
      */
     bool _first;
+    /**
+     * Persistent name cache, may be NULL.
+     */
+    const NameCache::shared_pointer _nameCache;
 
     /**
      * Update beacon.
+     * @param from server (TCP) address announced by the beacon.
      * @param remoteTransportRevision encoded (major, minor) revision.
      * @param timestamp time when beacon was received.
      * @param guid server GUID.
@@ -96,7 +104,8 @@ private:
      * @param changeCount change count.
      * @return network change (server restarted) detected.
      */
-    bool updateBeacon(epics::pvData::int8 remoteTransportRevision,
+    bool updateBeacon(osiSockAddr* from,
+                      epics::pvData::int8 remoteTransportRevision,
                       epics::pvData::TimeStamp* timestamp,
                       ServerGUID const &guid,
                       epics::pvData::int16 sequentalID,
@@ -43,6 +43,10 @@ namespace pvAccess {
 
 class ClientChannelImpl;
 
+namespace detail {
+class HandshakeLimit;
+}
+
 /**
  * Channel Access TCP connector.
  * @author <a href="mailto:matej.sekoranjaATcosylab.com">Matej Sekoranja</a>
@@ -64,6 +68,11 @@ private:
      */
     static const int LOCK_TIMEOUT = 20*1000; // 20s
 
+    /**
+     * TCP connect() timeout
+     */
+    static const int CONNECT_TIMEOUT = 5*1000; // 5s
+
     /**
      * Context instance.
      */
@@ -88,6 +97,11 @@ private:
      */
     SOCKET tryConnect(osiSockAddr& address, int tries);
 
+    /**
+     * Connect to an AF_UNIX address (see unixSocketAddress()).
+     */
+    SOCKET tryConnectUnix(const osiSockAddr& address);
+
 };
 
 /**
@@ -111,6 +125,14 @@ public:
     BlockingTCPAcceptor(Context::shared_pointer const & context,
                         ResponseHandler::shared_pointer const & responseHandler,
                         const osiSockAddr& addr, int receiveBufferSize);
+    /**
+     * Listen on an AF_UNIX stream socket.
+     * A stale socket file at <code>unixPath</code> is removed.
+     * @param unixPath file system path of the socket.
+     */
+    BlockingTCPAcceptor(Context::shared_pointer const & context,
+                        ResponseHandler::shared_pointer const & responseHandler,
+                        const std::string& unixPath, int receiveBufferSize);
 
     virtual ~BlockingTCPAcceptor();
 
@@ -122,6 +144,18 @@ public:
         return &_bindAddress;
     }
 
+    /**
+     * Maximum number of accepted connections being validated at once.
+     * Further connections wait in the listen backlog.
+     * Zero for no limit.
+     */
+    void setMaxHandshakes(size_t limit);
+
+    //! Connections in the validation handshake
+    const std::tr1::shared_ptr<detail::HandshakeLimit>& getHandshakeLimit() const {
+        return _handshakes;
+    }
+
     /**
      * Destroy acceptor (stop listening).
      */
@@ -145,6 +179,11 @@ private:
      */
     osiSockAddr _bindAddress;
 
+    /**
+     * AF_UNIX socket path, empty if listening on AF_INET.
+     */
+    std::string _unixPath;
+
     /**
      * Server socket channel.
      */
@@ -160,6 +199,11 @@ private:
      */
     bool _destroyed;
 
+    /**
+     * Connections in the validation handshake.
+     */
+    std::tr1::shared_ptr<detail::HandshakeLimit> _handshakes;
+
     epics::pvData::Mutex _mutex;
 
     epicsThread _thread;
@@ -171,10 +215,10 @@ private:
     int initialize();
 
     /**
-     * Validate connection by sending a validation message request.
-     * @return <code>true</code> on success.
+     * Initialize AF_UNIX connection acception.
      */
-    bool validateConnection(Transport::shared_pointer const & transport, const char* address);
+    void initializeUnix();
+
 };
 
 }
@@ -12,6 +12,8 @@
 #   undef epicsExportSharedSymbols
 #endif
 
+#include <vector>
+
 #include <osiSock.h>
 
 #ifdef channelSearchManagerEpicsExportSharedSymbols
@@ -50,6 +52,28 @@ public:
     virtual void searchResponse(const ServerGUID & guid, int8_t minorRevision, osiSockAddr* serverAddress) = 0;
 };
 
+/**
+ * Additional destination for search requests, eg. a TCP connection to a name server.
+ * Called from the search timer.
+ */
+class SearchSender {
+public:
+    POINTER_DEFINITIONS(SearchSender);
+
+    virtual ~SearchSender() {}
+
+    /**
+     * Queue a search request.  May be ignored if not currently able to send.
+     * @param channel to search for.
+     */
+    virtual void search(SearchInstance::shared_pointer const & channel) = 0;
+
+    /**
+     * Send all queued search requests.
+     */
+    virtual void flush() = 0;
+};
+
 
 class ChannelSearchManager :
         public epics::pvData::TimerCallback,
@@ -73,6 +97,13 @@ public:
      * @param channel to register.
      */
     void registerSearchInstance(SearchInstance::shared_pointer const & channel, bool penalize = false);
+    /**
+     * Register several channels.  One round of search requests for all of them
+     * is sent from the timer thread as soon as possible, rather than at the next period.
+     * Does not block.
+     * @param channels to register.
+     */
+    void registerSearchInstances(std::vector<SearchInstance::shared_pointer> const & channels);
     /**
      * Unregister channel.
      * @param channel to unregister.
@@ -92,6 +123,11 @@ public:
      * Boost searching of all channels.
      */
     void newServerDetected();
+    /**
+     * Also send search requests to this destination.
+     * @param sender to add.
+     */
+    void addSearchSender(SearchSender::shared_pointer const & sender);
 
     /// Timer callback.
     virtual void callback() OVERRIDE FINAL;
@@ -113,10 +149,17 @@ private:
     static bool generateSearchRequestMessage(SearchInstance::shared_pointer const & channel,
             epics::pvData::ByteBuffer* byteBuffer, TransportSendControl* control);
 
+    void search(std::vector<SearchInstance::shared_pointer> const & toSend);
+
+    // search for m_pending.  called from the timer thread.
+    struct BatchSearch;
+    void searchPending();
+
     void boost();
 
     void initializeSendBuffer();
     void flushSendBuffer();
+    bool hasSendAddresses();
 
     static bool isPowerOfTwo(int32_t x);
 
@@ -151,6 +194,23 @@ private:
     typedef std::map<pvAccessID,SearchInstance::weak_pointer> m_channels_t;
     m_channels_t m_channels;
 
+    /**
+     * Additional search destinations.
+     */
+    typedef std::vector<SearchSender::shared_pointer> m_senders_t;
+    m_senders_t m_senders;
+
+    /**
+     * Channels registered together, awaiting their first search.
+     * Guarded by m_channelMutex.
+     */
+    std::vector<SearchInstance::weak_pointer> m_pending;
+
+    /**
+     * One-shot timer callback which searches for m_pending.
+     */
+    epics::pvData::TimerCallbackPtr m_batchSearch;
+
     /**
      * Time of last frame send.
      */
@@ -68,6 +68,7 @@ namespace epics {
 namespace pvAccess {
 
 class ServerChannel;
+class ServerMonitorGroup;
 
 namespace detail {
 
@@ -174,6 +175,8 @@ public:
     static const std::size_t MAX_ENSURE_DATA_SIZE;
     static const std::size_t MAX_ENSURE_BUFFER_SIZE;
     static const std::size_t MAX_ENSURE_DATA_BUFFER_SIZE;
+    //! default seconds without large messages before grown buffers are shrunk
+    static const double BUFFER_SHRINK_DELAY;
 
     AbstractCodec(
         bool serverFlag,
@@ -240,11 +243,61 @@ public:
         return _sendQueue.empty();
     }
 
+    //! # of TransportSenders waiting to send
+    std::size_t sendQueueSize() const {
+        return _sendQueue.size();
+    }
+
+    /**
+     * Allow the receive buffer to grow, up to this size, after larger messages are seen.
+     * Growth takes effect between messages.
+     */
+    void setMaxReceiveBufferSize(std::size_t size);
+    std::size_t getMaxReceiveBufferSize() const;
+
+    /**
+     * The receive buffer does not grow until this is called,
+     * so that an unverified peer can't make us allocate.
+     */
+    void allowReceiveBufferGrowth();
+
+    /**
+     * Allow the send buffer to grow, up to this size, when messages must be segmented.
+     * Should not exceed what the peer advertises that it can receive.
+     */
+    void setMaxSendBufferSize(std::size_t size);
+
+    /**
+     * Shrink a grown buffer back to its initial size once no
+     * large message has been sent, or received, for this many seconds.
+     * Checked as messages are sent or received.
+     */
+    void setBufferShrinkDelay(double seconds);
+
+    struct BufferStats {
+        std::size_t receiveBufferSize, maxReceiveBufferSize;
+        std::size_t sendBufferSize, maxSendBufferSize;
+        std::size_t nrxMessages;    //!< # of application messages received
+        std::size_t nrxSegments;    //!< # of segments of those messages.  Unsegmented messages count as one.
+        std::size_t maxRxSegments;  //!< most segments of one received message
+        std::size_t ntxMessages;    //!< # of TransportSender::send() calls
+        std::size_t ntxSegments;
+        std::size_t maxTxSegments;
+        std::size_t ngrow;          //!< # of times either buffer was grown
+        std::size_t nshrink;        //!< # of times either buffer was shrunk back to its initial size
+        epics::pvData::uint64 nrxBytes; //!< # of bytes received, including headers
+        epics::pvData::uint64 ntxBytes; //!< # of bytes sent
+    };
+    void getBufferStats(BufferStats& stats) const;
+
 protected:
 
     virtual void sendBufferFull(int tries) = 0;
     void send(epics::pvData::ByteBuffer *buffer);
     void flushSendBuffer();
+    int bufferByteOrder() const {
+        return _byteOrderFlag ? EPICS_ENDIAN_BIG : EPICS_ENDIAN_LITTLE;
+    }
 
 
     ReadMode _readMode;
@@ -253,6 +306,8 @@ protected:
     int8_t _command;
     int32_t _payloadSize; // TODO why not size_t?
     epics::pvData::int32 _remoteTransportSocketReceiveBufferSize;
+    //! local SO_RCVBUF, if known
+    std::size_t _socketReceiveBufferSize;
     int64_t _totalBytesSent;
     //TODO initialize union
     osiSockAddr _sendTo;
@@ -261,8 +316,9 @@ protected:
     bool _writeOpReady;
     bool _lowLatency;
 
-    epics::pvData::ByteBuffer _socketBuffer;
-    epics::pvData::ByteBuffer _sendBuffer;
+    // replaced when grown
+    epics::auto_ptr<epics::pvData::ByteBuffer> _socketBuffer;
+    epics::auto_ptr<epics::pvData::ByteBuffer> _sendBuffer;
 
     fair_queue<TransportSender> _sendQueue;
 
@@ -276,13 +332,15 @@ private:
     void endMessage(bool hasMoreSegments);
     void processSender(
         epics::pvAccess::TransportSender::shared_pointer const & sender);
+    void resizeReceiveBuffer();
+    void resizeSendBuffer();
 
     std::size_t _storedPayloadSize;
     std::size_t _storedPosition;
     std::size_t _storedLimit;
     std::size_t _startPosition;
 
-    const std::size_t _maxSendPayloadSize;
+    std::size_t _maxSendPayloadSize;
     std::size_t _lastMessageStartPosition;
     std::size_t _lastSegmentedMessageType;
     int8_t _lastSegmentedMessageCommand;
@@ -292,6 +350,28 @@ private:
     epics::pvData::int8 _clientServerFlag;
     const size_t _socketSendBufferSize;
 
+    // receive thread
+    std::size_t _rxMessageBytes;
+    std::size_t _rxSegments;
+    std::size_t _receiveBufferResizeTo;
+    epicsTime _rxLargeTime; //!< when a message last needed more than the initial buffer
+    // send thread
+    std::size_t _txMessageBytes;
+    std::size_t _txSegments;
+    bool _txSplit;
+    std::size_t _sendBufferResizeTo;
+    epicsTime _txLargeTime;
+
+    const std::size_t _initialReceiveBufferSize;
+    const std::size_t _initialSendBufferSize;
+
+    // guarded by _mutex, as is replacement of _socketBuffer and _sendBuffer
+    std::size_t _maxReceiveBufferSize;
+    std::size_t _maxSendBufferSize;
+    bool _receiveGrowth;
+    double _bufferShrinkDelay;
+    BufferStats _stats;
+
 public:
     mutable epics::pvData::Mutex _mutex;
 };
@@ -349,10 +429,7 @@ public:
     }
 
 
-    virtual void processApplicationMessage() OVERRIDE FINAL {
-        _responseHandler->handleResponse(&_socketAddress, shared_from_this(),
-                                         _version, _command, _payloadSize, &_socketBuffer);
-    }
+    virtual void processApplicationMessage() OVERRIDE FINAL;
 
 
     virtual const osiSockAddr& getRemoteAddress() const OVERRIDE FINAL {
@@ -371,7 +448,8 @@ public:
 
 
     virtual std::size_t getReceiveBufferSize() const OVERRIDE FINAL {
-        return _socketBuffer.getSize();
+        epicsGuard<epicsMutex> G(_mutex);
+        return _socketBuffer->getSize();
     }
 
 
@@ -381,9 +459,7 @@ public:
 
 
     virtual void setRemoteTransportReceiveBufferSize(
-        std::size_t remoteTransportReceiveBufferSize) OVERRIDE FINAL {
-        _remoteTransportReceiveBufferSize = remoteTransportReceiveBufferSize;
-    }
+        std::size_t remoteTransportReceiveBufferSize) OVERRIDE FINAL;
 
 
     virtual void setRemoteTransportSocketReceiveBufferSize(
@@ -430,6 +506,22 @@ public:
 
     virtual void sendSecurityPluginMessage(epics::pvData::PVStructure::const_shared_pointer const & data) OVERRIDE FINAL;
 
+    /**
+     * Time spent in the ResponseHandler, by command.
+     * Only collected if Context::isHandlerTimingEnabled().
+     * The time to receive the remaining segments of a segmented message is included.
+     */
+    struct HandlerStats {
+        enum { ncommands = CMD_MULTI_PUT+1, nbuckets = 20 };
+        //! latency[c][i] counts messages with command c handled in less than 2^i microseconds.
+        //! The last bucket also counts all longer times.
+        std::size_t latency[ncommands][nbuckets];
+    };
+    //! @returns false, leaving 'stats' unchanged, if not collected.
+    bool getHandlerStats(HandlerStats& stats) const;
+    //! As getHandlerStats(), and zero our counters.  Used to keep totals once closed.
+    bool takeHandlerStats(HandlerStats& stats);
+
 private:
     void receiveThread();
     void sendThread();
@@ -467,6 +559,10 @@ private:
 
     ResponseHandler::shared_pointer _responseHandler;
     size_t _remoteTransportReceiveBufferSize;
+    // local limit from Context::getMaxBufferSize()
+    const size_t _maxBufferSize;
+    // NULL unless Context::isHandlerTimingEnabled().  guarded by _mutex
+    epics::auto_ptr<HandlerStats> _handlerStats;
     epics::pvData::int16 _priority;
 
 protected:
@@ -474,6 +570,51 @@ protected:
     epics::pvData::Event _verifiedEvent;
 };
 
+/**
+ * Bounds the number of server connections in the validation handshake.
+ * Shared by an acceptor and the transports it creates.
+ */
+class HandshakeLimit {
+public:
+    POINTER_DEFINITIONS(HandshakeLimit);
+
+    explicit HandshakeLimit(size_t limit);
+
+    /**
+     * Take a slot, waiting while the limit is reached.
+     * @return false once interrupt() has been called.
+     */
+    bool acquire();
+
+    //! Return a slot taken by acquire()
+    void release();
+
+    //! Fail current and future acquire()
+    void interrupt();
+
+    void setLimit(size_t limit);
+
+    //! Number of slots currently taken
+    size_t pending() const;
+
+    //! Snapshot of counters.  cf. stats()
+    struct Stats {
+        size_t pending;    //!< slots currently taken
+        size_t maxPending; //!< most slots ever taken at once
+        size_t nacquired;  //!< total acquire() which succeeded
+        size_t nwaited;    //!< acquire() which had to wait for a slot
+    };
+    void stats(Stats& ret) const;
+
+private:
+    mutable epics::pvData::Mutex _mutex;
+    epics::pvData::Event _wakeup;
+    size_t _limit;
+    size_t _pending;
+    bool _interrupted;
+    Stats _stats;
+};
+
 class BlockingServerTCPTransportCodec :
     public BlockingTCPTransportCodec,
     public TransportSender {
@@ -533,6 +674,14 @@ public:
 
     size_t getChannelCount() const;
 
+    /**
+     * Gathers monitor updates into CMD_MULTIPLE_DATA messages.
+     * NULL unless the client indicated support during connection validation.
+     */
+    void setMonitorGroup(std::tr1::shared_ptr<ServerMonitorGroup> const & group);
+
+    std::tr1::shared_ptr<ServerMonitorGroup> getMonitorGroup() const;
+
     virtual bool verify(epics::pvData::int32 timeoutMs) OVERRIDE FINAL {
 
         TransportSender::shared_pointer transportSender =
@@ -546,13 +695,16 @@ public:
         return verifiedStatus;
     }
 
-    virtual void verified(epics::pvData::Status const & status) OVERRIDE FINAL {
-        {
-            epicsGuard<epicsMutex> G(_mutex);
-            _verificationStatus = status;
-        }
-        BlockingTCPTransportCodec::verified(status);
-    }
+    /**
+     * Begin connection validation without waiting for the outcome.
+     * The result is sent to the client from verified(), or after
+     * timeout seconds without it.  A failed connection is closed
+     * after a short hold off.
+     * @param slot released when validation completes or the transport closes.  May be NULL.
+     */
+    void startVerify(double timeout, HandshakeLimit::shared_pointer const & slot);
+
+    virtual void verified(epics::pvData::Status const & status) OVERRIDE FINAL;
 
     virtual void aliveNotification() OVERRIDE FINAL {
         // noop on server-side
@@ -595,6 +747,19 @@ private:
 
     std::vector<std::string> advertisedAuthPlugins;
 
+    std::tr1::shared_ptr<ServerMonitorGroup> _monitorGroup;
+
+    friend struct HandshakeTimer;
+    void handshakeTimeout();
+    void releaseHandshake();
+
+    // set by startVerify()
+    HandshakeLimit::shared_pointer _handshakeSlot;
+    epics::pvData::TimerCallbackPtr _handshakeTimer;
+    bool _asyncVerify;
+    // outcome of startVerify() sent to client
+    bool _handshakeDone;
+
 };
 
 class BlockingClientTCPTransportCodec :
@@ -669,6 +834,14 @@ public:
                                          const std::tr1::shared_ptr<PeerInfo>& peer) OVERRIDE FINAL;
 
     virtual void verified(epics::pvData::Status const & status) OVERRIDE FINAL;
+
+    /**
+     * SERVER_FEATURE_* flags sent by the server with CMD_CONNECTION_VALIDATED.
+     * Zero for servers which send none.
+     */
+    void setServerFeatures(epics::pvData::int16 features);
+
+    epics::pvData::int16 getServerFeatures() const;
 protected:
 
     virtual void internalClose() OVERRIDE FINAL;
@@ -699,6 +872,8 @@ private:
 
     bool _verifyOrEcho;
 
+    epics::pvData::int16 _serverFeatures;
+
     /**
      * Unresponsive transport notify.
      */
@@ -0,0 +1,128 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#ifndef NAMECACHE_H
+#define NAMECACHE_H
+
+#ifdef epicsExportSharedSymbols
+#   define nameCacheEpicsExportSharedSymbols
+#   undef epicsExportSharedSymbols
+#endif
+
+#include <string>
+#include <map>
+#include <set>
+#include <utility>
+
+#include <osiSock.h>
+#include <epicsMutex.h>
+#include <epicsTypes.h>
+
+#include <pv/sharedPtr.h>
+
+#ifdef nameCacheEpicsExportSharedSymbols
+#   define epicsExportSharedSymbols
+#	undef nameCacheEpicsExportSharedSymbols
+#endif
+
+#include <shareLib.h>
+#include <pv/pvaDefs.h>
+
+namespace epics {
+namespace pvAccess {
+
+/**
+ * Persistent cache of channel name -> server (address, GUID).
+ *
+ * A fixed size, open addressed hash table in a memory mapped file,
+ * which outlives the client process.  On startup a client may then
+ * create channels directly on the remembered server, and only fall
+ * back to searching when this fails.
+ *
+ * The file may be shared between processes.  Updates are not atomic
+ * across processes, so a lookup may give a stale or wrong answer.
+ * Callers must treat any result as a hint to be verified.
+ *
+ * Only IPv4 server addresses, and names shorter than MAX_NAME_LENGTH are cached.
+ */
+class epicsShareClass NameCache
+{
+public:
+    POINTER_DEFINITIONS(NameCache);
+
+    enum { MAX_NAME_LENGTH = 106 };
+
+    /**
+     * Open, or create, a cache file.
+     * @param path file name.
+     * @param nslots number of entries when creating a new file.  An existing file keeps its size.
+     * @return NULL if the file can't be mapped, or this target doesn't support memory mapped files.
+     */
+    static shared_pointer open(const std::string& path, size_t nslots);
+
+    ~NameCache();
+
+    /**
+     * Find the server last known to provide a channel.
+     * @return true if name was found, and addr and guid have been updated.
+     */
+    bool lookup(const std::string& name, osiSockAddr& addr, ServerGUID& guid);
+
+    /**
+     * Remember, or replace, the server providing a channel.
+     * An older entry may be evicted.
+     */
+    void store(const std::string& name, const osiSockAddr& addr, const ServerGUID& guid);
+
+    /**
+     * Forget one channel.
+     */
+    void remove(const std::string& name);
+
+    /**
+     * Forget all channels on a server address, unless they were stored with this GUID.
+     * Used when beacons show that the server has restarted.
+     * Only visits the entries of this server, through an index built when the file
+     * is opened and kept by store() and remove().  Entries stored later by other
+     * processes are not seen.
+     * @return The number of entries removed.
+     */
+    size_t invalidate(const osiSockAddr& addr, const ServerGUID& guid);
+
+    const std::string& getPath() const { return _path; }
+    size_t getSize() const { return _nslots; }
+
+private:
+    struct Header;
+    struct Slot;
+
+    NameCache(const std::string& path, void* base, size_t length);
+
+    Slot* find(const std::string& name, epicsUInt32 hash);
+
+    // slot numbers by server (address, port), both in network byte order
+    typedef std::pair<epicsUInt32, epicsUInt16> server_t;
+    typedef std::map<server_t, std::set<size_t> > index_t;
+    void indexAdd(const Slot* slot);
+    void indexRemove(const Slot* slot);
+
+    const std::string _path;
+    void* const _base;
+    const size_t _length;
+    Slot* const _slots;
+    const size_t _nslots;
+
+    epicsMutex _mutex;
+    index_t _index; // guarded by _mutex
+
+    NameCache(const NameCache&);
+    NameCache& operator=(const NameCache&);
+};
+
+}
+}
+
+#endif /* NAMECACHE_H */
@@ -32,6 +32,7 @@
 #include <pv/pvaConstants.h>
 #include <pv/configuration.h>
 #include <pv/fairQueue.h>
+#include <pv/timerWheel.h>
 #include <pv/pvaDefs.h>
 
 /// TODO only here because of the Lockable
@@ -82,6 +83,28 @@ enum QoS {
     QOS_GET_PUT = 0x80
 };
 
+/**
+ * Flags in the QoS of a client connection validation response.
+ * The low byte is the connection priority.
+ */
+enum ConnectionQoS {
+    /**
+     * Client accepts CMD_MULTIPLE_DATA with per sub-message sizes.
+     */
+    CONNECTION_QOS_MULTIPLE_DATA = 0x1000
+};
+
+/**
+ * Flags which a server may append after the Status of CMD_CONNECTION_VALIDATED.
+ * Older clients ignore these trailing bytes.
+ */
+enum ServerFeatures {
+    /**
+     * Server accepts CMD_MULTI_GET and CMD_MULTI_PUT.
+     */
+    SERVER_FEATURE_MULTI_REQUEST = 0x0001
+};
+
 enum ApplicationCommands {
     CMD_BEACON = 0,
     CMD_CONNECTION_VALIDATION = 1,
@@ -105,7 +128,24 @@ enum ApplicationCommands {
     CMD_MULTIPLE_DATA = 19,
     CMD_RPC = 20,
     CMD_CANCEL_REQUEST = 21,
-    CMD_ORIGIN_TAG = 22
+    CMD_ORIGIN_TAG = 22,
+    CMD_MULTI_GET = 23,
+    CMD_MULTI_PUT = 24
+};
+
+/**
+ * Classes of messages queued for sending on a transport.
+ */
+enum SendPriority {
+    /**
+     * Large payloads, eg. array data.  Sent after queued
+     * messages of other classes, with a share to avoid starvation.
+     */
+    SEND_PRIORITY_BULK = 0,
+    /**
+     * Default.  Small, latency sensitive messages.
+     */
+    SEND_PRIORITY_NORMAL = 1
 };
 
 enum ControlCommands {
@@ -149,6 +189,12 @@ public:
      * NOTE: these limitations allow efficient implementation.
      */
     virtual void send(epics::pvData::ByteBuffer* buffer, TransportSendControl* control) = 0;
+
+    /**
+     * Class of the message(s) which the next send() will send.
+     * Checked when queued.
+     */
+    virtual SendPriority getSendPriority() const { return SEND_PRIORITY_NORMAL; }
 };
 
 class ClientChannelImpl;
@@ -289,7 +335,7 @@ public:
 
     virtual ~Context() {}
 
-    virtual epics::pvData::Timer::shared_pointer getTimer() = 0;
+    virtual TimerWheel::shared_pointer getTimer() = 0;
 
     virtual TransportRegistry* getTransportRegistry() = 0;
 
@@ -298,6 +344,18 @@ public:
 
     virtual Configuration::const_shared_pointer getConfiguration() = 0;
 
+    /**
+     * Limit to which the send and receive buffers of a TCP connection may grow.
+     * The receive limit is advertised to the peer during connection validation.
+     */
+    virtual std::size_t getMaxBufferSize() { return MAX_TCP_BUFFER; }
+
+    //! Whether TCP connections should time each call to their ResponseHandler.
+    virtual bool isHandlerTimingEnabled() { return false; }
+
+    //! Called by a server TCP connection as it is closed.
+    virtual void transportClosed(Transport::shared_pointer const & /*transport*/) {}
+
     ///
     /// due to ClientContextImpl
     ///
@@ -290,7 +290,7 @@ public:
 private:
     typedef std::map<int, AuthorizationPlugin::shared_pointer> map_t;
     map_t map;
-    void *busy;
+    size_t busy; // number of run() in progress
     mutable epicsMutex mutex;
 public:
 
@@ -306,6 +306,60 @@ public:
 epicsShareFunc
 void osdGetRoles(const std::string &account, PeerInfo::roles_t& roles);
 
+/** @brief Cache of role/group names for user accounts.
+ *
+ * osdGetRoles() may involve network I/O (eg. LDAP or SSSD).
+ * Lookups are made by a worker thread, and the results kept for a time.
+ * An expired entry is used while a refresh is made in the background.
+ * get() for an account which is not cached waits for at most the timeout.
+ *
+ * The default AuthorizationPlugin uses instance().  When get() times out,
+ * that peer is authorized without roles for the lifetime of its connection.
+ * This is counted in Stats::timeouts.  The lookup continues, so later
+ * connections of the same account are given its roles.
+ */
+class epicsShareClass RolesCache
+{
+    EPICS_NOT_COPYABLE(RolesCache)
+public:
+    typedef void (*resolver_t)(const std::string &account, PeerInfo::roles_t& roles);
+
+    //! Cache used when authorizing peers of a server
+    static RolesCache& instance();
+
+    explicit RolesCache(resolver_t resolver = &osdGetRoles);
+    ~RolesCache();
+
+    /** Add role names of account to roles.
+     * @returns false if the timeout expired before the first lookup of this account completed.
+     *          roles is not changed in this case.
+     */
+    bool get(const std::string& account, PeerInfo::roles_t& roles);
+
+    //! Seconds after which an entry is refreshed.  Default 60.
+    void setTTL(double ttl);
+    //! Seconds get() waits for an account which is not cached.  Default 1.
+    void setTimeout(double timeout);
+    //! Change the lookup function, and clear()
+    void setResolver(resolver_t resolver);
+    //! Discard all entries.  Lookups in progress are discarded when complete.
+    void clear();
+
+    struct Stats {
+        size_t entries; //!< accounts cached
+        size_t hits;    //!< get() with an unexpired entry
+        size_t stale;   //!< get() with an expired entry
+        size_t misses;  //!< get() with no entry
+        size_t timeouts;//!< misses where the timeout expired, leaving the peer without roles
+        size_t lookups; //!< calls to the resolver
+    };
+    void stats(Stats& s) const;
+
+private:
+    struct Pvt;
+    std::tr1::shared_ptr<Pvt> pvt;
+};
+
 }
 }
 
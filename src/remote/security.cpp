@@ -4,9 +4,16 @@
 * in file LICENSE that is included with this distribution.
 */
 
+#include <map>
+#include <deque>
+#include <vector>
+#include <algorithm>
+
 #include <osiProcess.h>
 
 #include <epicsThread.h>
+#include <epicsEvent.h>
+#include <epicsTime.h>
 #include <epicsGuard.h>
 #include <pv/epicsException.h>
 #include <pv/reftrack.h>
@@ -15,6 +22,7 @@
 #include <pv/securityImpl.h>
 
 typedef epicsGuard<epicsMutex> Guard;
+typedef epicsGuardRelease<epicsMutex> UnGuard;
 
 namespace {
 namespace pvd = epics::pvData;
@@ -113,7 +121,11 @@ struct GroupsPlugin : public pva::AuthorizationPlugin
         if(!peer->identified)
             return; // no groups for anonymous
 
-        pva::osdGetRoles(peer->account, peer->roles);
+        // Not repeated when the lookup completes.  The roles of a peer
+        // may already be in use, eg. by access security.
+        if(!pva::RolesCache::instance().get(peer->account, peer->roles))
+            LOG(pva::logLevelWarn, "Timeout looking up roles of '%s' for %s.  Continuing without for this connection",
+                peer->account.c_str(), peer->peer.c_str());
     }
 };
 
@@ -246,7 +258,7 @@ AuthenticationPlugin::shared_pointer AuthenticationRegistry::lookup(const std::s
 
 
 AuthorizationRegistry::AuthorizationRegistry()
-    :busy(0)
+    :busy(0u)
 {}
 
 AuthorizationRegistry& AuthorizationRegistry::plugins()
@@ -283,22 +295,288 @@ bool AuthorizationRegistry::remove(const AuthorizationPlugin::shared_pointer& pl
 
 void AuthorizationRegistry::run(const std::tr1::shared_ptr<PeerInfo>& peer)
 {
-    int marker;
+    // peers of different connections may be authorized concurrently
     {
         Guard G(mutex);
-        if(busy)
-            throw std::runtime_error("AuthorizationRegistry busy");
-        busy = &marker;
+        busy++;
+    }
+    try {
+        for(map_t::iterator it(map.begin()), end(map.end()); it!=end; ++it)
+        {
+            (it->second)->authorize(peer);
+        }
+    }catch(...){
+        Guard G(mutex);
+        busy--;
+        throw;
     }
-    for(map_t::iterator it(map.begin()), end(map.end()); it!=end; ++it)
     {
-        (it->second)->authorize(peer);
+        Guard G(mutex);
+        assert(busy>0u);
+        busy--;
     }
+}
+
+/* Entries are looked up by one worker thread, in the order requested.
+ * This also serializes calls to the resolver, as getpwnam() and friends
+ * are not reentrant.
+ *
+ * The worker holds a reference to Pvt, so ~RolesCache() need not wait
+ * for a slow lookup to complete.
+ */
+struct RolesCache::Pvt {
+    mutable epicsMutex mutex;
+    epicsEvent wakeup;
+
+    resolver_t resolver;
+    double ttl, timeout;
+    // incremented by clear().  Lookups begun before are discarded.
+    size_t generation;
+    bool stopping;
+
+    struct Entry {
+        PeerInfo::roles_t roles;
+        epicsTime expires;
+        bool valid;  // roles have been looked up at least once
+        bool queued; // in 'pending', or being looked up
+        std::vector<epicsEvent*> waiters;
+        Entry() :valid(false), queued(false) {}
+    };
+    typedef std::map<std::string, Entry> entries_t;
+    entries_t entries;
+    std::deque<std::string> pending;
+
+    Stats counters;
+
+    Pvt(resolver_t resolver)
+        :resolver(resolver)
+        ,ttl(60.0)
+        ,timeout(1.0)
+        ,generation(0u)
+        ,stopping(false)
+    {
+        counters = Stats();
+    }
+
+    // caller must hold mutex
+    void request(const std::string& account, Entry& ent)
+    {
+        if(ent.queued)
+            return;
+        ent.queued = true;
+        pending.push_back(account);
+        if(pending.size()==1u)
+            wakeup.signal();
+    }
+
+    // caller must hold mutex
+    void wakeWaiters(Entry& ent)
+    {
+        for(size_t i=0; i<ent.waiters.size(); i++)
+            ent.waiters[i]->signal();
+        ent.waiters.clear();
+    }
+
+    // caller must hold mutex
+    void clear()
+    {
+        generation++;
+        for(entries_t::iterator it(entries.begin()), end(entries.end()); it!=end; ++it)
+            wakeWaiters(it->second);
+        entries.clear();
+        pending.clear();
+    }
+
+    // caller must hold mutex.  Forget unused accounts.
+    void prune(const epicsTime& now)
+    {
+        if(entries.size()<1024u)
+            return;
+        for(entries_t::iterator it(entries.begin()), end(entries.end()); it!=end;) {
+            entries_t::iterator cur(it++);
+            if(cur->second.valid && !cur->second.queued && cur->second.expires < now)
+                entries.erase(cur);
+        }
+    }
+
+    static void worker(void *raw)
+    {
+        std::tr1::shared_ptr<Pvt> self;
+        {
+            std::tr1::shared_ptr<Pvt> *temp = static_cast<std::tr1::shared_ptr<Pvt>*>(raw);
+            self.swap(*temp);
+            delete temp;
+        }
+        self->run();
+    }
+
+    void run()
     {
         Guard G(mutex);
-        assert(busy==&marker);
-        busy = 0;
+        while(!stopping) {
+            if(pending.empty()) {
+                UnGuard U(G);
+                wakeup.wait();
+                continue;
+            }
+
+            std::string account(pending.front());
+            pending.pop_front();
+
+            const size_t gen = generation;
+            resolver_t fn = resolver;
+            counters.lookups++;
+
+            PeerInfo::roles_t roles;
+            {
+                UnGuard U(G);
+                try {
+                    (*fn)(account, roles);
+                }catch(std::exception& e){
+                    LOG(logLevelError, "Unhandled exception looking up roles of '%s' : %s", account.c_str(), e.what());
+                    roles.clear();
+                }
+            }
+
+            if(gen!=generation)
+                continue; // cleared, and maybe re-queued, while we were busy
+
+            entries_t::iterator it(entries.find(account));
+            if(it==entries.end())
+                continue;
+
+            Entry& ent = it->second;
+            ent.roles.swap(roles);
+            ent.expires = epicsTime::getCurrent() + ttl;
+            ent.valid = true;
+            ent.queued = false;
+            wakeWaiters(ent);
+        }
     }
+};
+
+namespace {
+RolesCache *rolesCache;
+epicsThreadOnceId rolesCacheOnce = EPICS_THREAD_ONCE_INIT;
+
+void rolesCacheInit(void *)
+{
+    rolesCache = new RolesCache;
+}
+} // namespace
+
+RolesCache& RolesCache::instance()
+{
+    epicsThreadOnce(&rolesCacheOnce, &rolesCacheInit, 0);
+    return *rolesCache;
+}
+
+RolesCache::RolesCache(resolver_t resolver)
+    :pvt(new Pvt(resolver))
+{
+    std::tr1::shared_ptr<Pvt> *arg = new std::tr1::shared_ptr<Pvt>(pvt);
+    if(!epicsThreadCreate("pvaRoles", epicsThreadPriorityMedium,
+                          epicsThreadGetStackSize(epicsThreadStackSmall),
+                          &Pvt::worker, arg))
+    {
+        delete arg;
+        throw std::runtime_error("Unable to start roles lookup worker");
+    }
+}
+
+RolesCache::~RolesCache()
+{
+    {
+        Guard G(pvt->mutex);
+        pvt->stopping = true;
+        pvt->clear();
+    }
+    pvt->wakeup.signal();
+}
+
+bool RolesCache::get(const std::string& account, PeerInfo::roles_t& roles)
+{
+    Pvt& P = *pvt;
+    Guard G(P.mutex);
+    const epicsTime now(epicsTime::getCurrent());
+
+    Pvt::entries_t::iterator it(P.entries.find(account));
+    if(it!=P.entries.end() && it->second.valid) {
+        Pvt::Entry& ent = it->second;
+        if(ent.expires < now) {
+            // use what we have while refreshing
+            P.counters.stale++;
+            P.request(account, ent);
+        } else {
+            P.counters.hits++;
+        }
+        roles.insert(ent.roles.begin(), ent.roles.end());
+        return true;
+    }
+
+    P.counters.misses++;
+    if(it==P.entries.end()) {
+        P.prune(now);
+        it = P.entries.insert(std::make_pair(account, Pvt::Entry())).first;
+    }
+    P.request(account, it->second);
+
+    epicsEvent done;
+    it->second.waiters.push_back(&done);
+    const double timeout = P.timeout;
+    {
+        UnGuard U(G);
+        done.wait(timeout);
+    }
+
+    // entries may have been cleared while unlocked
+    it = P.entries.find(account);
+    if(it!=P.entries.end()) {
+        Pvt::Entry& ent = it->second;
+        std::vector<epicsEvent*>::iterator W(std::find(ent.waiters.begin(), ent.waiters.end(), &done));
+        if(W!=ent.waiters.end())
+            ent.waiters.erase(W);
+        if(ent.valid) {
+            roles.insert(ent.roles.begin(), ent.roles.end());
+            return true;
+        }
+    }
+    P.counters.timeouts++;
+    return false;
+}
+
+void RolesCache::setTTL(double ttl)
+{
+    Guard G(pvt->mutex);
+    pvt->ttl = ttl;
+}
+
+void RolesCache::setTimeout(double timeout)
+{
+    Guard G(pvt->mutex);
+    pvt->timeout = timeout;
+}
+
+void RolesCache::setResolver(resolver_t resolver)
+{
+    {
+        Guard G(pvt->mutex);
+        pvt->resolver = resolver;
+    }
+    clear();
+}
+
+void RolesCache::clear()
+{
+    Guard G(pvt->mutex);
+    pvt->clear();
+}
+
+void RolesCache::stats(Stats& s) const
+{
+    Guard G(pvt->mutex);
+    s = pvt->counters;
+    s.entries = pvt->entries.size();
 }
 
 void AuthNZHandler::handleResponse(osiSockAddr* responseFrom,
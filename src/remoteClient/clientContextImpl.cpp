@@ -4,15 +4,21 @@
  * in file LICENSE that is included with this distribution.
  */
 
+#include <algorithm>
+#include <cmath>
+#include <deque>
 #include <iostream>
 #include <sstream>
 #include <memory>
 #include <queue>
+#include <set>
 #include <stdexcept>
 
 #include <osiSock.h>
 #include <epicsGuard.h>
 #include <epicsAssert.h>
+#include <epicsTime.h>
+#include <epicsThread.h>
 
 #include <pv/lock.h>
 #include <pv/timer.h>
@@ -35,8 +41,10 @@
 #include <pv/clientContextImpl.h>
 #include <pv/configuration.h>
 #include <pv/beaconHandler.h>
+#include <pv/nameCache.h>
 #include <pv/logger.h>
 #include <pv/securityImpl.h>
+#include <pv/ringBuffer.h>
 
 #include <pv/pvAccessMB.h>
 
@@ -56,6 +64,64 @@ Status ClientChannelImpl::channelDestroyed(
 Status ClientChannelImpl::channelDisconnected(
     Status::STATUSTYPE_WARNING, "channel disconnected");
 
+ClientChannelStats::ClientChannelStats()
+    :nintervals(0u)
+    ,intervalMean(0.0)
+    ,intervalM2(0.0)
+{
+    stats.enabled = true;
+}
+
+void ClientChannelStats::response(bool put,
+                                  const epicsTimeStamp& sent,
+                                  const epicsTimeStamp& received,
+                                  const epicsTimeStamp& decoded)
+{
+    const double latency = epicsTimeDiffInSeconds(&received, &sent),
+                 decode = epicsTimeDiffInSeconds(&decoded, &received);
+    epicsGuard<epicsMutex> G(mutex);
+    (put ? stats.putLatency : stats.getLatency).add(latency);
+    stats.decode.add(decode);
+}
+
+void ClientChannelStats::update(const epicsTimeStamp* previous,
+                                const epicsTimeStamp& received,
+                                const epicsTimeStamp& decoded)
+{
+    const double decode = epicsTimeDiffInSeconds(&decoded, &received);
+    const double interval = previous ? epicsTimeDiffInSeconds(&received, previous) : 0.0;
+    epicsGuard<epicsMutex> G(mutex);
+    stats.nupdates++;
+    stats.decode.add(decode);
+    if(previous) {
+        // Welford's method
+        nintervals++;
+        const double delta = interval - intervalMean;
+        intervalMean += delta/nintervals;
+        intervalM2 += delta*(interval - intervalMean);
+    }
+}
+
+void ClientChannelStats::received(size_t nbytes)
+{
+    epicsGuard<epicsMutex> G(mutex);
+    stats.nrxBytes += nbytes;
+}
+
+void ClientChannelStats::overrun()
+{
+    epicsGuard<epicsMutex> G(mutex);
+    stats.noverrun++;
+}
+
+void ClientChannelStats::get(Channel::Stats& s) const
+{
+    epicsGuard<epicsMutex> G(mutex);
+    s = stats;
+    s.updatePeriod = intervalMean;
+    s.updateJitter = nintervals>1u ? std::sqrt(intervalM2/(nintervals-1u)) : 0.0;
+}
+
 }}
 namespace {
 using namespace epics::pvAccess;
@@ -137,6 +203,11 @@ protected:
     // const after activate()
     pvAccessID m_ioid;
 
+    // NULL unless $EPICS_PVA_CLIENT_STATS
+    ClientChannelStats* const m_stats;
+    // when the last request was sent, and the last reply received
+    epicsTimeStamp m_sent, m_received;
+
 private:
     // holds: NULL_REQUEST, PURE_DESTROY_REQUEST, PURE_CANCEL_REQUEST, or
     // a mask of QOS_*
@@ -205,11 +276,14 @@ protected:
     BaseRequestImpl(ClientChannelImpl::shared_pointer const & channel) :
         m_channel(channel),
         m_ioid(INVALID_IOID),
+        m_stats(channel->getStatsCollector()),
         m_pendingRequest(NULL_REQUEST),
         m_destroyed(false),
         m_initialized(false),
         m_subscribed()
     {
+        m_sent.secPastEpoch = m_sent.nsec = 0u;
+        m_received = m_sent;
         REFTRACE_INCREMENT(num_instances);
     }
 
@@ -253,12 +327,35 @@ protected:
         m_pendingRequest = NULL_REQUEST;
     }
 
+    // call from send()
+    void requestSent() {
+        if (m_stats)
+            epicsTimeGetCurrent(&m_sent);
+    }
+
+    // call from normalResponse() once deserialized
+    void responseDecoded(bool put) {
+        if (m_stats) {
+            epicsTimeStamp now;
+            epicsTimeGetCurrent(&now);
+            m_stats->response(put, m_sent, m_received, now);
+        }
+    }
+
 public:
 
     pvAccessID getIOID() const OVERRIDE FINAL {
         return m_ioid;
     }
 
+    // payload size of a reply, before response()
+    void received(size_t nbytes) {
+        if (m_stats) {
+            epicsTimeGetCurrent(&m_received);
+            m_stats->received(nbytes);
+        }
+    }
+
     virtual void initResponse(Transport::shared_pointer const & transport, int8 version, ByteBuffer* payloadBuffer, int8 qos, const Status& status) = 0;
     virtual void normalResponse(Transport::shared_pointer const & transport, int8 version, ByteBuffer* payloadBuffer, int8 qos, const Status& status) = 0;
 
@@ -612,6 +709,7 @@ public:
         buffer->putInt(m_channel->getServerChannelID());
         buffer->putInt(m_ioid);
         buffer->putByte((int8)pendingRequest);
+        requestSent();
 
         if (initStage)
         {
@@ -652,6 +750,7 @@ public:
             m_bitSet->deserialize(payloadBuffer, transport.get());
             m_structure->deserialize(payloadBuffer, transport.get(), m_bitSet.get());
         }
+        responseDecoded(false);
 
         EXCEPTION_GUARD3(m_callback, cb, cb->getDone(status, external_from_this<ChannelGetImpl>(), m_structure, m_bitSet));
     }
@@ -750,12 +849,47 @@ public:
 
     Mutex m_structureMutex;
 
+    // pipeline=true options
+    bool m_pipeline;
+    int32 m_queueSize;
+
+    // guarded by m_mutex
+    // window accepted by the server, 1 unless pipelined
+    size_t m_window;
+    // puts sent, or waiting to be sent, without a reply
+    size_t m_putsInFlight;
+    struct PipelinedPut {
+        PVStructure::shared_pointer value;
+        BitSet::shared_pointer changed;
+        int8 qos;
+        PipelinedPut() :qos(0) {}
+    };
+    // copies waiting to be sent
+    std::deque<PipelinedPut> m_putQueue;
+    // containers for re-use
+    std::vector<PipelinedPut> m_putFree;
+    // when each put without a reply was sent.  Only with m_stats
+    std::deque<epicsTimeStamp> m_putSent;
+
+    // call with m_mutex locked
+    void putSent() {
+        if (m_stats) {
+            epicsTimeStamp now;
+            epicsTimeGetCurrent(&now);
+            m_putSent.push_back(now);
+        }
+    }
+
     ChannelPutImpl(ClientChannelImpl::shared_pointer const & channel,
                    ChannelPutRequester::shared_pointer const & requester,
                    PVStructure::shared_pointer const & pvRequest) :
         BaseRequestImpl(channel),
         m_callback(requester),
-        m_pvRequest(pvRequest)
+        m_pvRequest(pvRequest),
+        m_pipeline(false),
+        m_queueSize(4),
+        m_window(1u),
+        m_putsInFlight(0u)
     {
     }
 
@@ -767,6 +901,30 @@ public:
             return;
         }
 
+        PVStructurePtr pvOptions = m_pvRequest->getSubField<PVStructure>("record._options");
+        if (pvOptions) {
+            PVScalarPtr option(pvOptions->getSubField<PVScalar>("pipeline"));
+            if (option) {
+                try {
+                    m_pipeline = option->getAs<epics::pvData::boolean>();
+                }catch(std::runtime_error& e){
+                    SEND_MESSAGE(m_callback, cb, "Invalid pipeline=", warningMessage);
+                }
+            }
+
+            // number of puts in flight
+            option = pvOptions->getSubField<PVScalar>("queueSize");
+            if (m_pipeline && option) {
+                try {
+                    m_queueSize = option->getAs<int32>();
+                    if(m_queueSize<1)
+                        m_queueSize = 1;
+                }catch(std::runtime_error& e){
+                    SEND_MESSAGE(m_callback, cb, "Invalid queueSize=", warningMessage);
+                }
+            }
+        }
+
         BaseRequestImpl::activate();
 
         // TODO low-overhead put
@@ -788,7 +946,31 @@ public:
 
     virtual void send(ByteBuffer* buffer, TransportSendControl* control) OVERRIDE FINAL {
         int32 pendingRequest = beginRequest();
-        if (pendingRequest < 0)
+        if (pendingRequest == NULL_REQUEST)
+        {
+            // each pipelined put has its own enqueueSendRequest()
+            PipelinedPut next;
+            {
+                Lock guard(m_mutex);
+                if (m_putQueue.empty())
+                    return;
+                next = m_putQueue.front();
+                m_putQueue.pop_front();
+            }
+
+            control->startMessage((int8)CMD_PUT, 9);
+            buffer->putInt(m_channel->getServerChannelID());
+            buffer->putInt(m_ioid);
+            buffer->putByte(next.qos);
+            next.changed->serialize(buffer, control);
+            next.value->serialize(buffer, control, next.changed.get());
+
+            Lock guard(m_mutex);
+            m_putFree.push_back(next);
+            putSent();
+            return;
+        }
+        else if (pendingRequest < 0)
         {
             base_send(buffer, control, pendingRequest);
             return;
@@ -814,6 +996,12 @@ public:
                 m_bitSet->serialize(buffer, control);
                 m_structure->serialize(buffer, control, m_bitSet.get());
             }
+            Lock guard(m_mutex);
+            putSent();
+        }
+        else
+        {
+            requestSent();
         }
     }
 
@@ -831,6 +1019,34 @@ public:
             m_bitSet = createBitSetFor(m_structure, m_bitSet);
         }
 
+        // a server which accepts pipeline=true replies with its window.
+        // otherwise one put at a time.
+        size_t window = 1u;
+        if (m_pipeline && payloadBuffer->getRemaining()>=4) {
+            int32 accepted = payloadBuffer->getInt();
+            if (accepted>1)
+                window = std::min(accepted, m_queueSize);
+        }
+
+        size_t dropped;
+        {
+            Lock guard(m_mutex);
+            m_window = window;
+            // after (re)connect, replies to earlier puts will not arrive
+            dropped = m_putsInFlight;
+            m_putsInFlight = 0u;
+            m_putQueue.clear();
+            m_putFree.clear();
+            m_putSent.clear();
+        }
+
+        // each put gets exactly one putDone()
+        if (dropped) {
+            ChannelPut::shared_pointer thisPtr(external_from_this<ChannelPutImpl>());
+            for (size_t i = 0; i < dropped; i++)
+                EXCEPTION_GUARD3(m_callback, cb, cb->putDone(ClientChannelImpl::channelDisconnected, thisPtr));
+        }
+
         // notify
         EXCEPTION_GUARD3(m_callback, cb, cb->channelPutConnect(status, external_from_this<ChannelPutImpl>(), m_structure->getStructure()));
     }
@@ -852,11 +1068,23 @@ public:
                 m_bitSet->deserialize(payloadBuffer, transport.get());
                 m_structure->deserialize(payloadBuffer, transport.get(), m_bitSet.get());
             }
+            responseDecoded(false);
 
             EXCEPTION_GUARD3(m_callback, cb, cb->getDone(status, thisPtr, m_structure, m_bitSet));
         }
         else
         {
+            {
+                Lock guard(m_mutex);
+                if (m_putsInFlight)
+                    m_putsInFlight--;
+                // replies arrive in the order sent
+                if (!m_putSent.empty()) {
+                    m_sent = m_putSent.front();
+                    m_putSent.pop_front();
+                    responseDecoded(true);
+                }
+            }
             EXCEPTION_GUARD3(m_callback, cb, cb->putDone(status, thisPtr));
         }
     }
@@ -875,6 +1103,10 @@ public:
                 EXCEPTION_GUARD3(m_callback, cb, cb->getDone(notInitializedStatus, thisPtr, PVStructurePtr(), BitSetPtr()));
                 return;
             }
+            if (m_putsInFlight) {
+                EXCEPTION_GUARD3(m_callback, cb, cb->getDone(otherRequestPendingStatus, thisPtr, PVStructurePtr(), BitSetPtr()));
+                return;
+            }
         }
 
         if (!startRequest(m_lastRequest.get() ? QOS_GET | QOS_DESTROY : QOS_GET)) {
@@ -920,6 +1152,9 @@ public:
             return;
         }
 
+        if (putPipelined(pvPutStructure, pvPutBitSet))
+            return;
+
         if (!startRequest(m_lastRequest.get() ? QOS_DESTROY : QOS_DEFAULT)) {
             EXCEPTION_GUARD3(m_callback, cb, cb->putDone(otherRequestPendingStatus, thisPtr));
             return;
@@ -938,6 +1173,59 @@ public:
         }
     }
 
+    // with a window >1, copy into the queue instead of m_structure.
+    // returns false to fall back to a single put.
+    bool putPipelined(PVStructure::shared_pointer const & pvPutStructure, BitSet::shared_pointer const & pvPutBitSet)
+    {
+        ChannelPut::shared_pointer thisPtr(external_from_this<ChannelPutImpl>());
+
+        bool full;
+        {
+            Lock guard(m_mutex);
+            if (m_window<=1u)
+                return false;
+
+            full = m_putsInFlight>=m_window;
+            if (!full) {
+                PipelinedPut put;
+                if (!m_putFree.empty()) {
+                    put = m_putFree.back();
+                    m_putFree.pop_back();
+                } else {
+                    put.value = pvDataCreate->createPVStructure(m_structure->getStructure());
+                    put.changed.reset(new BitSet(put.value->getNumberFields()));
+                }
+                *put.changed = *pvPutBitSet;
+                put.value->copyUnchecked(*pvPutStructure, *put.changed);
+                put.qos = m_lastRequest.get() ? QOS_DESTROY : QOS_DEFAULT;
+
+                m_putQueue.push_back(put);
+                m_putsInFlight++;
+            }
+        }
+
+        if (full) {
+            EXCEPTION_GUARD3(m_callback, cb, cb->putDone(otherRequestPendingStatus, thisPtr));
+            return true;
+        }
+
+        try {
+            m_channel->checkAndGetTransport()->enqueueSendRequest(internal_from_this<ChannelPutImpl>());
+        } catch (std::runtime_error &rte) {
+            {
+                Lock guard(m_mutex);
+                if (!m_putQueue.empty()) {
+                    m_putFree.push_back(m_putQueue.back());
+                    m_putQueue.pop_back();
+                }
+                if (m_putsInFlight)
+                    m_putsInFlight--;
+            }
+            EXCEPTION_GUARD3(m_callback, cb, cb->putDone(channelNotConnected, thisPtr));
+        }
+        return true;
+    }
+
     virtual Channel::shared_pointer getChannel() OVERRIDE FINAL
     {
         return BaseRequestImpl::getChannel();
@@ -1814,7 +2102,121 @@ public:
 };
 
 typedef vector<MonitorElement::shared_pointer> FreeElementQueue;
-typedef queue<MonitorElement::shared_pointer> MonitorElementQueue;
+typedef ring_buffer<MonitorElement::shared_pointer> MonitorElementQueue;
+
+/* Array storage is reference counted (shared_vector), and copyUnchecked()
+ * shares it.  So a queued element shares the arrays which did not change
+ * with the element before it.  Deserializing into a shared array copies it
+ * first (copy on write), which we avoid by dropping our reference
+ * to storage which is about to be overwritten anyway.
+ */
+
+// drop references to array storage held by an unused element.
+static void releaseArrays(PVField& field)
+{
+    switch(field.getField()->getType()) {
+    case scalarArray: {
+        PVScalarArray& arr = static_cast<PVScalarArray&>(field);
+        if(arr.getScalarArray()->getArraySizeType()==Array::fixed)
+            break;
+        // keeps the element type
+        shared_vector<const void> empty;
+        arr.getAs(empty);
+        if(!empty.empty()) {
+            empty.clear();
+            arr.putFrom(empty);
+        }
+    }
+        break;
+    case structure: {
+        const PVFieldPtrArray& fields = static_cast<PVStructure&>(field).getPVFields();
+        for(size_t i=0, N=fields.size(); i<N; i++)
+            releaseArrays(*fields[i]);
+    }
+        break;
+    case union_: {
+        PVField::shared_pointer value(static_cast<PVUnion&>(field).get());
+        if(value)
+            releaseArrays(*value);
+    }
+        break;
+    case structureArray: {
+        PVStructureArray& arr = static_cast<PVStructureArray&>(field);
+        if(arr.getStructureArray()->getArraySizeType()!=Array::fixed && arr.getLength())
+            arr.replace(PVStructureArray::const_svector());
+    }
+        break;
+    case unionArray: {
+        PVUnionArray& arr = static_cast<PVUnionArray&>(field);
+        if(arr.getUnionArray()->getArraySizeType()!=Array::fixed && arr.getLength())
+            arr.replace(PVUnionArray::const_svector());
+    }
+        break;
+    default:
+        break;
+    }
+}
+
+typedef std::set<const void*> storage_t;
+
+// bytes of array storage not already counted in 'seen'.
+static size_t arrayBytes(const PVField& field, storage_t& seen)
+{
+    size_t nbytes = 0u;
+    switch(field.getField()->getType()) {
+    case scalarArray: {
+        shared_vector<const void> view;
+        static_cast<const PVScalarArray&>(field).getAs(view);
+        if(!view.empty() && seen.insert(view.data()).second)
+            nbytes += view.size(); // in bytes
+    }
+        break;
+    case structure: {
+        const PVFieldPtrArray& fields = static_cast<const PVStructure&>(field).getPVFields();
+        for(size_t i=0, N=fields.size(); i<N; i++)
+            nbytes += arrayBytes(*fields[i], seen);
+    }
+        break;
+    case union_: {
+        PVField::const_shared_pointer value(static_cast<const PVUnion&>(field).get());
+        if(value)
+            nbytes += arrayBytes(*value, seen);
+    }
+        break;
+    case structureArray: {
+        PVStructureArray::const_svector view(static_cast<const PVStructureArray&>(field).view());
+        if(!view.empty() && seen.insert(view.data()).second) {
+            nbytes += view.size()*sizeof(view[0]);
+            for(size_t i=0, N=view.size(); i<N; i++)
+                if(view[i])
+                    nbytes += arrayBytes(*view[i], seen);
+        }
+    }
+        break;
+    case unionArray: {
+        PVUnionArray::const_svector view(static_cast<const PVUnionArray&>(field).view());
+        if(!view.empty() && seen.insert(view.data()).second) {
+            nbytes += view.size()*sizeof(view[0]);
+            for(size_t i=0, N=view.size(); i<N; i++)
+                if(view[i])
+                    nbytes += arrayBytes(*view[i], seen);
+        }
+    }
+        break;
+    default:
+        break;
+    }
+    return nbytes;
+}
+
+static size_t arrayBytes(const FreeElementQueue& elements)
+{
+    storage_t seen;
+    size_t nbytes = 0u;
+    for(size_t i=0, N=elements.size(); i<N; i++)
+        nbytes += arrayBytes(*elements[i]->pvStructurePtr, seen);
+    return nbytes;
+}
 
 
 class MonitorStrategyQueue :
@@ -1829,16 +2231,21 @@ private:
     StructureConstPtr m_lastStructure;
     FreeElementQueue m_freeQueue;
     MonitorElementQueue m_monitorQueue;
+    // every element, including the spare and those held by the consumer
+    FreeElementQueue m_elements;
 
 
     const MonitorRequester::weak_pointer m_callback;
 
-    Mutex m_mutex;
+    mutable Mutex m_mutex;
 
     BitSet m_bitSet1;
     BitSet m_bitSet2;
+    // spare element, not counted in m_queueSize.
+    // filled only when all other elements are held by the consumer.
     MonitorElement::shared_pointer m_overrunElement;
     bool m_overrunInProgress;
+    size_t m_noverrun;
 
     PVStructure::shared_pointer m_up2datePVStructure;
 
@@ -1848,10 +2255,23 @@ private:
     // TODO check for cyclic-ref
     const ClientChannelImpl::shared_pointer m_channel;
     const pvAccessID m_ioid;
+    ClientChannelStats* const m_stats;
 
     const bool m_pipeline;
     const int32 m_ackAny;
 
+    // when adaptive, measure the rate at which the consumer drains
+    // the queue, and report this with each ack.
+    const bool m_adaptive;
+    // time of the last release()
+    epicsTimeStamp m_lastRelease;
+    // was the queue non-empty at the last release()
+    bool m_backlogged;
+    // average interval between release() while backlogged
+    double m_serviceTime;
+    // # of backlogged intervals since the last ack
+    size_t m_serviceSamples;
+
     bool m_unlisten;
 
 public:
@@ -1859,24 +2279,31 @@ public:
     MonitorStrategyQueue(ClientChannelImpl::shared_pointer channel, pvAccessID ioid,
                          MonitorRequester::weak_pointer const & callback,
                          int32 queueSize,
-                         bool pipeline, int32 ackAny) :
+                         bool pipeline, int32 ackAny, bool adaptive) :
         m_queueSize(queueSize), m_lastStructure(),
         m_freeQueue(),
         m_monitorQueue(),
         m_callback(callback), m_mutex(),
         m_bitSet1(), m_bitSet2(), m_overrunInProgress(false),
+        m_noverrun(0u),
         m_releasedCount(0),
         m_reportQueueStateInProgress(false),
         m_channel(channel), m_ioid(ioid),
+        m_stats(channel->getStatsCollector()),
         m_pipeline(pipeline), m_ackAny(ackAny),
+        m_adaptive(adaptive),
+        m_backlogged(false),
+        m_serviceTime(0.0),
+        m_serviceSamples(0u),
         m_unlisten(false)
     {
+        m_lastRelease.secPastEpoch = m_lastRelease.nsec = 0u;
         if (queueSize <= 1)
             throw std::invalid_argument("queueSize <= 1");
 
         m_freeQueue.reserve(m_queueSize);
-        // TODO array based deque
-        //m_monitorQueue.reserve(m_queueSize);
+        // all elements, including the spare, may be queued at once
+        m_monitorQueue.reset(m_queueSize + 1);
     }
 
     virtual ~MonitorStrategyQueue() {}
@@ -1888,8 +2315,7 @@ public:
         m_reportQueueStateInProgress = false;
 
         {
-            while (!m_monitorQueue.empty())
-                m_monitorQueue.pop();
+            m_monitorQueue.clear();
 
             m_freeQueue.clear();
 
@@ -1902,10 +2328,38 @@ public:
                 m_freeQueue.push_back(monitorElement);
             }
 
+            m_overrunElement.reset(new MonitorElement(getPVDataCreate()->createPVStructure(structure)));
+            m_overrunInProgress = false;
+
+            m_elements = m_freeQueue;
+            m_elements.push_back(m_overrunElement);
+
             m_lastStructure = structure;
         }
     }
 
+    // merge an update into an element which has already been filled.
+    // call with m_mutex locked
+    void squash(MonitorElement& element, Transport::shared_pointer const & transport, ByteBuffer* payloadBuffer)
+    {
+        m_bitSet1.deserialize(payloadBuffer, transport.get());
+        element.pvStructurePtr->deserialize(payloadBuffer, transport.get(), &m_bitSet1);
+        m_bitSet2.deserialize(payloadBuffer, transport.get());
+
+        // OR local overrun
+        element.overrunBitSet->or_and(*element.changedBitSet, m_bitSet1);
+
+        // OR remote change
+        *element.changedBitSet |= m_bitSet1;
+
+        // OR remote overrun
+        *element.overrunBitSet |= m_bitSet2;
+
+        m_noverrun++;
+        if (m_stats)
+            m_stats->overrun();
+    }
+
 
     virtual void response(Transport::shared_pointer const & transport, ByteBuffer* payloadBuffer) OVERRIDE FINAL {
 
@@ -1915,37 +2369,29 @@ public:
 
             if (m_overrunInProgress)
             {
-                PVStructurePtr pvStructure = m_overrunElement->pvStructurePtr;
-                BitSet::shared_pointer changedBitSet = m_overrunElement->changedBitSet;
-                BitSet::shared_pointer overrunBitSet = m_overrunElement->overrunBitSet;
-
-                m_bitSet1.deserialize(payloadBuffer, transport.get());
-                pvStructure->deserialize(payloadBuffer, transport.get(), &m_bitSet1);
-                m_bitSet2.deserialize(payloadBuffer, transport.get());
-
-                // OR local overrun
-                // TODO this does not work perfectly if bitSet is compressed !!!
-                // uncompressed bitSets should be used !!!
-                overrunBitSet->or_and(*(changedBitSet.get()), m_bitSet1);
-
-                // OR remove change
-                *(changedBitSet.get()) |= m_bitSet1;
-
-                // OR remote overrun
-                *(overrunBitSet.get()) |= m_bitSet2;
-
+                // consumer holds all other elements
                 // m_up2datePVStructure is already set
+                squash(*m_overrunElement, transport, payloadBuffer);
+                return;
 
+            } else if (m_freeQueue.empty() && !m_monitorQueue.empty()) {
+                // queue full.  merge into the newest queued element,
+                // which is also m_up2datePVStructure.
+                squash(*m_monitorQueue.back(), transport, payloadBuffer);
                 return;
             }
 
-            MonitorElementPtr newElement = m_freeQueue.back();
-            m_freeQueue.pop_back();
-
-            if (m_freeQueue.empty())
+            MonitorElementPtr newElement;
+            if (!m_freeQueue.empty())
+            {
+                newElement = m_freeQueue.back();
+                m_freeQueue.pop_back();
+            }
+            else
             {
+                // nothing free or queued.  fill the spare until the next release()
                 m_overrunInProgress = true;
-                m_overrunElement = newElement;
+                newElement = m_overrunElement;
             }
 
             // setup current fields
@@ -1957,6 +2403,8 @@ public:
             changedBitSet->deserialize(payloadBuffer, transport.get());
             if (m_up2datePVStructure && m_up2datePVStructure.get() != pvStructure.get()) {
                 assert(pvStructure->getStructure().get()==m_up2datePVStructure->getStructure().get());
+                // unchanged arrays are shared with the previous update, changed arrays are re-allocated
+                releaseArrays(*pvStructure);
                 pvStructure->copyUnchecked(*m_up2datePVStructure, *changedBitSet, true);
             }
             pvStructure->deserialize(payloadBuffer, transport.get(), changedBitSet.get());
@@ -1964,14 +2412,13 @@ public:
 
             m_up2datePVStructure = pvStructure;
 
-            if (!m_overrunInProgress)
-                m_monitorQueue.push(newElement);
-        }
+            if (m_overrunInProgress)
+                return;
 
-        if (!m_overrunInProgress)
-        {
-            EXCEPTION_GUARD3(m_callback, cb, cb->monitorEvent(shared_from_this()));
+            m_monitorQueue.push_back(newElement);
         }
+
+        EXCEPTION_GUARD3(m_callback, cb, cb->monitorEvent(shared_from_this()));
     }
 
     virtual void unlisten() OVERRIDE FINAL
@@ -2003,7 +2450,7 @@ public:
         }
 
         MonitorElement::shared_pointer retVal(m_monitorQueue.front());
-        m_monitorQueue.pop();
+        m_monitorQueue.pop_front();
         return retVal;
     }
 
@@ -2020,25 +2467,48 @@ public:
         {
             Lock guard(m_mutex);
 
-            m_freeQueue.push_back(monitorElement);
-
             if (m_overrunInProgress)
             {
-                // compress bit-set
-                PVStructurePtr pvStructure = m_overrunElement->pvStructurePtr;
-                BitSetUtil::compress(m_overrunElement->changedBitSet, pvStructure);
-                BitSetUtil::compress(m_overrunElement->overrunBitSet, pvStructure);
-
-                m_monitorQueue.push(m_overrunElement);
+                // queue the spare, and the released element becomes the new spare
+                m_monitorQueue.push_back(m_overrunElement);
 
-                m_overrunElement.reset();
+                m_overrunElement = monitorElement;
                 m_overrunInProgress = false;
             }
+            else
+            {
+                m_freeQueue.push_back(monitorElement);
+            }
+
+            // don't keep arrays which the next update will replace, or share
+            if (monitorElement->pvStructurePtr != m_up2datePVStructure)
+                releaseArrays(*monitorElement->pvStructurePtr);
+
+            // caught up with the server
+            bool drained = m_monitorQueue.empty();
+
+            if (m_adaptive)
+            {
+                epicsTimeStamp now;
+                epicsTimeGetCurrent(&now);
+                // the consumer went directly from the previous element to this one
+                if (m_backlogged)
+                {
+                    double interval = epicsTimeDiffInSeconds(&now, &m_lastRelease);
+                    m_serviceTime = m_serviceSamples ? 0.75*m_serviceTime + 0.25*interval : interval;
+                    m_serviceSamples++;
+                }
+                m_backlogged = !drained;
+                m_lastRelease = now;
+            }
 
             if (m_pipeline)
             {
                 m_releasedCount++;
-                if (!m_reportQueueStateInProgress && m_releasedCount >= m_ackAny)
+                // an adaptive server may hold back updates until everything sent is acked,
+                // so also ack when drained.
+                if (!m_reportQueueStateInProgress &&
+                        (m_releasedCount >= m_ackAny || (m_adaptive && drained)))
                 {
                     sendAck = true;
                     m_reportQueueStateInProgress = true;
@@ -2076,6 +2546,18 @@ public:
             buffer->putInt(m_releasedCount);
             m_releasedCount = 0;
             m_reportQueueStateInProgress = false;
+
+            if (m_adaptive)
+            {
+                // drain rate in updates per second, or zero if keeping up.
+                // ignored by older servers.
+                float rate = 0.0f;
+                if (m_serviceSamples && m_serviceTime > 0.0)
+                    rate = float(1.0 / m_serviceTime);
+                m_serviceSamples = 0u;
+                control->ensureBuffer(4);
+                buffer->putFloat(rate);
+            }
         }
 
         // immediate send
@@ -2087,13 +2569,9 @@ public:
         while (!m_monitorQueue.empty())
         {
             m_freeQueue.push_back(m_monitorQueue.front());
-            m_monitorQueue.pop();
-        }
-        if (m_overrunElement)
-        {
-            m_freeQueue.push_back(m_overrunElement);
-            m_overrunElement.reset();
+            m_monitorQueue.pop_front();
         }
+        // any content of the spare is discarded
         m_overrunInProgress = false;
         return Status::Ok;
     }
@@ -2105,6 +2583,16 @@ public:
     void destroy() OVERRIDE FINAL {
     }
 
+    virtual void getStats(Stats& s) const OVERRIDE FINAL
+    {
+        Lock guard(m_mutex);
+        s.nfilled = m_monitorQueue.size();
+        s.nempty = m_freeQueue.size();
+        s.noutstanding = m_lastStructure ? m_queueSize - s.nfilled - s.nempty : 0;
+        s.noverrun = m_noverrun;
+        s.nbytes = arrayBytes(m_elements);
+    }
+
 };
 
 
@@ -2125,6 +2613,11 @@ public:
     int32 m_queueSize;
     bool m_pipeline;
     int32 m_ackAny;
+    bool m_adaptive;
+
+    // when the previous update was received.  Only with m_stats
+    epicsTimeStamp m_lastUpdate;
+    bool m_updated;
 
     ChannelMonitorImpl(
         ClientChannelImpl::shared_pointer const & channel,
@@ -2137,8 +2630,11 @@ public:
         m_pvRequest(pvRequest),
         m_queueSize(2),
         m_pipeline(false),
-        m_ackAny(0)
+        m_ackAny(0),
+        m_adaptive(false),
+        m_updated(false)
     {
+        m_lastUpdate.secPastEpoch = m_lastUpdate.nsec = 0u;
     }
 
     virtual void activate() OVERRIDE FINAL
@@ -2212,6 +2708,16 @@ public:
                         m_ackAny = (m_ackAny <= m_queueSize) ? size : m_queueSize;
                     }
                 }
+
+                // report drain rate so the server can size its window
+                option = pvOptions->getSubField<PVScalar>("adaptive");
+                if (option) {
+                    try {
+                        m_adaptive = option->getAs<epics::pvData::boolean>();
+                    }catch(std::runtime_error& e){
+                        SEND_MESSAGE(m_callback, cb, "Invalid adaptive=", warningMessage);
+                    }
+                }
             }
         }
 
@@ -2219,7 +2725,7 @@ public:
 
         std::tr1::shared_ptr<MonitorStrategyQueue> tp(
             new MonitorStrategyQueue(m_channel, m_ioid, m_callback, m_queueSize,
-                                     m_pipeline, m_ackAny)
+                                     m_pipeline, m_ackAny, m_adaptive)
         );
         m_monitorStrategy = tp;
 
@@ -2293,6 +2799,8 @@ public:
         if(!structure)
             throw std::runtime_error("initResponse() w/o Structure");
         m_monitorStrategy->init(structure);
+        // don't count the time disconnected as an update interval
+        m_updated = false;
 
         bool restoreStartedState = m_started;
 
@@ -2318,8 +2826,10 @@ public:
         {
             // TODO for now status is ignored
 
-            if (payloadBuffer->getRemaining())
+            if (payloadBuffer->getRemaining()) {
                 m_monitorStrategy->response(transport, payloadBuffer);
+                updateDecoded();
+            }
 
             // unlisten will be called when all the elements in the queue gets processed
             m_monitorStrategy->unlisten();
@@ -2327,6 +2837,18 @@ public:
         else
         {
             m_monitorStrategy->response(transport, payloadBuffer);
+            updateDecoded();
+        }
+    }
+
+    void updateDecoded()
+    {
+        if (m_stats) {
+            epicsTimeStamp now;
+            epicsTimeGetCurrent(&now);
+            m_stats->update(m_updated ? &m_lastUpdate : 0, m_received, now);
+            m_lastUpdate = m_received;
+            m_updated = true;
         }
     }
 
@@ -2450,56 +2972,643 @@ public:
         m_monitorStrategy->release(monitorElement);
     }
 
+    virtual void getStats(Stats& s) const OVERRIDE FINAL
+    {
+        if (m_monitorStrategy)
+            m_monitorStrategy->getStats(s);
+        else
+            Monitor::getStats(s);
+    }
+
 };
 
 
 
-class AbstractClientResponseHandler : public ResponseHandler {
-    EPICS_NOT_COPYABLE(AbstractClientResponseHandler)
-protected:
-    const ClientContextImpl::weak_pointer _context;
-public:
-    AbstractClientResponseHandler(ClientContextImpl::shared_pointer const & context, string const & description) :
-        ResponseHandler(context.get(), description), _context(ClientContextImpl::weak_pointer(context)) {
-    }
+/**
+ * Several local subscriptions with identical (channel, pvRequest) share
+ * one wire subscription (a ChannelMonitorImpl) through a MonitorMux.
+ * Each MonitorMuxConsumer has its own element queue fed with copies
+ * of the elements delivered by the shared MonitorStrategyQueue.
+ */
+class MonitorMux;
 
-    virtual ~AbstractClientResponseHandler() {
-    }
+//! Keeps the index of MonitorMux by pvRequest.  Told when one is destroyed.
+struct MonitorMuxOwner
+{
+    POINTER_DEFINITIONS(MonitorMuxOwner);
+    virtual ~MonitorMuxOwner() {}
+    virtual void monitorMuxDestroyed(const std::string& key) = 0;
 };
 
-class NoopResponse : public AbstractClientResponseHandler {
-public:
-    NoopResponse(ClientContextImpl::shared_pointer const & context, string const & description) :
-        AbstractClientResponseHandler(context, description)
-    {
-    }
+static void copyMonitorElement(MonitorElement& dest, const MonitorElement& src)
+{
+    dest.pvStructurePtr->copyUnchecked(*src.pvStructurePtr);
+    *dest.changedBitSet = *src.changedBitSet;
+    *dest.overrunBitSet = *src.overrunBitSet;
+}
 
-    virtual ~NoopResponse() {
+static void squashMonitorElement(MonitorElement& dest, const MonitorElement& src)
+{
+    // fields changed again are overrun
+    dest.overrunBitSet->or_and(*dest.changedBitSet, *src.changedBitSet);
+    *dest.overrunBitSet |= *src.overrunBitSet;
+    *dest.changedBitSet |= *src.changedBitSet;
+    dest.pvStructurePtr->copyUnchecked(*src.pvStructurePtr, *src.changedBitSet);
+}
+
+static int32 monitorQueueSize(PVStructure::shared_pointer const & pvRequest)
+{
+    int32 queueSize = 2;
+    PVScalar::shared_pointer option(pvRequest->getSubField<PVScalar>("record._options.queueSize"));
+    if (option) {
+        try {
+            queueSize = option->getAs<int32>();
+        } catch(std::runtime_error&) {
+            // ChannelMonitorImpl warns
+        }
+        if (queueSize < 2)
+            queueSize = 2;
     }
-};
+    return queueSize;
+}
 
+class MonitorMuxConsumer :
+    public Monitor,
+    public std::tr1::enable_shared_from_this<MonitorMuxConsumer>
+{
+public:
+    POINTER_DEFINITIONS(MonitorMuxConsumer);
+
+    const std::tr1::shared_ptr<MonitorMux> m_mux;
+    const MonitorRequester::weak_pointer m_callback;
+
+private:
+    const int32 m_queueSize;
+
+    mutable Mutex m_mutex;
+
+    StructureConstPtr m_lastStructure;
+    FreeElementQueue m_freeQueue;
+    MonitorElementQueue m_monitorQueue;
+    // every element, including the spare and those held by the requester
+    FreeElementQueue m_elements;
+
+    // collects updates while all elements are held by the requester
+    MonitorElement::shared_pointer m_overrunElement;
+    bool m_overrunInProgress;
+    size_t m_noverrun;
+
+    bool m_started;
+    bool m_unlisten;
+    bool m_destroyed;
 
-class ResponseRequestHandler : public AbstractClientResponseHandler {
 public:
-    ResponseRequestHandler(ClientContextImpl::shared_pointer const & context) :
-        AbstractClientResponseHandler(context, "Data response")
-    {
-    }
+    MonitorMuxConsumer(const std::tr1::shared_ptr<MonitorMux>& mux,
+                       MonitorRequester::shared_pointer const & requester,
+                       int32 queueSize) :
+        m_mux(mux),
+        m_callback(requester),
+        m_queueSize(queueSize),
+        m_overrunInProgress(false),
+        m_noverrun(0u),
+        m_started(false),
+        m_unlisten(false),
+        m_destroyed(false)
+    {}
 
-    virtual ~ResponseRequestHandler() {
+    virtual ~MonitorMuxConsumer() {
+        destroy();
     }
 
-    virtual void handleResponse(osiSockAddr* responseFrom,
-                                Transport::shared_pointer const & transport, int8 version, int8 command,
-                                size_t payloadSize, epics::pvData::ByteBuffer* payloadBuffer) OVERRIDE FINAL
+    void init(StructureConstPtr const & structure)
     {
-        AbstractClientResponseHandler::handleResponse(responseFrom, transport, version, command, payloadSize, payloadBuffer);
+        Lock guard(m_mutex);
 
-        transport->ensureData(4);
+        m_monitorQueue.reset(m_queueSize + 1);
+        m_freeQueue.clear();
+        m_overrunInProgress = false;
+        m_unlisten = false;
+
+        // one more than queueSize for m_overrunElement
+        for (int32 i = 0; i <= m_queueSize; i++)
+        {
+            MonitorElement::shared_pointer monitorElement(new MonitorElement(getPVDataCreate()->createPVStructure(structure)));
+            m_freeQueue.push_back(monitorElement);
+        }
+        m_elements = m_freeQueue;
+        m_overrunElement = m_freeQueue.back();
+        m_freeQueue.pop_back();
+
+        m_lastStructure = structure;
+    }
+
+    /**
+     * Queue a copy of an update.
+     * @return true if the requester is to be notified.
+     */
+    bool push(const MonitorElement& update)
+    {
+        Lock guard(m_mutex);
+
+        if (!m_started || m_destroyed || !m_lastStructure)
+            return false;
+
+        if (!m_freeQueue.empty())
+        {
+            MonitorElement::shared_pointer elem(m_freeQueue.back());
+            m_freeQueue.pop_back();
+            copyMonitorElement(*elem, update);
+            m_monitorQueue.push_back(elem);
+            return m_monitorQueue.size()==1u;
+        }
+        else if (!m_monitorQueue.empty())
+        {
+            squashMonitorElement(*m_monitorQueue.back(), update);
+            m_noverrun++;
+        }
+        else if (m_overrunInProgress)
+        {
+            squashMonitorElement(*m_overrunElement, update);
+            m_noverrun++;
+        }
+        else
+        {
+            copyMonitorElement(*m_overrunElement, update);
+            m_overrunInProgress = true;
+        }
+        return false;
+    }
+
+    /**
+     * Upstream subscription ended.
+     * @return true if MonitorRequester::unlisten() is to be called now.
+     */
+    bool unlisten()
+    {
+        Lock guard(m_mutex);
+        m_unlisten = !m_monitorQueue.empty();
+        return !m_unlisten;
+    }
+
+    virtual MonitorElement::shared_pointer poll() OVERRIDE FINAL
+    {
+        Lock guard(m_mutex);
+
+        if (m_monitorQueue.empty()) {
+
+            if (m_unlisten) {
+                m_unlisten = false;
+                guard.unlock();
+                EXCEPTION_GUARD3(m_callback, cb, cb->unlisten(shared_from_this()));
+            }
+            return MonitorElement::shared_pointer();
+        }
+
+        MonitorElement::shared_pointer retVal(m_monitorQueue.front());
+        m_monitorQueue.pop_front();
+        return retVal;
+    }
+
+    virtual void release(MonitorElement::shared_pointer const & monitorElement) OVERRIDE FINAL
+    {
+        Lock guard(m_mutex);
+
+        // element from before a reconnect
+        if (monitorElement->pvStructurePtr->getStructure().get() != m_lastStructure.get())
+            return;
+
+        if (m_overrunInProgress)
+        {
+            m_monitorQueue.push_back(m_overrunElement);
+            m_overrunElement = monitorElement;
+            m_overrunInProgress = false;
+        }
+        else
+        {
+            m_freeQueue.push_back(monitorElement);
+        }
+
+        // the next copy into this element replaces all arrays
+        releaseArrays(*monitorElement->pvStructurePtr);
+    }
+
+    virtual void getStats(Stats& s) const OVERRIDE FINAL
+    {
+        Lock guard(m_mutex);
+        s.nfilled = m_monitorQueue.size();
+        s.nempty = m_freeQueue.size();
+        s.noutstanding = m_lastStructure ? m_queueSize - s.nfilled - s.nempty : 0;
+        s.noverrun = m_noverrun;
+        s.nbytes = arrayBytes(m_elements);
+    }
+
+    virtual Status start() OVERRIDE FINAL;
+
+    virtual Status stop() OVERRIDE FINAL;
+
+    virtual void destroy() OVERRIDE FINAL;
+};
+
+class MonitorMux :
+    public MonitorRequester,
+    public std::tr1::enable_shared_from_this<MonitorMux>
+{
+public:
+    POINTER_DEFINITIONS(MonitorMux);
+    typedef MonitorRequester requester_type;
+    typedef std::vector<MonitorMuxConsumer::weak_pointer> consumers_t;
+
+private:
+    mutable Mutex m_mutex;
+
+    const string m_channelName;
+
+    // our entry in the index of the owning channel
+    const MonitorMuxOwner::weak_pointer m_owner;
+    const string m_key;
+
+    // the shared wire subscription
+    Monitor::shared_pointer m_upstream;
+    bool m_upstreamStarted;
+
+    bool m_connected;
+    Status m_connectStatus;
+    StructureConstPtr m_structure;
+
+    // complete current value, used to prime consumers starting late
+    MonitorElement::shared_pointer m_latest;
+    bool m_hasLatest;
+
+    consumers_t m_consumers;
+    size_t m_nstarted;
+
+    consumers_t snapshot()
+    {
+        Lock guard(m_mutex);
+        return m_consumers;
+    }
+
+public:
+    static size_t num_instances;
+
+    MonitorMux(const string& channelName,
+               const MonitorMuxOwner::shared_pointer& owner,
+               const string& key) :
+        m_channelName(channelName),
+        m_owner(owner),
+        m_key(key),
+        m_upstreamStarted(false),
+        m_connected(false),
+        m_hasLatest(false),
+        m_nstarted(0)
+    {
+        REFTRACE_INCREMENT(num_instances);
+    }
+
+    virtual ~MonitorMux()
+    {
+        REFTRACE_DECREMENT(num_instances);
+        if (m_upstream)
+            m_upstream->destroy();
+        MonitorMuxOwner::shared_pointer owner(m_owner.lock());
+        if (owner)
+            owner->monitorMuxDestroyed(m_key);
+    }
+
+    void setUpstream(const Monitor::shared_pointer& upstream)
+    {
+        bool start;
+        {
+            Lock guard(m_mutex);
+            m_upstream = upstream;
+            // a consumer may have start()ed from monitorConnect() before we got here
+            start = m_nstarted > 0 && !m_upstreamStarted;
+        }
+        if (start)
+        {
+            Status sts(upstream->start());
+            Lock guard(m_mutex);
+            m_upstreamStarted = sts.isSuccess();
+        }
+    }
+
+    size_t consumerCount() const
+    {
+        Lock guard(m_mutex);
+        return m_consumers.size();
+    }
+
+    /** Attach a new local subscriber.  Completes with MonitorRequester::monitorConnect()
+     *  immediately if the shared subscription is already connected.
+     */
+    Monitor::shared_pointer addConsumer(MonitorRequester::shared_pointer const & requester, int32 queueSize)
+    {
+        MonitorMuxConsumer::shared_pointer consumer(new MonitorMuxConsumer(shared_from_this(), requester, queueSize));
+        bool connected;
+        Status status;
+        StructureConstPtr structure;
+        {
+            Lock guard(m_mutex);
+            m_consumers.push_back(consumer);
+            connected = m_connected;
+            status = m_connectStatus;
+            structure = m_structure;
+        }
+
+        if (connected)
+        {
+            if (status.isSuccess())
+                consumer->init(structure);
+            requester->monitorConnect(status, consumer, structure);
+        }
+        return consumer;
+    }
+
+    void removeConsumer(MonitorMuxConsumer* consumer)
+    {
+        Lock guard(m_mutex);
+        for (consumers_t::iterator it = m_consumers.begin(); it != m_consumers.end(); )
+        {
+            MonitorMuxConsumer::shared_pointer C(it->lock());
+            if (!C || C.get()==consumer)
+                it = m_consumers.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    Status consumerStart(MonitorMuxConsumer::shared_pointer const & consumer)
+    {
+        Status ret;
+        bool notify = false;
+        Monitor::shared_pointer upstream;
+        {
+            Lock guard(m_mutex);
+            if (m_hasLatest)
+            {
+                // new subscriber gets the complete current value
+                m_latest->changedBitSet->clear();
+                m_latest->changedBitSet->set(0);
+                m_latest->overrunBitSet->clear();
+                notify = consumer->push(*m_latest);
+            }
+            // m_upstream is NULL until setUpstream()
+            if (m_nstarted++ == 0 && !m_upstreamStarted)
+                upstream = m_upstream;
+        }
+
+        if (upstream)
+        {
+            ret = upstream->start();
+            Lock guard(m_mutex);
+            m_upstreamStarted = ret.isSuccess();
+        }
+
+        if (notify)
+        {
+            EXCEPTION_GUARD3(consumer->m_callback, cb, cb->monitorEvent(consumer));
+        }
+        return ret;
+    }
+
+    Status consumerStop()
+    {
+        Monitor::shared_pointer upstream;
+        {
+            Lock guard(m_mutex);
+            assert(m_nstarted > 0);
+            if (--m_nstarted == 0 && m_upstreamStarted)
+            {
+                upstream = m_upstream;
+                m_upstreamStarted = false;
+                // value may become stale while stopped
+                m_hasLatest = false;
+            }
+        }
+        if (upstream)
+            return upstream->stop();
+        return Status::Ok;
+    }
+
+    virtual string getRequesterName() OVERRIDE FINAL
+    {
+        return "MonitorMux:" + m_channelName;
+    }
+
+    virtual void message(std::string const & message, MessageType messageType) OVERRIDE FINAL
+    {
+        consumers_t consumers(snapshot());
+        for (size_t i = 0; i < consumers.size(); i++)
+        {
+            MonitorMuxConsumer::shared_pointer C(consumers[i].lock());
+            if (C)
+                SEND_MESSAGE(C->m_callback, cb, message, messageType);
+        }
+    }
+
+    virtual void channelDisconnect(bool destroy) OVERRIDE FINAL
+    {
+        {
+            Lock guard(m_mutex);
+            m_connected = false;
+            m_hasLatest = false;
+        }
+        consumers_t consumers(snapshot());
+        for (size_t i = 0; i < consumers.size(); i++)
+        {
+            MonitorMuxConsumer::shared_pointer C(consumers[i].lock());
+            if (C)
+                EXCEPTION_GUARD3(C->m_callback, cb, cb->channelDisconnect(destroy));
+        }
+    }
+
+    virtual void monitorConnect(Status const & status,
+                                Monitor::shared_pointer const & monitor,
+                                StructureConstPtr const & structure) OVERRIDE FINAL
+    {
+        consumers_t consumers;
+        bool restart;
+        {
+            Lock guard(m_mutex);
+            m_connected = true;
+            m_connectStatus = status;
+            m_structure = structure;
+            m_hasLatest = false;
+            if (status.isSuccess())
+                m_latest.reset(new MonitorElement(getPVDataCreate()->createPVStructure(structure)));
+            consumers = m_consumers;
+            // upstream ChannelMonitorImpl restores its own started state on reconnect
+            restart = status.isSuccess() && m_nstarted > 0 && !m_upstreamStarted;
+        }
+
+        for (size_t i = 0; i < consumers.size(); i++)
+        {
+            MonitorMuxConsumer::shared_pointer C(consumers[i].lock());
+            if (!C)
+                continue;
+            if (status.isSuccess())
+                C->init(structure);
+            EXCEPTION_GUARD3(C->m_callback, cb, cb->monitorConnect(status, C, structure));
+        }
+
+        if (restart)
+        {
+            Status sts(monitor->start());
+            Lock guard(m_mutex);
+            m_upstreamStarted = sts.isSuccess();
+        }
+    }
+
+    virtual void monitorEvent(Monitor::shared_pointer const & monitor) OVERRIDE FINAL
+    {
+        consumers_t consumers(snapshot());
+        std::vector<MonitorMuxConsumer::shared_pointer> notify;
+
+        MonitorElement::shared_pointer elem;
+        while ((elem = monitor->poll()))
+        {
+            {
+                Lock guard(m_mutex);
+                if (m_latest && elem->pvStructurePtr->getStructure().get()==m_latest->pvStructurePtr->getStructure().get())
+                {
+                    m_latest->pvStructurePtr->copyUnchecked(*elem->pvStructurePtr, *elem->changedBitSet);
+                    // upstream elements are complete (MonitorStrategyQueue copies unchanged fields)
+                    m_hasLatest = true;
+                }
+            }
+
+            for (size_t i = 0; i < consumers.size(); i++)
+            {
+                MonitorMuxConsumer::shared_pointer C(consumers[i].lock());
+                if (C && C->push(*elem))
+                    notify.push_back(C);
+            }
+
+            monitor->release(elem);
+        }
+
+        for (size_t i = 0; i < notify.size(); i++)
+        {
+            EXCEPTION_GUARD3(notify[i]->m_callback, cb, cb->monitorEvent(notify[i]));
+        }
+    }
+
+    virtual void unlisten(Monitor::shared_pointer const & /*monitor*/) OVERRIDE FINAL
+    {
+        consumers_t consumers(snapshot());
+        for (size_t i = 0; i < consumers.size(); i++)
+        {
+            MonitorMuxConsumer::shared_pointer C(consumers[i].lock());
+            if (C && C->unlisten())
+                EXCEPTION_GUARD3(C->m_callback, cb, cb->unlisten(C));
+        }
+    }
+};
+
+size_t MonitorMux::num_instances;
+
+Status MonitorMuxConsumer::start()
+{
+    {
+        Lock guard(m_mutex);
+        if (m_destroyed)
+            return BaseRequestImpl::destroyedStatus;
+        if (!m_lastStructure)
+            return BaseRequestImpl::notInitializedStatus;
+        if (m_started)
+            return Status::Ok;
+        m_started = true;
+    }
+    return m_mux->consumerStart(shared_from_this());
+}
+
+Status MonitorMuxConsumer::stop()
+{
+    {
+        Lock guard(m_mutex);
+        if (m_destroyed)
+            return BaseRequestImpl::destroyedStatus;
+        if (!m_started)
+            return Status::Ok;
+        m_started = false;
+    }
+    return m_mux->consumerStop();
+}
+
+void MonitorMuxConsumer::destroy()
+{
+    bool wasStarted;
+    {
+        Lock guard(m_mutex);
+        if (m_destroyed)
+            return;
+        m_destroyed = true;
+        wasStarted = m_started;
+        m_started = false;
+    }
+    if (wasStarted)
+        m_mux->consumerStop();
+    m_mux->removeConsumer(this);
+}
+
+
+
+class AbstractClientResponseHandler : public ResponseHandler {
+    EPICS_NOT_COPYABLE(AbstractClientResponseHandler)
+protected:
+    const ClientContextImpl::weak_pointer _context;
+public:
+    AbstractClientResponseHandler(ClientContextImpl::shared_pointer const & context, string const & description) :
+        ResponseHandler(context.get(), description), _context(ClientContextImpl::weak_pointer(context)) {
+    }
+
+    virtual ~AbstractClientResponseHandler() {
+    }
+};
+
+class NoopResponse : public AbstractClientResponseHandler {
+public:
+    NoopResponse(ClientContextImpl::shared_pointer const & context, string const & description) :
+        AbstractClientResponseHandler(context, description)
+    {
+    }
+
+    virtual ~NoopResponse() {
+    }
+};
+
+
+// count the payload of a reply against the channel of an operation.  Only with $EPICS_PVA_CLIENT_STATS
+void receivedPayload(ResponseRequest::shared_pointer const & rr, size_t nbytes)
+{
+    if (BaseRequestImpl* req = dynamic_cast<BaseRequestImpl*>(rr.get()))
+        req->received(nbytes);
+}
+
+class ResponseRequestHandler : public AbstractClientResponseHandler {
+public:
+    ResponseRequestHandler(ClientContextImpl::shared_pointer const & context) :
+        AbstractClientResponseHandler(context, "Data response")
+    {
+    }
+
+    virtual ~ResponseRequestHandler() {
+    }
+
+    virtual void handleResponse(osiSockAddr* responseFrom,
+                                Transport::shared_pointer const & transport, int8 version, int8 command,
+                                size_t payloadSize, epics::pvData::ByteBuffer* payloadBuffer) OVERRIDE FINAL
+    {
+        AbstractClientResponseHandler::handleResponse(responseFrom, transport, version, command, payloadSize, payloadBuffer);
+
+        transport->ensureData(4);
+        ClientContextImpl::shared_pointer context(_context.lock());
         // TODO check and optimize?
-        ResponseRequest::shared_pointer rr = _context.lock()->getResponseRequest(payloadBuffer->getInt());
+        ResponseRequest::shared_pointer rr = context->getResponseRequest(payloadBuffer->getInt());
         if (rr)
         {
+            if (context->isChannelStatsEnabled())
+                receivedPayload(rr, payloadSize - 4u);
             rr->response(transport, version, payloadBuffer);
         } else {
             // oh no, we can't complete parsing this message!
@@ -2526,10 +3635,11 @@ public:
     {
         AbstractClientResponseHandler::handleResponse(responseFrom, transport, version, command, payloadSize, payloadBuffer);
 
-        // TODO add submessage payload size, so that non-existant IOID can be skipped
-        // and others not lost
+        // sub-messages of (IOID, size, response), ending with INVALID_IOID
 
         ClientContextImpl::shared_pointer context = _context.lock();
+        if (!context)
+            return;
         while (true)
         {
             transport->ensureData(4);
@@ -2537,13 +3647,28 @@ public:
             if (ioid == INVALID_IOID)
                 return;
 
+            transport->ensureData(4);
+            size_t size = static_cast<uint32>(payloadBuffer->getInt());
+
             ResponseRequest::shared_pointer rr = context->getResponseRequest(ioid);
             if (rr)
             {
+                if (context->isChannelStatsEnabled())
+                    receivedPayload(rr, size);
                 rr->response(transport, version, payloadBuffer);
             }
             else
-                return; // we cannot deserialize, we are lost in stream, we must stop
+            {
+                // eg. already cancelled, skip over
+                while (size > 0)
+                {
+                    if (!payloadBuffer->getRemaining())
+                        transport->ensureData(1);
+                    size_t n = std::min(size, payloadBuffer->getRemaining());
+                    payloadBuffer->setPosition(payloadBuffer->getPosition() + n);
+                    size -= n;
+                }
+            }
         }
     }
 };
@@ -2766,7 +3891,7 @@ public:
         }
 
         // notify beacon handler
-        beaconHandler->beaconNotify(responseFrom, version, &timestamp, guid, sequentalID, changeCount, data);
+        beaconHandler->beaconNotify(&serverAddress, version, &timestamp, guid, sequentalID, changeCount, data);
     }
 };
 
@@ -2786,8 +3911,10 @@ public:
 
         transport->ensureData(4+2);
 
-        transport->setRemoteTransportReceiveBufferSize(payloadBuffer->getInt());
-        // TODO
+        // server max. payload size, bounds the growth of our send buffer
+        const int32 serverReceiveBufferSize = payloadBuffer->getInt();
+        if (serverReceiveBufferSize > 0)
+            transport->setRemoteTransportReceiveBufferSize(serverReceiveBufferSize);
         // TODO serverIntrospectionRegistryMaxSize
         /*int serverIntrospectionRegistryMaxSize = */ payloadBuffer->getShort();
 
@@ -2824,6 +3951,13 @@ public:
 
         Status status;
         status.deserialize(payloadBuffer, transport.get());
+
+        if (payloadBuffer->getRemaining() >= 2)
+        {
+            epics::pvAccess::detail::BlockingClientTCPTransportCodec* cliTransport(static_cast<epics::pvAccess::detail::BlockingClientTCPTransportCodec*>(transport.get()));
+            cliTransport->setServerFeatures(payloadBuffer->getShort());
+        }
+
         transport->verified(status);
 
     }
@@ -2966,7 +4100,7 @@ public:
         ResponseHandler::shared_pointer ignoreResponse(new NoopResponse(context, "Ignore"));
         ResponseHandler::shared_pointer dataResponse(new ResponseRequestHandler(context));
 
-        m_handlerTable.resize(CMD_CANCEL_REQUEST+1);
+        m_handlerTable.resize(CMD_MULTI_PUT+1);
 
         m_handlerTable[CMD_BEACON].reset(new BeaconResponseHandler(context)); /*  0 */
         m_handlerTable[CMD_CONNECTION_VALIDATION].reset(new ClientConnectionValidationHandler(context)); /*  1 */
@@ -2990,6 +4124,9 @@ public:
         m_handlerTable[CMD_MULTIPLE_DATA].reset(new MultipleResponseRequestHandler(context)); /* 19 - grouped monitors */
         m_handlerTable[CMD_RPC] = dataResponse; /* 20 - RPC response */
         m_handlerTable[CMD_CANCEL_REQUEST] = ignoreResponse; /* 21 - cancel request */
+        m_handlerTable[CMD_ORIGIN_TAG] = ignoreResponse; /* 22 - origin tag */
+        m_handlerTable[CMD_MULTI_GET] = dataResponse; /* 23 - multi-channel get response */
+        m_handlerTable[CMD_MULTI_PUT] = dataResponse; /* 24 - multi-channel put response */
     }
 
     virtual void handleResponse(osiSockAddr* responseFrom,
@@ -3004,6 +4141,8 @@ public:
             hexDump(buf, (const int8*)(payloadBuffer->getArray()), payloadBuffer->getPosition(), payloadSize);
             return;
         }
+        MB_POINT(pvAccess, 1, "dispatch");
+
         // delegate
         m_handlerTable[command]->handleResponse(responseFrom, transport, version, command, payloadSize, payloadBuffer);
     }
@@ -3037,6 +4176,10 @@ enum ContextState {
 
 
 
+// delay between connection attempts to a name server.  Doubled after each failure, up to the maximum.
+const double nameServerReconnectDelay = 1.0;
+const double nameServerMaxReconnectDelay = 60.0;
+
 class InternalClientContextImpl :
     public ClientContextImpl,
     public ChannelProvider
@@ -3094,7 +4237,7 @@ public:
         std::string const & addressesStr) OVERRIDE FINAL
     {
         InetAddrVector addresses;
-        getSocketAddressList(addresses, addressesStr, PVA_SERVER_PORT);
+        getSocketAddressList(addresses, addressesStr, PVA_SERVER_PORT, NULL, true);
 
         Channel::shared_pointer channel = createChannelInternal(channelName, channelRequester, priority, addresses);
         if (channel.get())
@@ -3104,13 +4247,94 @@ public:
         // NOTE it's up to internal code to respond w/ error to requester and return 0 in case of errors
     }
 
+    virtual void createChannels(
+        std::vector<std::string> const & channelNames,
+        std::vector<ChannelRequester::shared_pointer> const & channelRequesters,
+        short priority,
+        std::string const & addressesStr,
+        std::vector<Channel::shared_pointer>& channels) OVERRIDE FINAL
+    {
+        if (channelNames.size() != channelRequesters.size())
+            throw std::logic_error("createChannels() requires one requester per name");
+
+        checkState();
+
+        if (priority < ChannelProvider::PRIORITY_MIN || priority > ChannelProvider::PRIORITY_MAX)
+            throw std::range_error("priority out of bounds");
+
+        for (size_t i = 0; i < channelNames.size(); i++)
+        {
+            checkChannelName(channelNames[i]);
+            if (!channelRequesters[i])
+                throw std::runtime_error("0 requester");
+        }
+
+        InetAddrVector addresses;
+        getSocketAddressList(addresses, addressesStr, PVA_SERVER_PORT, NULL, true);
+
+        std::vector<pvAccessID> cids;
+        generateCIDs(channelNames.size(), cids);
+
+        // searches are collected, then registered and sent together
+        std::vector<SearchInstance::shared_pointer> searches;
+        searches.reserve(channelNames.size());
+
+        const size_t first = channels.size();
+        channels.reserve(first + channelNames.size());
+
+        InternalClientContextImpl::shared_pointer self(internal_from_this());
+        for (size_t i = 0; i < channelNames.size(); i++)
+        {
+            Channel::shared_pointer channel;
+            try {
+                channel = InternalChannelImpl::create(self, cids[i], channelNames[i], channelRequesters[i],
+                                                      priority, addresses, &searches);
+            } catch(std::exception& e) {
+                LOG(logLevelError, "createChannels() exception: %s\n", e.what());
+                freeCID(cids[i]);
+            }
+            channels.push_back(channel);
+        }
+
+        m_channelSearchManager->registerSearchInstances(searches);
+
+        for (size_t i = 0; i < channelNames.size(); i++)
+        {
+            if (channels[first+i])
+                channelRequesters[i]->channelCreated(Status::Ok, channels[first+i]);
+        }
+    }
+
+    virtual void getMany(std::vector<Channel::shared_pointer> const & channels,
+                         PVStructure::shared_pointer const & pvRequest,
+                         ChannelMultiRequester::shared_pointer const & requester) OVERRIDE FINAL;
+
+    virtual void putMany(std::vector<Channel::shared_pointer> const & channels,
+                         PVStructure::shared_pointer const & pvRequest,
+                         std::vector<PVStructure::shared_pointer> const & values,
+                         std::vector<BitSet::shared_pointer> const & changed,
+                         ChannelMultiRequester::shared_pointer const & requester) OVERRIDE FINAL;
+
+private:
+    /**
+     * Sends one CMD_MULTI_GET or CMD_MULTI_PUT to each server which supports it,
+     * and uses the per-channel ChannelProvider implementation for the remaining channels.
+     */
+    void multiRequest(int8 command,
+                      std::vector<Channel::shared_pointer> const & channels,
+                      PVStructure::shared_pointer const & pvRequest,
+                      std::vector<PVStructure::shared_pointer> const & values,
+                      std::vector<BitSet::shared_pointer> const & changed,
+                      ChannelMultiRequester::shared_pointer const & requester);
+
 public:
     /**
      * Implementation of <code>Channel</code>.
      */
     class InternalChannelImpl :
         public ClientChannelImpl,
-        public TimerCallback
+        public TimerCallback,
+        public MonitorMuxOwner
     {
         InternalChannelImpl(InternalChannelImpl&);
         InternalChannelImpl& operator=(const InternalChannelImpl&);
@@ -3222,6 +4446,32 @@ private:
          */
         ServerGUID m_guid;
 
+        /**
+         * Whether the name cache (see EPICS_PVA_NAME_CACHE) has been consulted.
+         * Only done before the first connection.
+         */
+        bool m_cacheChecked;
+
+        /**
+         * Whether the current connection attempt uses a name cache entry,
+         * the address and GUID of which are stored here.
+         */
+        bool m_cacheAttempt;
+        osiSockAddr m_cacheAddress;
+        ServerGUID m_cacheGUID;
+
+        /**
+         * Shared subscriptions, keyed by pvRequest (see EPICS_PVA_SHARE_MONITORS).
+         * Guarded by m_channelMutex.
+         */
+        typedef std::map<std::string, MonitorMux::weak_pointer> monitor_muxes_t;
+        monitor_muxes_t m_monitorMuxes;
+
+        /**
+         * Operation statistics, when enabled by $EPICS_PVA_CLIENT_STATS
+         */
+        const epics::auto_ptr<ClientChannelStats> m_stats;
+
     public:
         static size_t num_instances;
         static size_t num_active;
@@ -3252,18 +4502,21 @@ private:
             m_needSubscriptionUpdate(false),
             m_allowCreation(true),
             m_serverChannelID(0xFFFFFFFF),
-            m_issueCreateMessage(true)
+            m_issueCreateMessage(true),
+            m_cacheChecked(false),
+            m_cacheAttempt(false),
+            m_stats(context->isChannelStatsEnabled() ? new ClientChannelStats : 0)
         {
             REFTRACE_INCREMENT(num_instances);
         }
 
-        void activate()
+        void activate(std::vector<SearchInstance::shared_pointer>* searches)
         {
             // register before issuing search request
             m_context->registerChannel(internal_from_this());
 
             // connect
-            connect();
+            connect(searches);
 
             REFTRACE_INCREMENT(num_active);
         }
@@ -3275,14 +4528,15 @@ private:
                 string const & name,
                 ChannelRequester::shared_pointer requester,
                 short priority,
-                const InetAddrVector& addresses)
+                const InetAddrVector& addresses,
+                std::vector<SearchInstance::shared_pointer>* searches = 0)
         {
             std::tr1::shared_ptr<InternalChannelImpl> internal(
                 new InternalChannelImpl(context, channelID, name, requester, priority, addresses)),
                     external(internal.get(), epics::pvAccess::Destroyable::cleaner(internal));
             const_cast<weak_pointer&>(internal->m_internal_this) = internal;
             const_cast<weak_pointer&>(internal->m_external_this) = external;
-            internal->activate();
+            internal->activate(searches);
             return external;
         }
 
@@ -3422,13 +4676,13 @@ public:
             m_responseRequests.erase(ioid);
         }
 
-        void connect() {
+        void connect(std::vector<SearchInstance::shared_pointer>* searches = 0) {
             Lock guard(m_channelMutex);
             // if not destroyed...
             if (m_connectionState == DESTROYED)
                 throw std::runtime_error("Channel destroyed.");
             else if (m_connectionState != CONNECTED)
-                initiateSearch();
+                initiateSearch(false, searches);
         }
 
         void disconnect() {
@@ -3468,6 +4722,18 @@ public:
                 old_transport.swap(m_transport);
             }
 
+            if (m_cacheAttempt)
+            {
+                // stale name cache entry.  forget it and search immediately
+                m_cacheAttempt = false;
+                NameCache::shared_pointer cache(m_context->getNameCache());
+                if (cache)
+                    cache->remove(m_name);
+                m_allowCreation = true;
+                initiateSearch();
+                return;
+            }
+
             // ... and search again, with penalty
             initiateSearch(true);
         }
@@ -3496,6 +4762,7 @@ public:
                     //setAccessRights(rights);
 
                     m_addressIndex = 0; // reset
+                    m_cacheAttempt = false;
 
                     // user might create monitors in listeners, so this has to be done before this can happen
                     // however, it would not be nice if events would come before connection event is fired
@@ -3567,16 +4834,33 @@ public:
 
         /**
          * Initiate search (connect) procedure.
+         * @param searches if not NULL, append instead of registering with the search manager.
          */
-        void initiateSearch(bool penalize = false)
+        void initiateSearch(bool penalize = false, std::vector<SearchInstance::shared_pointer>* searches = 0)
         {
             Lock guard(m_channelMutex);
 
             m_allowCreation = true;
 
+            if (m_addresses.empty() && !m_cacheChecked)
+            {
+                m_cacheChecked = true;
+                NameCache::shared_pointer cache(m_context->getNameCache());
+                if (cache && cache->lookup(m_name, m_cacheAddress, m_cacheGUID))
+                {
+                    // try the remembered server first (from the timer thread, as connect() may block)
+                    m_cacheAttempt = true;
+                    m_context->getTimer()->scheduleAfterDelay(internal_from_this(), 0.0);
+                    return;
+                }
+            }
+
             if (m_addresses.empty())
             {
-                m_context->getChannelSearchManager()->registerSearchInstance(internal_from_this(), penalize);
+                if (searches)
+                    searches->push_back(internal_from_this());
+                else
+                    m_context->getChannelSearchManager()->registerSearchInstance(internal_from_this(), penalize);
             }
             else
             {
@@ -3589,6 +4873,22 @@ public:
             // TODO cancellaction?!
             // TODO not in this timer thread !!!
             // TODO boost when a server (from address list) is started!!! IP vs address !!!
+            if (m_addresses.empty())
+            {
+                // name cache entry
+                osiSockAddr addr;
+                ServerGUID guid;
+                {
+                    Lock guard(m_channelMutex);
+                    if (!m_cacheAttempt)
+                        return;
+                    addr = m_cacheAddress;
+                    guid = m_cacheGUID;
+                }
+                searchResponse(guid, PVA_PROTOCOL_REVISION, &addr);
+                return;
+            }
+
             int ix = m_addressIndex % m_addresses.size();
             m_addressIndex++;
             if (m_addressIndex >= static_cast<int>(m_addresses.size()*(STATIC_SEARCH_MAX_MULTIPLIER+1)))
@@ -3637,6 +4937,14 @@ public:
             // remember GUID
             std::copy(guid.value, guid.value + 12, m_guid.value);
 
+            // remember name resolution found by search
+            if (m_addresses.empty() && !m_cacheAttempt)
+            {
+                NameCache::shared_pointer cache(m_context->getNameCache());
+                if (cache)
+                    cache->store(m_name, *serverAddress, guid);
+            }
+
             // create channel
             {
                 Lock guard(m_channelMutex);
@@ -3949,49 +5257,416 @@ public:
             return BaseRequestImpl::build<ChannelPutGetImpl>(external_from_this(), requester, pvRequest);
         }
 
-        virtual ChannelRPC::shared_pointer createChannelRPC(
-            ChannelRPCRequester::shared_pointer const & requester,
-            epics::pvData::PVStructure::shared_pointer const & pvRequest) OVERRIDE FINAL
+        virtual ChannelRPC::shared_pointer createChannelRPC(
+            ChannelRPCRequester::shared_pointer const & requester,
+            epics::pvData::PVStructure::shared_pointer const & pvRequest) OVERRIDE FINAL
+        {
+            return BaseRequestImpl::build<ChannelRPCImpl>(external_from_this(), requester, pvRequest);
+        }
+
+        virtual Monitor::shared_pointer createMonitor(
+            MonitorRequester::shared_pointer const & requester,
+            epics::pvData::PVStructure::shared_pointer const & pvRequest) OVERRIDE FINAL
+        {
+            if (!pvRequest || !m_context->isShareMonitors())
+                return BaseRequestImpl::build<ChannelMonitorImpl>(external_from_this(), requester, pvRequest);
+
+            // identical requests share one subscription
+            std::ostringstream strm;
+            strm << *pvRequest;
+            const std::string key(strm.str());
+
+            MonitorMux::shared_pointer mux;
+            bool created = false;
+            {
+                Lock guard(m_channelMutex);
+                MonitorMux::weak_pointer& entry = m_monitorMuxes[key];
+                mux = entry.lock();
+                if (!mux)
+                {
+                    mux.reset(new MonitorMux(m_name, internal_from_this(), key));
+                    entry = mux;
+                    created = true;
+                }
+            }
+
+            if (created)
+                mux->setUpstream(BaseRequestImpl::build<ChannelMonitorImpl>(external_from_this(), mux, pvRequest));
+
+            return mux->addConsumer(requester, monitorQueueSize(pvRequest));
+        }
+
+        virtual void monitorMuxDestroyed(const std::string& key) OVERRIDE FINAL
+        {
+            Lock guard(m_channelMutex);
+            monitor_muxes_t::iterator it(m_monitorMuxes.find(key));
+            // may already have been replaced by a new MonitorMux for the same pvRequest
+            if (it != m_monitorMuxes.end() && it->second.expired())
+                m_monitorMuxes.erase(it);
+        }
+
+        virtual ChannelArray::shared_pointer createChannelArray(
+            ChannelArrayRequester::shared_pointer const & requester,
+            epics::pvData::PVStructure::shared_pointer const & pvRequest) OVERRIDE FINAL
+        {
+            return BaseRequestImpl::build<ChannelArrayImpl>(external_from_this(), requester, pvRequest);
+        }
+
+        virtual void printInfo(std::ostream& out) OVERRIDE FINAL {
+            //Lock lock(m_channelMutex);
+
+            out << "CHANNEL  : " << m_name << std::endl;
+            out << "STATE    : " << ConnectionStateNames[m_connectionState] << std::endl;
+            if (m_connectionState == CONNECTED)
+            {
+                out << "ADDRESS  : " << getRemoteAddress() << std::endl;
+                //out << "RIGHTS   : " << getAccessRights() << std::endl;
+            }
+            if (m_stats.get())
+            {
+                Stats stats;
+                m_stats->get(stats);
+                stats.show(out);
+            }
+        }
+
+        virtual ClientChannelStats* getStatsCollector() OVERRIDE FINAL {
+            return m_stats.get();
+        }
+
+        virtual void getStats(Stats& s) const OVERRIDE FINAL {
+            if (m_stats.get())
+                m_stats->get(s);
+            else
+                Channel::getStats(s);
+        }
+    };
+
+
+    /**
+     * Persistent TCP connection to a name server, ie. any PVA server which answers
+     * searches from its providers.  Search requests are sent over it in large batches.
+     * Acts as a transport owner, so most of ClientChannelImpl is a stub.
+     */
+    class NameServer :
+        public ClientChannelImpl,
+        public SearchSender,
+        public TimerCallback,
+        public std::tr1::enable_shared_from_this<NameServer>
+    {
+        NameServer(NameServer&);
+        NameServer& operator=(const NameServer&);
+    public:
+        POINTER_DEFINITIONS(NameServer);
+
+        // limit names per CMD_SEARCH message.  The count is an unsigned short.
+        enum { MAX_BATCH = 4096 };
+    private:
+        const std::tr1::weak_ptr<InternalClientContextImpl> m_context;
+
+        /**
+         * Reserved client ID.  Identifies this owner to the transport.
+         */
+        const pvAccessID m_id;
+
+        osiSockAddr m_address;
+
+        const std::string m_name;
+
+        /**
+         * Delay between connection attempts.
+         */
+        const double m_reconnectDelay;
+
+        Mutex m_mutex;
+
+        Transport::shared_pointer m_transport;
+
+        // a connect() thread is running
+        bool m_connecting;
+        // delay before the next attempt, with backoff
+        double m_retryDelay;
+
+        typedef std::vector<std::pair<pvAccessID, std::string> > pending_t;
+        pending_t m_pending;
+
+        int32 m_sequenceNumber;
+
+        int32 m_userValue;
+
+        bool m_destroyed;
+
+    public:
+        NameServer(const InternalClientContextImpl::shared_pointer& context, pvAccessID id,
+                   const osiSockAddr& address, double reconnectDelay)
+            :m_context(context)
+            ,m_id(id)
+            ,m_address(address)
+            ,m_name(inetAddressToString(address))
+            ,m_reconnectDelay(reconnectDelay)
+            ,m_connecting(false)
+            ,m_retryDelay(reconnectDelay)
+            ,m_sequenceNumber(0)
+            ,m_userValue(0)
+            ,m_destroyed(false)
+        {}
+
+        virtual ~NameServer() {}
+
+        // SearchSender
+
+        virtual void search(SearchInstance::shared_pointer const & channel) OVERRIDE FINAL
+        {
+            Lock guard(m_mutex);
+            // not connected, everything is searched again once connected
+            if (!m_transport)
+                return;
+            m_pending.push_back(std::make_pair(channel->getSearchInstanceID(), channel->getSearchInstanceName()));
+        }
+
+        virtual void flush() OVERRIDE FINAL
+        {
+            Transport::shared_pointer transport;
+            {
+                Lock guard(m_mutex);
+                if (m_pending.empty())
+                    return;
+                transport = m_transport;
+            }
+            if (transport)
+                transport->enqueueSendRequest(shared_from_this());
+        }
+
+        // TransportSender
+
+        virtual void send(ByteBuffer* buffer, TransportSendControl* control) OVERRIDE FINAL
+        {
+            pending_t pending;
+            {
+                Lock guard(m_mutex);
+                pending.swap(m_pending);
+            }
+
+            // replies come back over this connection, so no response address
+            osiSockAddr anyAddress;
+            memset(&anyAddress, 0, sizeof(anyAddress));
+            anyAddress.ia.sin_family = AF_INET;
+
+            for (size_t first = 0; first < pending.size(); first += MAX_BATCH)
+            {
+                const size_t count = std::min(pending.size() - first, size_t(MAX_BATCH));
+
+                control->startMessage(CMD_SEARCH, 4+1+3+16+2+1);
+
+                buffer->putInt(++m_sequenceNumber);
+                // no reply unless found
+                buffer->putByte((int8)0);
+                // reserved part
+                buffer->putByte((int8)0);
+                buffer->putShort((int16)0);
+                encodeAsIPv6Address(buffer, &anyAddress);
+                buffer->putShort((int16)0);
+
+                SerializeHelper::writeSize(1, buffer, control);
+                SerializeHelper::serializeString("tcp", buffer, control);
+
+                control->ensureBuffer(2);
+                buffer->putShort((int16)count);
+
+                for (size_t i = first; i < first + count; i++)
+                {
+                    control->ensureBuffer(4);
+                    buffer->putInt(pending[i].first);
+                    SerializeHelper::serializeString(pending[i].second, buffer, control);
+                }
+
+                control->endMessage();
+            }
+        }
+
+        // TimerCallback, start a (re)connect attempt
+
+        virtual void callback() OVERRIDE FINAL
+        {
+            {
+                Lock guard(m_mutex);
+                if (m_destroyed || m_transport || m_connecting)
+                    return;
+                m_connecting = true;
+            }
+
+            // connect() and validation block for several seconds if the server is unreachable.
+            // So not on the timer thread shared with the heartbeats and searches of the context.
+            epics::auto_ptr<shared_pointer> arg(new shared_pointer(shared_from_this()));
+            epicsThreadId tid = epicsThreadCreate("pvaNameServer", epicsThreadPriorityLow,
+                                                  epicsThreadGetStackSize(epicsThreadStackBig),
+                                                  &connectThread, arg.get());
+            if (tid)
+            {
+                arg.release(); // thread owns
+                return;
+            }
+
+            LOG(logLevelError, "Unable to start thread to connect to name server %s", m_name.c_str());
+            connectDone(Transport::shared_pointer());
+        }
+
+        static void connectThread(void *raw)
+        {
+            epics::auto_ptr<shared_pointer> self(static_cast<shared_pointer*>(raw));
+
+            Transport::shared_pointer transport;
+            {
+                // keeps the context alive only for the duration of one attempt,
+                // which the connect timeout and validation timeout bound.
+                InternalClientContextImpl::shared_pointer context((*self)->m_context.lock());
+                if (context)
+                    transport = context->getTransport(*self, &(*self)->m_address,
+                                                      PVA_PROTOCOL_REVISION, PVA_DEFAULT_PRIORITY);
+            }
+            (*self)->connectDone(transport);
+        }
+
+        void connectDone(const Transport::shared_pointer& transport)
+        {
+            InternalClientContextImpl::shared_pointer context(m_context.lock());
+            double delay = 0.0;
+            {
+                Lock guard(m_mutex);
+                m_connecting = false;
+                if (m_destroyed || !context)
+                {
+                    guard.unlock();
+                    if (transport)
+                        transport->release(m_id);
+                    return;
+                }
+                if (transport)
+                {
+                    m_transport = transport;
+                    m_retryDelay = m_reconnectDelay;
+                }
+                else
+                {
+                    delay = m_retryDelay;
+                    m_retryDelay = std::min(2.0*m_retryDelay, std::max(m_reconnectDelay, nameServerMaxReconnectDelay));
+                }
+            }
+
+            if (!transport)
+            {
+                LOG(logLevelDebug, "Unable to connect to name server %s, retrying in %f sec.",
+                    m_name.c_str(), delay);
+                context->getTimer()->scheduleAfterDelay(shared_from_this(), delay);
+                return;
+            }
+
+            // closed before we could notice
+            if (transport->isClosed())
+            {
+                transportClosed();
+                return;
+            }
+
+            LOG(logLevelDebug, "Connected to name server %s.", m_name.c_str());
+
+            // search again for all channels not yet found
+            context->getChannelSearchManager()->newServerDetected();
+        }
+
+        virtual void timerStopped() OVERRIDE FINAL {}
+
+        virtual void transportClosed() OVERRIDE FINAL
         {
-            return BaseRequestImpl::build<ChannelRPCImpl>(external_from_this(), requester, pvRequest);
+            {
+                Lock guard(m_mutex);
+                if (!m_transport)
+                    return;
+                m_transport.reset();
+                m_pending.clear();
+                if (m_destroyed)
+                    return;
+            }
+
+            InternalClientContextImpl::shared_pointer context(m_context.lock());
+            if (!context)
+                return;
+
+            LOG(logLevelDebug, "Lost connection to name server %s.", m_name.c_str());
+
+            TimerCallback::shared_pointer self(shared_from_this());
+            context->getTimer()->cancel(self);
+            context->getTimer()->scheduleAfterDelay(self, m_reconnectDelay);
         }
 
-        virtual Monitor::shared_pointer createMonitor(
-            MonitorRequester::shared_pointer const & requester,
-            epics::pvData::PVStructure::shared_pointer const & pvRequest) OVERRIDE FINAL
+        virtual void destroy() OVERRIDE FINAL
         {
-            return BaseRequestImpl::build<ChannelMonitorImpl>(external_from_this(), requester, pvRequest);
-        }
+            Transport::shared_pointer transport;
+            {
+                Lock guard(m_mutex);
+                if (m_destroyed)
+                    return;
+                m_destroyed = true;
+                transport.swap(m_transport);
+                m_pending.clear();
+            }
 
-        virtual ChannelArray::shared_pointer createChannelArray(
-            ChannelArrayRequester::shared_pointer const & requester,
-            epics::pvData::PVStructure::shared_pointer const & pvRequest) OVERRIDE FINAL
+            InternalClientContextImpl::shared_pointer context(m_context.lock());
+            if (context)
+                context->getTimer()->cancel(shared_from_this());
+
+            if (transport)
+                transport->release(m_id);
+        }
+
+        // ClientChannelImpl, mostly unused
+
+        virtual pvAccessID getChannelID() OVERRIDE FINAL { return m_id; }
+        virtual pvAccessID getID() OVERRIDE FINAL { return m_id; }
+        virtual pvAccessID getServerChannelID() OVERRIDE FINAL { return (pvAccessID)-1; }
+        virtual ClientContextImpl* getContext() OVERRIDE FINAL { return m_context.lock().get(); }
+        virtual void connectionCompleted(pvAccessID /*sid*/) OVERRIDE FINAL {}
+        virtual void createChannelFailed() OVERRIDE FINAL {}
+        virtual void channelDestroyedOnServer() OVERRIDE FINAL {}
+        virtual void registerResponseRequest(ResponseRequest::shared_pointer const & /*responseRequest*/) OVERRIDE FINAL {}
+        virtual void unregisterResponseRequest(pvAccessID /*ioid*/) OVERRIDE FINAL {}
+        virtual Transport::shared_pointer checkAndGetTransport() OVERRIDE FINAL { return getTransport(); }
+        virtual Transport::shared_pointer checkDestroyedAndGetTransport() OVERRIDE FINAL { return getTransport(); }
+        virtual Transport::shared_pointer getTransport() OVERRIDE FINAL
         {
-            return BaseRequestImpl::build<ChannelArrayImpl>(external_from_this(), requester, pvRequest);
+            Lock guard(m_mutex);
+            return m_transport;
         }
+        virtual void transportUnresponsive() OVERRIDE FINAL {}
+        virtual void transportChanged() OVERRIDE FINAL {}
+        virtual void transportResponsive(Transport::shared_pointer const & /*transport*/) OVERRIDE FINAL {}
+        virtual ClientChannelStats* getStatsCollector() OVERRIDE FINAL { return 0; }
 
-        virtual void printInfo(std::ostream& out) OVERRIDE FINAL {
-            //Lock lock(m_channelMutex);
+        virtual pvAccessID getSearchInstanceID() OVERRIDE FINAL { return m_id; }
+        virtual const std::string& getSearchInstanceName() OVERRIDE FINAL { return m_name; }
+        virtual int32_t& getUserValue() OVERRIDE FINAL { return m_userValue; }
+        virtual void searchResponse(const ServerGUID & /*guid*/, int8_t /*minorRevision*/, osiSockAddr* /*serverAddress*/) OVERRIDE FINAL {}
 
-            out << "CHANNEL  : " << m_name << std::endl;
-            out << "STATE    : " << ConnectionStateNames[m_connectionState] << std::endl;
-            if (m_connectionState == CONNECTED)
-            {
-                out << "ADDRESS  : " << getRemoteAddress() << std::endl;
-                //out << "RIGHTS   : " << getAccessRights() << std::endl;
-            }
-        }
+        virtual ChannelProvider::shared_pointer getProvider() OVERRIDE FINAL { return ChannelProvider::shared_pointer(); }
+        virtual std::string getRemoteAddress() OVERRIDE FINAL { return m_name; }
+        virtual std::string getChannelName() OVERRIDE FINAL { return m_name; }
+        virtual ChannelRequester::shared_pointer getChannelRequester() OVERRIDE FINAL { return ChannelRequester::shared_pointer(); }
     };
 
 
 
 
+
 public:
     static size_t num_instances;
 
     InternalClientContextImpl(const Configuration::shared_pointer& conf) :
         m_addressList(""), m_autoAddressList(true), m_connectionTimeout(30.0f), m_beaconPeriod(15.0f),
         m_broadcastPort(PVA_BROADCAST_PORT), m_receiveBufferSize(MAX_TCP_RECV),
+        m_maxBufferSize(MAX_TCP_BUFFER),
+        m_shareMonitors(false),
+        m_channelStats(false),
+        m_nameCacheSize(131072),
         m_lastCID(0), m_lastIOID(0),
         m_version("pvAccess Client", "cpp",
                   EPICS_PVA_MAJOR_VERSION,
@@ -4012,11 +5687,15 @@ public:
         return m_configuration;
     }
 
+    virtual std::size_t getMaxBufferSize() OVERRIDE FINAL {
+        return m_maxBufferSize;
+    }
+
     virtual const Version& getVersion() OVERRIDE FINAL {
         return m_version;
     }
 
-    virtual Timer::shared_pointer getTimer() OVERRIDE FINAL
+    virtual TimerWheel::shared_pointer getTimer() OVERRIDE FINAL
     {
         return m_timer;
     }
@@ -4031,6 +5710,21 @@ public:
         return m_searchTransport;
     }
 
+    bool isShareMonitors() const
+    {
+        return m_shareMonitors;
+    }
+
+    virtual bool isChannelStatsEnabled() const OVERRIDE FINAL
+    {
+        return m_channelStats;
+    }
+
+    NameCache::shared_pointer getNameCache() const
+    {
+        return m_nameCache;
+    }
+
     virtual void initialize() OVERRIDE FINAL {
         Lock lock(m_contextMutex);
 
@@ -4055,6 +5749,14 @@ public:
         out << "BEACON_PERIOD      : " << m_beaconPeriod << std::endl;
         out << "BROADCAST_PORT     : " << m_broadcastPort << std::endl;;
         out << "RCV_BUFFER_SIZE    : " << m_receiveBufferSize << std::endl;
+        out << "MAX_BUFFER_SIZE    : " << m_maxBufferSize << std::endl;
+        out << "SHARE_MONITORS     : " << (m_shareMonitors ? "true" : "false") << std::endl;
+        out << "CLIENT_STATS       : " << (m_channelStats ? "true" : "false") << std::endl;
+        out << "NAME_SERVERS       : " << m_nameServerList << std::endl;
+        out << "NAME_CACHE         : " << m_nameCachePath;
+        if (m_nameCache)
+            out << " (" << m_nameCache->getSize() << " entries)";
+        out << std::endl;
         out << "STATE              : ";
         switch (m_contextState)
         {
@@ -4070,6 +5772,29 @@ public:
         default:
             out << "UNKNOWN" << std::endl;
         }
+
+        if (m_channelStats)
+        {
+            lock.unlock();
+
+            std::vector<ClientChannelImpl::shared_pointer> channels;
+            {
+                Lock guard(m_cidMapMutex);
+                channels.reserve(m_channelsByCID.size());
+                for (CIDChannelMap::const_iterator it = m_channelsByCID.begin(); it != m_channelsByCID.end(); ++it)
+                {
+                    ClientChannelImpl::shared_pointer channel(it->second.lock());
+                    if (channel)
+                        channels.push_back(channel);
+                }
+            }
+
+            for (size_t i = 0; i < channels.size(); i++)
+            {
+                out << std::endl;
+                channels[i]->printInfo(out);
+            }
+        }
     }
 
     virtual void destroy() OVERRIDE FINAL
@@ -4092,6 +5817,14 @@ public:
 
         m_channelSearchManager->cancel();
 
+        // release name server connections
+        for (NameServers::const_iterator it = m_nameServers.begin(); it != m_nameServers.end(); ++it)
+        {
+            EXCEPTION_GUARD((*it)->destroy());
+            freeCID((*it)->getID());
+        }
+        m_nameServers.clear();
+
         // this will also close all PVA transports
         destroyAllChannels();
 
@@ -4147,12 +5880,24 @@ private:
         m_beaconPeriod = m_configuration->getPropertyAsFloat("EPICS_PVA_BEACON_PERIOD", m_beaconPeriod);
         m_broadcastPort = m_configuration->getPropertyAsInteger("EPICS_PVA_BROADCAST_PORT", m_broadcastPort);
         m_receiveBufferSize = m_configuration->getPropertyAsInteger("EPICS_PVA_MAX_ARRAY_BYTES", m_receiveBufferSize);
+        m_maxBufferSize = m_configuration->getPropertyAsInteger("EPICS_PVA_MAX_BUFFER_SIZE", m_maxBufferSize);
+        if(m_maxBufferSize<0)
+            m_maxBufferSize = 0;
+        m_shareMonitors = m_configuration->getPropertyAsBoolean("EPICS_PVA_SHARE_MONITORS", m_shareMonitors);
+        m_channelStats = m_configuration->getPropertyAsBoolean("EPICS_PVA_CLIENT_STATS", m_channelStats);
+        m_nameCachePath = m_configuration->getPropertyAsString("EPICS_PVA_NAME_CACHE", m_nameCachePath);
+        m_nameCacheSize = m_configuration->getPropertyAsInteger("EPICS_PVA_NAME_CACHE_SIZE", m_nameCacheSize);
+        m_nameServerList = m_configuration->getPropertyAsString("EPICS_PVA_NAME_SERVERS", m_nameServerList);
     }
 
     void internalInitialize() {
 
         osiSockAttach();
-        m_timer.reset(new Timer("pvAccess-client timer", lowPriority));
+        m_timer.reset(new TimerWheel("pvAccess-client timer", lowPriority));
+
+        if (!m_nameCachePath.empty())
+            m_nameCache = NameCache::open(m_nameCachePath, m_nameCacheSize > 0 ? size_t(m_nameCacheSize) : 1u);
+
         InternalClientContextImpl::shared_pointer thisPointer(internal_from_this());
         // stores weak_ptr
         m_connector.reset(new BlockingTCPConnector(thisPointer, m_receiveBufferSize, m_connectionTimeout));
@@ -4190,6 +5935,22 @@ private:
         // Starts timer
         m_channelSearchManager->activate();
 
+        // setup name server connections, also searched in addition to UDP
+        if (!m_nameServerList.empty())
+        {
+            InetAddrVector addresses;
+            getSocketAddressList(addresses, m_nameServerList, PVA_SERVER_PORT, NULL, true);
+
+            for (InetAddrVector::const_iterator it = addresses.begin(); it != addresses.end(); ++it)
+            {
+                NameServer::shared_pointer ns(new NameServer(thisPointer, generateCID(), *it, nameServerReconnectDelay));
+                m_nameServers.push_back(ns);
+                m_channelSearchManager->addSearchSender(ns);
+                // timer starts the first connection attempt
+                m_timer->scheduleAfterDelay(ns, 0.0);
+            }
+        }
+
         // TODO what if initialization failed!!!
     }
 
@@ -4288,6 +6049,25 @@ private:
         return m_lastCID;
     }
 
+    /**
+     * Generate several Client channel IDs (CID) at once.
+     * @param count number of IDs.
+     * @param cids appended with the new IDs.
+     */
+    void generateCIDs(size_t count, std::vector<pvAccessID>& cids)
+    {
+        cids.reserve(cids.size() + count);
+
+        Lock guard(m_cidMapMutex);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            while (m_channelsByCID.find(++m_lastCID) != m_channelsByCID.end()) ;
+            m_channelsByCID[m_lastCID].reset();
+            cids.push_back(m_lastCID);
+        }
+    }
+
     /**
      * Free generated channel ID (CID).
      */
@@ -4384,7 +6164,7 @@ private:
         if (it == m_beaconHandlers.end())
         {
             // stores weak_ptr
-            handler.reset(new BeaconHandler(internal_from_this(), responseFrom));
+            handler.reset(new BeaconHandler(internal_from_this(), responseFrom, m_nameCache));
             m_beaconHandlers[*responseFrom] = handler;
         }
         else
@@ -4485,10 +6265,51 @@ private:
      */
     int m_receiveBufferSize;
 
+    /**
+     * Limit on the growth of the buffers of each server connection.
+     */
+    int m_maxBufferSize;
+
+    /**
+     * Whether monitors with identical (channel, pvRequest) share one subscription.
+     */
+    bool m_shareMonitors;
+
+    /**
+     * Whether channels collect operation statistics.
+     */
+    bool m_channelStats;
+
+    /**
+     * File backing the persistent name resolution cache.  Empty to disable.
+     */
+    string m_nameCachePath;
+
+    /**
+     * Number of entries when creating a new name cache file.
+     */
+    int32 m_nameCacheSize;
+
+    /**
+     * Persistent name resolution cache, may be NULL.
+     */
+    NameCache::shared_pointer m_nameCache;
+
+    /**
+     * List of name servers (host[:port]) to also send searches to over TCP.
+     */
+    string m_nameServerList;
+
+    /**
+     * Name server connections.
+     */
+    typedef std::vector<NameServer::shared_pointer> NameServers;
+    NameServers m_nameServers;
+
     /**
      * Timer.
      */
-    Timer::shared_pointer m_timer;
+    TimerWheel::shared_pointer m_timer;
 
     /**
      * UDP transports needed to receive channel searches.
@@ -4750,6 +6571,325 @@ void InternalClientContextImpl::InternalChannelImpl::getField(GetFieldRequester:
     // activate() stores self in channel
 }
 
+/* One CMD_MULTI_GET or CMD_MULTI_PUT to one server,
+ * on behalf of ChannelProvider::getMany() or putMany().
+ * Holds a reference to itself until every entry is complete,
+ * or MULTI_REQUEST_CLIENT_TIMEOUT passes without a response.
+ */
+class ChannelMultiRequestImpl :
+    public ResponseRequest,
+    public TransportSender,
+    public TimerCallback,
+    public std::tr1::enable_shared_from_this<ChannelMultiRequestImpl>
+{
+public:
+    POINTER_DEFINITIONS(ChannelMultiRequestImpl);
+
+    const int8 m_command;
+    const ClientContextImpl::shared_pointer m_context;
+    const ChannelMultiRequester::shared_pointer m_requester;
+    const PVStructure::shared_pointer m_pvRequest;
+
+    // const after activate()
+    std::vector<size_t> m_indices;
+    // all share a Transport.  Each notifies us of disconnect.
+    std::vector<ClientChannelImpl::shared_pointer> m_channels;
+    std::vector<pvAccessID> m_sids;
+    std::vector<PVStructure::shared_pointer> m_values;
+    std::vector<BitSet::shared_pointer> m_changed;
+    pvAccessID m_ioid;
+
+    Mutex m_mutex;
+    // Note: this forms a reference loop, which is broken in complete()
+    shared_pointer m_self;
+
+    ChannelMultiRequestImpl(int8 command,
+                            ClientContextImpl::shared_pointer const & context,
+                            ChannelMultiRequester::shared_pointer const & requester,
+                            PVStructure::shared_pointer const & pvRequest) :
+        m_command(command),
+        m_context(context),
+        m_requester(requester),
+        m_pvRequest(pvRequest),
+        m_ioid(INVALID_IOID)
+    {}
+
+    virtual ~ChannelMultiRequestImpl() {}
+
+    void add(size_t index, ClientChannelImpl::shared_pointer const & channel,
+             PVStructure::shared_pointer const & value = PVStructure::shared_pointer(),
+             BitSet::shared_pointer const & changed = BitSet::shared_pointer())
+    {
+        m_indices.push_back(index);
+        m_channels.push_back(channel);
+        m_sids.push_back(channel->getServerChannelID());
+        if (m_command == CMD_MULTI_PUT)
+        {
+            m_values.push_back(value);
+            m_changed.push_back(changed);
+        }
+    }
+
+    void activate(Transport::shared_pointer const & transport)
+    {
+        shared_pointer self(shared_from_this());
+        {
+            Lock G(m_mutex);
+            m_self = self;
+        }
+        m_ioid = m_context->registerResponseRequest(self);
+        for (size_t i = 0; i < m_channels.size(); i++)
+            m_channels[i]->registerResponseRequest(self);
+
+        m_context->getTimer()->scheduleAfterDelay(self, MULTI_REQUEST_CLIENT_TIMEOUT);
+
+        transport->enqueueSendRequest(self);
+    }
+
+    // returns false if already complete
+    bool complete()
+    {
+        shared_pointer self;
+        {
+            Lock G(m_mutex);
+            if (!m_self)
+                return false;
+            self.swap(m_self);
+        }
+
+        m_context->getTimer()->cancel(self);
+        m_context->unregisterResponseRequest(m_ioid);
+        for (size_t i = 0; i < m_channels.size(); i++)
+            m_channels[i]->unregisterResponseRequest(m_ioid);
+        return true;
+    }
+
+    void fail(const Status& status)
+    {
+        if (!complete())
+            return;
+
+        for (size_t i = 0; i < m_indices.size(); i++)
+        {
+            if (m_command == CMD_MULTI_GET)
+                EXCEPTION_GUARD(m_requester->getManyDone(m_indices[i], status, PVStructure::shared_pointer(), BitSet::shared_pointer()));
+            else
+                EXCEPTION_GUARD(m_requester->putManyDone(m_indices[i], status));
+        }
+    }
+
+    // no response in time
+    virtual void callback() OVERRIDE FINAL {
+        fail(Status(Status::STATUSTYPE_ERROR, "Timeout"));
+    }
+
+    virtual void timerStopped() OVERRIDE FINAL {}
+
+    ChannelBaseRequester::shared_pointer getRequester() OVERRIDE FINAL {
+        return ChannelBaseRequester::shared_pointer();
+    }
+
+    pvAccessID getIOID() const OVERRIDE FINAL {
+        return m_ioid;
+    }
+
+    virtual void send(ByteBuffer* buffer, TransportSendControl* control) OVERRIDE FINAL {
+        control->startMessage(m_command, 5);
+        buffer->putInt(m_ioid);
+        buffer->putByte((int8)0);
+
+        SerializationHelper::serializePVRequest(buffer, control, m_pvRequest);
+
+        SerializeHelper::writeSize(m_sids.size(), buffer, control);
+        for (size_t i = 0; i < m_sids.size(); i++)
+        {
+            control->ensureBuffer(4);
+            buffer->putInt(m_sids[i]);
+            if (m_command == CMD_MULTI_PUT)
+            {
+                SerializationHelper::serializeStructureFull(buffer, control, m_values[i]);
+                m_changed[i]->serialize(buffer, control);
+            }
+        }
+    }
+
+    virtual void cancel() OVERRIDE FINAL {
+        fail(Status(Status::STATUSTYPE_ERROR, "Cancelled"));
+    }
+
+    virtual void timeout() OVERRIDE FINAL {
+        cancel();
+    }
+
+    void reportStatus(Channel::ConnectionState status) OVERRIDE FINAL {
+        if (status == Channel::DESTROYED)
+            fail(ClientChannelImpl::channelDestroyed);
+        else if (status == Channel::DISCONNECTED)
+            fail(ClientChannelImpl::channelDisconnected);
+    }
+
+    virtual void response(Transport::shared_pointer const & transport, int8 /*version*/, ByteBuffer* payloadBuffer) OVERRIDE FINAL {
+        transport->ensureData(1);
+        payloadBuffer->getByte(); // QoS
+
+        const size_t count = SerializeHelper::readSize(payloadBuffer, transport.get());
+        if (count != m_indices.size())
+        {
+            // can't parse the remainder
+            fail(Status(Status::STATUSTYPE_FATAL, "Malformed multi-channel response"));
+            return;
+        }
+
+        std::vector<Status> statuses(count);
+        std::vector<PVStructure::shared_pointer> values(m_command == CMD_MULTI_GET ? count : 0u);
+        std::vector<BitSet::shared_pointer> changed(values.size());
+
+        for (size_t i = 0; i < count; i++)
+        {
+            statuses[i].deserialize(payloadBuffer, transport.get());
+            if (m_command == CMD_MULTI_GET && statuses[i].isSuccess())
+            {
+                values[i] = SerializationHelper::deserializeStructureAndCreatePVStructure(payloadBuffer, transport.get());
+                changed[i].reset(new BitSet(values[i]->getNumberFields()));
+                changed[i]->deserialize(payloadBuffer, transport.get());
+                values[i]->deserialize(payloadBuffer, transport.get(), changed[i].get());
+            }
+        }
+
+        if (!complete())
+            return;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            if (m_command == CMD_MULTI_GET)
+                EXCEPTION_GUARD(m_requester->getManyDone(m_indices[i], statuses[i], values[i], changed[i]));
+            else
+                EXCEPTION_GUARD(m_requester->putManyDone(m_indices[i], statuses[i]));
+        }
+    }
+};
+
+// Forwards results for the channels handled by the per-channel implementation to their positions in the full request.
+struct MultiFallbackRequester : public ChannelMultiRequester
+{
+    const ChannelMultiRequester::shared_pointer requester;
+    std::vector<size_t> indices;
+
+    MultiFallbackRequester(ChannelMultiRequester::shared_pointer const & requester) :requester(requester) {}
+    virtual ~MultiFallbackRequester() {}
+
+    virtual std::string getRequesterName() OVERRIDE FINAL { return requester->getRequesterName(); }
+
+    virtual void getManyDone(size_t index, const Status& status,
+                             PVStructure::shared_pointer const & value,
+                             BitSet::shared_pointer const & changed) OVERRIDE FINAL
+    {
+        requester->getManyDone(indices.at(index), status, value, changed);
+    }
+
+    virtual void putManyDone(size_t index, const Status& status) OVERRIDE FINAL
+    {
+        requester->putManyDone(indices.at(index), status);
+    }
+};
+
+void InternalClientContextImpl::getMany(std::vector<Channel::shared_pointer> const & channels,
+                                        PVStructure::shared_pointer const & pvRequest,
+                                        ChannelMultiRequester::shared_pointer const & requester)
+{
+    multiRequest(CMD_MULTI_GET, channels, pvRequest,
+                 std::vector<PVStructure::shared_pointer>(), std::vector<BitSet::shared_pointer>(),
+                 requester);
+}
+
+void InternalClientContextImpl::putMany(std::vector<Channel::shared_pointer> const & channels,
+                                        PVStructure::shared_pointer const & pvRequest,
+                                        std::vector<PVStructure::shared_pointer> const & values,
+                                        std::vector<BitSet::shared_pointer> const & changed,
+                                        ChannelMultiRequester::shared_pointer const & requester)
+{
+    if (values.size() != channels.size() || (!changed.empty() && changed.size() != channels.size()))
+        throw std::logic_error("putMany() requires one value, and optionally one BitSet, per channel");
+
+    multiRequest(CMD_MULTI_PUT, channels, pvRequest, values, changed, requester);
+}
+
+void InternalClientContextImpl::multiRequest(int8 command,
+                                             std::vector<Channel::shared_pointer> const & channels,
+                                             PVStructure::shared_pointer const & pvRequest,
+                                             std::vector<PVStructure::shared_pointer> const & values,
+                                             std::vector<BitSet::shared_pointer> const & changed,
+                                             ChannelMultiRequester::shared_pointer const & requester)
+{
+    if (!requester)
+        throw std::runtime_error("0 requester");
+
+    checkState();
+
+    const bool put = command == CMD_MULTI_PUT;
+
+    typedef std::map<Transport::shared_pointer, ChannelMultiRequestImpl::shared_pointer> requests_t;
+    requests_t requests;
+
+    std::tr1::shared_ptr<MultiFallbackRequester> fallback(new MultiFallbackRequester(requester));
+    std::vector<Channel::shared_pointer> fallbackChannels;
+    std::vector<PVStructure::shared_pointer> fallbackValues;
+    std::vector<BitSet::shared_pointer> fallbackChanged;
+
+    for (size_t i = 0; i < channels.size(); i++)
+    {
+        ClientChannelImpl::shared_pointer chan(dynamic_pointer_cast<ClientChannelImpl>(channels[i]));
+
+        Transport::shared_pointer transport;
+        if (chan && chan->getContext() == this && chan->getConnectionState() == Channel::CONNECTED)
+            transport = chan->getTransport();
+
+        if (transport && (!put || values[i]) &&
+                (static_cast<epics::pvAccess::detail::BlockingClientTCPTransportCodec*>(transport.get())->getServerFeatures() & SERVER_FEATURE_MULTI_REQUEST))
+        {
+            ChannelMultiRequestImpl::shared_pointer& req = requests[transport];
+            if (!req)
+                req.reset(new ChannelMultiRequestImpl(command, internal_from_this(), requester, pvRequest));
+
+            if (put)
+            {
+                BitSet::shared_pointer mask(changed.empty() ? BitSet::shared_pointer() : changed[i]);
+                if (!mask)
+                {
+                    mask.reset(new BitSet);
+                    mask->set(0);
+                }
+                req->add(i, chan, values[i], mask);
+            }
+            else
+            {
+                req->add(i, chan);
+            }
+        }
+        else
+        {
+            // not connected, an older server, or a channel of another provider
+            fallback->indices.push_back(i);
+            fallbackChannels.push_back(channels[i]);
+            if (put)
+            {
+                fallbackValues.push_back(values[i]);
+                fallbackChanged.push_back(changed.empty() ? BitSet::shared_pointer() : changed[i]);
+            }
+        }
+    }
+
+    for (requests_t::iterator it(requests.begin()), end(requests.end()); it != end; ++it)
+        it->second->activate(it->first);
+
+    if (fallbackChannels.empty())
+        return;
+    else if (put)
+        ChannelProvider::putMany(fallbackChannels, pvRequest, fallbackValues, fallbackChanged, fallback);
+    else
+        ChannelProvider::getMany(fallbackChannels, pvRequest, fallback);
+}
+
 void InternalClientContextImpl::InternalChannelImpl::resubscribeSubscriptions()
 {
     Lock guard(m_responseRequestsMutex);
@@ -4786,6 +6926,7 @@ ChannelProvider::shared_pointer createClientProvider(const Configuration::shared
     registerRefCounter("InternalChannelImpl (Active)", &InternalClientContextImpl::InternalChannelImpl::num_active);
     registerRefCounter("BaseRequestImpl", &BaseRequestImpl::num_instances);
     registerRefCounter("BaseRequestImpl (Active)", &BaseRequestImpl::num_active);
+    registerRefCounter("MonitorMux", &MonitorMux::num_instances);
     InternalClientContextImpl::shared_pointer internal(new InternalClientContextImpl(conf)),
                                               external(internal.get(), epics::pvAccess::Destroyable::cleaner(internal));
     const_cast<InternalClientContextImpl::weak_pointer&>(internal->m_external_this) = external;
@@ -12,6 +12,9 @@
 #   undef epicsExportSharedSymbols
 #endif
 
+#include <epicsMutex.h>
+#include <epicsTime.h>
+
 #include <pv/sharedPtr.h>
 
 #ifdef clientContextImplEpicsExportSharedSymbols
@@ -32,6 +35,44 @@ namespace pvAccess {
 class BeaconHandler;
 class ClientContextImpl;
 
+/**
+ * Accumulates the Channel::Stats of one channel.
+ * Present only when enabled by $EPICS_PVA_CLIENT_STATS
+ */
+class ClientChannelStats
+{
+public:
+    ClientChannelStats();
+
+    //! Reply to a get (put==false) or put request
+    //! @param sent When the request was sent
+    //! @param received When the reply was received
+    //! @param decoded When the reply had been deserialized
+    void response(bool put,
+                  const epicsTimeStamp& sent,
+                  const epicsTimeStamp& received,
+                  const epicsTimeStamp& decoded);
+    //! Monitor update
+    //! @param previous When the previous update of the same subscription was received, or NULL
+    void update(const epicsTimeStamp* previous,
+                const epicsTimeStamp& received,
+                const epicsTimeStamp& decoded);
+    //! Payload of any reply or update
+    void received(size_t nbytes);
+    void overrun();
+
+    void get(Channel::Stats& s) const;
+
+private:
+    mutable epicsMutex mutex;
+    Channel::Stats stats;
+    // running mean and sum of squared differences of update intervals
+    size_t nintervals;
+    double intervalMean, intervalM2;
+
+    EPICS_NOT_COPYABLE(ClientChannelStats)
+};
+
 class ClientChannelImpl :
     public Channel,
     public TransportSender,
@@ -57,6 +98,8 @@ public:
     virtual void transportChanged() =0;
     virtual void transportClosed() =0;
     virtual void transportResponsive(Transport::shared_pointer const & /*transport*/) =0;
+    //! NULL unless statistics are enabled
+    virtual ClientChannelStats* getStatsCollector() =0;
 
     static epics::pvData::Status channelDestroyed;
     static epics::pvData::Status channelDisconnected;
@@ -91,6 +134,9 @@ public:
     virtual void printInfo(std::ostream& out) = 0;
 
 
+    //! $EPICS_PVA_CLIENT_STATS
+    virtual bool isChannelStatsEnabled() const = 0;
+
     virtual ChannelSearchManager::shared_pointer getChannelSearchManager() = 0;
     virtual void checkChannelName(std::string const & name) = 0;
 
@@ -105,14 +105,14 @@ void BeaconEmitter::timerStopped()
 
 void BeaconEmitter::destroy()
 {
-    Timer::shared_pointer timer(_timer.lock());
+    TimerWheel::shared_pointer timer(_timer.lock());
     if(timer)
         timer->cancel(shared_from_this());
 }
 
 void BeaconEmitter::start()
 {
-    Timer::shared_pointer timer(_timer.lock());
+    TimerWheel::shared_pointer timer(_timer.lock());
     if(timer)
         timer->scheduleAfterDelay(shared_from_this(), 0.0);
 }
@@ -122,7 +122,7 @@ void BeaconEmitter::reschedule()
     const double period = (_beaconSequenceID >= _beaconCountLimit) ? _slowBeaconPeriod : _fastBeaconPeriod;
     if (period > 0)
     {
-        Timer::shared_pointer timer(_timer.lock());
+        TimerWheel::shared_pointer timer(_timer.lock());
         if(timer)
             timer->scheduleAfterDelay(shared_from_this(), period);
     }
@@ -0,0 +1,575 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <map>
+#include <vector>
+
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+#include <epicsTime.h>
+
+#include <pv/sharedPtr.h>
+#include <pv/sharedVector.h>
+#include <pv/pvData.h>
+#include <pv/bitSet.h>
+#include <pv/createRequest.h>
+#include <pv/status.h>
+#include <pv/reftrack.h>
+
+#define epicsExportSharedSymbols
+#include "pva/gateway.h"
+#include "pva/sharedstate.h"
+#include "pv/pvAccess.h"
+#include "pv/logger.h"
+#include "pv/timerWheel.h"
+
+namespace pvd = epics::pvData;
+namespace pva = epics::pvAccess;
+
+typedef epicsGuard<epicsMutex> Guard;
+typedef epicsGuardRelease<epicsMutex> UnGuard;
+
+namespace pvas {
+
+namespace {
+
+// Forward one downstream Put or RPC upstream, and complete() it when done.
+// Owns itself until the upstream operation completes.
+struct GWOp : public pvac::ClientChannel::PutCallback,
+              public pvac::ClientChannel::GetCallback
+{
+    POINTER_DEFINITIONS(GWOp);
+
+    Operation op;
+
+    epicsMutex mutex;
+    shared_pointer self;
+    pvac::Operation upstream;
+
+    explicit GWOp(const Operation& op) :op(op) {}
+    virtual ~GWOp() {}
+
+    static void start(const Operation& op, pvac::ClientChannel& chan, bool rpc)
+    {
+        shared_pointer P(new GWOp(op));
+        P->self = P;
+
+        pvac::Operation up;
+        if(rpc) {
+            pvd::PVStructurePtr args(pvd::getPVDataCreate()->createPVStructure(op.value().getStructure()));
+            args->copyUnchecked(op.value());
+            up = chan.rpc(P.get(), args);
+        } else {
+            up = chan.put(P.get());
+        }
+
+        Guard G(P->mutex);
+        if(P->self)
+            P->upstream = up;
+        // else completed while starting
+    }
+
+    void done()
+    {
+        shared_pointer keep;
+        pvac::Operation up;
+        {
+            Guard G(mutex);
+            keep.swap(self);
+            up = upstream;
+            upstream = pvac::Operation();
+        }
+        // 'up' destroyed before 'keep', which may free this
+    }
+
+    void complete(const pvac::PutEvent& evt)
+    {
+        switch(evt.event) {
+        case pvac::PutEvent::Success:
+            op.complete();
+            break;
+        case pvac::PutEvent::Fail:
+            op.complete(pvd::Status::error(evt.message));
+            break;
+        case pvac::PutEvent::Cancel:
+            op.complete(pvd::Status::error("Upstream operation cancelled"));
+            break;
+        }
+    }
+
+    virtual void putBuild(const epics::pvData::StructureConstPtr& build, Args& args) OVERRIDE FINAL
+    {
+        pvd::PVStructurePtr root(pvd::getPVDataCreate()->createPVStructure(build));
+        root->copy(op.value()); // throws if upstream type changed
+        args.root = root;
+        args.tosend = op.changed();
+    }
+
+    virtual void putDone(const pvac::PutEvent& evt) OVERRIDE FINAL
+    {
+        complete(evt);
+        done();
+    }
+
+    virtual void getDone(const pvac::GetEvent& evt) OVERRIDE FINAL
+    {
+        if(evt.event==pvac::GetEvent::Success) {
+            if(evt.valid)
+                op.complete(*evt.value, *evt.valid);
+            else
+                op.complete(*evt.value, pvd::BitSet().set(0));
+        } else {
+            complete(evt);
+        }
+        done();
+    }
+};
+
+// A no-op getField() request.  Marks a new downstream Channel as connected
+// so that a following Get is served, and so onLastDisconnect() will be called.
+struct GWPrimer : public pva::GetFieldRequester
+{
+    POINTER_DEFINITIONS(GWPrimer);
+    virtual ~GWPrimer() {}
+    virtual std::string getRequesterName() OVERRIDE FINAL { return "GatewayProvider"; }
+    virtual void getDone(const pvd::Status& status, pvd::FieldConstPtr const & field) OVERRIDE FINAL {}
+};
+
+// One upstream channel, and the SharedPV through which it is served
+struct GWChannel : public pvac::ClientChannel::ConnectCallback,
+                   public pvac::ClientChannel::MonitorCallback
+{
+    POINTER_DEFINITIONS(GWChannel);
+
+    const std::string name;
+    pvac::ClientChannel upstream;
+    SharedPV::shared_pointer pv; // const after ctor
+    const GWPrimer::shared_pointer primer;
+
+    mutable epicsMutex mutex;
+    bool connected; // upstream
+    bool active; // has downstream clients
+    bool idle; // was not active at the last periodic sweep
+    pvac::Monitor sub;
+    size_t updates;
+
+    // serialize draining of 'sub' into 'pv'
+    epicsMutex pollLock;
+    pvd::StructureConstPtr type; // guarded by pollLock
+
+    GWChannel(const std::string& name, pvac::ClientProvider& provider)
+        :name(name)
+        ,upstream(provider.connect(name))
+        ,primer(new GWPrimer)
+        ,connected(false)
+        ,active(false)
+        ,idle(false)
+        ,updates(0u)
+    {}
+    virtual ~GWChannel()
+    {
+        upstream.removeConnectListener(this);
+        pvac::Monitor temp;
+        {
+            Guard G(mutex);
+            temp = sub;
+            sub = pvac::Monitor();
+        }
+        temp.cancel();
+    }
+
+    bool isConnected() const
+    {
+        Guard G(mutex);
+        return connected;
+    }
+
+    virtual void connectEvent(const pvac::ConnectEvent& evt) OVERRIDE FINAL
+    {
+        Guard G(mutex);
+        connected = evt.connected;
+    }
+
+    virtual void monitorEvent(const pvac::MonitorEvent& evt) OVERRIDE FINAL
+    {
+        switch(evt.event) {
+        case pvac::MonitorEvent::Data:
+            drain();
+            break;
+        case pvac::MonitorEvent::Fail:
+            LOG(pva::logLevelWarn, "Gateway upstream subscription to '%s' fails: %s", name.c_str(), evt.message.c_str());
+            // fall through
+        case pvac::MonitorEvent::Disconnect:
+        {
+            Guard P(pollLock);
+            type.reset();
+            pv->close();
+        }
+            break;
+        case pvac::MonitorEvent::Cancel:
+            break;
+        }
+    }
+
+    void drain()
+    {
+        Guard P(pollLock);
+
+        pvac::Monitor mon;
+        {
+            Guard G(mutex);
+            mon = sub;
+        }
+        if(!mon)
+            return;
+
+        try {
+            while(mon.poll()) {
+                {
+                    Guard G(mutex);
+                    updates++;
+                }
+                if(type!=mon.root->getStructure()) {
+                    // first update, or type change on reconnect
+                    if(pv->isOpen())
+                        pv->close();
+                    pv->open(*mon.root, mon.changed);
+                    type = mon.root->getStructure();
+                } else {
+                    pv->post(*mon.root, mon.changed);
+                }
+            }
+        }catch(std::exception& e){
+            LOG(pva::logLevelError, "Gateway unable to forward update for '%s': %s", name.c_str(), e.what());
+        }
+    }
+
+    // start upstream subscription on first downstream client
+    void start()
+    {
+        {
+            Guard G(mutex);
+            active = true;
+            if(sub)
+                return;
+        }
+
+        pvac::Monitor temp(upstream.monitor(this));
+        {
+            Guard G(mutex);
+            if(active && !sub) {
+                sub = temp;
+                temp = pvac::Monitor();
+            }
+        }
+        if(temp) {
+            // lost race with stop()
+            temp.cancel();
+        } else {
+            // Data events are not repeated, so catch any which arrived before 'sub' was set.
+            drain();
+        }
+    }
+
+    // cancel upstream subscription after last downstream client disconnects
+    void stop()
+    {
+        pvac::Monitor temp;
+        {
+            Guard G(mutex);
+            active = false;
+            temp = sub;
+            sub = pvac::Monitor();
+        }
+        temp.cancel();
+
+        Guard P(pollLock);
+        type.reset();
+        pv->close();
+    }
+};
+
+struct GWHandler : public SharedPV::Handler
+{
+    const std::tr1::weak_ptr<GWChannel> channel;
+
+    explicit GWHandler(const GWChannel::shared_pointer& channel) :channel(channel) {}
+    virtual ~GWHandler() {}
+
+    virtual void onFirstConnect(const SharedPV::shared_pointer& pv) OVERRIDE FINAL
+    {
+        GWChannel::shared_pointer chan(channel.lock());
+        if(chan)
+            chan->start();
+    }
+    virtual void onLastDisconnect(const SharedPV::shared_pointer& pv) OVERRIDE FINAL
+    {
+        GWChannel::shared_pointer chan(channel.lock());
+        if(chan)
+            chan->stop();
+    }
+    virtual void onPut(const SharedPV::shared_pointer& pv, Operation& op) OVERRIDE FINAL
+    {
+        GWChannel::shared_pointer chan(channel.lock());
+        if(chan)
+            GWOp::start(op, chan->upstream, false);
+        else
+            op.complete(pvd::Status::error("Gateway channel closed"));
+    }
+    virtual void onRPC(const SharedPV::shared_pointer& pv, Operation& op) OVERRIDE FINAL
+    {
+        GWChannel::shared_pointer chan(channel.lock());
+        if(chan)
+            GWOp::start(op, chan->upstream, true);
+        else
+            op.complete(pvd::Status::error("Gateway channel closed"));
+    }
+};
+
+} // namespace
+
+struct GatewayProvider::Impl : public DynamicProvider::Handler
+{
+    POINTER_DEFINITIONS(Impl);
+
+    static size_t num_instances;
+
+    pvac::ClientProvider upstream;
+
+    mutable epicsMutex mutex;
+
+    typedef std::map<std::string, GWChannel::shared_pointer> channels_t;
+    channels_t channels;
+
+    // token bucket limiting the creation of upstream channels
+    const double createRate, createBurst;
+    double tokens;
+    epicsTime lastRefill;
+
+    size_t throttled, expired;
+
+    // runs the periodic sweep
+    pva::TimerWheel timer;
+
+    struct Sweeper : public pvd::TimerCallback
+    {
+        const std::tr1::weak_ptr<Impl> impl;
+        explicit Sweeper(const Impl::shared_pointer& impl) :impl(impl) {}
+        virtual ~Sweeper() {}
+        virtual void callback() OVERRIDE FINAL
+        {
+            Impl::shared_pointer I(impl.lock());
+            if(I)
+                I->sweep(false);
+        }
+        virtual void timerStopped() OVERRIDE FINAL {}
+    };
+
+    Impl(const pvac::ClientProvider& upstream, double createRate)
+        :upstream(upstream)
+        ,createRate(createRate>0.0 ? createRate : 0.0)
+        ,createBurst(createRate>0.0 ? 10.0*createRate : 0.0)
+        ,tokens(createBurst)
+        ,lastRefill(epicsTime::getCurrent())
+        ,throttled(0u)
+        ,expired(0u)
+        ,timer("gwSweep", pvd::lowPriority, 1.0)
+    {
+        REFTRACE_INCREMENT(num_instances);
+    }
+    virtual ~Impl() {
+        REFTRACE_DECREMENT(num_instances);
+    }
+
+    // may a new upstream channel be created?  caller must hold mutex
+    bool takeToken()
+    {
+        if(createRate<=0.0)
+            return true; // no limit
+
+        epicsTime now(epicsTime::getCurrent());
+        tokens += (now - lastRefill)*createRate;
+        if(tokens > createBurst)
+            tokens = createBurst;
+        lastRefill = now;
+
+        if(tokens < 1.0) {
+            throttled++;
+            return false;
+        }
+        tokens -= 1.0;
+        return true;
+    }
+
+    /* Forget inactive channels.  With all=false, only those which were already
+     * inactive at the last call.
+     */
+    size_t sweep(bool all)
+    {
+        std::vector<GWChannel::shared_pointer> victims;
+        {
+            Guard G(mutex);
+            for(channels_t::iterator it(channels.begin()), end(channels.end()); it!=end;)
+            {
+                channels_t::iterator cur(it++);
+                GWChannel& chan = *cur->second;
+                bool remove;
+                {
+                    Guard G2(chan.mutex);
+                    remove = !chan.active && (all || chan.idle);
+                    chan.idle = !chan.active;
+                }
+                if(remove) {
+                    victims.push_back(cur->second);
+                    channels.erase(cur);
+                }
+            }
+            if(!all)
+                expired += victims.size();
+        }
+        for(size_t i=0; i<victims.size(); i++) {
+            victims[i]->pv->close(true);
+            upstream.disconnect(victims[i]->name);
+        }
+        return victims.size();
+    }
+
+    GWChannel::shared_pointer lookup(const std::string& name, bool create)
+    {
+        GWChannel::shared_pointer ret;
+        {
+            Guard G(mutex);
+            channels_t::const_iterator it(channels.find(name));
+            if(it!=channels.end())
+                return it->second;
+            else if(!create || !takeToken())
+                return ret;
+        }
+
+        ret.reset(new GWChannel(name, upstream));
+        SharedPV::Handler::shared_pointer handler(new GWHandler(ret));
+        ret->pv = SharedPV::build(handler);
+
+        {
+            Guard G(mutex);
+            std::pair<channels_t::iterator, bool> ins(channels.insert(std::make_pair(name, ret)));
+            if(!ins.second)
+                return ins.first->second; // lost race, discard ours
+        }
+        // may call connectEvent() immediately
+        ret->upstream.addConnectListener(ret.get());
+        return ret;
+    }
+
+    virtual void hasChannels(search_type& names) OVERRIDE FINAL
+    {
+        for(search_type::iterator it(names.begin()), end(names.end()); it!=end; ++it)
+        {
+            GWChannel::shared_pointer chan(lookup(it->name(), true));
+            if(chan && chan->isConnected())
+                it->claim();
+        }
+    }
+
+    virtual void listChannels(names_type& names, bool& dynamic) OVERRIDE FINAL
+    {
+        Guard G(mutex);
+        names.reserve(channels.size());
+        for(channels_t::const_iterator it(channels.begin()), end(channels.end()); it!=end; ++it)
+            names.push_back(it->first);
+    }
+
+    virtual std::tr1::shared_ptr<epics::pvAccess::Channel> createChannel(const std::tr1::shared_ptr<epics::pvAccess::ChannelProvider>& provider,
+                                                                         const std::string& name,
+                                                                         const std::tr1::shared_ptr<epics::pvAccess::ChannelRequester>& requester) OVERRIDE FINAL
+    {
+        pva::Channel::shared_pointer ret;
+        GWChannel::shared_pointer chan(lookup(name, false));
+        if(chan) {
+            ret = chan->pv->connect(provider, name, requester);
+            // SharedPV only counts a client as connected after a getField, Put, or Monitor.
+            // Treat every Channel as connected so that Get completes from the cache,
+            // and the upstream subscription ends with the last downstream Channel.
+            if(ret)
+                ret->getField(chan->primer, std::string());
+        }
+        return ret;
+    }
+
+    virtual void destroy() OVERRIDE FINAL
+    {
+        channels_t temp;
+        {
+            Guard G(mutex);
+            temp.swap(channels);
+        }
+        for(channels_t::iterator it(temp.begin()), end(temp.end()); it!=end; ++it)
+            it->second->pv->close(true);
+    }
+};
+
+size_t GatewayProvider::Impl::num_instances;
+
+GatewayProvider::Stats::Stats()
+    :channels(0u)
+    ,subscriptions(0u)
+    ,upstreamUpdates(0u)
+    ,throttled(0u)
+    ,expired(0u)
+{}
+
+GatewayProvider::GatewayProvider(const std::string& name,
+                                 const pvac::ClientProvider& upstream,
+                                 double sweepPeriod,
+                                 double maxCreateRate)
+    :impl(new Impl(upstream, maxCreateRate))
+    ,dynamic(new DynamicProvider(name, impl))
+{
+    if(sweepPeriod>0.0) {
+        pvd::TimerCallbackPtr sweeper(new Impl::Sweeper(impl));
+        impl->timer.schedulePeriodic(sweeper, sweepPeriod, sweepPeriod);
+    }
+}
+
+GatewayProvider::~GatewayProvider()
+{
+    // join the sweep thread, which may otherwise hold the last reference to impl
+    impl->timer.close();
+}
+
+std::tr1::shared_ptr<epics::pvAccess::ChannelProvider> GatewayProvider::provider() const
+{
+    return dynamic->provider();
+}
+
+void GatewayProvider::stats(Stats& ret) const
+{
+    ret = Stats();
+
+    Guard G(impl->mutex);
+    ret.channels = impl->channels.size();
+    ret.throttled = impl->throttled;
+    ret.expired = impl->expired;
+    for(Impl::channels_t::const_iterator it(impl->channels.begin()), end(impl->channels.end()); it!=end; ++it)
+    {
+        const GWChannel& chan = *it->second;
+        Guard G2(chan.mutex);
+        if(chan.sub)
+            ret.subscriptions++;
+        ret.upstreamUpdates += chan.updates;
+    }
+}
+
+size_t GatewayProvider::sweep()
+{
+    return impl->sweep(true);
+}
+
+void registerRefTrackGateway()
+{
+    epics::registerRefCounter("pvas::GatewayProvider", &GatewayProvider::Impl::num_instances);
+}
+
+} // namespace pvas
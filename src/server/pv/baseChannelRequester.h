@@ -48,7 +48,7 @@ protected:
     const pvAccessID _ioid;
     const Transport::shared_pointer _transport;
     const std::tr1::shared_ptr<ServerChannel> _channel;
-    epics::pvData::Mutex _mutex;
+    mutable epics::pvData::Mutex _mutex;
 private:
     ServerContextImpl::shared_pointer _context;
     static const epics::pvData::int32 NULL_REQUEST;
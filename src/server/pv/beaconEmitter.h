@@ -146,7 +146,7 @@ private:
      *  We will also be queuing ourselves, and be referenced by Timer.
      *  So keep only a weak ref to Timer to avoid possible ref. loop.
      */
-    epics::pvData::Timer::weak_pointer _timer;
+    TimerWheel::weak_pointer _timer;
 };
 
 }
@@ -8,6 +8,8 @@
 #define RESPONSEHANDLERS_H_
 
 #include <list>
+#include <deque>
+#include <vector>
 
 #include <pv/timer.h>
 
@@ -141,7 +143,8 @@ public:
     virtual ~ServerChannelFindRequesterImpl() {}
     void clear();
     ServerChannelFindRequesterImpl* set(std::string _name, epics::pvData::int32 searchSequenceId,
-                                        epics::pvData::int32 cid, osiSockAddr const & sendTo, bool responseRequired, bool serverSearch);
+                                        epics::pvData::int32 cid, osiSockAddr const & sendTo, bool responseRequired, bool serverSearch,
+                                        Transport::shared_pointer const & transport = Transport::shared_pointer());
     virtual void channelFindResult(const epics::pvData::Status& status, ChannelFind::shared_pointer const & channelFind, bool wasFound) OVERRIDE FINAL;
 
     virtual std::tr1::shared_ptr<const PeerInfo> getPeerInfo() OVERRIDE FINAL;
@@ -156,6 +159,8 @@ private:
     epics::pvData::int32 _searchSequenceId;
     epics::pvData::int32 _cid;
     osiSockAddr _sendTo;
+    // reply over this (TCP) connection instead of UDP
+    Transport::shared_pointer _transport;
     bool _responseRequired;
     bool _wasFound;
     const ServerContextImpl::shared_pointer _context;
@@ -311,12 +316,15 @@ public:
     virtual std::tr1::shared_ptr<ChannelRequest> getOperation() OVERRIDE FINAL { return getChannelGet(); }
 
     virtual void send(epics::pvData::ByteBuffer* buffer, TransportSendControl* control) OVERRIDE FINAL;
+    virtual SendPriority getSendPriority() const OVERRIDE FINAL;
 private:
     // Note: this forms a reference loop, which is broken in destroy()
     ChannelGet::shared_pointer _channelGet;
     epics::pvData::PVStructure::shared_pointer _pvStructure;
     epics::pvData::BitSet::shared_pointer _bitSet;
     epics::pvData::Status _status;
+    // structure may carry arrays.  set by channelGetConnect(), guarded by _mutex
+    bool _bulk;
 };
 
 
@@ -371,12 +379,46 @@ public:
     epics::pvData::BitSet::shared_pointer getPutBitSet();
     epics::pvData::PVStructure::shared_pointer getPutPVStructure();
     void send(epics::pvData::ByteBuffer* buffer, TransportSendControl* control);
+
+    // with pipeline=true, puts are queued and replied to in order
+    bool isPipelined() const { return _window>1u; }
+    // any put not yet replied to
+    bool putsPending();
+    // take a container for one more put, or false if the window is full
+    bool reservePut(epics::pvData::PVStructure::shared_pointer& value,
+                    epics::pvData::BitSet::shared_pointer& changed);
+    void queuePut(epics::pvData::int8 qos,
+                  epics::pvData::PVStructure::shared_pointer const & value,
+                  epics::pvData::BitSet::shared_pointer const & changed);
 private:
+    // issue queued puts to _channelPut one at a time
+    void runPuts();
+
     // Note: this forms a reference loop, which is broken in destroy()
     ChannelPut::shared_pointer _channelPut;
     epics::pvData::BitSet::shared_pointer _bitSet;
     epics::pvData::PVStructure::shared_pointer _pvStructure;
     epics::pvData::Status _status;
+
+    // when _window>1
+    struct PendingPut {
+        epics::pvData::PVStructure::shared_pointer value;
+        epics::pvData::BitSet::shared_pointer changed;
+        epics::pvData::int8 qos;
+        PendingPut() :qos(0) {}
+    };
+    typedef std::pair<epics::pvData::int8, epics::pvData::Status> put_result_t;
+    size_t _window; // const after activate()
+    // reserved, and not yet replied to
+    size_t _putsOutstanding;
+    // received, waiting for the previous put() to complete
+    std::deque<PendingPut> _puts;
+    // completed, waiting to be sent
+    std::deque<put_result_t> _putResults;
+    // containers for re-use
+    std::vector<PendingPut> _putsFree;
+    PendingPut _putCurrent;
+    bool _putActive, _putRunning;
 };
 
 /****************************************************************************************/
@@ -497,8 +539,44 @@ public:
     virtual std::tr1::shared_ptr<ChannelRequest> getOperation() OVERRIDE FINAL { return std::tr1::shared_ptr<ChannelRequest>(); }
 
     virtual void send(epics::pvData::ByteBuffer* buffer, TransportSendControl* control) OVERRIDE FINAL;
-    void ack(size_t cnt);
+    virtual SendPriority getSendPriority() const OVERRIDE FINAL;
+    //! @param rate drain rate reported by an adaptive client, or zero.
+    void ack(size_t cnt, double rate =0.0);
+
+    //! Flow control state of a pipeline=true subscription
+    struct FlowStats {
+        bool pipeline;
+        size_t window;      //!< # of updates which the client has room for
+        size_t inflight;    //!< # of updates sent, but not acknowledged
+        size_t limit;       //!< adaptive limit on inflight, or zero if none
+        double ackLatency;  //!< average time in seconds from send to ack
+        double clientRate;  //!< last drain rate reported by the client
+        size_t nheld;       //!< # of times an update was held back by flow control
+        size_t nsent;       //!< # of updates sent
+        size_t noverrun;    //!< # of updates squashed in the server queue
+    };
+    void getFlowStats(FlowStats& s);
 private:
+    friend class ServerMonitorGroup;
+
+    // call with _mutex locked
+    bool windowClosed() const {
+        return _window_open==0 || (_window_limit && _window_closed.size()>=_window_limit);
+    }
+
+    // send now, or add to the transport's monitor group
+    void scheduleUpdate();
+    // how sendGrouped() disposed of an update
+    enum group_result_t { groupNone, groupAdded, groupSeparate };
+    // called by ServerMonitorGroup::send()
+    group_result_t sendGrouped(epics::pvData::ByteBuffer* buffer, TransportSendControl* control, bool& open);
+    // bitsets and data of one update
+    void serializeUpdate(epics::pvData::MonitorElement& element, epics::pvData::ByteBuffer* buffer, TransportSendControl* control);
+    // after an element has been sent
+    void sentElement(epics::pvData::MonitorElement::Ref& element);
+    // flow control prevents sending
+    void heldBack(Monitor& monitor);
+
     // Note: this forms a reference loop, which is broken in destroy()
     Monitor::shared_pointer _channelMonitor;
     epics::pvData::StructureConstPtr _structure;
@@ -510,8 +588,58 @@ private:
     // The elements we have sent, but have not been acknowledged
     typedef std::list<epics::pvData::MonitorElementPtr> window_t;
     window_t _window_closed;
+    // when each of _window_closed was sent
+    std::deque<epicsTimeStamp> _window_sent;
+    // with an adaptive client, the most to have in flight.  Zero for no limit.
+    size_t _window_limit;
+    double _ack_latency, _min_ack_latency, _client_rate;
+    size_t _nheld;
+    size_t _nsent;
+    // an update was held back, send again on ack
+    bool _held;
     bool _unlisten;
     bool _pipeline; // const after activate()
+    bool _bulk; // structure may carry arrays.  set by monitorConnect(), guarded by _mutex
+    // NULL unless the client accepts grouped updates.  const after ctor
+    std::tr1::shared_ptr<ServerMonitorGroup> _group;
+    // queued in _group.  guarded by ServerMonitorGroup::_mutex
+    bool _grouped;
+};
+
+/**
+ * Gathers monitor updates of all subscriptions on one transport
+ * into CMD_MULTIPLE_DATA messages.  Each sub-message is prefixed
+ * with its IOID and size, and the list ends with INVALID_IOID.
+ * Updates which don't fit in the send buffer are sent as individual CMD_MONITOR.
+ * Subscriptions with BULK send priority are not grouped.
+ */
+class ServerMonitorGroup :
+    public TransportSender,
+    public std::tr1::enable_shared_from_this<ServerMonitorGroup>
+{
+public:
+    POINTER_DEFINITIONS(ServerMonitorGroup);
+
+    explicit ServerMonitorGroup(Transport::shared_pointer const & transport);
+    virtual ~ServerMonitorGroup() {}
+
+    void schedule(ServerMonitorRequesterImpl::shared_pointer const & request);
+
+    virtual void send(epics::pvData::ByteBuffer* buffer, TransportSendControl* control) OVERRIDE FINAL;
+
+    struct Stats {
+        size_t nmessages; //!< # of CMD_MULTIPLE_DATA messages sent
+        size_t ngrouped;  //!< # of updates sent in CMD_MULTIPLE_DATA
+        size_t nseparate; //!< # of updates too large to group, sent as CMD_MONITOR
+    };
+    void stats(Stats& s) const;
+
+private:
+    const Transport::weak_pointer _transport;
+    mutable epics::pvData::Mutex _mutex;
+    typedef std::vector<std::tr1::weak_ptr<ServerMonitorRequesterImpl> > pending_t;
+    pending_t _pending;
+    Stats _stats;
 };
 
 
@@ -572,6 +700,7 @@ public:
 
     epics::pvData::PVArray::shared_pointer getPVArray();
     virtual void send(epics::pvData::ByteBuffer* buffer, TransportSendControl* control) OVERRIDE FINAL;
+    virtual SendPriority getSendPriority() const OVERRIDE FINAL { return SEND_PRIORITY_BULK; }
 
 private:
     // Note: this forms a reference loop, which is broken in destroy()
@@ -800,6 +929,85 @@ private:
 };
 
 
+/****************************************************************************************/
+/**
+ * Multi-channel get and put request handler (CMD_MULTI_GET and CMD_MULTI_PUT).
+ */
+class ServerMultiRequestHandler : public AbstractServerResponseHandler
+{
+public:
+    ServerMultiRequestHandler(ServerContextImpl::shared_pointer const & context) :
+        AbstractServerResponseHandler(context, "Multi-channel request") {
+    }
+    virtual ~ServerMultiRequestHandler() {}
+
+    virtual void handleResponse(osiSockAddr* responseFrom,
+                                Transport::shared_pointer const & transport, epics::pvData::int8 version, epics::pvData::int8 command,
+                                std::size_t payloadSize, epics::pvData::ByteBuffer* payloadBuffer) OVERRIDE FINAL;
+};
+
+/**
+ * Collects the result of one get or put for each channel named in a
+ * CMD_MULTI_GET or CMD_MULTI_PUT, and sends all results in one response
+ * after the last completes, or after MULTI_REQUEST_SERVER_TIMEOUT.
+ */
+class ServerMultiRequesterImpl :
+    public ChannelMultiRequester,
+    public TransportSender,
+    public epics::pvData::TimerCallback,
+    public std::tr1::enable_shared_from_this<ServerMultiRequesterImpl>
+{
+public:
+    POINTER_DEFINITIONS(ServerMultiRequesterImpl);
+
+    ServerMultiRequesterImpl(Transport::shared_pointer const & transport,
+                             TimerWheel::shared_pointer const & timer,
+                             const epics::pvData::int8 command, const pvAccessID ioid);
+    virtual ~ServerMultiRequesterImpl() {}
+
+    //! Add an entry while decoding the request.  Returns its index.
+    size_t add();
+    //! After all entries are added.  Starts the timeout.
+    void activate();
+
+    virtual std::string getRequesterName() OVERRIDE FINAL;
+
+    virtual void getManyDone(size_t index,
+                             const epics::pvData::Status& status,
+                             epics::pvData::PVStructure::shared_pointer const & value,
+                             epics::pvData::BitSet::shared_pointer const & changed) OVERRIDE FINAL;
+
+    virtual void putManyDone(size_t index, const epics::pvData::Status& status) OVERRIDE FINAL;
+
+    virtual void send(epics::pvData::ByteBuffer* buffer, TransportSendControl* control) OVERRIDE FINAL;
+
+    // timeout
+    virtual void callback() OVERRIDE FINAL;
+    virtual void timerStopped() OVERRIDE FINAL {}
+private:
+    void complete(size_t index, const epics::pvData::Status& status,
+                  epics::pvData::PVStructure::shared_pointer const & value,
+                  epics::pvData::BitSet::shared_pointer const & changed);
+
+    struct result_t {
+        bool done;
+        epics::pvData::Status status;
+        epics::pvData::PVStructure::shared_pointer value;
+        epics::pvData::BitSet::shared_pointer changed;
+        result_t() :done(false) {}
+    };
+
+    const Transport::shared_pointer _transport;
+    const std::tr1::weak_ptr<TimerWheel> _timer;
+    const epics::pvData::int8 _command;
+    const pvAccessID _ioid;
+
+    epics::pvData::Mutex _mutex;
+    std::vector<result_t> _results;
+    size_t _pending;
+};
+
+
 /**
  * PVAS request handler - main handler which dispatches requests to appropriate handlers.
  */
@@ -832,6 +1040,7 @@ private:
     ServerGetFieldHandler handle_getfield;
     ServerRPCHandler handle_rpc;
     ServerCancelRequestHandler handle_cancel;
+    ServerMultiRequestHandler handle_multi;
     /**
      * Table of response handlers for each command ID.
      */
@@ -7,6 +7,9 @@
 #ifndef SERVERCHANNEL_H_
 #define SERVERCHANNEL_H_
 
+#include <map>
+#include <vector>
+
 #include <pv/destroyable.h>
 #include <pv/remote.h>
 #include <pv/security.h>
@@ -52,6 +55,10 @@ public:
     //! may return NULL
     std::tr1::shared_ptr<BaseChannelRequester> getRequest(pvAccessID id);
 
+    typedef std::vector<std::pair<pvAccessID, std::tr1::shared_ptr<BaseChannelRequester> > > requests_t;
+    //! copy of all registered requests
+    void getRequests(requests_t& requests) const;
+
     void destroy();
 
     void printInfo() const;
@@ -16,6 +16,7 @@
 #include <pv/blockingUDP.h>
 #include <pv/blockingTCP.h>
 #include <pv/beaconEmitter.h>
+#include <pv/serverStats.h>
 
 #include "serverContext.h"
 
@@ -46,10 +47,13 @@ public:
     void printInfo(std::ostream& str, int lvl) OVERRIDE FINAL;
     void setBeaconServerStatusProvider(BeaconServerStatusProvider::shared_pointer const & beaconServerStatusProvider) OVERRIDE FINAL;
     //**************** derived from Context ****************//
-    epics::pvData::Timer::shared_pointer getTimer() OVERRIDE FINAL;
+    TimerWheel::shared_pointer getTimer() OVERRIDE FINAL;
     Channel::shared_pointer getChannel(pvAccessID id) OVERRIDE FINAL;
     Transport::shared_pointer getSearchTransport() OVERRIDE FINAL;
     Configuration::const_shared_pointer getConfiguration() OVERRIDE FINAL;
+    virtual std::size_t getMaxBufferSize() OVERRIDE FINAL { return _maxBufferSize; }
+    virtual bool isHandlerTimingEnabled() OVERRIDE FINAL { return !_statsPrefix.empty(); }
+    virtual void transportClosed(Transport::shared_pointer const & transport) OVERRIDE FINAL;
     TransportRegistry* getTransportRegistry() OVERRIDE FINAL;
 
     virtual void newServerDetected() OVERRIDE FINAL;
@@ -118,6 +122,12 @@ public:
      */
     const osiSockAddr *getServerInetAddress();
 
+    /**
+     * TCP acceptor.
+     * @return acceptor, <code>NULL</code> if not initialized or shut down.
+     */
+    const BlockingTCPAcceptor::shared_pointer& getAcceptor() const { return _acceptor; }
+
     /**
      * Broadcast (UDP send) transport.
      * @return broadcast transport.
@@ -136,6 +146,12 @@ public:
      */
     bool isChannelProviderNamePreconfigured();
 
+    /**
+     * Whether monitor updates may be grouped into CMD_MULTIPLE_DATA messages
+     * for clients which support this.
+     */
+    bool isGroupMonitors() const { return _groupMonitors; }
+
     // used by ServerChannelFindRequesterImpl
     typedef std::map<std::string, std::tr1::weak_ptr<ChannelProvider> > s_channelNameToProvider_t;
     s_channelNameToProvider_t s_channelNameToProvider;
@@ -190,7 +206,40 @@ private:
      */
     epics::pvData::int32 _receiveBufferSize;
 
-    epics::pvData::Timer::shared_pointer _timer;
+    /**
+     * Path of an AF_UNIX socket to listen on in addition to TCP, empty to disable.
+     */
+    std::string _unixSocketPath;
+
+    /**
+     * Group monitor updates for capable clients.
+     */
+    bool _groupMonitors;
+
+    /**
+     * Maximum number of connections being validated at once, zero for no limit.
+     */
+    epics::pvData::int32 _maxHandshakes;
+
+    /**
+     * Limit on the growth of the buffers of each client connection.
+     */
+    epics::pvData::int32 _maxBufferSize;
+
+    /**
+     * Prefix of the names of the server statistics PVs, empty to disable.
+     */
+    std::string _statsPrefix;
+
+    /**
+     * Period in seconds between updates of the server statistics PVs.
+     */
+    double _statsPeriod;
+
+    // set by initialize(), cleared by shutdown() with _mutex locked
+    ServerStats::shared_pointer _stats;
+
+    TimerWheel::shared_pointer _timer;
 
     /**
      * UDP transports needed to receive channel searches.
@@ -209,6 +258,11 @@ private:
      */
     BlockingTCPAcceptor::shared_pointer _acceptor;
 
+    /**
+     * Optional acceptor for co-located clients (AF_UNIX).
+     */
+    BlockingTCPAcceptor::shared_pointer _unixAcceptor;
+
     /**
      * PVA transport (virtual circuit) registry.
      * This registry contains all active transports - connections to PVA servers.
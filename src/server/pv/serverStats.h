@@ -0,0 +1,124 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#ifndef SERVERSTATS_H
+#define SERVERSTATS_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#ifdef epicsExportSharedSymbols
+#   define serverStatsEpicsExportSharedSymbols
+#   undef epicsExportSharedSymbols
+#endif
+
+#include <epicsTime.h>
+
+#include <pv/timer.h>
+#include <pv/lock.h>
+#include <pv/sharedPtr.h>
+#include <pv/noDefaultMethods.h>
+
+#ifdef serverStatsEpicsExportSharedSymbols
+#   define epicsExportSharedSymbols
+#	undef serverStatsEpicsExportSharedSymbols
+#endif
+
+#include <pv/pvAccess.h>
+#include <pv/remote.h>
+#include <pva/server.h>
+#include <pva/sharedstate.h>
+
+namespace epics {
+namespace pvAccess {
+
+class ServerContextImpl;
+class ServerChannel;
+
+/**
+ * Publishes statistics of a ServerContext as PVs, refreshed periodically.
+ * Enabled by setting $EPICS_PVAS_STATS_PREFIX.
+ *
+ * - \<prefix\>transports - NTTable, one row per client connection.
+ *   Bytes, messages and segments in and out, and send queue depth.
+ * - \<prefix\>channels - NTTable, one row per channel of each client.
+ *   Monitor updates sent, update rate, and overruns.
+ * - \<prefix\>latency - NTTable, one row per command.
+ *   Histogram of time spent in the request handler, including by closed connections.
+ */
+class ServerStats :
+    public epics::pvData::TimerCallback,
+    public std::tr1::enable_shared_from_this<ServerStats>
+{
+public:
+    POINTER_DEFINITIONS(ServerStats);
+
+    /**
+     * @param context Not kept alive by us
+     * @param prefix Prepended to the names of our PVs
+     * @param period Time between updates, in seconds
+     */
+    ServerStats(const std::tr1::shared_ptr<ServerContextImpl>& context,
+                const std::string& prefix, double period);
+    virtual ~ServerStats();
+
+    //! Serves our PVs.  To be added to the providers of the ServerContext
+    ChannelProvider::shared_pointer getProvider() const;
+
+    //! Begin periodic updates
+    void start();
+
+    //! Stop updates and disconnect any clients
+    void destroy();
+
+    //! Update all PVs now.  Not to be called concurrently.
+    void update();
+
+    //! Keep the counters of a connection which is closing in our totals
+    void transportClosed(Transport::shared_pointer const & transport);
+
+    virtual void callback() OVERRIDE FINAL;
+    virtual void timerStopped() OVERRIDE FINAL;
+
+private:
+    const std::tr1::weak_ptr<ServerContextImpl> _context;
+    const std::tr1::weak_ptr<TimerWheel> _timer;
+    const double _period;
+
+    pvas::StaticProvider _provider;
+    const pvas::SharedPV::shared_pointer _transports, _channels, _latency;
+
+    // counters from the previous update(), for rates.
+    // keyed by address, and compared by weak_ptr to catch re-use of that address.
+    struct TransportSample {
+        std::tr1::weak_ptr<Transport> transport;
+        epics::pvData::uint64 nrxBytes, ntxBytes;
+    };
+    typedef std::map<const Transport*, TransportSample> transportSamples_t;
+    transportSamples_t _transportSamples;
+
+    struct ChannelSample {
+        std::tr1::weak_ptr<ServerChannel> channel;
+        size_t nsent;
+    };
+    typedef std::map<const ServerChannel*, ChannelSample> channelSamples_t;
+    channelSamples_t _channelSamples;
+
+    epicsTimeStamp _lastUpdate;
+    bool _updated;
+
+    // latency histograms of closed connections, ncommands x nbuckets
+    epics::pvData::Mutex _closedMutex;
+    std::vector<size_t> _closedLatency; // guarded by _closedMutex
+
+    EPICS_NOT_COPYABLE(ServerStats)
+};
+
+}
+}
+
+#endif // SERVERSTATS_H
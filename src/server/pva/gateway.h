@@ -0,0 +1,107 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+#ifndef PVA_GATEWAY_H
+#define PVA_GATEWAY_H
+
+#include <string>
+
+#include <shareLib.h>
+#include <pv/sharedPtr.h>
+#include <pv/noDefaultMethods.h>
+
+#include <pva/server.h>
+#include <pva/client.h>
+
+namespace epics{namespace pvAccess{
+class ChannelProvider;
+}} // epics::pvAccess
+
+namespace pvas {
+
+/** @addtogroup pvas
+ * @{
+ */
+
+/** @brief A caching proxy Provider.
+ *
+ * Claims searches for names which the upstream client provider can connect,
+ * and serves each through a SharedPV.  Some ServerContext built around provider()
+ * then fans out to any number of downstream clients.
+ *
+ * While at least one downstream client is connected, a single upstream subscription
+ * is kept per channel name.  Its updates are cached, so new downstream Get and Monitor
+ * operations complete from the cache without an upstream round trip.
+ * The various downstream pvRequests are applied by the SharedPV.
+ * Put and RPC operations are forwarded upstream.
+ *
+ * The first search for a name starts an upstream connection, but is not claimed.
+ * Later (retried) searches are claimed once this upstream connection is established.
+ * New upstream connections are started at a limited rate, and searches for
+ * other new names are ignored meanwhile, so a storm of searches does not become
+ * a storm of upstream channels.  Upstream channels without downstream clients
+ * are forgotten periodically.
+ *
+ * @code
+ *   pvac::ClientProvider upstream("pva");
+ *   pvas::GatewayProvider gw("gateway", upstream);
+ *   epics::pvAccess::ServerContext::shared_pointer server(
+ *       epics::pvAccess::ServerContext::create(epics::pvAccess::ServerContext::Config()
+ *           .provider(gw.provider())));
+ * @endcode
+ *
+ * @note Upstream and downstream configurations must not overlap,
+ *       or the gateway will find itself.
+ */
+class epicsShareClass GatewayProvider {
+public:
+    POINTER_DEFINITIONS(GatewayProvider);
+    struct Impl;
+private:
+    std::tr1::shared_ptr<Impl> impl; // const after ctor
+    std::tr1::shared_ptr<DynamicProvider> dynamic; // const after ctor
+public:
+    //! Snapshot of counters.  cf. stats()
+    struct epicsShareClass Stats {
+        size_t channels;        //!< number of cached upstream channels
+        size_t subscriptions;   //!< number of active upstream subscriptions
+        size_t upstreamUpdates; //!< total monitor updates received from upstream
+        size_t throttled;       //!< searches for new names ignored because of maxCreateRate
+        size_t expired;         //!< upstream channels forgotten by the periodic sweep
+        Stats();
+    };
+
+    /** Build a new gateway
+     * @param name Provider Name.  Only relevant if registerAsServer() is called, then must be unique in this process.
+     * @param upstream Client through which names are resolved.
+     * @param sweepPeriod Interval in seconds of the periodic sweep.  Upstream channels are forgotten
+     *                    after having no downstream clients for at least one full interval.
+     *                    <=0 disables, leaving it to sweep().
+     * @param maxCreateRate Upstream channels created per second in response to searches, on average.
+     *                      Up to ten seconds worth may be created at once.  <=0 for no limit.
+     */
+    GatewayProvider(const std::string& name,
+                    const pvac::ClientProvider& upstream,
+                    double sweepPeriod = 60.0,
+                    double maxCreateRate = 100.0);
+    ~GatewayProvider();
+
+    //! Fetch the underlying ChannelProvider.  Usually to build a ServerContext around.
+    std::tr1::shared_ptr<epics::pvAccess::ChannelProvider> provider() const;
+
+    void stats(Stats& ret) const;
+
+    //! Forget upstream channels with no downstream clients now.
+    //! Names searched for, but never connected, are otherwise expired by the periodic sweep.
+    //! @returns The number of channels removed
+    size_t sweep();
+
+    EPICS_NOT_COPYABLE(GatewayProvider)
+};
+
+//! @}
+
+} // namespace pvas
+
+#endif // PVA_GATEWAY_H
@@ -7,6 +7,7 @@
 
 #include <string>
 #include <list>
+#include <map>
 
 #include <shareLib.h>
 #include <pv/sharedPtr.h>
@@ -36,6 +37,7 @@ namespace pvas {
 namespace detail {
 struct SharedChannel;
 struct SharedMonitorFIFO;
+struct MonitorGroup;
 struct SharedPut;
 struct SharedRPC;
 }
@@ -85,9 +87,31 @@ public:
     struct epicsShareClass Config {
         bool dropEmptyUpdates; //!< default true.  Drop updates which don't include an field values.
         epics::pvData::PVRequestMapper::mode_t mapperMode; //!< default Mask.  @see epics::pvData::PVRequestMapper::mode_t
+        /** default 0, all subscribers are updated by the thread calling post().
+         *  If non-zero, when post() has more than this many subscribers, they are divided into
+         *  shards of about this size, which are updated and notified concurrently
+         *  by a pool of worker threads shared by all SharedPVs.
+         *  post() returns when all shards are complete.
+         *  @since >7.1.0
+         */
+        size_t fanoutShardSize;
         Config();
     };
 
+    //! Counters of post() calls.  Only collected when Config::fanoutShardSize is non-zero.
+    //! @see fanoutStats()
+    //! @since >7.1.0
+    struct epicsShareClass FanoutStats {
+        size_t nposts;    //!< post() calls
+        size_t nparallel; //!< post() calls which used the worker pool
+        size_t maxShards; //!< largest number of shards of one post()
+        //! Histogram of post-to-notify time, from post() until every subscriber has been notified.
+        //! This ends when updates are queued for sending, not when they are sent.
+        //! postToNotify[i] counts times less than 2^i microseconds.  The last bucket also counts all longer times.
+        size_t postToNotify[20];
+        FanoutStats();
+    };
+
     /** Callbacks associated with a SharedPV.
      *
     * @note For the purposes of locking, this class is an Requester (see @ref provider_roles_requester_locking)
@@ -175,6 +199,11 @@ public:
             const std::string& channelName,
             const std::tr1::shared_ptr<epics::pvAccess::ChannelRequester>& requester);
 
+    //! Fetch post() counters.
+    //! @param reset If true, zero counters after fetching
+    //! @since >7.1.0
+    void fanoutStats(FanoutStats& stats, bool reset=false);
+
     void setDebug(int lvl);
     int isDebug() const;
 
@@ -195,6 +224,7 @@ private:
     typedef std::list<detail::SharedMonitorFIFO*> monitors_t;
     typedef std::list<std::tr1::weak_ptr<epics::pvAccess::GetFieldRequester> > getfields_t;
     typedef std::list<detail::SharedChannel*> channels_t;
+    typedef std::map<std::string, std::tr1::shared_ptr<detail::MonitorGroup> > monitorgroups_t;
 
     std::tr1::shared_ptr<const epics::pvData::Structure> type;
 
@@ -203,6 +233,11 @@ private:
     monitors_t monitors;
     getfields_t getfields;
     channels_t channels;
+    // monitors grouped by field selection, so that post() maps each update once per group.
+    monitorgroups_t monitorGroups;
+    // incremented by each post()
+    size_t postCount;
+    FanoutStats fanout;
 
     std::tr1::shared_ptr<epics::pvData::PVStructure> current;
     //! mask of fields which are considered to have non-default values.
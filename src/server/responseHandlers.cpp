@@ -54,6 +54,9 @@ namespace pvAccess {
 // TODO this is a copy from clientContextImpl.cpp
 static PVDataCreatePtr pvDataCreate = getPVDataCreate();
 
+// upper limit on the number of pipelined puts accepted per ChannelPut
+static const size_t maxPipelinePutWindow = 64u;
+
 
 static BitSet::shared_pointer createBitSetFor(
     PVStructure::shared_pointer const & pvStructure,
@@ -72,6 +75,28 @@ static BitSet::shared_pointer createBitSetFor(
         return BitSet::shared_pointer(new BitSet(pvStructureSize));
 }
 
+// true if values of this type carry numeric array data, which may be large.
+// string arrays (eg. NTEnum choices), and unions, are not counted.
+static bool hasArray(Field::const_shared_pointer const & field)
+{
+    if(!field)
+        return false;
+    switch(field->getType()) {
+    case scalarArray:
+        return static_cast<const ScalarArray*>(field.get())->getElementType()!=pvString;
+    case structure: {
+        const FieldConstPtrArray& fields(static_cast<const Structure*>(field.get())->getFields());
+        for(size_t i=0; i<fields.size(); i++) {
+            if(hasArray(fields[i]))
+                return true;
+        }
+        return false;
+    }
+    default:
+        return false;
+    }
+}
+
 static PVField::shared_pointer reuseOrCreatePVField(
     Field::const_shared_pointer const & field,
     PVField::shared_pointer const & existingPVField)
@@ -120,7 +145,8 @@ ServerResponseHandler::ServerResponseHandler(ServerContextImpl::shared_pointer c
     ,handle_getfield(context)
     ,handle_rpc(context)
     ,handle_cancel(context)
-    ,m_handlerTable(CMD_CANCEL_REQUEST+1, &handle_bad)
+    ,handle_multi(context)
+    ,m_handlerTable(CMD_MULTI_PUT+1, &handle_bad)
 {
 
     m_handlerTable[CMD_BEACON] = &handle_beacon; /*  0 */
@@ -147,6 +173,9 @@ ServerResponseHandler::ServerResponseHandler(ServerContextImpl::shared_pointer c
 
     m_handlerTable[CMD_RPC] = &handle_rpc; /* 20 - RPC response */
     m_handlerTable[CMD_CANCEL_REQUEST] = &handle_cancel; /* 21 - cancel request */
+    m_handlerTable[CMD_ORIGIN_TAG] = &handle_bad; /* 22 - origin tag */
+    m_handlerTable[CMD_MULTI_GET] = &handle_multi; /* 23 - multi-channel get */
+    m_handlerTable[CMD_MULTI_PUT] = &handle_multi; /* 24 - multi-channel put */
 }
 
 void ServerResponseHandler::handleResponse(osiSockAddr* responseFrom,
@@ -168,6 +197,8 @@ void ServerResponseHandler::handleResponse(osiSockAddr* responseFrom,
         return;
     }
 
+    MB_POINT(pvAccess, 1, "dispatch");
+
     // delegate
     m_handlerTable[command]->handleResponse(responseFrom, transport,
                                             version, command, payloadSize, payloadBuffer);
@@ -182,11 +213,14 @@ void ServerConnectionValidationHandler::handleResponse(
             transport, version, command, payloadSize, payloadBuffer);
 
     transport->ensureData(4+2+2);
-    transport->setRemoteTransportReceiveBufferSize(payloadBuffer->getInt());
+    // client max. payload size, bounds the growth of our send buffer
+    const int32 clientReceiveBufferSize = payloadBuffer->getInt();
+    if (clientReceiveBufferSize > 0)
+        transport->setRemoteTransportReceiveBufferSize(clientReceiveBufferSize);
     // TODO clientIntrospectionRegistryMaxSize
     /* int clientIntrospectionRegistryMaxSize = */ payloadBuffer->getShort();
-    // TODO connectionQoS
-    /* int16 connectionQoS = */ payloadBuffer->getShort();
+    // TODO connection priority
+    const int16 connectionQoS = payloadBuffer->getShort();
 
     // authNZ
     std::string securityPluginName = SerializeHelper::deserializeString(payloadBuffer, transport.get());
@@ -206,6 +240,9 @@ void ServerConnectionValidationHandler::handleResponse(
     //TODO: simplify byzantine class heirarchy...
     assert(casTransport);
 
+    if ((connectionQoS & CONNECTION_QOS_MULTIPLE_DATA) && _context->isGroupMonitors())
+        casTransport->setMonitorGroup(ServerMonitorGroup::shared_pointer(new ServerMonitorGroup(transport)));
+
     try {
         casTransport->authNZInitialize(securityPluginName, data);
     }catch(std::exception& e){
@@ -333,6 +370,12 @@ void ServerSearchHandler::handleResponse(osiSockAddr* responseFrom,
         }
     }
 
+    // search over TCP, eg. from a client using this server as a name server.
+    // Reply on the same connection.
+    Transport::shared_pointer replyTransport;
+    if (!dynamic_pointer_cast<BlockingUDPTransport>(transport))
+        replyTransport = transport;
+
     PeerInfo::shared_pointer info;
     if(allowed) {
         info.reset(new PeerInfo);
@@ -357,7 +400,7 @@ void ServerSearchHandler::handleResponse(osiSockAddr* responseFrom,
 
                 int providerCount = _providers.size();
                 std::tr1::shared_ptr<ServerChannelFindRequesterImpl> tp(new ServerChannelFindRequesterImpl(_context, info, providerCount));
-                tp->set(name, searchSequenceId, cid, responseAddress, responseRequired, false);
+                tp->set(name, searchSequenceId, cid, responseAddress, responseRequired, false, replyTransport);
 
                 for (int i = 0; i < providerCount; i++)
                     _providers[i]->channelFind(name, tp);
@@ -375,7 +418,7 @@ void ServerSearchHandler::handleResponse(osiSockAddr* responseFrom,
             delay = delay*0.1 + 0.05;
 
             std::tr1::shared_ptr<ServerChannelFindRequesterImpl> tp(new ServerChannelFindRequesterImpl(_context, info, 1));
-            tp->set("", searchSequenceId, 0, responseAddress, true, true);
+            tp->set("", searchSequenceId, 0, responseAddress, true, true, replyTransport);
 
             TimerCallback::shared_pointer tc = tp;
             _context->getTimer()->scheduleAfterDelay(tc, delay);
@@ -401,6 +444,7 @@ void ServerChannelFindRequesterImpl::clear()
     _wasFound = false;
     _responseCount = 0;
     _serverSearch = false;
+    _transport.reset();
 }
 
 void ServerChannelFindRequesterImpl::callback()
@@ -414,13 +458,14 @@ void ServerChannelFindRequesterImpl::timerStopped()
 }
 
 ServerChannelFindRequesterImpl* ServerChannelFindRequesterImpl::set(std::string name, int32 searchSequenceId, int32 cid, osiSockAddr const & sendTo,
-        bool responseRequired, bool serverSearch)
+        bool responseRequired, bool serverSearch, Transport::shared_pointer const & transport)
 {
     Lock guard(_mutex);
     _name = name;
     _searchSequenceId = searchSequenceId;
     _cid = cid;
     _sendTo = sendTo;
+    _transport = transport;
     _responseRequired = responseRequired;
     _serverSearch = serverSearch;
     return this;
@@ -455,11 +500,17 @@ void ServerChannelFindRequesterImpl::channelFindResult(const Status& /*status*/,
             _context->s_channelNameToProvider[_name] = channelFind->getChannelProvider();
         }
         _wasFound = wasFound;
-        
+
+        TransportSender::shared_pointer thisSender = shared_from_this();
+        if (_transport)
+        {
+            _transport->enqueueSendRequest(thisSender);
+            return;
+        }
+
         BlockingUDPTransport::shared_pointer bt = _context->getBroadcastTransport();
         if (bt)
         {
-            TransportSender::shared_pointer thisSender = shared_from_this();
             bt->enqueueSendRequest(thisSender);
         }
     }
@@ -1098,8 +1149,8 @@ void ServerGetHandler::handleResponse(osiSockAddr* responseFrom,
     }
 
 ServerChannelGetRequesterImpl::ServerChannelGetRequesterImpl(ServerContextImpl::shared_pointer const & context, ServerChannel::shared_pointer const & channel, const pvAccessID ioid, Transport::shared_pointer const & transport) :
-    BaseChannelRequester(context, channel, ioid, transport)
-
+    BaseChannelRequester(context, channel, ioid, transport),
+    _bulk(false)
 {
 }
 
@@ -1132,6 +1183,7 @@ void ServerChannelGetRequesterImpl::channelGetConnect(const Status& status, Chan
         {
             _pvStructure = std::tr1::static_pointer_cast<PVStructure>(reuseOrCreatePVField(structure, _pvStructure));
             _bitSet = createBitSetFor(_pvStructure, _bitSet);
+            _bulk = hasArray(structure);
         }
     }
 
@@ -1190,6 +1242,12 @@ ChannelGet::shared_pointer ServerChannelGetRequesterImpl::getChannelGet()
 }
 
 // TODO get rid of all these mutex-es
+SendPriority ServerChannelGetRequesterImpl::getSendPriority() const
+{
+    Lock guard(_mutex);
+    return _bulk ? SEND_PRIORITY_BULK : SEND_PRIORITY_NORMAL;
+}
+
 void ServerChannelGetRequesterImpl::send(ByteBuffer* buffer, TransportSendControl* control)
 {
     const int32 request = getPendingRequest();
@@ -1288,7 +1346,27 @@ void ServerPutHandler::handleResponse(osiSockAddr* responseFrom,
             return;
         }
 
-        if (!request->startRequest(qosCode))
+        if (request->isPipelined() && !get)
+        {
+            PVStructure::shared_pointer putPVStructure;
+            BitSet::shared_pointer putBitSet;
+            if (!request->reservePut(putPVStructure, putBitSet))
+            {
+                BaseChannelRequester::sendFailureMessage((int8)CMD_PUT, transport, ioid, qosCode, BaseChannelRequester::otherRequestPendingStatus);
+                return;
+            }
+
+            DESERIALIZE_EXCEPTION_GUARD(
+                putBitSet->deserialize(payloadBuffer, transport.get());
+                putPVStructure->deserialize(payloadBuffer, transport.get(), putBitSet.get());
+            );
+
+            // lastRequest is applied when this put is started
+            request->queuePut(qosCode, putPVStructure, putBitSet);
+            return;
+        }
+
+        if ((get && request->putsPending()) || !request->startRequest(qosCode))
         {
             BaseChannelRequester::sendFailureMessage((int8)CMD_PUT, transport, ioid, qosCode, BaseChannelRequester::otherRequestPendingStatus);
             return;
@@ -1327,7 +1405,11 @@ void ServerPutHandler::handleResponse(osiSockAddr* responseFrom,
 
 ServerChannelPutRequesterImpl::ServerChannelPutRequesterImpl(ServerContextImpl::shared_pointer const & context, ServerChannel::shared_pointer const & channel,
         const pvAccessID ioid, Transport::shared_pointer const & transport):
-    BaseChannelRequester(context, channel, ioid, transport)
+    BaseChannelRequester(context, channel, ioid, transport),
+    _window(1u),
+    _putsOutstanding(0u),
+    _putActive(false),
+    _putRunning(false)
 {
 }
 
@@ -1343,6 +1425,26 @@ ChannelPutRequester::shared_pointer ServerChannelPutRequesterImpl::create(Server
 
 void ServerChannelPutRequesterImpl::activate(PVStructure::shared_pointer const & pvRequest)
 {
+    PVStructure::shared_pointer O(pvRequest->getSubField<PVStructure>("record._options"));
+    if(O) {
+        try{
+            PVScalar::shared_pointer pipeline(O->getSubField<PVScalar>("pipeline"));
+            if(pipeline && pipeline->getAs<boolean>()) {
+                // the client's window, default 4
+                PVScalar::shared_pointer queueSize(O->getSubField<PVScalar>("queueSize"));
+                int32 window = queueSize ? queueSize->getAs<int32>() : 4;
+                if(window<1)
+                    window = 1;
+                else if(size_t(window)>maxPipelinePutWindow)
+                    window = maxPipelinePutWindow;
+                _window = window;
+            }
+        }catch(std::exception& e){
+            std::ostringstream strm;
+            strm<<"Ignoring invalid pipeline= : "<<e.what();
+            message(strm.str(), epics::pvData::errorMessage);
+        }
+    }
     startRequest(QOS_INIT);
     shared_pointer thisPointer(shared_from_this());
     _channel->registerRequest(_ioid, thisPointer);
@@ -1374,12 +1476,101 @@ void ServerChannelPutRequesterImpl::channelPutConnect(const Status& status, Chan
 
 void ServerChannelPutRequesterImpl::putDone(const Status& status, ChannelPut::shared_pointer const & /*channelPut*/)
 {
+    bool pipelined;
     {
         Lock guard(_mutex);
         _status = status;
+        pipelined = _putActive;
+        if (pipelined)
+        {
+            _putActive = false;
+            _putResults.push_back(std::make_pair(_putCurrent.qos, status));
+            _putsFree.push_back(_putCurrent);
+            _putCurrent = PendingPut();
+        }
     }
     TransportSender::shared_pointer thisSender = shared_from_this();
     _transport->enqueueSendRequest(thisSender);
+
+    if (pipelined)
+        runPuts();
+}
+
+bool ServerChannelPutRequesterImpl::putsPending()
+{
+    Lock guard(_mutex);
+    return _putsOutstanding!=0u;
+}
+
+bool ServerChannelPutRequesterImpl::reservePut(PVStructure::shared_pointer& value,
+                                               BitSet::shared_pointer& changed)
+{
+    Lock guard(_mutex);
+    if (_putsOutstanding>=_window || !_pvStructure)
+        return false;
+    _putsOutstanding++;
+
+    if (!_putsFree.empty())
+    {
+        value = _putsFree.back().value;
+        changed = _putsFree.back().changed;
+        _putsFree.pop_back();
+    }
+    else
+    {
+        value = pvDataCreate->createPVStructure(_pvStructure->getStructure());
+        changed.reset(new BitSet(value->getNumberFields()));
+    }
+    return true;
+}
+
+void ServerChannelPutRequesterImpl::queuePut(int8 qos,
+                                             PVStructure::shared_pointer const & value,
+                                             BitSet::shared_pointer const & changed)
+{
+    {
+        Lock guard(_mutex);
+        PendingPut put;
+        put.value = value;
+        put.changed = changed;
+        put.qos = qos;
+        _puts.push_back(put);
+    }
+    runPuts();
+}
+
+void ServerChannelPutRequesterImpl::runPuts()
+{
+    {
+        Lock guard(_mutex);
+        if (_putRunning)
+            return; // putDone() called from within put()
+        _putRunning = true;
+    }
+
+    while (true)
+    {
+        ChannelPut::shared_pointer channelPut;
+        PendingPut next;
+        {
+            Lock guard(_mutex);
+            if (_putActive || _puts.empty() || !_channelPut)
+            {
+                // an active put will call us again on completion
+                _putRunning = false;
+                return;
+            }
+            _putActive = true;
+            _putCurrent = next = _puts.front();
+            _puts.pop_front();
+            channelPut = _channelPut;
+        }
+
+        if (next.qos & QOS_DESTROY)
+            channelPut->lastRequest();
+
+        channelPut->put(next.value, next.changed);
+    }
 }
 
 void ServerChannelPutRequesterImpl::getDone(const Status& status, ChannelPut::shared_pointer const & /*channelPut*/, PVStructure::shared_pointer const & pvStructure, BitSet::shared_pointer const & bitSet)
@@ -1439,6 +1630,34 @@ PVStructure::shared_pointer ServerChannelPutRequesterImpl::getPutPVStructure()
 
 void ServerChannelPutRequesterImpl::send(ByteBuffer* buffer, TransportSendControl* control)
 {
+    {
+        put_result_t result;
+        bool pipelined;
+        {
+            Lock guard(_mutex);
+            pipelined = !_putResults.empty();
+            if (pipelined)
+            {
+                result = _putResults.front();
+                _putResults.pop_front();
+                _putsOutstanding--;
+            }
+        }
+
+        if (pipelined)
+        {
+            control->startMessage((int32)CMD_PUT, sizeof(int32)/sizeof(int8) + 1);
+            buffer->putInt(_ioid);
+            buffer->putByte(result.first);
+            result.second.serialize(buffer, control);
+
+            // lastRequest
+            if ((QOS_DESTROY & result.first) != 0)
+                destroy();
+            return;
+        }
+    }
+
     const int32 request = getPendingRequest();
 
     ChannelPut::shared_pointer channelPut;
@@ -1464,6 +1683,13 @@ void ServerChannelPutRequesterImpl::send(ByteBuffer* buffer, TransportSendContro
         {
             Lock guard(_mutex);
             control->cachedSerialize(_pvStructure->getStructure(), buffer);
+            // acknowledge pipeline=true with the accepted window.
+            // older clients ignore this.
+            if (_window>1u)
+            {
+                control->ensureBuffer(sizeof(int32)/sizeof(int8));
+                buffer->putInt(_window);
+            }
         }
         else if ((QOS_GET & request) != 0)
         {
@@ -1825,7 +2051,11 @@ void ServerMonitorHandler::handleResponse(osiSockAddr* responseFrom,
         {
             transport->ensureData(4);
             int32 nfree = payloadBuffer->getInt();
-            request->ack(nfree);
+            // adaptive clients append their drain rate
+            double rate = 0.0;
+            if (payloadBuffer->getRemaining() >= 4)
+                rate = payloadBuffer->getFloat();
+            request->ack(nfree, rate);
             return;
             // note: not possible to ack and destroy
         }
@@ -1862,8 +2092,18 @@ ServerMonitorRequesterImpl::ServerMonitorRequesterImpl(
         const pvAccessID ioid, Transport::shared_pointer const & transport)
     :BaseChannelRequester(context, channel, ioid, transport)
     ,_window_open(0u)
+    ,_window_limit(0u)
+    ,_ack_latency(0.0)
+    ,_min_ack_latency(0.0)
+    ,_client_rate(0.0)
+    ,_nheld(0u)
+    ,_nsent(0u)
+    ,_held(false)
     ,_unlisten(false)
     ,_pipeline(false)
+    ,_bulk(false)
+    ,_group(static_cast<detail::BlockingServerTCPTransportCodec*>(transport.get())->getMonitorGroup())
+    ,_grouped(false)
 {}
 
 ServerMonitorRequesterImpl::shared_pointer ServerMonitorRequesterImpl::create(
@@ -1900,6 +2140,7 @@ void ServerMonitorRequesterImpl::monitorConnect(const Status& status, Monitor::s
         _status = status;
         _channelMonitor = monitor;
         _structure = structure;
+        _bulk = hasArray(structure);
     }
     TransportSender::shared_pointer thisSender = shared_from_this();
     _transport->enqueueSendRequest(thisSender);
@@ -1923,8 +2164,27 @@ void ServerMonitorRequesterImpl::unlisten(Monitor::shared_pointer const & /*moni
 
 void ServerMonitorRequesterImpl::monitorEvent(Monitor::shared_pointer const & /*monitor*/)
 {
-    TransportSender::shared_pointer thisSender = shared_from_this();
-    _transport->enqueueSendRequest(thisSender);
+    scheduleUpdate();
+}
+
+void ServerMonitorRequesterImpl::scheduleUpdate()
+{
+    bool alone;
+    {
+        Lock guard(_mutex);
+        alone = _bulk || _unlisten;
+    }
+    // the group is sent with NORMAL priority, so bulk updates are queued alone.
+    // Once unlisten()'d, send() drains the queue and ends with QOS_DESTROY.
+    if (_group && !alone)
+    {
+        _group->schedule(shared_from_this());
+    }
+    else
+    {
+        TransportSender::shared_pointer thisSender = shared_from_this();
+        _transport->enqueueSendRequest(thisSender);
+    }
 }
 
 void ServerMonitorRequesterImpl::destroy()
@@ -1943,6 +2203,7 @@ void ServerMonitorRequesterImpl::destroy()
         _channel->unregisterRequest(_ioid);
 
         window.swap(_window_closed);
+        _window_sent.clear();
 
         monitor.swap(_channelMonitor);
     }
@@ -1958,6 +2219,12 @@ Monitor::shared_pointer ServerMonitorRequesterImpl::getChannelMonitor()
     return _channelMonitor;
 }
 
+SendPriority ServerMonitorRequesterImpl::getSendPriority() const
+{
+    Lock guard(_mutex);
+    return _bulk ? SEND_PRIORITY_BULK : SEND_PRIORITY_NORMAL;
+}
+
 void ServerMonitorRequesterImpl::send(ByteBuffer* buffer, TransportSendControl* control)
 {
     const int32 request = getPendingRequest();
@@ -1992,8 +2259,11 @@ void ServerMonitorRequesterImpl::send(ByteBuffer* buffer, TransportSendControl*
         bool busy = false;
         if(_pipeline) {
             Lock guard(_mutex);
-            busy = _window_open==0;
+            busy = windowClosed();
+            _held |= busy;
         }
+        if(busy)
+            heldBack(*monitor);
 
         MonitorElement::Ref element;
         if(!busy) {
@@ -2006,38 +2276,9 @@ void ServerMonitorRequesterImpl::send(ByteBuffer* buffer, TransportSendControl*
             buffer->putInt(_ioid);
             buffer->putByte((int8)request);
 
-            // changedBitSet and data, if not notify only (i.e. queueSize == -1)
-            const BitSet::shared_pointer& changedBitSet = element->changedBitSet;
-            if (changedBitSet)
-            {
-                changedBitSet->serialize(buffer, control);
-                element->pvStructurePtr->serialize(buffer, control, changedBitSet.get());
+            serializeUpdate(*element, buffer, control);
 
-                // overrunBitset
-                element->overrunBitSet->serialize(buffer, control);
-            }
-
-            {
-                Lock guard(_mutex);
-                if(!_pipeline) {
-                } else if(_window_open==0) {
-                    // This really shouldn't happen as the above ensures that _window_open *was* non-zero,
-                    // and only we (the sender) will decrement.
-                    message("Monitor Logic Error: send outside of window", epics::pvData::warningMessage);
-                    LOG(logLevelError, "Monitor Logic Error: send outside of window %zu", _window_closed.size());
-
-                } else {
-                    _window_closed.push_back(element.letGo());
-                    _window_open--;
-                }
-            }
-
-            element.reset(); // calls Monitor::release() if not swap()'d
-
-            // TODO if we try to proces several monitors at once, then fairness suffers
-            // TODO compbine several monitors into one message (reduces payload)
-            TransportSender::shared_pointer thisSender = shared_from_this();
-            _transport->enqueueSendRequest(thisSender);
+            sentElement(element);
         }
         else
         {
@@ -2049,6 +2290,7 @@ void ServerMonitorRequesterImpl::send(ByteBuffer* buffer, TransportSendControl*
                 _unlisten = false;
                 if(unlisten) {
                     window.swap(_window_closed);
+                    _window_sent.clear();
                     _window_open = 0u;
                 }
             }
@@ -2070,14 +2312,344 @@ void ServerMonitorRequesterImpl::send(ByteBuffer* buffer, TransportSendControl*
     }
 }
 
-void ServerMonitorRequesterImpl::ack(size_t cnt)
+void ServerMonitorRequesterImpl::heldBack(Monitor& monitor)
+{
+    // only count if an update is actually waiting
+    Monitor::Stats stats;
+    monitor.getStats(stats);
+    if(stats.nfilled) {
+        Lock guard(_mutex);
+        _nheld++;
+    }
+}
+
+void ServerMonitorRequesterImpl::serializeUpdate(MonitorElement& element, ByteBuffer* buffer, TransportSendControl* control)
+{
+    // changedBitSet and data, if not notify only (i.e. queueSize == -1)
+    const BitSet::shared_pointer& changedBitSet = element.changedBitSet;
+    if (changedBitSet)
+    {
+        changedBitSet->serialize(buffer, control);
+        element.pvStructurePtr->serialize(buffer, control, changedBitSet.get());
+
+        // overrunBitset
+        element.overrunBitSet->serialize(buffer, control);
+    }
+}
+
+void ServerMonitorRequesterImpl::sentElement(MonitorElement::Ref& element)
+{
+    {
+        Lock guard(_mutex);
+        _nsent++;
+        if(!_pipeline) {
+        } else if(_window_open==0) {
+            // This really shouldn't happen as the above ensures that _window_open *was* non-zero,
+            // and only we (the sender) will decrement.
+            message("Monitor Logic Error: send outside of window", epics::pvData::warningMessage);
+            LOG(logLevelError, "Monitor Logic Error: send outside of window %zu", _window_closed.size());
+
+        } else {
+            _window_closed.push_back(element.letGo());
+            _window_open--;
+            epicsTimeStamp now;
+            epicsTimeGetCurrent(&now);
+            _window_sent.push_back(now);
+        }
+    }
+
+    element.reset(); // calls Monitor::release() if not swap()'d
+
+    // one element at a time for fairness.  Come back for any others.
+    scheduleUpdate();
+}
+
+namespace {
+// thrown when a grouped sub-message doesn't fit in the send buffer
+struct group_full {};
+
+// Serialize into the current send buffer without flushing,
+// always leaving room for the end of the group.
+class GroupSendControl : public TransportSendControl
+{
+    ByteBuffer * const buffer;
+    TransportSendControl * const control;
+    const std::size_t reserve;
+public:
+    GroupSendControl(ByteBuffer* buffer, TransportSendControl* control, std::size_t reserve)
+        :buffer(buffer), control(control), reserve(reserve)
+    {}
+    virtual ~GroupSendControl() {}
+
+    virtual void startMessage(int8 /*command*/, std::size_t /*ensureCapacity*/, int32 /*payloadSize*/) OVERRIDE FINAL { throw group_full(); }
+    virtual void endMessage() OVERRIDE FINAL { throw group_full(); }
+    virtual void flush(bool /*lastMessageCompleted*/) OVERRIDE FINAL { throw group_full(); }
+    virtual void setRecipient(osiSockAddr const & sendTo) OVERRIDE FINAL { control->setRecipient(sendTo); }
+    virtual void flushSerializeBuffer() OVERRIDE FINAL { throw group_full(); }
+    virtual void ensureBuffer(std::size_t size) OVERRIDE FINAL {
+        if (buffer->getRemaining() < size + reserve)
+            throw group_full();
+    }
+    virtual void alignBuffer(std::size_t alignment) OVERRIDE FINAL {
+        if (buffer->getRemaining() < alignment + reserve)
+            throw group_full();
+        control->alignBuffer(alignment);
+    }
+    virtual bool directSerialize(ByteBuffer* /*existingBuffer*/, const char* /*toSerialize*/,
+                                 std::size_t /*elementCount*/, std::size_t /*elementSize*/) OVERRIDE FINAL
+    {
+        return false;
+    }
+    virtual void cachedSerialize(const std::tr1::shared_ptr<const Field>& /*field*/, ByteBuffer* /*buffer*/) OVERRIDE FINAL
+    {
+        // may flush
+        throw group_full();
+    }
+};
+
+// end the list of sub-messages
+void endGroup(ByteBuffer* buffer, TransportSendControl* control)
+{
+    buffer->putInt(INVALID_IOID);
+    control->endMessage();
+}
+}
+
+ServerMonitorRequesterImpl::group_result_t
+ServerMonitorRequesterImpl::sendGrouped(ByteBuffer* buffer, TransportSendControl* control, bool& open)
+{
+    if ((QOS_INIT & getPendingRequest()) != 0)
+    {
+        // INIT response must come first
+        TransportSender::shared_pointer thisSender = shared_from_this();
+        _transport->enqueueSendRequest(thisSender);
+        return groupNone;
+    }
+
+    Monitor::shared_pointer monitor(getChannelMonitor());
+    if (!monitor)
+        return groupNone;
+
+    {
+        Lock guard(_mutex);
+        if(_pipeline && windowClosed()) {
+            _held = true;
+            guard.unlock();
+            heldBack(*monitor);
+            return groupNone;
+        }
+    }
+
+    MonitorElement::Ref element(monitor);
+    if (!element)
+    {
+        bool unlisten;
+        {
+            Lock guard(_mutex);
+            unlisten = _unlisten;
+        }
+        if (unlisten)
+        {
+            // queue drained, QOS_DESTROY is sent by send()
+            TransportSender::shared_pointer thisSender = shared_from_this();
+            _transport->enqueueSendRequest(thisSender);
+        }
+        return groupNone;
+    }
+
+    const int8 request = (int8)getPendingRequest();
+
+    // sub-message header, and end of group
+    const std::size_t overhead = 4+4+1 + 4;
+
+    bool grouped = false;
+    if (!open || buffer->getRemaining() >= overhead)
+    {
+        // leave room for the CMD_MULTIPLE_DATA header, which is only
+        // written once the first sub-message fits.
+        std::size_t messageStart = 0u;
+        if (!open)
+        {
+            control->ensureBuffer(PVA_MESSAGE_HEADER_SIZE + overhead);
+            messageStart = buffer->getPosition();
+            buffer->setPosition(messageStart + PVA_MESSAGE_HEADER_SIZE);
+        }
+
+        const std::size_t start = buffer->getPosition();
+        try
+        {
+            GroupSendControl gcontrol(buffer, control, 4);
+            gcontrol.ensureBuffer(4+4+1);
+            buffer->putInt(_ioid);
+            buffer->putInt(0); // size, filled in below
+            buffer->putByte(request);
+
+            serializeUpdate(*element, buffer, &gcontrol);
+
+            buffer->putInt(start + 4, int32(buffer->getPosition() - start - 4 - 4));
+            grouped = true;
+        }
+        catch (group_full&)
+        {
+            buffer->setPosition(start);
+        }
+
+        if (!open)
+        {
+            if (grouped)
+            {
+                // capacity already ensured, so this does not flush
+                const std::size_t end = buffer->getPosition();
+                buffer->setPosition(messageStart);
+                control->startMessage((int8)CMD_MULTIPLE_DATA, overhead);
+                buffer->setPosition(end);
+                open = true;
+            }
+            else
+            {
+                buffer->setPosition(messageStart);
+            }
+        }
+    }
+
+    if (!grouped)
+    {
+        // doesn't fit, end this group and send on its own
+        if (open)
+        {
+            endGroup(buffer, control);
+            open = false;
+        }
+
+        control->startMessage((int8)CMD_MONITOR, sizeof(int32)/sizeof(int8) + 1);
+        buffer->putInt(_ioid);
+        buffer->putByte(request);
+
+        serializeUpdate(*element, buffer, control);
+
+        control->endMessage();
+    }
+
+    sentElement(element);
+    return grouped ? groupAdded : groupSeparate;
+}
+
+ServerMonitorGroup::ServerMonitorGroup(Transport::shared_pointer const & transport)
+    :_transport(transport)
+{
+    _stats.nmessages = _stats.ngrouped = _stats.nseparate = 0u;
+}
+
+void ServerMonitorGroup::stats(Stats& s) const
+{
+    Lock guard(_mutex);
+    s = _stats;
+}
+
+void ServerMonitorGroup::schedule(ServerMonitorRequesterImpl::shared_pointer const & request)
+{
+    {
+        Lock guard(_mutex);
+        if (request->_grouped)
+            return;
+        request->_grouped = true;
+        _pending.push_back(request);
+        // already queued
+        if (_pending.size() > 1u)
+            return;
+    }
+
+    Transport::shared_pointer transport(_transport.lock());
+    if (transport)
+    {
+        TransportSender::shared_pointer thisSender = shared_from_this();
+        transport->enqueueSendRequest(thisSender);
+    }
+}
+
+void ServerMonitorGroup::send(ByteBuffer* buffer, TransportSendControl* control)
+{
+    pending_t pending;
+    {
+        Lock guard(_mutex);
+        pending.swap(_pending);
+        for (pending_t::const_iterator it = pending.begin(); it != pending.end(); ++it)
+        {
+            ServerMonitorRequesterImpl::shared_pointer request(it->lock());
+            if (request)
+                request->_grouped = false;
+        }
+    }
+
+    Stats counts = {0u, 0u, 0u};
+    bool open = false;
+    for (pending_t::const_iterator it = pending.begin(); it != pending.end(); ++it)
+    {
+        ServerMonitorRequesterImpl::shared_pointer request(it->lock());
+        if (!request)
+            continue;
+
+        const bool wasOpen = open;
+        switch (request->sendGrouped(buffer, control, open))
+        {
+        case ServerMonitorRequesterImpl::groupAdded:
+            counts.ngrouped++;
+            if (!wasOpen)
+                counts.nmessages++;
+            break;
+        case ServerMonitorRequesterImpl::groupSeparate:
+            counts.nseparate++;
+            break;
+        case ServerMonitorRequesterImpl::groupNone:
+            break;
+        }
+    }
+
+    if (open)
+        endGroup(buffer, control);
+
+    Lock guard(_mutex);
+    _stats.nmessages += counts.nmessages;
+    _stats.ngrouped += counts.ngrouped;
+    _stats.nseparate += counts.nseparate;
+}
+
+void ServerMonitorRequesterImpl::ack(size_t cnt, double rate)
 {
     typedef std::vector<MonitorElementPtr> acking_t;
     acking_t acking;
     Monitor::shared_pointer mon;
+    bool resend;
     {
         Lock guard(_mutex);
 
+        const size_t nsent = std::min(cnt, _window_sent.size());
+        if(nsent) {
+            epicsTimeStamp now;
+            epicsTimeGetCurrent(&now);
+            // delay of the most recent update acknowledged
+            double latency = epicsTimeDiffInSeconds(&now, &_window_sent[nsent-1]);
+            if(_ack_latency==0.0) {
+                _ack_latency = _min_ack_latency = latency;
+            } else {
+                _ack_latency = 0.75*_ack_latency + 0.25*latency;
+                _min_ack_latency = std::min(_min_ack_latency, latency);
+            }
+            _window_sent.erase(_window_sent.begin(), _window_sent.begin()+nsent);
+        }
+
+        // A client which reports a drain rate is not keeping up.
+        // Only keep in flight enough updates to cover one round trip at
+        // that rate.  The remainder are squashed in our queue.
+        _client_rate = rate;
+        if(rate>0.0)
+            _window_limit = 2u + size_t(rate * _min_ack_latency);
+        else
+            _window_limit = 0u;
+
+        resend = _held;
+        _held = false;
+
         // cnt will be larger if this is the initial window update,
         // or if the window is being enlarged.
         size_t nack = std::min(cnt, _window_closed.size());
@@ -2105,6 +2677,30 @@ void ServerMonitorRequesterImpl::ack(size_t cnt)
     }
 
     mon->reportRemoteQueueStatus(cnt);
+
+    if(resend)
+        scheduleUpdate();
+}
+
+void ServerMonitorRequesterImpl::getFlowStats(FlowStats& s)
+{
+    Monitor::shared_pointer mon;
+    {
+        Lock guard(_mutex);
+        s.pipeline = _pipeline;
+        s.window = _window_open;
+        s.inflight = _window_closed.size();
+        s.limit = _window_limit;
+        s.ackLatency = _ack_latency;
+        s.clientRate = _client_rate;
+        s.nheld = _nheld;
+        s.nsent = _nsent;
+        mon = _channelMonitor;
+    }
+    Monitor::Stats ms;
+    if(mon)
+        mon->getStats(ms);
+    s.noverrun = ms.noverrun;
 }
 
 /****************************************************************************************/
@@ -2891,5 +3487,279 @@ void ServerChannelRPCRequesterImpl::send(ByteBuffer* buffer, TransportSendContro
         destroy();
 }
 
+
+/****************************************************************************************/
+
+namespace {
+
+// Forwards the results for the channels of one provider to their positions in the full request.
+struct MultiProviderRequester : public ChannelMultiRequester
+{
+    const ChannelMultiRequester::shared_pointer collector;
+    std::vector<size_t> indices;
+
+    MultiProviderRequester(const ChannelMultiRequester::shared_pointer& collector) :collector(collector) {}
+    virtual ~MultiProviderRequester() {}
+
+    virtual std::string getRequesterName() OVERRIDE FINAL { return collector->getRequesterName(); }
+
+    virtual void getManyDone(size_t index, const Status& status,
+                             PVStructure::shared_pointer const & value,
+                             BitSet::shared_pointer const & changed) OVERRIDE FINAL
+    {
+        collector->getManyDone(indices.at(index), status, value, changed);
+    }
+
+    virtual void putManyDone(size_t index, const Status& status) OVERRIDE FINAL
+    {
+        collector->putManyDone(indices.at(index), status);
+    }
+};
+
+struct MultiProviderGroup {
+    ChannelProvider::shared_pointer provider;
+    std::tr1::shared_ptr<MultiProviderRequester> requester;
+    std::vector<Channel::shared_pointer> channels;
+    std::vector<PVStructure::shared_pointer> values;
+    std::vector<BitSet::shared_pointer> changed;
+};
+
+} // namespace
+
+void ServerMultiRequestHandler::handleResponse(osiSockAddr* responseFrom,
+        Transport::shared_pointer const & transport, int8 version, int8 command,
+        size_t payloadSize, ByteBuffer* payloadBuffer)
+{
+    AbstractServerResponseHandler::handleResponse(responseFrom,
+            transport, version, command, payloadSize, payloadBuffer);
+
+    // NOTE: we do not explicitly check if transport is OK
+    detail::BlockingServerTCPTransportCodec* casTransport(static_cast<detail::BlockingServerTCPTransportCodec*>(transport.get()));
+
+    const bool put = command==CMD_MULTI_PUT;
+
+    transport->ensureData(sizeof(int32)/sizeof(int8)+1);
+    const pvAccessID ioid = payloadBuffer->getInt();
+    payloadBuffer->getByte(); // QoS, no modes defined yet
+
+    PVStructure::shared_pointer pvRequest(SerializationHelper::deserializePVRequest(payloadBuffer, transport.get()));
+
+    const size_t count = SerializeHelper::readSize(payloadBuffer, transport.get());
+
+    ServerMultiRequesterImpl::shared_pointer collector(new ServerMultiRequesterImpl(transport, _context->getTimer(), command, ioid));
+
+    typedef std::map<ChannelProvider*, MultiProviderGroup> groups_t;
+    groups_t groups;
+
+    // decode the whole request before starting any operation.
+    // count comes from the peer, so only allocate for entries actually decoded.
+    std::vector<std::pair<size_t, Status> > failed;
+    for(size_t i=0; i<count; i++)
+    {
+        transport->ensureData(sizeof(int32)/sizeof(int8));
+        const pvAccessID sid = payloadBuffer->getInt();
+
+        PVStructure::shared_pointer value;
+        BitSet::shared_pointer changed;
+        if(put) {
+            value = SerializationHelper::deserializeStructureFull(payloadBuffer, transport.get());
+            changed.reset(new BitSet);
+            changed->deserialize(payloadBuffer, transport.get());
+        }
+
+        const size_t index = collector->add();
+
+        ServerChannel::shared_pointer channel = casTransport->getChannel(sid);
+        if (!channel)
+        {
+            failed.push_back(std::make_pair(index, BaseChannelRequester::badCIDStatus));
+            continue;
+        }
+
+        Channel::shared_pointer chan(channel->getChannel());
+        ChannelProvider::shared_pointer provider(chan->getProvider());
+        if(!provider)
+        {
+            failed.push_back(std::make_pair(index, BaseChannelRequester::badCIDStatus));
+            continue;
+        }
+
+        MultiProviderGroup& group = groups[provider.get()];
+        if(!group.provider) {
+            group.provider = provider;
+            group.requester.reset(new MultiProviderRequester(collector));
+        }
+        group.requester->indices.push_back(index);
+        group.channels.push_back(chan);
+        if(put) {
+            group.values.push_back(value);
+            group.changed.push_back(changed);
+        }
+    }
+
+    // sends now if there are no entries
+    collector->activate();
+
+    for(size_t i=0; i<failed.size(); i++)
+    {
+        if(put)
+            collector->putManyDone(failed[i].first, failed[i].second);
+        else
+            collector->getManyDone(failed[i].first, failed[i].second, PVStructure::shared_pointer(), BitSet::shared_pointer());
+    }
+
+    for(groups_t::iterator it(groups.begin()), end(groups.end()); it!=end; ++it)
+    {
+        MultiProviderGroup& group = it->second;
+        try {
+            if(put)
+                group.provider->putMany(group.channels, pvRequest, group.values, group.changed, group.requester);
+            else
+                group.provider->getMany(group.channels, pvRequest, group.requester);
+        } catch(std::exception& e) {
+            // fails only those entries not already completed
+            Status status(Status::STATUSTYPE_FATAL, e.what());
+            for(size_t i=0; i<group.channels.size(); i++)
+            {
+                if(put)
+                    group.requester->putManyDone(i, status);
+                else
+                    group.requester->getManyDone(i, status, PVStructure::shared_pointer(), BitSet::shared_pointer());
+            }
+        }
+    }
+}
+
+ServerMultiRequesterImpl::ServerMultiRequesterImpl(Transport::shared_pointer const & transport,
+        TimerWheel::shared_pointer const & timer,
+        const int8 command, const pvAccessID ioid)
+    :_transport(transport)
+    ,_timer(timer)
+    ,_command(command)
+    ,_ioid(ioid)
+    ,_pending(0u)
+{}
+
+size_t ServerMultiRequesterImpl::add()
+{
+    Lock guard(_mutex);
+    _results.push_back(result_t());
+    return _results.size()-1u;
+}
+
+void ServerMultiRequesterImpl::activate()
+{
+    bool empty;
+    {
+        Lock guard(_mutex);
+        _pending = _results.size();
+        empty = _pending==0u;
+    }
+
+    if(empty)
+    {
+        TransportSender::shared_pointer thisSender = shared_from_this();
+        _transport->enqueueSendRequest(thisSender);
+    }
+    else if(TimerWheel::shared_pointer timer = _timer.lock())
+    {
+        timer->scheduleAfterDelay(shared_from_this(), MULTI_REQUEST_SERVER_TIMEOUT);
+    }
+}
+
+void ServerMultiRequesterImpl::callback()
+{
+    // fail whatever has not completed
+    size_t nresults;
+    {
+        Lock guard(_mutex);
+        nresults = _results.size();
+    }
+    const Status timeout(Status::STATUSTYPE_ERROR, "Timeout");
+    for(size_t i=0; i<nresults; i++)
+        complete(i, timeout, PVStructure::shared_pointer(), BitSet::shared_pointer());
+}
+
+std::string ServerMultiRequesterImpl::getRequesterName()
+{
+    std::stringstream name;
+    name<<"ServerMultiRequesterImpl "<<_transport->getRemoteName();
+    return name.str();
+}
+
+void ServerMultiRequesterImpl::getManyDone(size_t index, const Status& status,
+        PVStructure::shared_pointer const & value,
+        BitSet::shared_pointer const & changed)
+{
+    complete(index, status, value, changed);
+}
+
+void ServerMultiRequesterImpl::putManyDone(size_t index, const Status& status)
+{
+    complete(index, status, PVStructure::shared_pointer(), BitSet::shared_pointer());
+}
+
+void ServerMultiRequesterImpl::complete(size_t index, const Status& status,
+                                        PVStructure::shared_pointer const & value,
+                                        BitSet::shared_pointer const & changed)
+{
+    bool last;
+    {
+        Lock guard(_mutex);
+        if(index>=_results.size() || _results[index].done)
+            return;
+        result_t& result = _results[index];
+        result.done = true;
+        result.status = status;
+        if(_command!=CMD_MULTI_GET || !status.isSuccess()) {
+            // no data
+        } else if(!value || !changed) {
+            result.status = Status(Status::STATUSTYPE_ERROR, "get completed without data");
+        } else {
+            // the value belongs to the provider after we return, so take a copy
+            result.value = getPVDataCreate()->createPVStructure(value->getStructure());
+            result.changed.reset(new BitSet(*changed));
+            result.value->copyUnchecked(*value, *result.changed);
+        }
+        last = --_pending==0u;
+    }
+
+    if(last)
+    {
+        if(TimerWheel::shared_pointer timer = _timer.lock())
+            timer->cancel(shared_from_this());
+        TransportSender::shared_pointer thisSender = shared_from_this();
+        _transport->enqueueSendRequest(thisSender);
+    }
+}
+
+void ServerMultiRequesterImpl::send(ByteBuffer* buffer, TransportSendControl* control)
+{
+    // take the results, so that a late complete() finds nothing to change
+    std::vector<result_t> results;
+    {
+        Lock guard(_mutex);
+        results.swap(_results);
+    }
+
+    control->startMessage(_command, sizeof(int32)/sizeof(int8) + 1);
+    buffer->putInt(_ioid);
+    buffer->put((int8)0);
+    SerializeHelper::writeSize(results.size(), buffer, control);
+
+    for(size_t i=0; i<results.size(); i++)
+    {
+        const result_t& result = results[i];
+        result.status.serialize(buffer, control);
+
+        if (result.value)
+        {
+            control->cachedSerialize(result.value->getStructure(), buffer);
+            result.changed->serialize(buffer, control);
+            result.value->serialize(buffer, control, result.changed.get());
+        }
+    }
+}
+
 }
 }
@@ -60,6 +60,12 @@ std::tr1::shared_ptr<BaseChannelRequester> ServerChannel::getRequest(const pvAcc
     return BaseChannelRequester::shared_pointer();
 }
 
+void ServerChannel::getRequests(requests_t& requests) const
+{
+    Lock guard(_mutex);
+    requests.assign(_requests.begin(), _requests.end());
+}
+
 void ServerChannel::destroy()
 {
     _requests_t reqs;
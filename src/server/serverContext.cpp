@@ -39,9 +39,15 @@ ServerContextImpl::ServerContextImpl():
     _broadcastPort(PVA_BROADCAST_PORT),
     _serverPort(PVA_SERVER_PORT),
     _receiveBufferSize(MAX_TCP_RECV),
-    _timer(new Timer("PVAS timers", lowerPriority)),
+    _groupMonitors(true),
+    _maxHandshakes(MAX_PENDING_HANDSHAKES),
+    _maxBufferSize(MAX_TCP_BUFFER),
+    _statsPrefix(),
+    _statsPeriod(1.0),
+    _timer(new TimerWheel("PVAS timers", lowerPriority)),
     _beaconEmitter(),
     _acceptor(),
+    _unixAcceptor(),
     _transportRegistry(),
     _channelProviders(),
     _beaconServerStatusProvider(),
@@ -145,6 +151,24 @@ void ServerContextImpl::loadConfiguration()
     _receiveBufferSize = config->getPropertyAsInteger("EPICS_PVA_MAX_ARRAY_BYTES", _receiveBufferSize);
     _receiveBufferSize = config->getPropertyAsInteger("EPICS_PVAS_MAX_ARRAY_BYTES", _receiveBufferSize);
 
+    _unixSocketPath = config->getPropertyAsString("EPICS_PVAS_UNIX_SOCKET", _unixSocketPath);
+
+    _groupMonitors = config->getPropertyAsBoolean("EPICS_PVAS_GROUP_MONITORS", _groupMonitors);
+
+    _maxHandshakes = config->getPropertyAsInteger("EPICS_PVAS_MAX_HANDSHAKES", _maxHandshakes);
+    if(_maxHandshakes<0)
+        _maxHandshakes = 0;
+
+    _maxBufferSize = config->getPropertyAsInteger("EPICS_PVA_MAX_BUFFER_SIZE", _maxBufferSize);
+    _maxBufferSize = config->getPropertyAsInteger("EPICS_PVAS_MAX_BUFFER_SIZE", _maxBufferSize);
+    if(_maxBufferSize<0)
+        _maxBufferSize = 0;
+
+    _statsPrefix = config->getPropertyAsString("EPICS_PVAS_STATS_PREFIX", _statsPrefix);
+    _statsPeriod = config->getPropertyAsDouble("EPICS_PVAS_STATS_PERIOD", _statsPeriod);
+    if(_statsPeriod<0.1)
+        _statsPeriod = 0.1;
+
     if(_channelProviders.empty()) {
         std::string providers = config->getPropertyAsString("EPICS_PVAS_PROVIDER_NAMES", PVACCESS_DEFAULT_PROVIDER);
 
@@ -185,6 +209,11 @@ void ServerContextImpl::loadConfiguration()
     if(_channelProviders.empty())
         LOG(logLevelError, "ServerContext configured with no Providers will do nothing!\n");
 
+    if(!_statsPrefix.empty()) {
+        _stats.reset(new ServerStats(shared_from_this(), _statsPrefix, _statsPeriod));
+        _channelProviders.push_back(_stats->getProvider());
+    }
+
     //
     // introspect network interfaces
     //
@@ -214,6 +243,9 @@ ServerContextImpl::getCurrentConfig()
 
     std::ostringstream providerName;
     for(size_t i=0; i<_channelProviders.size(); i++) {
+        // not from the registry, and re-created from EPICS_PVAS_STATS_PREFIX
+        if(_stats && _channelProviders[i]==_stats->getProvider())
+            continue;
         if(i>0)
             providerName<<" ";
         providerName<<_channelProviders[i]->getProviderName();
@@ -250,6 +282,18 @@ ServerContextImpl::getCurrentConfig()
 
     SET("EPICS_PVAS_PROVIDER_NAMES", providerName.str());
 
+    SET("EPICS_PVAS_UNIX_SOCKET", _unixSocketPath);
+
+    SET("EPICS_PVAS_GROUP_MONITORS", _groupMonitors ? "YES" : "NO");
+
+    SET("EPICS_PVAS_MAX_HANDSHAKES", _maxHandshakes);
+
+    SET("EPICS_PVAS_MAX_BUFFER_SIZE", _maxBufferSize);
+    SET("EPICS_PVA_MAX_BUFFER_SIZE", _maxBufferSize);
+
+    SET("EPICS_PVAS_STATS_PREFIX", _statsPrefix);
+    SET("EPICS_PVAS_STATS_PERIOD", _statsPeriod);
+
 #undef SET
 
     return B.push_map().build();
@@ -273,8 +317,14 @@ void ServerContextImpl::initialize()
     _responseHandler.reset(new ServerResponseHandler(thisServerContext));
 
     _acceptor.reset(new BlockingTCPAcceptor(thisServerContext, _responseHandler, _ifaceAddr, _receiveBufferSize));
+    _acceptor->setMaxHandshakes(_maxHandshakes);
     _serverPort = ntohs(_acceptor->getBindAddress()->ia.sin_port);
 
+    if(!_unixSocketPath.empty()) {
+        _unixAcceptor.reset(new BlockingTCPAcceptor(thisServerContext, _responseHandler, _unixSocketPath, _receiveBufferSize));
+        _unixAcceptor->setMaxHandshakes(_maxHandshakes);
+    }
+
     // setup broadcast UDP transport
     initializeUDPTransports(true, _udpTransports, _ifaceList, _responseHandler, _broadcastTransport,
                             _broadcastPort, _autoBeaconAddressList, _beaconAddressList, _ignoreAddressList);
@@ -282,6 +332,9 @@ void ServerContextImpl::initialize()
     _beaconEmitter.reset(new BeaconEmitter("tcp", _broadcastTransport, thisServerContext));
 
     _beaconEmitter->start();
+
+    if(_stats)
+        _stats->start();
 }
 
 void ServerContextImpl::run(uint32 seconds)
@@ -321,6 +374,17 @@ void ServerContextImpl::shutdown()
     }
     _udpTransports.clear();
 
+    // stop updating statistics, and disconnect its clients
+    ServerStats::shared_pointer stats;
+    {
+        Lock guard(_mutex);
+        stats.swap(_stats);
+    }
+    if (stats)
+    {
+        stats->destroy();
+    }
+
     // stop emitting beacons
     if (_beaconEmitter)
     {
@@ -344,6 +408,12 @@ void ServerContextImpl::shutdown()
         LEAK_CHECK(_acceptor, "_acceptor")
         _acceptor.reset();
     }
+    if (_unixAcceptor)
+    {
+        _unixAcceptor->destroy();
+        LEAK_CHECK(_unixAcceptor, "_unixAcceptor")
+        _unixAcceptor.reset();
+    }
 
     // this will also destroy all channels
     _transportRegistry.clear();
@@ -382,7 +452,13 @@ void ServerContextImpl::printInfo(ostream& str, int lvl)
             << "BEACON_PERIOD : " << _beaconPeriod << endl
             << "BROADCAST_PORT : " << _broadcastPort << endl
             << "SERVER_PORT : " << _serverPort << endl
+            << "UNIX_SOCKET : " << _unixSocketPath << endl
+            << "GROUP_MONITORS : " << _groupMonitors << endl
+            << "MAX_HANDSHAKES : " << _maxHandshakes << endl
             << "RCV_BUFFER_SIZE : " << _receiveBufferSize << endl
+            << "MAX_BUFFER_SIZE : " << _maxBufferSize << endl
+            << "STATS_PREFIX : " << _statsPrefix << endl
+            << "STATS_PERIOD : " << _statsPeriod << endl
             << "IGNORE_ADDR_LIST: " << _ignoreAddressList << endl
             << "INTF_ADDR_LIST : " << inetAddressToString(_ifaceAddr, false) << endl;
 
@@ -436,9 +512,19 @@ void ServerContextImpl::printInfo(ostream& str, int lvl)
             str<<"\n";
 
             if(!casTransport || lvl<2)
-                return;
+                continue;
             // lvl >= 2
 
+            detail::AbstractCodec::BufferStats bstats;
+            casTransport->getBufferStats(bstats);
+            str<<"    rx buffer "<<bstats.receiveBufferSize<<"/"<<bstats.maxReceiveBufferSize
+               <<" "<<bstats.nrxMessages<<" messages in "<<bstats.nrxSegments<<" segments (max "<<bstats.maxRxSegments<<")"
+               <<", tx buffer "<<bstats.sendBufferSize<<"/"<<bstats.maxSendBufferSize
+               <<" "<<bstats.ntxMessages<<" messages in "<<bstats.ntxSegments<<" segments (max "<<bstats.maxTxSegments<<")"
+               <<", grown "<<bstats.ngrow<<", shrunk "<<bstats.nshrink
+               <<", "<<bstats.nrxBytes<<" bytes in, "<<bstats.ntxBytes<<" bytes out"
+               <<", send queue "<<casTransport->sendQueueSize()<<"\n";
+
             typedef std::vector<ServerChannel::shared_pointer> channels_t;
             channels_t channels;
             casTransport->getChannels(channels);
@@ -457,6 +543,35 @@ void ServerContextImpl::printInfo(ostream& str, int lvl)
                     providerChan->printInfo(str);
                 }
                 str<<"\n";
+
+                if(lvl<3)
+                    continue;
+                // lvl >= 3
+
+                ServerChannel::requests_t requests;
+                channel->getRequests(requests);
+
+                for(ServerChannel::requests_t::const_iterator rit(requests.begin()), rend(requests.end()); rit!=rend; ++rit)
+                {
+                    ServerMonitorRequesterImpl *mon = dynamic_cast<ServerMonitorRequesterImpl*>(rit->second.get());
+                    if(!mon)
+                        continue;
+
+                    ServerMonitorRequesterImpl::FlowStats stats;
+                    mon->getFlowStats(stats);
+
+                    str<<"    monitor ioid="<<rit->first;
+                    if(stats.pipeline) {
+                        str<<" window="<<stats.window
+                           <<" inflight="<<stats.inflight;
+                        if(stats.limit)
+                            str<<" limit="<<stats.limit
+                               <<" client="<<stats.clientRate<<"/s";
+                        str<<" ack="<<stats.ackLatency*1e3<<"ms"
+                           <<" held="<<stats.nheld;
+                    }
+                    str<<" overrun="<<stats.noverrun<<"\n";
+                }
             }
         }
     }
@@ -502,6 +617,17 @@ std::string ServerContextImpl::getIgnoreAddressList()
     return _ignoreAddressList;
 }
 
+void ServerContextImpl::transportClosed(Transport::shared_pointer const & transport)
+{
+    ServerStats::shared_pointer stats;
+    {
+        Lock guard(_mutex);
+        stats = _stats;
+    }
+    if(stats)
+        stats->transportClosed(transport);
+}
+
 BeaconServerStatusProvider::shared_pointer ServerContextImpl::getBeaconServerStatusProvider()
 {
     return _beaconServerStatusProvider;
@@ -526,7 +652,7 @@ const std::vector<ChannelProvider::shared_pointer>& ServerContextImpl::getChanne
     return _channelProviders;
 }
 
-Timer::shared_pointer ServerContextImpl::getTimer()
+TimerWheel::shared_pointer ServerContextImpl::getTimer()
 {
     return _timer;
 }
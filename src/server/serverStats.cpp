@@ -0,0 +1,464 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <vector>
+#include <sstream>
+
+#include <string.h>
+
+#include <epicsTime.h>
+
+#include <pv/pvData.h>
+#include <pv/standardField.h>
+#include <pv/sharedVector.h>
+#include <pv/bitSet.h>
+
+#define epicsExportSharedSymbols
+#include <pv/serverStats.h>
+#include <pv/serverContextImpl.h>
+#include <pv/responseHandlers.h>
+#include <pv/codec.h>
+#include <pv/logger.h>
+
+using namespace std;
+using namespace epics::pvData;
+
+namespace epics {
+namespace pvAccess {
+
+namespace {
+
+typedef detail::BlockingServerTCPTransportCodec::HandlerStats HandlerStats;
+
+const char * const commandNames[HandlerStats::ncommands] = {
+    "beacon",
+    "connectionValidation",
+    "echo",
+    "search",
+    "searchResponse",
+    "authNZ",
+    "aclChange",
+    "createChannel",
+    "destroyChannel",
+    "connectionValidated",
+    "get",
+    "put",
+    "putGet",
+    "monitor",
+    "array",
+    "destroyRequest",
+    "process",
+    "getField",
+    "message",
+    "multipleData",
+    "rpc",
+    "cancelRequest",
+    "originTag",
+    "multiGet",
+    "multiPut",
+};
+
+struct Column {
+    std::string name, label;
+    ScalarType type;
+    Column(const std::string& name, const std::string& label, ScalarType type)
+        :name(name), label(label), type(type) {}
+};
+typedef std::vector<Column> columns_t;
+
+PVStructurePtr buildTable(const columns_t& columns)
+{
+    FieldBuilderPtr builder(getFieldCreate()->createFieldBuilder());
+    builder->setId("epics:nt/NTTable:1.0")
+           ->addArray("labels", pvString)
+           ->addNestedStructure("value");
+    for(size_t i=0; i<columns.size(); i++)
+        builder->addArray(columns[i].name, columns[i].type);
+    builder->endNested()
+           ->add("timeStamp", getStandardField()->timeStamp());
+
+    PVStructurePtr root(getPVDataCreate()->createPVStructure(builder->createStructure()));
+
+    PVStringArray::svector labels(columns.size());
+    for(size_t i=0; i<columns.size(); i++)
+        labels[i] = columns[i].label;
+    root->getSubFieldT<PVStringArray>("labels")->replace(freeze(labels));
+    return root;
+}
+
+columns_t transportColumns()
+{
+    columns_t cols;
+    cols.push_back(Column("remote", "Client", pvString));
+    cols.push_back(Column("account", "Account", pvString));
+    cols.push_back(Column("channels", "Channels", pvUInt));
+    cols.push_back(Column("bytesIn", "Bytes in", pvULong));
+    cols.push_back(Column("bytesOut", "Bytes out", pvULong));
+    cols.push_back(Column("bytesInRate", "Bytes/s in", pvDouble));
+    cols.push_back(Column("bytesOutRate", "Bytes/s out", pvDouble));
+    cols.push_back(Column("messagesIn", "Messages in", pvULong));
+    cols.push_back(Column("messagesOut", "Messages out", pvULong));
+    cols.push_back(Column("segmentsIn", "Segments in", pvULong));
+    cols.push_back(Column("segmentsOut", "Segments out", pvULong));
+    cols.push_back(Column("sendQueue", "Send queue", pvUInt));
+    return cols;
+}
+
+columns_t channelColumns()
+{
+    columns_t cols;
+    cols.push_back(Column("channel", "Channel", pvString));
+    cols.push_back(Column("remote", "Client", pvString));
+    cols.push_back(Column("monitors", "Monitors", pvUInt));
+    cols.push_back(Column("updates", "Updates", pvULong));
+    cols.push_back(Column("updateRate", "Updates/s", pvDouble));
+    cols.push_back(Column("overruns", "Overruns", pvULong));
+    return cols;
+}
+
+columns_t latencyColumns()
+{
+    columns_t cols;
+    cols.push_back(Column("command", "Command", pvString));
+    cols.push_back(Column("count", "Count", pvULong));
+    cols.push_back(Column("p50", "50% < us", pvDouble));
+    cols.push_back(Column("p90", "90% < us", pvDouble));
+    cols.push_back(Column("p99", "99% < us", pvDouble));
+    for(size_t i=0; i<size_t(HandlerStats::nbuckets); i++) {
+        std::ostringstream name, label;
+        name<<"lt"<<(1u<<i)<<"us";
+        label<<"< "<<(1u<<i)<<" us";
+        if(i+1u==size_t(HandlerStats::nbuckets))
+            label<<" (and longer)";
+        cols.push_back(Column(name.str(), label.str(), pvULong));
+    }
+    return cols;
+}
+
+template<typename T>
+void putColumn(PVStructure& root, const std::string& name, typename PVValueArray<T>::svector& col)
+{
+    root.getSubFieldT<PVValueArray<T> >("value."+name)->replace(freeze(col));
+}
+
+void postTable(const pvas::SharedPV::shared_pointer& pv, PVStructure& root, const epicsTimeStamp& now)
+{
+    root.getSubFieldT<PVLong>("timeStamp.secondsPastEpoch")->put(now.secPastEpoch + POSIX_TIME_AT_EPICS_EPOCH);
+    root.getSubFieldT<PVInt>("timeStamp.nanoseconds")->put(now.nsec);
+
+    // labels are unchanged since open()
+    BitSet changed;
+    changed.set(root.getSubFieldT<PVStructure>("value")->getFieldOffset());
+    changed.set(root.getSubFieldT<PVStructure>("timeStamp")->getFieldOffset());
+    pv->post(root, changed);
+}
+
+// upper bound of the histogram bucket holding the given fraction of all counts
+double percentile(const size_t *hist, size_t total, double fraction)
+{
+    const size_t target = size_t(fraction*total);
+    size_t sum = 0u;
+    for(size_t i=0; i<size_t(HandlerStats::nbuckets); i++) {
+        sum += hist[i];
+        if(sum > target)
+            return double(1u<<i);
+    }
+    return double(1u<<(HandlerStats::nbuckets-1));
+}
+
+} // namespace
+
+ServerStats::ServerStats(const std::tr1::shared_ptr<ServerContextImpl>& context,
+                         const std::string& prefix, double period)
+    :_context(context)
+    ,_timer(context->getTimer())
+    ,_period(period)
+    ,_provider("serverStats")
+    ,_transports(pvas::SharedPV::buildReadOnly())
+    ,_channels(pvas::SharedPV::buildReadOnly())
+    ,_latency(pvas::SharedPV::buildReadOnly())
+    ,_updated(false)
+    ,_closedLatency(size_t(HandlerStats::ncommands)*size_t(HandlerStats::nbuckets), 0u)
+{
+    _transports->open(*buildTable(transportColumns()));
+    _channels->open(*buildTable(channelColumns()));
+    _latency->open(*buildTable(latencyColumns()));
+
+    _provider.add(prefix+"transports", _transports);
+    _provider.add(prefix+"channels", _channels);
+    _provider.add(prefix+"latency", _latency);
+}
+
+ServerStats::~ServerStats() {}
+
+ChannelProvider::shared_pointer ServerStats::getProvider() const
+{
+    return _provider.provider();
+}
+
+void ServerStats::start()
+{
+    TimerWheel::shared_pointer timer(_timer.lock());
+    if(timer)
+        timer->schedulePeriodic(shared_from_this(), 0.0, _period);
+}
+
+void ServerStats::destroy()
+{
+    TimerWheel::shared_pointer timer(_timer.lock());
+    if(timer)
+        timer->cancel(shared_from_this());
+    _provider.close(true);
+}
+
+void ServerStats::timerStopped()
+{
+    //noop
+}
+
+void ServerStats::callback()
+{
+    try {
+        update();
+    } catch(std::exception& e) {
+        LOG(logLevelError, "Error updating server statistics: %s", e.what());
+    }
+}
+
+void ServerStats::transportClosed(Transport::shared_pointer const & transport)
+{
+    detail::BlockingTCPTransportCodec *codec = dynamic_cast<detail::BlockingTCPTransportCodec*>(transport.get());
+    if(!codec)
+        return;
+
+    Lock G(_closedMutex);
+    // counters are moved, so update() doesn't count them twice
+    HandlerStats hstats;
+    if(!codec->takeHandlerStats(hstats))
+        return;
+    for(size_t c=0; c<size_t(HandlerStats::ncommands); c++)
+        for(size_t b=0; b<size_t(HandlerStats::nbuckets); b++)
+            _closedLatency[c*HandlerStats::nbuckets + b] += hstats.latency[c][b];
+}
+
+void ServerStats::update()
+{
+    std::tr1::shared_ptr<ServerContextImpl> context(_context.lock());
+    if(!context)
+        return;
+
+    epicsTimeStamp now;
+    epicsTimeGetCurrent(&now);
+    // rates are zero on the first update
+    const double dt = _updated ? epicsTimeDiffInSeconds(&now, &_lastUpdate) : 0.0;
+    _lastUpdate = now;
+    _updated = true;
+
+    TransportRegistry::transportVector_t transports;
+    context->getTransportRegistry()->toArray(transports);
+
+    PVStringArray::svector remote, account;
+    PVUIntArray::svector nchannels, sendQueue;
+    PVULongArray::svector bytesIn, bytesOut, messagesIn, messagesOut, segmentsIn, segmentsOut;
+    PVDoubleArray::svector bytesInRate, bytesOutRate;
+
+    PVStringArray::svector chanName, chanRemote;
+    PVUIntArray::svector chanMonitors;
+    PVULongArray::svector chanUpdates, chanOverruns;
+    PVDoubleArray::svector chanRate;
+
+    transportSamples_t transportSamples;
+    channelSamples_t channelSamples;
+
+    for(TransportRegistry::transportVector_t::const_iterator it(transports.begin()), end(transports.end());
+        it!=end; ++it)
+    {
+        const Transport::shared_pointer& transport(*it);
+        const detail::BlockingServerTCPTransportCodec *casTransport = dynamic_cast<const detail::BlockingServerTCPTransportCodec*>(transport.get());
+        if(!casTransport)
+            continue;
+
+        const std::string name(transport->getType()+"://"+transport->getRemoteName());
+
+        detail::AbstractCodec::BufferStats bstats;
+        casTransport->getBufferStats(bstats);
+
+        TransportSample& sample = transportSamples[transport.get()];
+        sample.transport = transport;
+        sample.nrxBytes = bstats.nrxBytes;
+        sample.ntxBytes = bstats.ntxBytes;
+
+        double rxRate = 0.0, txRate = 0.0;
+        transportSamples_t::const_iterator prev(_transportSamples.find(transport.get()));
+        if(dt>0.0 && prev!=_transportSamples.end() && prev->second.transport.lock()==transport) {
+            rxRate = double(bstats.nrxBytes - prev->second.nrxBytes)/dt;
+            txRate = double(bstats.ntxBytes - prev->second.ntxBytes)/dt;
+        }
+
+        std::string user;
+        {
+            PeerInfo::const_shared_pointer peer;
+            {
+                epicsGuard<epicsMutex> G(casTransport->_mutex);
+                peer = casTransport->_peerInfo;
+            }
+            if(peer) {
+                user = peer->authority+"/"+peer->account;
+                if(!peer->realm.empty())
+                    user += "@"+peer->realm;
+            }
+        }
+
+        remote.push_back(name);
+        account.push_back(user);
+        nchannels.push_back(casTransport->getChannelCount());
+        bytesIn.push_back(bstats.nrxBytes);
+        bytesOut.push_back(bstats.ntxBytes);
+        bytesInRate.push_back(rxRate);
+        bytesOutRate.push_back(txRate);
+        messagesIn.push_back(bstats.nrxMessages);
+        messagesOut.push_back(bstats.ntxMessages);
+        segmentsIn.push_back(bstats.nrxSegments);
+        segmentsOut.push_back(bstats.ntxSegments);
+        sendQueue.push_back(casTransport->sendQueueSize());
+
+        typedef std::vector<ServerChannel::shared_pointer> channels_t;
+        channels_t channels;
+        casTransport->getChannels(channels);
+
+        for(channels_t::const_iterator cit(channels.begin()), cend(channels.end()); cit!=cend; ++cit)
+        {
+            const ServerChannel::shared_pointer& channel(*cit);
+            const Channel::shared_pointer& providerChan(channel->getChannel());
+            if(!providerChan)
+                continue;
+
+            ServerChannel::requests_t requests;
+            channel->getRequests(requests);
+
+            size_t nmonitors = 0u, nsent = 0u, noverrun = 0u;
+            for(ServerChannel::requests_t::const_iterator rit(requests.begin()), rend(requests.end()); rit!=rend; ++rit)
+            {
+                ServerMonitorRequesterImpl *mon = dynamic_cast<ServerMonitorRequesterImpl*>(rit->second.get());
+                if(!mon)
+                    continue;
+
+                ServerMonitorRequesterImpl::FlowStats stats;
+                mon->getFlowStats(stats);
+                nmonitors++;
+                nsent += stats.nsent;
+                noverrun += stats.noverrun;
+            }
+
+            ChannelSample& csample = channelSamples[channel.get()];
+            csample.channel = channel;
+            csample.nsent = nsent;
+
+            double rate = 0.0;
+            channelSamples_t::const_iterator cprev(_channelSamples.find(channel.get()));
+            // monitors may have been destroyed since
+            if(dt>0.0 && cprev!=_channelSamples.end() && cprev->second.channel.lock()==channel
+                    && nsent >= cprev->second.nsent)
+                rate = double(nsent - cprev->second.nsent)/dt;
+
+            chanName.push_back(providerChan->getChannelName());
+            chanRemote.push_back(name);
+            chanMonitors.push_back(nmonitors);
+            chanUpdates.push_back(nsent);
+            chanRate.push_back(rate);
+            chanOverruns.push_back(noverrun);
+        }
+    }
+
+    _transportSamples.swap(transportSamples);
+    _channelSamples.swap(channelSamples);
+
+    // totals since start, including closed connections.
+    // Summed with _closedMutex locked, so that a connection closing meanwhile is counted once.
+    HandlerStats latency;
+    {
+        Lock G(_closedMutex);
+        for(size_t c=0; c<size_t(HandlerStats::ncommands); c++)
+            for(size_t b=0; b<size_t(HandlerStats::nbuckets); b++)
+                latency.latency[c][b] = _closedLatency[c*HandlerStats::nbuckets + b];
+
+        for(TransportRegistry::transportVector_t::const_iterator it(transports.begin()), end(transports.end());
+            it!=end; ++it)
+        {
+            const detail::BlockingServerTCPTransportCodec *casTransport = dynamic_cast<const detail::BlockingServerTCPTransportCodec*>(it->get());
+            HandlerStats hstats;
+            if(!casTransport || !casTransport->getHandlerStats(hstats))
+                continue;
+            for(size_t c=0; c<size_t(HandlerStats::ncommands); c++)
+                for(size_t b=0; b<size_t(HandlerStats::nbuckets); b++)
+                    latency.latency[c][b] += hstats.latency[c][b];
+        }
+    }
+
+    {
+        PVStructurePtr root(_transports->build());
+        putColumn<std::string>(*root, "remote", remote);
+        putColumn<std::string>(*root, "account", account);
+        putColumn<uint32>(*root, "channels", nchannels);
+        putColumn<uint64>(*root, "bytesIn", bytesIn);
+        putColumn<uint64>(*root, "bytesOut", bytesOut);
+        putColumn<double>(*root, "bytesInRate", bytesInRate);
+        putColumn<double>(*root, "bytesOutRate", bytesOutRate);
+        putColumn<uint64>(*root, "messagesIn", messagesIn);
+        putColumn<uint64>(*root, "messagesOut", messagesOut);
+        putColumn<uint64>(*root, "segmentsIn", segmentsIn);
+        putColumn<uint64>(*root, "segmentsOut", segmentsOut);
+        putColumn<uint32>(*root, "sendQueue", sendQueue);
+        postTable(_transports, *root, now);
+    }
+    {
+        PVStructurePtr root(_channels->build());
+        putColumn<std::string>(*root, "channel", chanName);
+        putColumn<std::string>(*root, "remote", chanRemote);
+        putColumn<uint32>(*root, "monitors", chanMonitors);
+        putColumn<uint64>(*root, "updates", chanUpdates);
+        putColumn<double>(*root, "updateRate", chanRate);
+        putColumn<uint64>(*root, "overruns", chanOverruns);
+        postTable(_channels, *root, now);
+    }
+    {
+        PVStringArray::svector command;
+        PVULongArray::svector count;
+        PVDoubleArray::svector p50, p90, p99;
+        std::vector<PVULongArray::svector> buckets(HandlerStats::nbuckets);
+
+        for(size_t c=0; c<size_t(HandlerStats::ncommands); c++) {
+            const size_t *hist = latency.latency[c];
+            size_t total = 0u;
+            for(size_t b=0; b<size_t(HandlerStats::nbuckets); b++)
+                total += hist[b];
+            if(!total)
+                continue;
+
+            command.push_back(commandNames[c]);
+            count.push_back(total);
+            p50.push_back(percentile(hist, total, 0.50));
+            p90.push_back(percentile(hist, total, 0.90));
+            p99.push_back(percentile(hist, total, 0.99));
+            for(size_t b=0; b<size_t(HandlerStats::nbuckets); b++)
+                buckets[b].push_back(hist[b]);
+        }
+
+        const columns_t cols(latencyColumns());
+        PVStructurePtr root(_latency->build());
+        putColumn<std::string>(*root, "command", command);
+        putColumn<uint64>(*root, "count", count);
+        putColumn<double>(*root, "p50", p50);
+        putColumn<double>(*root, "p90", p90);
+        putColumn<double>(*root, "p99", p99);
+        for(size_t b=0; b<size_t(HandlerStats::nbuckets); b++)
+            putColumn<uint64>(*root, cols[5u+b].name, buckets[b]);
+        postTable(_latency, *root, now);
+    }
+}
+
+}
+}
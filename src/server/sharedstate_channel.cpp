@@ -4,6 +4,7 @@
  */
 
 #include <list>
+#include <sstream>
 
 #include <epicsMutex.h>
 #include <epicsGuard.h>
@@ -226,6 +227,19 @@ pva::Monitor::shared_pointer SharedChannel::createMonitor(
 
         } else {
             owner->monitors.push_back(ret.get());
+
+            {
+                const std::string key(MonitorGroup::keyOf(*pvRequest));
+                std::tr1::shared_ptr<MonitorGroup>& group = owner->monitorGroups[key];
+                if(!group) {
+                    group.reset(new MonitorGroup(key, pvRequest));
+                    if(owner->type)
+                        group->compute(owner->type, owner->config.mapperMode);
+                }
+                group->nmembers++;
+                ret->group = group;
+            }
+
             notify = !!owner->type;
             if(notify) {
                 ret->open(owner->type);
@@ -267,6 +281,49 @@ SharedMonitorFIFO::~SharedMonitorFIFO()
 {
     Guard G(channel->owner->mutex);
     channel->owner->monitors.remove(this);
+    if(group && --group->nmembers==0u)
+        channel->owner->monitorGroups.erase(group->key);
+}
+
+MonitorGroup::MonitorGroup(const std::string& key,
+                           const pvd::PVStructure::const_shared_pointer& pvRequest)
+    :key(key)
+    ,pvRequest(pvRequest)
+    ,valid(false)
+    ,mapped(0u)
+    ,nmembers(0u)
+{}
+
+std::string MonitorGroup::keyOf(const pvd::PVStructure& pvRequest)
+{
+    pvd::PVStructure::const_shared_pointer fields(pvRequest.getSubField<pvd::PVStructure>("field"));
+    if(!fields || fields->getPVFields().empty())
+        return std::string(); // all fields
+
+    // record._options (eg. queueSize) does not effect the mapping
+    std::ostringstream strm;
+    strm<<*fields;
+    return strm.str();
+}
+
+void MonitorGroup::compute(const pvd::StructureConstPtr& type, pvd::PVRequestMapper::mode_t mode)
+{
+    reset();
+    try {
+        mapper.compute(*pvd::getPVDataCreate()->createPVStructure(type), *pvRequest, mode);
+        value = mapper.buildRequested();
+        valid = true;
+    }catch(std::runtime_error&){
+        // members see the same error from MonitorFIFO::open()
+    }
+}
+
+void MonitorGroup::reset()
+{
+    mapper.reset();
+    value.reset();
+    changed.clear();
+    valid = false;
 }
 
 } // namespace detail
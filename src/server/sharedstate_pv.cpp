@@ -4,9 +4,15 @@
  */
 
 #include <list>
+#include <deque>
+#include <vector>
 
 #include <epicsMutex.h>
 #include <epicsGuard.h>
+#include <epicsEvent.h>
+#include <epicsThread.h>
+#include <epicsTime.h>
+#include <dbDefs.h>
 #include <errlog.h>
 
 #include <shareLib.h>
@@ -36,6 +42,177 @@ struct MailboxHandler : public pvas::SharedPV::Handler {
         return ret;
     }
 };
+typedef std::vector<std::tr1::shared_ptr<pvas::detail::SharedMonitorFIFO> > fanout_monitors_t;
+
+/* One post() divided into shards.  Each shard is a contiguous range of subscribers.
+ * Either push the mapped update into each subscriber's FIFO (PV mutex held by post()),
+ * or notify() each subscriber (no locks held).
+ */
+struct FanoutBatch {
+    epicsMutex mutex;
+    epicsEvent done;
+
+    const fanout_monitors_t& monitors;
+    const size_t nshards;
+    const bool notify;
+
+    // guarded by mutex
+    size_t remaining;
+    std::string error;
+
+    FanoutBatch(const fanout_monitors_t& monitors, size_t nshards, bool notify)
+        :monitors(monitors)
+        ,nshards(nshards)
+        ,notify(notify)
+        ,remaining(nshards)
+    {}
+
+    void runShard(size_t shard)
+    {
+        const size_t begin = monitors.size()*shard/nshards,
+                     end   = monitors.size()*(shard+1u)/nshards;
+        try {
+            for(size_t i=begin; i<end; i++) {
+                pvas::detail::SharedMonitorFIFO& mon = *monitors[i];
+                if(notify) {
+                    mon.notify();
+                } else {
+                    const pvas::detail::MonitorGroup& group = *mon.group;
+                    if(group.valid)
+                        mon.postMapped(*group.value, group.changed);
+                }
+            }
+        }catch(std::exception& e){
+            Guard G(mutex);
+            if(error.empty())
+                error = e.what();
+        }
+        Guard G(mutex);
+        if(--remaining==0u)
+            done.signal(); // while locked, so the waiter can't destroy us early
+    }
+};
+
+/* Worker threads shared by all SharedPVs.
+ * The thread calling post() runs the first shard, and then any shards
+ * which no worker has yet taken.  So a post() completes even when
+ * all workers are busy with other PVs.
+ */
+struct FanoutPool {
+    epicsMutex mutex;
+    epicsEvent wakeup;
+
+    typedef std::deque<std::pair<FanoutBatch*, size_t> > queue_t;
+    queue_t queue;
+
+    size_t nworkers;
+
+    FanoutPool()
+        :nworkers(0u)
+    {
+        unsigned ncpus = epicsThreadGetCPUs();
+        unsigned want = ncpus>1u ? ncpus-1u : 1u;
+
+        for(unsigned i=0; i<want; i++) {
+            if(!epicsThreadCreate("pvasFanout", epicsThreadPriorityMedium,
+                                  epicsThreadGetStackSize(epicsThreadStackBig),
+                                  &FanoutPool::worker, this))
+                break;
+            nworkers++;
+        }
+        if(nworkers==0u)
+            errlogPrintf("Warning: Unable to start SharedPV fanout workers.  post() will be serial\n");
+    }
+
+    static void worker(void *raw)
+    {
+        FanoutPool *self = static_cast<FanoutPool*>(raw);
+        Guard G(self->mutex);
+        while(true) {
+            if(self->queue.empty()) {
+                UnGuard U(G);
+                self->wakeup.wait();
+                continue;
+            }
+
+            queue_t::value_type work(self->queue.front());
+            self->queue.pop_front();
+            if(!self->queue.empty())
+                self->wakeup.signal(); // pass on to another idle worker
+
+            UnGuard U(G);
+            work.first->runShard(work.second);
+        }
+    }
+
+    // run all shards of batch, and return when all are complete.
+    void execute(FanoutBatch& batch)
+    {
+        {
+            Guard G(mutex);
+            for(size_t i=1u; i<batch.nshards; i++)
+                queue.push_back(std::make_pair(&batch, i));
+        }
+        wakeup.signal();
+
+        batch.runShard(0u);
+
+        while(true) {
+            size_t shard = 0u;
+            {
+                Guard G(mutex);
+                for(queue_t::iterator it(queue.begin()), end(queue.end()); it!=end; ++it) {
+                    if(it->first==&batch) {
+                        shard = it->second;
+                        queue.erase(it);
+                        break;
+                    }
+                }
+            }
+            if(shard==0u)
+                break;
+            batch.runShard(shard);
+        }
+
+        batch.done.wait();
+        Guard G(batch.mutex); // wait for the last runShard() to unlock
+    }
+
+    static FanoutPool* instance();
+};
+
+epicsThreadOnceId fanoutPoolOnce = EPICS_THREAD_ONCE_INIT;
+FanoutPool* fanoutPool;
+
+void fanoutPoolInit(void *)
+{
+    fanoutPool = new FanoutPool;
+}
+
+FanoutPool* FanoutPool::instance()
+{
+    epicsThreadOnce(&fanoutPoolOnce, &fanoutPoolInit, 0);
+    return fanoutPool;
+}
+
+// number of shards for one post() with nmonitors subscribers
+size_t fanoutShards(size_t nmonitors, size_t shardSize)
+{
+    if(shardSize==0u || nmonitors<=shardSize)
+        return 1u;
+    size_t nshards = (nmonitors+shardSize-1u)/shardSize;
+    size_t limit = FanoutPool::instance()->nworkers+1u;
+    return nshards < limit ? nshards : limit;
+}
+
+void fanoutRun(const fanout_monitors_t& monitors, size_t nshards, bool notify)
+{
+    FanoutBatch batch(monitors, nshards, notify);
+    FanoutPool::instance()->execute(batch);
+    if(!batch.error.empty())
+        throw std::logic_error(batch.error);
+}
+
 } // namespace
 
 namespace pvas {
@@ -55,8 +232,18 @@ void SharedPV::Handler::onRPC(const SharedPV::shared_pointer& pv, Operation& op)
 SharedPV::Config::Config()
     :dropEmptyUpdates(true)
     ,mapperMode(pvd::PVRequestMapper::Mask)
+    ,fanoutShardSize(0u)
 {}
 
+SharedPV::FanoutStats::FanoutStats()
+    :nposts(0u)
+    ,nparallel(0u)
+    ,maxShards(0u)
+{
+    for(size_t i=0; i<NELEMENTS(postToNotify); i++)
+        postToNotify[i] = 0u;
+}
+
 size_t SharedPV::num_instances;
 
 SharedPV::shared_pointer SharedPV::build(const std::tr1::shared_ptr<Handler>& handler, Config *conf)
@@ -85,6 +272,7 @@ SharedPV::shared_pointer SharedPV::buildMailbox(pvas::SharedPV::Config *conf)
 SharedPV::SharedPV(const std::tr1::shared_ptr<Handler> &handler, pvas::SharedPV::Config *conf)
     :config(conf ? *conf : Config())
     ,handler(handler)
+    ,postCount(0u)
     ,notifiedConn(false)
     ,debugLvl(0)
 {
@@ -182,6 +370,9 @@ void SharedPV::open(const pvd::PVStructure &value, const epics::pvData::BitSet&
                 p_rpc.push_back((*it)->shared_from_this());
             }catch(std::tr1::bad_weak_ptr&) {}
         }
+        FOR_EACH(monitorgroups_t::const_iterator, it, end, monitorGroups) {
+            it->second->compute(newtype, config.mapperMode);
+        }
         FOR_EACH(monitors_t::const_iterator, it, end, monitors) {
             if((*it)->channel->dead) continue;
             try {
@@ -262,6 +453,9 @@ void SharedPV::close(bool destroy)
                 (*it)->mapper.reset();
                 p_put.push_back((*it)->requester.lock());
             }
+            FOR_EACH(monitorgroups_t::const_iterator, it, end, monitorGroups) {
+                it->second->reset();
+            }
             FOR_EACH(monitors_t::const_iterator, it, end, monitors) {
                 (*it)->close();
                 try {
@@ -322,8 +516,15 @@ pvd::PVStructure::shared_pointer SharedPV::build()
 void SharedPV::post(const pvd::PVStructure& value,
                     const pvd::BitSet& changed)
 {
-    typedef std::vector<std::tr1::shared_ptr<pva::MonitorFIFO> > xmonitors_t;
-    xmonitors_t p_monitor;
+    // FanoutStats only with the worker pool
+    const bool timed = config.fanoutShardSize!=0u;
+
+    epicsTimeStamp start;
+    if(timed)
+        epicsTimeGetCurrent(&start);
+
+    fanout_monitors_t p_monitor;
+    size_t nshards;
     {
         Guard I(mutex);
 
@@ -339,14 +540,61 @@ void SharedPV::post(const pvd::PVStructure& value,
 
         p_monitor.reserve(monitors.size()); // ick, for lack of a list with thread-safe iteration
 
+        // identifies the update being mapped
+        const size_t seq = ++postCount;
+
         FOR_EACH(monitors_t::const_iterator, it, end, monitors) {
-            (*it)->post(value, changed);
-            p_monitor.push_back((*it)->shared_from_this());
+            detail::MonitorGroup& group = *(*it)->group;
+            // the first member of each group maps this update for the others
+            if(group.valid && group.mapped!=seq) {
+                group.changed.clear();
+                group.mapper.copyBaseToRequested(value, changed, *group.value, group.changed);
+                group.mapped = seq;
+            }
+            p_monitor.push_back(std::tr1::static_pointer_cast<detail::SharedMonitorFIFO>((*it)->shared_from_this()));
+        }
+
+        nshards = fanoutShards(p_monitor.size(), config.fanoutShardSize);
+
+        if(nshards>1u) {
+            fanoutRun(p_monitor, nshards, false);
+
+        } else {
+            FOR_EACH(fanout_monitors_t::const_iterator, it, end, p_monitor) {
+                const detail::MonitorGroup& group = *(*it)->group;
+                if(group.valid)
+                    (*it)->postMapped(*group.value, group.changed);
+            }
         }
     }
-    FOR_EACH(xmonitors_t::iterator, it, end, p_monitor) {
-        (*it)->notify();
+
+    if(nshards>1u) {
+        fanoutRun(p_monitor, nshards, true);
+
+    } else {
+        FOR_EACH(fanout_monitors_t::iterator, it, end, p_monitor) {
+            (*it)->notify();
+        }
     }
+
+    if(!timed)
+        return;
+
+    epicsTimeStamp finish;
+    epicsTimeGetCurrent(&finish);
+    double usec = epicsTimeDiffInSeconds(&finish, &start)*1e6;
+
+    size_t bucket = 0u;
+    while(bucket+1u < NELEMENTS(fanout.postToNotify) && usec >= double(1u<<bucket))
+        bucket++;
+
+    Guard I(mutex);
+    fanout.nposts++;
+    if(nshards>1u)
+        fanout.nparallel++;
+    if(fanout.maxShards < nshards)
+        fanout.maxShards = nshards;
+    fanout.postToNotify[bucket]++;
 }
 
 void SharedPV::fetch(epics::pvData::PVStructure& value, epics::pvData::BitSet& valid)
@@ -372,6 +620,14 @@ SharedPV::connect(const std::tr1::shared_ptr<epics::pvAccess::ChannelProvider> &
     return ret;
 }
 
+void SharedPV::fanoutStats(FanoutStats& stats, bool reset)
+{
+    Guard G(mutex);
+    stats = fanout;
+    if(reset)
+        fanout = FanoutStats();
+}
+
 void SharedPV::setDebug(int lvl)
 {
     Guard G(mutex);
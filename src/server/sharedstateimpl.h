@@ -63,9 +63,39 @@ struct SharedChannel : public pva::Channel,
             pvd::PVStructure::shared_pointer const & pvRequest) OVERRIDE FINAL;
 };
 
+// Subscribers whose pvRequests select the same fields.
+// Each update is mapped once per group, then copied to each member.
+// guarded by PV mutex
+struct MonitorGroup
+{
+    const std::string key;
+    const pvd::PVStructure::const_shared_pointer pvRequest; // of first member
+
+    // valid after a successful compute()
+    pvd::PVRequestMapper mapper;
+    pvd::PVStructurePtr value;
+    pvd::BitSet changed;
+    bool valid;
+
+    // the SharedPV::postCount when value was last updated
+    size_t mapped;
+    size_t nmembers;
+
+    MonitorGroup(const std::string& key,
+                 const pvd::PVStructure::const_shared_pointer& pvRequest);
+
+    // normalized form of the field selection of a pvRequest
+    static std::string keyOf(const pvd::PVStructure& pvRequest);
+
+    void compute(const pvd::StructureConstPtr& type, pvd::PVRequestMapper::mode_t mode);
+    void reset();
+};
+
 struct SharedMonitorFIFO : public pva::MonitorFIFO
 {
     const std::tr1::shared_ptr<SharedChannel> channel;
+    // set when added to SharedPV::monitors
+    std::tr1::shared_ptr<MonitorGroup> group;
     SharedMonitorFIFO(const std::tr1::shared_ptr<SharedChannel>& channel,
                       const requester_type::shared_pointer& requester,
                       const pvd::PVStructure::const_shared_pointer &pvRequest,
@@ -0,0 +1,198 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <stdexcept>
+#include <sstream>
+#include <string.h>
+
+#include <epicsTypes.h>
+
+// target attributes, needed to use intrinsics without -mavx2, appear in GCC 4.9
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) \
+    && (defined(__clang__) || __GNUC__>4 || (__GNUC__==4 && __GNUC_MINOR__>=9))
+#  define SWAP_X86
+#  include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  define SWAP_NEON
+#  include <arm_neon.h>
+#endif
+
+#define epicsExportSharedSymbols
+#include <pv/byteSwap.h>
+
+namespace {
+
+// index of the shuffle for an element size
+unsigned shuffleIndex(size_t elementSize)
+{
+    switch(elementSize) {
+    case 2: return 0u;
+    case 4: return 1u;
+    case 8: return 2u;
+    default: {
+        std::ostringstream msg;
+        msg<<"swapCopy() element size "<<elementSize<<" not supported";
+        throw std::invalid_argument(msg.str());
+    }
+    }
+}
+
+template<size_t N>
+void swapElements(char *dest, const char *src, size_t count)
+{
+    for(size_t i=0; i<count; i++, dest+=N, src+=N) {
+        char temp[N]; // allows dest==src
+        for(size_t b=0; b<N; b++)
+            temp[b] = src[N-1u-b];
+        memcpy(dest, temp, N);
+    }
+}
+
+/* A vector kernel swaps whole vectors, and returns the number of bytes done.
+ * The remainder, less than one vector, is left to swapCopyScalar().
+ */
+typedef size_t (*kernel_t)(char *dest, const char *src, size_t nbytes, unsigned shuffle);
+
+#ifdef SWAP_X86
+
+// byte order within each 16 byte lane.  repeated for the second lane of AVX2
+const epicsUInt8 shuffles[3][32] = {
+    {1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14, 1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14},
+    {3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12, 3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12},
+    {7,6,5,4,3,2,1,0,15,14,13,12,11,10,9,8, 7,6,5,4,3,2,1,0,15,14,13,12,11,10,9,8},
+};
+
+__attribute__((target("ssse3")))
+size_t swapSSSE3(char *dest, const char *src, size_t nbytes, unsigned shuffle)
+{
+    const __m128i mask(_mm_loadu_si128((const __m128i*)shuffles[shuffle]));
+    size_t i=0;
+    for(; i+32u<=nbytes; i+=32u) {
+        __m128i A(_mm_loadu_si128((const __m128i*)(src+i))),
+                B(_mm_loadu_si128((const __m128i*)(src+i+16u)));
+        _mm_storeu_si128((__m128i*)(dest+i), _mm_shuffle_epi8(A, mask));
+        _mm_storeu_si128((__m128i*)(dest+i+16u), _mm_shuffle_epi8(B, mask));
+    }
+    for(; i+16u<=nbytes; i+=16u) {
+        __m128i A(_mm_loadu_si128((const __m128i*)(src+i)));
+        _mm_storeu_si128((__m128i*)(dest+i), _mm_shuffle_epi8(A, mask));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+size_t swapAVX2(char *dest, const char *src, size_t nbytes, unsigned shuffle)
+{
+    const __m256i mask(_mm256_loadu_si256((const __m256i*)shuffles[shuffle]));
+    size_t i=0;
+    for(; i+64u<=nbytes; i+=64u) {
+        __m256i A(_mm256_loadu_si256((const __m256i*)(src+i))),
+                B(_mm256_loadu_si256((const __m256i*)(src+i+32u)));
+        _mm256_storeu_si256((__m256i*)(dest+i), _mm256_shuffle_epi8(A, mask));
+        _mm256_storeu_si256((__m256i*)(dest+i+32u), _mm256_shuffle_epi8(B, mask));
+    }
+    for(; i+32u<=nbytes; i+=32u) {
+        __m256i A(_mm256_loadu_si256((const __m256i*)(src+i)));
+        _mm256_storeu_si256((__m256i*)(dest+i), _mm256_shuffle_epi8(A, mask));
+    }
+    return i;
+}
+
+#endif // SWAP_X86
+
+#ifdef SWAP_NEON
+
+size_t swapNEON(char *dest, const char *src, size_t nbytes, unsigned shuffle)
+{
+    size_t i=0;
+    switch(shuffle) {
+    case 0:
+        for(; i+16u<=nbytes; i+=16u)
+            vst1q_u8((uint8_t*)(dest+i), vrev16q_u8(vld1q_u8((const uint8_t*)(src+i))));
+        break;
+    case 1:
+        for(; i+16u<=nbytes; i+=16u)
+            vst1q_u8((uint8_t*)(dest+i), vrev32q_u8(vld1q_u8((const uint8_t*)(src+i))));
+        break;
+    case 2:
+        for(; i+16u<=nbytes; i+=16u)
+            vst1q_u8((uint8_t*)(dest+i), vrev64q_u8(vld1q_u8((const uint8_t*)(src+i))));
+        break;
+    }
+    return i;
+}
+
+#endif // SWAP_NEON
+
+/* Selected during static initialization, instead of with epicsThreadOnce(),
+ * to keep a lock out of the (de)serialization of every array.
+ */
+struct Kernel {
+    kernel_t fn;
+    const char *name;
+    Kernel() :fn(0), name("scalar")
+    {
+#if defined(SWAP_X86)
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx2")) {
+            fn = &swapAVX2;
+            name = "avx2";
+        } else if(__builtin_cpu_supports("ssse3")) {
+            fn = &swapSSSE3;
+            name = "ssse3";
+        }
+#elif defined(SWAP_NEON)
+        fn = &swapNEON;
+        name = "neon";
+#endif
+    }
+} kernel;
+
+} // namespace
+
+namespace epics {
+namespace pvAccess {
+
+void swapCopyScalar(void *dest, const void *src, size_t count, size_t elementSize)
+{
+    char *D = static_cast<char*>(dest);
+    const char *S = static_cast<const char*>(src);
+    switch(elementSize) {
+    case 1:
+        if(D!=S)
+            memcpy(D, S, count);
+        break;
+    case 2: swapElements<2>(D, S, count); break;
+    case 4: swapElements<4>(D, S, count); break;
+    case 8: swapElements<8>(D, S, count); break;
+    default:
+        (void)shuffleIndex(elementSize); // throws
+    }
+}
+
+void swapCopy(void *dest, const void *src, size_t count, size_t elementSize)
+{
+    if(elementSize==1u) {
+        swapCopyScalar(dest, src, count, elementSize);
+        return;
+    }
+    const unsigned shuffle = shuffleIndex(elementSize);
+
+    char *D = static_cast<char*>(dest);
+    const char *S = static_cast<const char*>(src);
+    const size_t nbytes = count*elementSize;
+
+    size_t done = kernel.fn ? kernel.fn(D, S, nbytes, shuffle) : 0u;
+    // vectors are a multiple of every element size
+    swapCopyScalar(D+done, S+done, (nbytes-done)/elementSize, elementSize);
+}
+
+const char* swapCopyImpl()
+{
+    return kernel.name;
+}
+
+}} // namespace epics::pvAccess
@@ -12,6 +12,9 @@
 #include <osiSock.h>
 #include <ellLib.h>
 #include <errlog.h>
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+#include <epicsThread.h>
 
 #include <pv/pvType.h>
 #include <pv/byteBuffer.h>
@@ -20,6 +23,10 @@
 #define epicsExportSharedSymbols
 #include <pv/inetAddressUtil.h>
 
+#ifdef PVA_UNIX_SOCKET
+#  include <sys/un.h>
+#endif
+
 // RTEMS 4.9 doesn't define this, but does implement SIOCGIFNETMASK
 // and stores under the ifr_addr union member.
 #ifndef ifr_netmask
@@ -79,9 +86,85 @@ bool isMulticastAddress(const osiSockAddr* address) {
     return msB >= 224 && msB <= 239;
 }
 
+namespace {
+// interned AF_UNIX paths, index is stored in sin_addr
+struct UnixPaths {
+    epicsMutex lock;
+    std::vector<std::string> paths;
+};
+UnixPaths *unixPaths;
+epicsThreadOnceId unixPathsOnce = EPICS_THREAD_ONCE_INIT;
+
+void unixPathsInit(void *)
+{
+    unixPaths = new UnixPaths;
+}
+} // namespace
+
+bool unixSocketAddress(const std::string& path, osiSockAddr* address)
+{
+#ifdef PVA_UNIX_SOCKET
+    if(path.empty() || path.size() >= sizeof(((sockaddr_un*)0)->sun_path))
+        return false;
+
+    epicsThreadOnce(&unixPathsOnce, &unixPathsInit, 0);
+
+    uint32 idx;
+    {
+        epicsGuard<epicsMutex> G(unixPaths->lock);
+        std::vector<std::string>& paths = unixPaths->paths;
+        for(idx=0; idx<paths.size(); idx++) {
+            if(paths[idx]==path)
+                break;
+        }
+        if(idx==paths.size())
+            paths.push_back(path);
+    }
+
+    memset(address, 0, sizeof(*address));
+    address->ia.sin_family = AF_UNIX;
+    address->ia.sin_addr.s_addr = htonl(idx);
+    return true;
+#else
+    (void)path;
+    (void)address;
+    return false;
+#endif
+}
+
+std::string unixSocketPath(const osiSockAddr& address)
+{
+#ifdef PVA_UNIX_SOCKET
+    if(address.sa.sa_family==AF_UNIX) {
+        epicsThreadOnce(&unixPathsOnce, &unixPathsInit, 0);
+
+        uint32 idx = ntohl(address.ia.sin_addr.s_addr);
+        epicsGuard<epicsMutex> G(unixPaths->lock);
+        if(idx < unixPaths->paths.size())
+            return unixPaths->paths[idx];
+    }
+#else
+    (void)address;
+#endif
+    return std::string();
+}
+
+static bool parseSocketAddress(const std::string& address, int defaultPort, osiSockAddr* addr, bool allowUnix)
+{
+    if(address.compare(0, 5, "unix:")==0) {
+        if(!allowUnix) {
+            errlogPrintf("Warning: ignoring \"%s\", AF_UNIX is only valid for TCP server addresses\n", address.c_str());
+            return false;
+        }
+        return unixSocketAddress(address.substr(5), addr);
+    }
+    return aToIPAddr(address.c_str(), defaultPort, &addr->ia) == 0;
+}
+
 void getSocketAddressList(InetAddrVector& ret,
                           const std::string & list, int defaultPort,
-                                     const InetAddrVector* appendList) {
+                                     const InetAddrVector* appendList,
+                                     bool allowUnix) {
     ret.clear();
 
     // skip leading spaces
@@ -95,14 +178,14 @@ void getSocketAddressList(InetAddrVector& ret,
     while((subEnd = list.find(' ', subStart))!=std::string::npos) {
         string address = list.substr(subStart, (subEnd-subStart));
         osiSockAddr addr;
-        if (aToIPAddr(address.c_str(), defaultPort, &addr.ia) == 0)
+        if (parseSocketAddress(address, defaultPort, &addr, allowUnix))
             ret.push_back(addr);
         subStart = list.find_first_not_of(" \t\r\n\v", subEnd);
     }
 
     if(subStart!=std::string::npos && subStart<len) {
         osiSockAddr addr;
-        if (aToIPAddr(list.substr(subStart).c_str(), defaultPort, &addr.ia) == 0)
+        if (parseSocketAddress(list.substr(subStart), defaultPort, &addr, allowUnix))
             ret.push_back(addr);
     }
 
@@ -116,6 +199,15 @@ string inetAddressToString(const osiSockAddr &addr,
                            bool displayPort, bool displayHex) {
     stringstream saddr;
 
+#ifdef PVA_UNIX_SOCKET
+    if(addr.sa.sa_family==AF_UNIX) {
+        saddr<<"unix:"<<unixSocketPath(addr);
+        // server side connections are told apart by a sequence number
+        if(displayPort && addr.ia.sin_port) saddr<<'#'<<ntohs(addr.ia.sin_port);
+        return saddr.str();
+    }
+#endif
+
     int ipa = ntohl(addr.ia.sin_addr.s_addr);
 
     saddr<<((int)(ipa>>24)&0xFF)<<'.';
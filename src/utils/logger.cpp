@@ -9,10 +9,24 @@
 #include <time.h>
 #include <cstring>
 #include <stdio.h>
+#include <stdarg.h>
 
 #include <epicsExit.h>
 #include <errlog.h>
 #include <epicsTime.h>
+#include <epicsThread.h>
+#include <epicsEvent.h>
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+#include <epicsVersion.h>
+#include <epicsStdio.h>
+
+#ifdef EPICS_VERSION_INT
+#if EPICS_VERSION_INT>=VERSION_INT(3,15,1,0)
+#include <epicsAtomic.h>
+#define PVA_LOG_USE_ATOMIC
+#endif
+#endif
 
 #include <pv/noDefaultMethods.h>
 #include <pv/lock.h>
@@ -33,27 +47,354 @@ namespace pvAccess {
 
 static pvAccessLogLevel g_pvAccessLogLevel = logLevelInfo;
 
-void pvAccessLog(pvAccessLogLevel level, const char* format, ...)
+namespace {
+
+typedef epicsGuard<epicsMutex> Guard;
+
+/* Messages are formatted by the logging thread directly into a slot
+ * of a bounded queue, and printed by a writer thread.
+ *
+ * The queue is lock-free for any number of logging threads
+ * (Dmitry Vyukov's bounded MPMC queue, with a single consumer).
+ * Each slot has a sequence number which is equal to
+ *   the position at which it may next be filled,
+ *   or one more when it has been filled and may be printed.
+ */
+struct LogSlot {
+    size_t sequence;
+    epicsTimeStamp time;
+    char message[512];
+};
+
+struct LogQueue {
+    enum { size = 256 }; // power of 2
+    LogSlot slots[size];
+    size_t head; // next position to fill
+    size_t tail; // next position to print.  only the writer changes, loggers read
+    size_t dropped; // messages not queued, for any reason
+    size_t overflow; // messages not queued because it was full
+
+    unsigned rateLimit;
+
+    epicsEvent wakeup;
+    epicsEvent drained;
+    epicsEvent done;
+    epicsMutex flushLock; // serialize pvAccessLogFlush()
+    epicsMutex stateLock; // guards running and flushing
+#ifndef PVA_LOG_USE_ATOMIC
+    epicsMutex lock; // guards head, dropped, overflow, counters of pvAccessLogSite, and LogSlot::sequence
+#endif
+    bool started;
+    bool running;
+    bool flushing;
+
+    LogQueue()
+        :head(0u)
+        ,tail(0u)
+        ,dropped(0u)
+        ,overflow(0u)
+        ,rateLimit(10u)
+        ,started(false)
+        ,running(true)
+        ,flushing(false)
+    {
+        for(size_t i=0; i<size_t(size); i++)
+            slots[i].sequence = i;
+    }
+};
+
+LogQueue *logQueue;
+epicsThreadOnceId logQueueOnce = EPICS_THREAD_ONCE_INIT;
+
+size_t incrSize(size_t *pval)
 {
-    // TODO lock
-    if (level >= g_pvAccessLogLevel)
+#ifdef PVA_LOG_USE_ATOMIC
+    return epicsAtomicIncrSizeT(pval);
+#else
+    Guard G(logQueue->lock);
+    return ++*pval;
+#endif
+}
+
+// fetch and zero
+size_t takeSize(size_t *pval)
+{
+#ifdef PVA_LOG_USE_ATOMIC
+    size_t val = epicsAtomicGetSizeT(pval);
+    while(val) {
+        size_t prev = epicsAtomicCmpAndSwapSizeT(pval, val, 0u);
+        if(prev==val)
+            break;
+        val = prev;
+    }
+    return val;
+#else
+    Guard G(logQueue->lock);
+    size_t val = *pval;
+    *pval = 0u;
+    return val;
+#endif
+}
+
+// claim a slot to fill, or NULL if the queue is full
+LogSlot* claim(size_t& pos)
+{
+    LogQueue& Q = *logQueue;
+#ifdef PVA_LOG_USE_ATOMIC
+    pos = epicsAtomicGetSizeT(&Q.head);
+    while(true) {
+        LogSlot& slot = Q.slots[pos&(LogQueue::size-1)];
+        size_t seq = epicsAtomicGetSizeT(&slot.sequence);
+        epicsAtomicReadMemoryBarrier();
+        ptrdiff_t diff = ptrdiff_t(seq) - ptrdiff_t(pos);
+        if(diff==0) {
+            size_t prev = epicsAtomicCmpAndSwapSizeT(&Q.head, pos, pos+1u);
+            if(prev==pos)
+                return &slot;
+            pos = prev; // lost a race with another logger
+        } else if(diff<0) {
+            return 0; // full
+        } else {
+            pos = epicsAtomicGetSizeT(&Q.head);
+        }
+    }
+#else
+    Guard G(Q.lock);
+    pos = Q.head;
+    LogSlot& slot = Q.slots[pos&(LogQueue::size-1)];
+    if(slot.sequence!=pos)
+        return 0;
+    Q.head++;
+    return &slot;
+#endif
+}
+
+// mark a claim()'d slot as ready to print.
+// returns true if the writer had printed everything before it, and may be waiting.
+bool commit(LogSlot *slot, size_t pos)
+{
+#ifdef PVA_LOG_USE_ATOMIC
+    epicsAtomicWriteMemoryBarrier();
+    // full barrier, pairs with the increment of tail in release()
+    epicsAtomicIncrSizeT(&slot->sequence);
+    return epicsAtomicGetSizeT(&logQueue->tail)==pos;
+#else
+    Guard G(logQueue->lock);
+    slot->sequence++;
+    return logQueue->tail==pos;
+#endif
+}
+
+// the next slot to print, or NULL if empty.  Only the writer calls
+LogSlot* peek()
+{
+    LogQueue& Q = *logQueue;
+    LogSlot& slot = Q.slots[Q.tail&(LogQueue::size-1)];
+#ifdef PVA_LOG_USE_ATOMIC
+    size_t seq = epicsAtomicGetSizeT(&slot.sequence);
+    epicsAtomicReadMemoryBarrier();
+#else
+    size_t seq;
+    {
+        Guard G(Q.lock);
+        seq = slot.sequence;
+    }
+#endif
+    return seq==Q.tail+1u ? &slot : 0;
+}
+
+// return the slot from peek() to be filled again
+void release(LogSlot *slot)
+{
+    LogQueue& Q = *logQueue;
+#ifdef PVA_LOG_USE_ATOMIC
+    epicsAtomicSetSizeT(&slot->sequence, Q.tail + LogQueue::size);
+    // full barrier, so that either the next peek() sees a slot committed meanwhile,
+    // or its logger sees the new tail and wakes us.
+    epicsAtomicIncrSizeT(&Q.tail);
+#else
+    Guard G(Q.lock);
+    slot->sequence = Q.tail + LogQueue::size;
+    Q.tail++;
+#endif
+}
+
+void printSlot(const LogSlot& slot)
+{
+    char timeText[TIMETEXTLEN];
+    epicsTimeToStrftime(timeText, TIMETEXTLEN, "%Y-%m-%dT%H:%M:%S.%03f", &slot.time);
+    printf("%s %s\n", timeText, slot.message);
+}
+
+void logWriter(void *)
+{
+    LogQueue& Q = *logQueue;
+    size_t reported = 0u;
+    bool running;
+
+    while(true) {
+        // woken by a message queued while we are idle, a full queue, flush, or stop
+        Q.wakeup.wait();
+
+        // messages queued before a flush, or stop, are printed by this pass
+        bool flush;
+        {
+            Guard G(Q.stateLock);
+            flush = Q.flushing;
+            running = Q.running;
+        }
+
+        bool printed = false;
+        LogSlot *slot;
+        while((slot = peek())!=0) {
+            printSlot(*slot);
+            release(slot);
+            printed = true;
+        }
+
+        // report messages dropped because the queue was full
+#ifdef PVA_LOG_USE_ATOMIC
+        size_t dropped = epicsAtomicGetSizeT(&Q.overflow);
+#else
+        size_t dropped;
+        {
+            Guard G(Q.lock);
+            dropped = Q.overflow;
+        }
+#endif
+        if(dropped!=reported) {
+            epicsTimeStamp now;
+            epicsTimeGetCurrent(&now);
+            char timeText[TIMETEXTLEN];
+            epicsTimeToStrftime(timeText, TIMETEXTLEN, "%Y-%m-%dT%H:%M:%S.%03f", &now);
+            printf("%s %u log messages dropped, queue full\n", timeText, unsigned(dropped-reported));
+            reported = dropped;
+            printed = true;
+        }
+
+        if(printed)
+            fflush(stdout);    // needed for WIN32
+
+        if(flush) {
+            {
+                Guard G(Q.stateLock);
+                Q.flushing = false;
+            }
+            Q.drained.signal();
+        }
+
+        if(!running)
+            break;
+    }
+
     {
-        char timeText[TIMETEXTLEN];
-        epicsTimeStamp tsNow;
+        // a flush which began after our last pass has nothing more to wait for
+        Guard G(Q.stateLock);
+        if(Q.flushing) {
+            Q.flushing = false;
+            Q.drained.signal();
+        }
+    }
+    Q.done.signal();
+}
 
-        epicsTimeGetCurrent(&tsNow);
-        epicsTimeToStrftime(timeText, TIMETEXTLEN, "%Y-%m-%dT%H:%M:%S.%03f", &tsNow);
+void logStop(void *)
+{
+    LogQueue& Q = *logQueue;
+    {
+        Guard G(Q.stateLock);
+        if(!Q.started || !Q.running)
+            return;
+        Q.running = false;
+    }
+    Q.wakeup.signal();
+    Q.done.wait();
+}
 
-        printf("%s ", timeText);
+void logInit(void *)
+{
+    logQueue = new LogQueue;
+    // if this fails, messages are queued but never printed
+    if(epicsThreadCreate("pvAccessLog",
+                         epicsThreadPriorityLow,
+                         epicsThreadGetStackSize(epicsThreadStackSmall),
+                         &logWriter, 0)) {
+        logQueue->started = true;
+        epicsAtExit(&logStop, 0);
+    }
+}
 
+void logQueued(pvAccessLogLevel level, size_t suppressed, const char* format, va_list args)
+{
+    epicsThreadOnce(&logQueueOnce, &logInit, 0);
+
+    size_t pos;
+    LogSlot *slot = claim(pos);
+    if(!slot) {
+        incrSize(&logQueue->overflow);
+        incrSize(&logQueue->dropped);
+        logQueue->wakeup.signal();
+        return;
+    }
+
+    epicsTimeGetCurrent(&slot->time);
+    const size_t limit = sizeof(slot->message);
+    int len = vsnprintf(slot->message, limit, format, args);
+    if(suppressed && len>=0 && size_t(len)<limit)
+        epicsSnprintf(slot->message+len, limit-len, " (%u similar messages suppressed)", unsigned(suppressed));
+    slot->message[limit-1] = '\0';
+
+    if(commit(slot, pos))
+        logQueue->wakeup.signal();
+
+    // likely followed by an abort
+    if(level>=logLevelFatal)
+        pvAccessLogFlush();
+}
+
+} // namespace
+
+void pvAccessLog(pvAccessLogLevel level, const char* format, ...)
+{
+    if (level >= g_pvAccessLogLevel)
+    {
         va_list arg;
         va_start(arg, format);
-        vprintf(format, arg);
+        logQueued(level, 0u, format, arg);
         va_end(arg);
+    }
+}
+
+void pvAccessLogLimited(pvAccessLogSite* site, pvAccessLogLevel level, const char* format, ...)
+{
+    if (level < g_pvAccessLogLevel)
+        return;
 
-        printf("\n");
-        fflush(stdout);    // needed for WIN32
+    epicsThreadOnce(&logQueueOnce, &logInit, 0);
+
+    const unsigned limit = logQueue->rateLimit;
+    if (limit) {
+        epicsTimeStamp now;
+        epicsTimeGetCurrent(&now);
+
+        // concurrent callers at the start of a second may both reset the count.
+        // So the limit is approximate.
+        if (site->window != now.secPastEpoch) {
+            site->window = now.secPastEpoch;
+            site->count = 0u;
+        }
+
+        if (incrSize(&site->count) > limit) {
+            incrSize(&site->suppressed);
+            incrSize(&logQueue->dropped);
+            return;
+        }
     }
+
+    va_list arg;
+    va_start(arg, format);
+    logQueued(level, limit ? takeSize(&site->suppressed) : 0u, format, arg);
+    va_end(arg);
 }
 
 void pvAccessSetLogLevel(pvAccessLogLevel level)
@@ -66,5 +407,39 @@ bool pvAccessIsLoggable(pvAccessLogLevel level)
     return level >= g_pvAccessLogLevel;
 }
 
+void pvAccessSetLogRateLimit(unsigned perSecond)
+{
+    epicsThreadOnce(&logQueueOnce, &logInit, 0);
+    logQueue->rateLimit = perSecond;
+}
+
+size_t pvAccessLogDropped()
+{
+    epicsThreadOnce(&logQueueOnce, &logInit, 0);
+#ifdef PVA_LOG_USE_ATOMIC
+    return epicsAtomicGetSizeT(&logQueue->dropped);
+#else
+    Guard G(logQueue->lock);
+    return logQueue->dropped;
+#endif
+}
+
+void pvAccessLogFlush()
+{
+    epicsThreadOnce(&logQueueOnce, &logInit, 0);
+    LogQueue& Q = *logQueue;
+
+    Guard F(Q.flushLock);
+    {
+        Guard G(Q.stateLock);
+        if(!Q.started || !Q.running)
+            return;
+        Q.flushing = true;
+    }
+    // wait for a pass of the writer which begins after now
+    Q.wakeup.signal();
+    Q.drained.wait();
+}
+
 }
 }
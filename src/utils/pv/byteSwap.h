@@ -0,0 +1,40 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#ifndef BYTESWAP_H
+#define BYTESWAP_H
+
+#include <stddef.h>
+
+#include <shareLib.h>
+
+namespace epics {
+namespace pvAccess {
+
+/** @brief Copy an array of numbers, reversing the byte order of each element.
+ *
+ * For transfers between peers of different byte order.
+ * Uses SSSE3 or AVX2 (x86, selected at runtime) or NEON (ARM),
+ * and falls back to one element at a time.
+ *
+ * @param dest Destination.  May be the same as src, but may not otherwise overlap.
+ * @param src Source.  No alignment is required.
+ * @param count Number of elements
+ * @param elementSize 1, 2, 4, or 8.  1 is a plain copy.
+ * @throws std::invalid_argument for other element sizes
+ */
+epicsShareFunc void swapCopy(void *dest, const void *src, size_t count, size_t elementSize);
+
+//! Same as swapCopy(), one element at a time.  For comparison.
+epicsShareFunc void swapCopyScalar(void *dest, const void *src, size_t count, size_t elementSize);
+
+//! Name of the implementation used by swapCopy() on this host.  eg. "avx2"
+epicsShareFunc const char* swapCopyImpl();
+
+}
+}
+
+#endif // BYTESWAP_H
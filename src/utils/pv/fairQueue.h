@@ -52,6 +52,10 @@ namespace pvAccess {
  *     this order.
  *     Adding [A, A, B, A, C, C] would give out [A, B, C, A, C, A].
  *
+ * @li Two classes.  Entries pushed as background are returned only when
+ *     no others are queued, or once for every background_interval others
+ *     returned while background entries wait.  Round robin applies within each class.
+ *
  * @warning Only one thread should call pop_front()
  *   as push_back() does not broadcast (only wakes up one waiter)
  */
@@ -62,6 +66,9 @@ class fair_queue
 public:
     typedef std::tr1::shared_ptr<T> value_type;
 
+    //! Foreground entries returned in a row before a waiting background entry
+    static const unsigned background_interval = 16u;
+
     class entry {
         /* In c++, use of ellLib (which implies offsetof()) should be restricted
          * to POD structs.  So enode_t exists as a POD struct for which offsetof()
@@ -75,6 +82,7 @@ public:
         unsigned Qcnt;
         value_type holder;
         fair_queue *owner;
+        bool background;
 
         friend class fair_queue;
 
@@ -83,6 +91,7 @@ public:
     public:
         entry() :Qcnt(0), holder()
             , owner(NULL)
+            , background(false)
         {
             enode.node.next = enode.node.previous = NULL;
             enode.self = this;
@@ -96,13 +105,16 @@ public:
     };
 
     fair_queue()
+        :nforeground(0u)
     {
         ellInit(&list);
+        ellInit(&blist);
     }
     ~fair_queue()
     {
         clear();
         assert(ellCount(&list)==0);
+        assert(ellCount(&blist)==0);
     }
 
     //! Remove all items.
@@ -114,6 +126,9 @@ public:
         {
             guard_t G(mutex);
 
+            ellConcat(&list, &blist);
+            nforeground = 0u;
+
             garbage.resize(unsigned(ellCount(&list)));
             size_t i=0;
 
@@ -134,23 +149,33 @@ public:
 
     bool empty() const {
         guard_t G(mutex);
-        return ellFirst(&list)==NULL;
+        return ellFirst(&list)==NULL && ellFirst(&blist)==NULL;
+    }
+
+    //! # of entries queued, foreground and background
+    size_t size() const {
+        guard_t G(mutex);
+        return size_t(ellCount(&list)) + size_t(ellCount(&blist));
     }
 
-    void push_back(const value_type& ent)
+    /** Queue an entry.
+     * @param background Class of the entry.  Ignored if the entry is already queued.
+     */
+    void push_back(const value_type& ent, bool background=false)
     {
         bool wake;
         entry *P = ent.get();
         {
             guard_t G(mutex);
-            wake = ellFirst(&list)==NULL; // empty queue
+            wake = ellFirst(&list)==NULL && ellFirst(&blist)==NULL; // empty queue
 
             if(P->Qcnt++==0) {
                 // not in list
                 assert(P->owner==NULL);
                 P->owner = this;
                 P->holder = ent; // the list will hold a reference
-                ellAdd(&list, &P->enode.node); // push_back
+                P->background = background;
+                ellAdd(background ? &blist : &list, &P->enode.node); // push_back
             } else
                 assert(P->owner==this);
         }
@@ -161,7 +186,16 @@ public:
     {
         ret.reset();
         guard_t G(mutex);
-        ELLNODE *cur = ellGet(&list); // pop_front
+        ELLNODE *cur = NULL;
+        if(ellFirst(&blist)==NULL) {
+            nforeground = 0u;
+            cur = ellGet(&list); // pop_front
+        } else if(nforeground < background_interval && (cur = ellGet(&list))!=NULL) {
+            nforeground++;
+        } else {
+            nforeground = 0u;
+            cur = ellGet(&blist);
+        }
 
         if(cur) {
             typedef typename entry::enode_t enode_t;
@@ -175,7 +209,7 @@ public:
 
                 ret.swap(P->holder);
             } else {
-                ellAdd(&list, &P->enode.node); // push_back
+                ellAdd(P->background ? &blist : &list, &P->enode.node); // push_back
 
                 ret = P->holder;
             }
@@ -208,6 +242,8 @@ public:
 
 private:
     ELLLIST list;
+    ELLLIST blist; // background
+    unsigned nforeground; // # returned from list while blist waits
     mutable epicsMutex mutex;
     mutable epicsEvent wakeup;
 };
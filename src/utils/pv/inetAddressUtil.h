@@ -12,6 +12,10 @@
 #include <osiSock.h>
 #include <shareLib.h>
 
+#if defined(AF_UNIX) && !defined(_WIN32) && !defined(vxWorks) && !defined(__rtems__)
+#  define PVA_UNIX_SOCKET
+#endif
+
 #include <pv/pvType.h>
 #include <pv/byteBuffer.h>
 
@@ -55,16 +59,37 @@ epicsShareFunc bool decodeAsIPv6Address(epics::pvData::ByteBuffer* buffer, osiSo
  */
 epicsShareFunc bool isMulticastAddress(const osiSockAddr* address);
 
+/**
+ * Map an AF_UNIX stream socket path into an <code>osiSockAddr</code>.
+ * The path is interned in a process wide table and the returned address
+ * has <code>sa_family==AF_UNIX</code> with the table index in place of the IPv4 address,
+ * so that it can be used as a key (eg. in TransportRegistry) like any IP address.
+ * @param path  socket file system path.
+ * @param address   where to store the result.
+ * @return false if AF_UNIX sockets are not supported on this target, or the path is too long.
+ */
+epicsShareFunc bool unixSocketAddress(const std::string& path, osiSockAddr* address);
+
+/**
+ * Reverse of unixSocketAddress().
+ * @return the socket path, or an empty string if <code>address</code> is not an AF_UNIX address.
+ */
+epicsShareFunc std::string unixSocketPath(const osiSockAddr& address);
+
 /**
  * Parse space delimited addresss[:port] string and populate array of <code>InetSocketAddress</code>.
+ * Entries of the form <code>unix:/path/to/socket</code> are mapped with unixSocketAddress()
+ * when allowUnix is set, and are otherwise ignored.
  * @param ret results stored hre
  * @param list  space delimited addresss[:port] string.
  * @param defaultPort   port take if not specified.
  * @param appendList    list to be appended.
+ * @param allowUnix     accept <code>unix:</code> entries.  Only meaningful for lists of TCP servers.
  * @return  array of <code>InetSocketAddress</code>.
  */
 epicsShareFunc void getSocketAddressList(InetAddrVector& ret, const std::string & list, int defaultPort,
-                                         const InetAddrVector* appendList = NULL);
+                                         const InetAddrVector* appendList = NULL,
+                                         bool allowUnix = false);
 
 epicsShareFunc std::string inetAddressToString(const osiSockAddr &addr,
         bool displayPort = true, bool displayHex = false);
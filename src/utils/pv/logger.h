@@ -8,6 +8,7 @@
 #define LOGGER_H_
 
 #include <string>
+#include <stddef.h>
 
 #include <compilerDependencies.h>
 #include <shareLib.h>
@@ -38,14 +39,36 @@ OFF
 */
 
 
+/** Per call site state of the LOG() rate limit.  Zero initialized. */
+struct pvAccessLogSite {
+    unsigned window; //!< second in which count began
+    size_t count; //!< messages in this window
+    size_t suppressed; //!< messages not logged since the last one which was
+};
+
+/** Queue a message to be printed by the log writer thread.
+ *
+ * Formatting is done by the caller.  Printing is done later, so as not to delay I/O threads.
+ * If the queue is full, the message is dropped and counted.
+ */
 epicsShareFunc void pvAccessLog(pvAccessLogLevel level, const char* format, ...) EPICS_PRINTF_STYLE(2, 3);
+//! pvAccessLog() limited to pvAccessSetLogRateLimit() messages per second from one call site.
+epicsShareFunc void pvAccessLogLimited(pvAccessLogSite* site, pvAccessLogLevel level, const char* format, ...) EPICS_PRINTF_STYLE(3, 4);
 epicsShareFunc void pvAccessSetLogLevel(pvAccessLogLevel level);
 epicsShareFunc bool pvAccessIsLoggable(pvAccessLogLevel level);
+//! Messages per second logged by each LOG() call site, 0 for no limit.  Default 10.
+epicsShareFunc void pvAccessSetLogRateLimit(unsigned perSecond);
+//! Total of messages not logged, either rate limited or because the queue was full.
+epicsShareFunc size_t pvAccessLogDropped();
+//! Block until all messages queued before this call have been printed.
+epicsShareFunc void pvAccessLogFlush();
 
 #if defined (__GNUC__) && __GNUC__ < 3
-#define LOG(level, format, ARGS...) pvAccessLog(level, format, ##ARGS)
+#define LOG(level, format, ARGS...) do { static ::epics::pvAccess::pvAccessLogSite pvaLogSite; \
+    if(::epics::pvAccess::pvAccessIsLoggable(level)) ::epics::pvAccess::pvAccessLogLimited(&pvaLogSite, level, format, ##ARGS); } while(0)
 #else
-#define LOG(level, format, ...) pvAccessLog(level, format, ##__VA_ARGS__)
+#define LOG(level, format, ...) do { static ::epics::pvAccess::pvAccessLogSite pvaLogSite; \
+    if(::epics::pvAccess::pvAccessIsLoggable(level)) ::epics::pvAccess::pvAccessLogLimited(&pvaLogSite, level, format, ##__VA_ARGS__); } while(0)
 #endif
 #define SET_LOG_LEVEL(level) pvAccessSetLogLevel(level)
 #define IS_LOGGABLE(level) pvAccessIsLoggable(level)
@@ -0,0 +1,96 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <vector>
+#include <stdexcept>
+
+#include <epicsAssert.h>
+
+namespace epics {
+namespace pvAccess {
+
+/** @brief A fixed capacity FIFO of values stored in a circular array.
+ *
+ * @li Bounded.  push_back() on a full ring is an error.
+ *     Storage is allocated only by reset().
+ *
+ * @li O(1).  All operations, except reset() and clear(), take constant time.
+ *
+ * @li Not thread safe.  Callers must provide their own locking.
+ *
+ * Popped slots are overwritten with a default constructed T,
+ * so that (eg.) a shared_ptr is released promptly.
+ */
+template<typename T>
+class ring_buffer
+{
+    std::vector<T> slots;
+    size_t head, count;
+
+    size_t index(size_t i) const {
+        i += head;
+        return i < slots.size() ? i : i - slots.size();
+    }
+public:
+    typedef T value_type;
+
+    ring_buffer() :head(0u), count(0u) {}
+    explicit ring_buffer(size_t capacity) :slots(capacity), head(0u), count(0u) {}
+
+    //! Discard all entries and change capacity
+    void reset(size_t capacity)
+    {
+        std::vector<T> temp(capacity);
+        slots.swap(temp);
+        head = count = 0u;
+    }
+
+    //! Discard all entries.
+    //! @post empty()==true
+    void clear()
+    {
+        while(count)
+            pop_front();
+        head = 0u;
+    }
+
+    size_t capacity() const { return slots.size(); }
+    size_t size() const { return count; }
+    bool empty() const { return count==0u; }
+    bool full() const { return count==slots.size(); }
+
+    T& front() { assert(count); return slots[head]; }
+    const T& front() const { assert(count); return slots[head]; }
+    T& back() { assert(count); return slots[index(count-1u)]; }
+    const T& back() const { assert(count); return slots[index(count-1u)]; }
+    //! i-th entry from the front
+    T& operator[](size_t i) { return slots[index(i)]; }
+    const T& operator[](size_t i) const { return slots[index(i)]; }
+
+    void push_back(const T& val)
+    {
+        if(count==slots.size())
+            throw std::logic_error("ring_buffer overflow");
+        slots[index(count)] = val;
+        count++;
+    }
+
+    void pop_front()
+    {
+        assert(count);
+        slots[head] = T();
+        if(++head==slots.size())
+            head = 0u;
+        count--;
+    }
+};
+
+}} // namespace epics::pvAccess
+
+#endif // RINGBUFFER_H
@@ -0,0 +1,81 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <ostream>
+#include <string>
+
+#include <pv/noDefaultMethods.h>
+#include <pv/sharedPtr.h>
+#include <pv/timer.h>
+
+#include <shareLib.h>
+
+namespace epics {
+namespace pvAccess {
+
+/** @brief Runs TimerCallbacks from a hierarchical timer wheel.
+ *
+ * A replacement for epics::pvData::Timer with the same interface,
+ * for when many timers are scheduled (eg. one per connection).
+ * Scheduling and cancelling take constant time for the wheel,
+ * plus a lookup by callback, instead of an insertion into a sorted list.
+ *
+ * Times are rounded up to a whole tick, so callbacks run late by at most one tick.
+ * Delays longer than 2^32 ticks are clamped.
+ */
+class epicsShareClass TimerWheel
+{
+    EPICS_NOT_COPYABLE(TimerWheel)
+public:
+    POINTER_DEFINITIONS(TimerWheel);
+
+    /**
+     * @param threadName Name of the thread which runs callbacks
+     * @param priority of this thread
+     * @param tick resolution in seconds
+     */
+    TimerWheel(const std::string& threadName,
+               epics::pvData::ThreadPriority priority,
+               double tick = 0.01);
+    //! Calls close()
+    ~TimerWheel();
+
+    //! Stop the thread, and call timerStopped() for all scheduled callbacks.
+    //! Later calls to schedule*() only call timerStopped().
+    void close();
+
+    //! Run callback once after delay seconds.
+    //! @throws std::logic_error if already scheduled
+    void scheduleAfterDelay(epics::pvData::TimerCallbackPtr const & callback,
+                            double delay);
+    //! Run callback after delay seconds, then every period seconds until cancel()'d
+    //! @throws std::logic_error if already scheduled
+    void schedulePeriodic(epics::pvData::TimerCallbackPtr const & callback,
+                          double delay,
+                          double period);
+    //! @returns true if callback was scheduled
+    bool cancel(epics::pvData::TimerCallbackPtr const & callback);
+    bool isScheduled(epics::pvData::TimerCallbackPtr const & callback) const;
+
+    //! Number of scheduled callbacks
+    size_t size() const;
+
+    void dump(std::ostream& o) const;
+
+private:
+    struct Pvt;
+    epics::auto_ptr<Pvt> pvt;
+};
+
+epicsShareFunc std::ostream& operator<<(std::ostream& o, const TimerWheel& timer);
+
+}
+}
+
+#endif // TIMERWHEEL_H
@@ -0,0 +1,356 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <map>
+#include <vector>
+#include <stdexcept>
+#include <math.h>
+
+#include <epicsTypes.h>
+#include <epicsTime.h>
+#include <epicsEvent.h>
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+#include <epicsThread.h>
+
+#define epicsExportSharedSymbols
+#include <pv/logger.h>
+#include <pv/timerWheel.h>
+
+namespace pvd = epics::pvData;
+
+typedef epicsGuard<epicsMutex> Guard;
+typedef epicsGuardRelease<epicsMutex> UnGuard;
+
+namespace epics {
+namespace pvAccess {
+
+/* Four levels of 256 slots.  Level 0 holds timers which expire within 256 ticks,
+ * one slot per tick.  Level N holds timers which expire within 256^(N+1) ticks,
+ * one slot per 256^N ticks.  When level 0 wraps around, the next slot of level 1
+ * is cascaded, ie. its timers are re-inserted in level 0.  Likewise when
+ * level 1 wraps, the next slot of level 2 is cascaded, and so on.
+ *
+ * Timers are kept in a map by callback, which is the only non-constant time
+ * operation.  This also gives the storage for the (intrusive) lists of each slot.
+ */
+struct TimerWheel::Pvt : public epicsThreadRunable
+{
+    enum { bits = 8, nslots = 1<<bits, nlevels = 4 };
+    typedef epicsUInt64 tick_t;
+
+    struct Entry {
+        pvd::TimerCallbackPtr callback;
+        tick_t expires;
+        tick_t period; // in ticks, or zero for one-shot
+        Entry *prev, *next;
+        Entry **head; // list of the slot we are in
+        Entry() :expires(0u), period(0u), prev(0), next(0), head(0) {}
+    };
+    typedef std::map<pvd::TimerCallback*, Entry> entries_t;
+
+    const std::string name;
+    const double tick;
+    const epicsTime start;
+
+    mutable epicsMutex mutex;
+    epicsEvent wakeup;
+
+    entries_t entries;
+    Entry *slots[nlevels][nslots];
+
+    tick_t current; // next tick to process
+    tick_t waitUntil; // the worker sleeps until this tick
+    bool stopping, closed;
+
+    // callbacks of the tick being processed
+    std::vector<pvd::TimerCallbackPtr> due;
+
+    epicsThread worker;
+
+    Pvt(const std::string& name, pvd::ThreadPriority priority, double tick)
+        :name(name)
+        ,tick(tick>0.0 ? tick : 0.01)
+        ,start(epicsTime::getCurrent())
+        ,current(0u)
+        ,waitUntil(tick_t(-1))
+        ,stopping(false)
+        ,closed(false)
+        ,worker(*this, name.c_str(),
+                epicsThreadGetStackSize(epicsThreadStackBig),
+                unsigned(priority))
+    {
+        for(unsigned l=0; l<nlevels; l++)
+            for(unsigned s=0; s<nslots; s++)
+                slots[l][s] = 0;
+        worker.start();
+    }
+
+    virtual ~Pvt() {}
+
+    // first tick which begins after (or at) 'when'
+    tick_t tickAfter(const epicsTime& when) const
+    {
+        double t = (when - start)/tick;
+        return t<=0.0 ? 0u : tick_t(ceil(t));
+    }
+
+    // last tick which began at or before 'when'
+    tick_t tickBefore(const epicsTime& when) const
+    {
+        double t = (when - start)/tick;
+        return t<=0.0 ? 0u : tick_t(floor(t));
+    }
+
+    tick_t ticks(double period) const
+    {
+        tick_t N = tick_t(ceil(period/tick));
+        return N ? N : 1u;
+    }
+
+    void link(Entry& ent)
+    {
+        tick_t expires = ent.expires < current ? current : ent.expires;
+        tick_t delta = expires - current;
+
+        unsigned level = 0u;
+        while(level+1u < unsigned(nlevels) && delta >= (tick_t(1u)<<(bits*(level+1u))))
+            level++;
+        if(delta >= (tick_t(1u)<<(bits*nlevels))) {
+            expires = current + (tick_t(1u)<<(bits*nlevels)) - 1u;
+            ent.expires = expires;
+        }
+
+        Entry **head = &slots[level][(expires>>(bits*level))&(nslots-1)];
+        ent.head = head;
+        ent.prev = 0;
+        ent.next = *head;
+        if(ent.next)
+            ent.next->prev = &ent;
+        *head = &ent;
+    }
+
+    void unlink(Entry& ent)
+    {
+        if(ent.prev)
+            ent.prev->next = ent.next;
+        else
+            *ent.head = ent.next;
+        if(ent.next)
+            ent.next->prev = ent.prev;
+        ent.prev = ent.next = 0;
+        ent.head = 0;
+    }
+
+    // re-insert timers of one slot of a higher level.  returns the slot index
+    unsigned cascade(unsigned level)
+    {
+        unsigned idx = unsigned(current>>(bits*level))&(nslots-1);
+        Entry *ent = slots[level][idx];
+        slots[level][idx] = 0;
+        while(ent) {
+            Entry *next = ent->next;
+            link(*ent);
+            ent = next;
+        }
+        return idx;
+    }
+
+    // expire timers of 'current'.  caller must hold mutex
+    void process()
+    {
+        unsigned idx = unsigned(current)&(nslots-1);
+        if(idx==0u) {
+            for(unsigned level=1u; level<unsigned(nlevels) && cascade(level)==0u; level++) {}
+        }
+
+        Entry *ent = slots[0][idx];
+        while(ent) {
+            Entry *next = ent->next;
+            due.push_back(ent->callback);
+            unlink(*ent);
+            if(ent->period) {
+                ent->expires = current + ent->period;
+                link(*ent);
+            } else {
+                entries.erase(ent->callback.get());
+            }
+            ent = next;
+        }
+        current++;
+    }
+
+    // earliest tick which may have something to do.  caller must hold mutex
+    tick_t nextWork() const
+    {
+        for(tick_t t = current; ; t++) {
+            unsigned idx = unsigned(t)&(nslots-1);
+            if(slots[0][idx] || idx==0u) // expiry, or cascade
+                return t;
+        }
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        Guard G(mutex);
+        while(!stopping) {
+            tick_t now = tickBefore(epicsTime::getCurrent());
+
+            while(!stopping && current <= now) {
+                process();
+                if(due.empty())
+                    continue;
+
+                std::vector<pvd::TimerCallbackPtr> todo;
+                todo.swap(due);
+                UnGuard U(G);
+                for(size_t i=0; i<todo.size(); i++) {
+                    try {
+                        todo[i]->callback();
+                    }catch(std::exception& e){
+                        LOG(logLevelError, "Unhandled exception from %s timer callback : %s", name.c_str(), e.what());
+                    }
+                }
+                todo.clear(); // release outside of the lock
+            }
+            if(stopping)
+                break;
+
+            if(entries.empty()) {
+                waitUntil = tick_t(-1);
+                UnGuard U(G);
+                wakeup.wait();
+            } else {
+                waitUntil = nextWork();
+                double delay = (start + double(waitUntil)*tick) - epicsTime::getCurrent();
+                if(delay>0.0) {
+                    UnGuard U(G);
+                    wakeup.wait(delay);
+                }
+            }
+        }
+    }
+
+    void schedule(const pvd::TimerCallbackPtr& callback, double delay, double period)
+    {
+        {
+            Guard G(mutex);
+            if(!closed) {
+                if(entries.empty()) {
+                    // skip over the ticks since we became idle
+                    tick_t now = tickBefore(epicsTime::getCurrent());
+                    if(now > current)
+                        current = now;
+                }
+                Entry& ent = entries[callback.get()];
+                if(ent.callback)
+                    throw std::logic_error("already queued");
+                ent.callback = callback;
+                ent.period = period>0.0 ? ticks(period) : 0u;
+                ent.expires = delay>0.0 ? tickAfter(epicsTime::getCurrent() + delay) : current;
+                link(ent);
+
+                bool wake = ent.expires < waitUntil;
+                if(wake)
+                    waitUntil = ent.expires;
+                UnGuard U(G);
+                if(wake)
+                    wakeup.signal();
+                return;
+            }
+        }
+        callback->timerStopped();
+    }
+};
+
+TimerWheel::TimerWheel(const std::string& threadName,
+                       epics::pvData::ThreadPriority priority,
+                       double tick)
+    :pvt(new Pvt(threadName, priority, tick))
+{}
+
+TimerWheel::~TimerWheel()
+{
+    close();
+}
+
+void TimerWheel::close()
+{
+    std::vector<pvd::TimerCallbackPtr> stopped;
+    {
+        Guard G(pvt->mutex);
+        if(pvt->closed)
+            return;
+        pvt->closed = true;
+        pvt->stopping = true;
+    }
+    pvt->wakeup.signal();
+    pvt->worker.exitWait();
+    {
+        Guard G(pvt->mutex);
+        stopped.reserve(pvt->entries.size());
+        for(Pvt::entries_t::iterator it(pvt->entries.begin()), end(pvt->entries.end()); it!=end; ++it)
+            stopped.push_back(it->second.callback);
+        pvt->entries.clear();
+        for(unsigned l=0; l<Pvt::nlevels; l++)
+            for(unsigned s=0; s<Pvt::nslots; s++)
+                pvt->slots[l][s] = 0;
+    }
+    for(size_t i=0; i<stopped.size(); i++)
+        stopped[i]->timerStopped();
+}
+
+void TimerWheel::scheduleAfterDelay(epics::pvData::TimerCallbackPtr const & callback,
+                                    double delay)
+{
+    pvt->schedule(callback, delay, 0.0);
+}
+
+void TimerWheel::schedulePeriodic(epics::pvData::TimerCallbackPtr const & callback,
+                                  double delay,
+                                  double period)
+{
+    pvt->schedule(callback, delay, period);
+}
+
+bool TimerWheel::cancel(epics::pvData::TimerCallbackPtr const & callback)
+{
+    pvd::TimerCallbackPtr victim; // destroy after unlock
+    Guard G(pvt->mutex);
+    Pvt::entries_t::iterator it(pvt->entries.find(callback.get()));
+    if(it==pvt->entries.end())
+        return false;
+    pvt->unlink(it->second);
+    victim.swap(it->second.callback);
+    pvt->entries.erase(it);
+    return true;
+}
+
+bool TimerWheel::isScheduled(epics::pvData::TimerCallbackPtr const & callback) const
+{
+    Guard G(pvt->mutex);
+    return pvt->entries.find(callback.get())!=pvt->entries.end();
+}
+
+size_t TimerWheel::size() const
+{
+    Guard G(pvt->mutex);
+    return pvt->entries.size();
+}
+
+void TimerWheel::dump(std::ostream& o) const
+{
+    Guard G(pvt->mutex);
+    o<<"TimerWheel '"<<pvt->name<<"' tick="<<pvt->tick<<"s timers="<<pvt->entries.size()<<"\n";
+}
+
+std::ostream& operator<<(std::ostream& o, const TimerWheel& timer)
+{
+    timer.dump(o);
+    return o;
+}
+
+}} // namespace epics::pvAccess
@@ -235,8 +235,8 @@ public:
                 std::size_t pos = caMessage._payload->getPosition();
 
 
-                while(_socketBuffer.getRemaining() > 0) {
-                    caMessage._payload->putByte(_socketBuffer.getByte());
+                while(_socketBuffer->getRemaining() > 0) {
+                    caMessage._payload->putByte(_socketBuffer->getByte());
                 }
 
                 std::size_t read =
@@ -281,7 +281,7 @@ public:
 
     ByteBuffer*  getSendBuffer()
     {
-        return &_sendBuffer;
+        return _sendBuffer.get();
     }
 
     const osiSockAddr* getLastReadBufferSocketAddress()
@@ -436,7 +436,7 @@ class CodecTest {
 public:
 
     int runAllTest() {
-        testPlan(5883);
+        testPlan(5908);
         testHeaderProcess();
         testInvalidHeaderMagic();
         testInvalidHeaderSegmentedInNormal();
@@ -460,6 +460,11 @@ public:
         testEnqueueSendDirectRequest();
         testSendException();
         testSendHugeMessagePartes();
+        testReceiveBufferGrowth();
+        testReceiveBufferNoGrowthUnverified();
+        testSendBufferGrowth();
+        testReceiveBufferShrink();
+        testSendBufferShrink();
         testRecipient();
         testInvalidArguments();
         testDefaultModes();
@@ -2668,6 +2673,271 @@ private:
     }
 
 
+    void testReceiveBufferGrowth()
+    {
+        testDiag("BEGIN TEST %s:", CURRENT_FUNCTION);
+
+        TestCodec codec(DEFAULT_BUFFER_SIZE,DEFAULT_BUFFER_SIZE);
+        codec.setMaxReceiveBufferSize(8*DEFAULT_BUFFER_SIZE);
+        codec.allowReceiveBufferGrowth();
+
+        AbstractCodec::BufferStats stats;
+        codec.getBufferStats(stats);
+        const std::size_t initialSize = stats.receiveBufferSize;
+
+        codec._readPayload = true;
+
+        // two messages larger than the initial buffer
+        const int32_t payloadSize = 3*DEFAULT_BUFFER_SIZE;
+        codec._readBuffer.reset(
+            new ByteBuffer(2*(PVA_MESSAGE_HEADER_SIZE+payloadSize)));
+
+        for (int n = 0; n < 2; n++)
+        {
+            codec._readBuffer->put(PVA_MAGIC);
+            codec._readBuffer->put(PVA_VERSION);
+            codec._readBuffer->put((int8_t)0x80);
+            codec._readBuffer->put((int8_t)0x01);
+            codec._readBuffer->putInt(payloadSize);
+            for (int32_t i = 0; i < payloadSize; i++)
+                codec._readBuffer->put((int8_t)i);
+        }
+        codec._readBuffer->flip();
+
+        codec.processRead();
+
+        testOk(codec._invalidDataStreamCount == 0,
+               "%s: codec._invalidDataStreamCount == 0",
+               CURRENT_FUNCTION);
+        testOk(codec._receivedAppMessages.size() == 2,
+               "%s: codec._receivedAppMessages.size() == 2",
+               CURRENT_FUNCTION);
+
+        for (size_t n = 0; n < codec._receivedAppMessages.size(); n++)
+        {
+            PVAMessage& msg = codec._receivedAppMessages[n];
+            msg._payload->flip();
+            testOk((std::size_t)payloadSize == msg._payload->getLimit(),
+                   "%s: payloadSize == msg._payload->getLimit()",
+                   CURRENT_FUNCTION);
+        }
+
+        codec.getBufferStats(stats);
+
+        testOk(stats.receiveBufferSize > initialSize
+               && stats.receiveBufferSize <= 8*DEFAULT_BUFFER_SIZE,
+               "%s: %u < receiveBufferSize %u <= %u",
+               CURRENT_FUNCTION, unsigned(initialSize),
+               unsigned(stats.receiveBufferSize), unsigned(8*DEFAULT_BUFFER_SIZE));
+        testOk(stats.ngrow == 1,
+               "%s: stats.ngrow %u == 1", CURRENT_FUNCTION, unsigned(stats.ngrow));
+        testOk(stats.nrxMessages == 2 && stats.nrxSegments == 2,
+               "%s: 2 messages in %u segments", CURRENT_FUNCTION, unsigned(stats.nrxSegments));
+    }
+
+
+    // append a message with a payload of 'payloadSize' bytes to codec._readBuffer
+    static void putMessage(TestCodec& codec, int32_t payloadSize)
+    {
+        codec._readBuffer->put(PVA_MAGIC);
+        codec._readBuffer->put(PVA_VERSION);
+        codec._readBuffer->put((int8_t)0x80);
+        codec._readBuffer->put((int8_t)0x01);
+        codec._readBuffer->putInt(payloadSize);
+        for (int32_t i = 0; i < payloadSize; i++)
+            codec._readBuffer->put((int8_t)i);
+    }
+
+
+    void testReceiveBufferNoGrowthUnverified()
+    {
+        testDiag("BEGIN TEST %s:", CURRENT_FUNCTION);
+
+        // growth not allowed until the peer is verified
+        TestCodec codec(DEFAULT_BUFFER_SIZE,DEFAULT_BUFFER_SIZE);
+        codec.setMaxReceiveBufferSize(8*DEFAULT_BUFFER_SIZE);
+
+        AbstractCodec::BufferStats stats;
+        codec.getBufferStats(stats);
+        const std::size_t initialSize = stats.receiveBufferSize;
+
+        codec._readPayload = true;
+
+        const int32_t payloadSize = 3*DEFAULT_BUFFER_SIZE;
+        codec._readBuffer.reset(
+            new ByteBuffer(2*(PVA_MESSAGE_HEADER_SIZE+payloadSize)));
+        putMessage(codec, payloadSize);
+        putMessage(codec, payloadSize);
+        codec._readBuffer->flip();
+
+        codec.processRead();
+
+        testOk(codec._invalidDataStreamCount == 0,
+               "%s: codec._invalidDataStreamCount == 0",
+               CURRENT_FUNCTION);
+        testOk(codec._receivedAppMessages.size() == 2,
+               "%s: codec._receivedAppMessages.size() == 2",
+               CURRENT_FUNCTION);
+
+        codec.getBufferStats(stats);
+
+        testOk(stats.receiveBufferSize == initialSize,
+               "%s: receiveBufferSize %u == %u",
+               CURRENT_FUNCTION, unsigned(stats.receiveBufferSize), unsigned(initialSize));
+        testOk(stats.ngrow == 0,
+               "%s: stats.ngrow %u == 0", CURRENT_FUNCTION, unsigned(stats.ngrow));
+    }
+
+
+    void testReceiveBufferShrink()
+    {
+        testDiag("BEGIN TEST %s:", CURRENT_FUNCTION);
+
+        TestCodec codec(DEFAULT_BUFFER_SIZE,DEFAULT_BUFFER_SIZE);
+        codec.setMaxReceiveBufferSize(8*DEFAULT_BUFFER_SIZE);
+        codec.allowReceiveBufferGrowth();
+        // shrink on the first small message
+        codec.setBufferShrinkDelay(0.0);
+
+        AbstractCodec::BufferStats stats;
+        codec.getBufferStats(stats);
+        const std::size_t initialSize = stats.receiveBufferSize;
+
+        codec._readPayload = true;
+
+        // one large message grows the buffer, the first small one shrinks it
+        const int32_t payloadSize = 3*DEFAULT_BUFFER_SIZE;
+        codec._readBuffer.reset(
+            new ByteBuffer(PVA_MESSAGE_HEADER_SIZE+payloadSize + 2*(PVA_MESSAGE_HEADER_SIZE+16)));
+        putMessage(codec, payloadSize);
+        putMessage(codec, 16);
+        putMessage(codec, 16);
+        codec._readBuffer->flip();
+
+        codec.processRead();
+
+        testOk(codec._invalidDataStreamCount == 0,
+               "%s: codec._invalidDataStreamCount == 0",
+               CURRENT_FUNCTION);
+        testOk(codec._receivedAppMessages.size() == 3,
+               "%s: codec._receivedAppMessages.size() == 3",
+               CURRENT_FUNCTION);
+
+        codec.getBufferStats(stats);
+
+        testOk(stats.ngrow == 1,
+               "%s: stats.ngrow %u == 1", CURRENT_FUNCTION, unsigned(stats.ngrow));
+        testOk(stats.nshrink == 1,
+               "%s: stats.nshrink %u == 1", CURRENT_FUNCTION, unsigned(stats.nshrink));
+        testOk(stats.receiveBufferSize == initialSize,
+               "%s: receiveBufferSize %u == %u",
+               CURRENT_FUNCTION, unsigned(stats.receiveBufferSize), unsigned(initialSize));
+    }
+
+
+    void testSendBufferGrowth()
+    {
+        testDiag("BEGIN TEST %s:", CURRENT_FUNCTION);
+
+        TestCodec codec(DEFAULT_BUFFER_SIZE,DEFAULT_BUFFER_SIZE);
+        codec.setMaxSendBufferSize(8*DEFAULT_BUFFER_SIZE);
+
+        AbstractCodec::BufferStats stats;
+        codec.getBufferStats(stats);
+        const std::size_t initialSize = stats.sendBufferSize;
+
+        codec._readBuffer.reset(
+            new ByteBuffer(11*DEFAULT_BUFFER_SIZE));
+
+        // larger than the initial buffer
+        std::tr1::shared_ptr<TransportSender> sender =
+            std::tr1::shared_ptr<TransportSender>(
+                new TransportSenderForTestSendHugeMessagePartes(
+                    codec, 3*DEFAULT_BUFFER_SIZE));
+
+        codec._writePollOneCallback.reset(new WritePollOneCallbackForTestSendHugeMessagePartes
+                                          (codec));
+
+        codec.enqueueSendRequest(sender);
+        codec.enqueueSendRequest(sender);
+        codec.breakSender();
+        try {
+            codec.processSendQueue();
+        } catch(sender_break&) {
+            testDiag("sender_break");
+        }
+
+        codec.getBufferStats(stats);
+
+        testOk(stats.ntxMessages == 2,
+               "%s: stats.ntxMessages %u == 2", CURRENT_FUNCTION, unsigned(stats.ntxMessages));
+        testOk(stats.maxTxSegments > 1,
+               "%s: first message segmented in %u", CURRENT_FUNCTION, unsigned(stats.maxTxSegments));
+        testOk(stats.ntxSegments == stats.maxTxSegments + 1,
+               "%s: second message not segmented", CURRENT_FUNCTION);
+        testOk(stats.sendBufferSize > initialSize
+               && stats.sendBufferSize <= 8*DEFAULT_BUFFER_SIZE,
+               "%s: %u < sendBufferSize %u <= %u",
+               CURRENT_FUNCTION, unsigned(initialSize),
+               unsigned(stats.sendBufferSize), unsigned(8*DEFAULT_BUFFER_SIZE));
+        testOk(stats.ngrow == 1,
+               "%s: stats.ngrow %u == 1", CURRENT_FUNCTION, unsigned(stats.ngrow));
+    }
+
+
+    void testSendBufferShrink()
+    {
+        testDiag("BEGIN TEST %s:", CURRENT_FUNCTION);
+
+        TestCodec codec(DEFAULT_BUFFER_SIZE,DEFAULT_BUFFER_SIZE);
+        codec.setMaxSendBufferSize(8*DEFAULT_BUFFER_SIZE);
+        codec.setBufferShrinkDelay(0.0);
+
+        AbstractCodec::BufferStats stats;
+        codec.getBufferStats(stats);
+        const std::size_t initialSize = stats.sendBufferSize;
+
+        codec._readBuffer.reset(
+            new ByteBuffer(11*DEFAULT_BUFFER_SIZE));
+
+        std::tr1::shared_ptr<TransportSender> large =
+            std::tr1::shared_ptr<TransportSender>(
+                new TransportSenderForTestSendHugeMessagePartes(
+                    codec, 3*DEFAULT_BUFFER_SIZE));
+        std::tr1::shared_ptr<TransportSender> small =
+            std::tr1::shared_ptr<TransportSender>(
+                new TransportSenderForTestSendHugeMessagePartes(
+                    codec, 16));
+
+        codec._writePollOneCallback.reset(new WritePollOneCallbackForTestSendHugeMessagePartes
+                                          (codec));
+
+        // grown after the first, shrunk before the last
+        codec.enqueueSendRequest(large);
+        codec.enqueueSendRequest(large);
+        codec.enqueueSendRequest(small);
+        codec.enqueueSendRequest(small);
+        codec.breakSender();
+        try {
+            codec.processSendQueue();
+        } catch(sender_break&) {
+            testDiag("sender_break");
+        }
+
+        codec.getBufferStats(stats);
+
+        testOk(stats.ntxMessages == 4,
+               "%s: stats.ntxMessages %u == 4", CURRENT_FUNCTION, unsigned(stats.ntxMessages));
+        testOk(stats.ngrow == 1,
+               "%s: stats.ngrow %u == 1", CURRENT_FUNCTION, unsigned(stats.ngrow));
+        testOk(stats.nshrink == 1,
+               "%s: stats.nshrink %u == 1", CURRENT_FUNCTION, unsigned(stats.nshrink));
+        testOk(stats.sendBufferSize == initialSize,
+               "%s: sendBufferSize %u == %u",
+               CURRENT_FUNCTION, unsigned(stats.sendBufferSize), unsigned(initialSize));
+    }
+
+
     void testRecipient()
     {
         // nothing to test, depends on implementation
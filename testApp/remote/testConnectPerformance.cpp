@@ -0,0 +1,184 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+/* Measure the time to connect many channels to a local server,
+ * creating channels one at a time with ClientProvider::connect(name),
+ * and together with ClientProvider::connect(names).
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <epicsGetopt.h>
+#include <epicsTime.h>
+#include <epicsEvent.h>
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+
+#include <pv/configuration.h>
+#include <pv/serverContext.h>
+#include <pva/server.h>
+#include <pva/sharedstate.h>
+#include <pva/client.h>
+
+namespace pvd = epics::pvData;
+namespace pva = epics::pvAccess;
+
+typedef epicsGuard<epicsMutex> Guard;
+
+namespace {
+
+#define DEFAULT_CHANNELS 250000
+#define DEFAULT_TIMEOUT 300.0
+
+const pvd::StructureConstPtr type(pvd::getFieldCreate()->createFieldBuilder()
+                                  ->add("value", pvd::pvInt)
+                                  ->createStructure());
+
+void usage (void)
+{
+    fprintf (stderr, "\nUsage: testConnectPerformance [options]\n\n"
+             "  -h: Help: Print this message\n"
+             "options:\n"
+             "  -c <channels>:     number of channels, default is '%d'\n"
+             "  -w <sec>:          wait time, specifies timeout, default is %f second(s)\n\n"
+             , DEFAULT_CHANNELS, DEFAULT_TIMEOUT);
+}
+
+struct Counter : public pvac::ClientChannel::ConnectCallback
+{
+    epicsMutex mutex;
+    epicsEvent done;
+    size_t connected, expect;
+
+    explicit Counter(size_t expect) :connected(0u), expect(expect) {}
+    virtual ~Counter() {}
+
+    virtual void connectEvent(const pvac::ConnectEvent& evt)
+    {
+        if(!evt.connected)
+            return;
+        bool last;
+        {
+            Guard G(mutex);
+            last = ++connected==expect;
+        }
+        if(last)
+            done.signal();
+    }
+};
+
+void measure(const char *label, const pva::Configuration::shared_pointer& conf,
+             const std::vector<std::string>& names, bool bulk, double timeout)
+{
+    pvac::ClientProvider client("pva", conf);
+    Counter counter(names.size());
+
+    epicsTimeStamp start, created, end;
+    epicsTimeGetCurrent(&start);
+
+    std::vector<pvac::ClientChannel> channels;
+    if(bulk) {
+        channels = client.connect(names);
+    } else {
+        channels.reserve(names.size());
+        for(size_t i=0; i<names.size(); i++)
+            channels.push_back(client.connect(names[i]));
+    }
+
+    epicsTimeGetCurrent(&created);
+
+    for(size_t i=0; i<channels.size(); i++)
+        channels[i].addConnectListener(&counter);
+
+    bool ok = counter.done.wait(timeout);
+    epicsTimeGetCurrent(&end);
+
+    size_t connected;
+    {
+        Guard G(counter.mutex);
+        connected = counter.connected;
+    }
+
+    printf("%-10s %8u channels, create %8.3f s, all connected %8.3f s%s (%u connected)\n",
+           label, unsigned(names.size()),
+           epicsTimeDiffInSeconds(&created, &start),
+           epicsTimeDiffInSeconds(&end, &start),
+           ok ? "" : " TIMEOUT",
+           unsigned(connected));
+
+    for(size_t i=0; i<channels.size(); i++)
+        channels[i].removeConnectListener(&counter);
+}
+
+} // namespace
+
+int main (int argc, char *argv[])
+{
+    int nchannels = DEFAULT_CHANNELS;
+    double timeout = DEFAULT_TIMEOUT;
+
+    int opt;
+    while ((opt = getopt(argc, argv, ":hc:w:")) != -1) {
+        switch (opt) {
+        case 'h':
+            usage();
+            return 0;
+        case 'c':
+            nchannels = atoi(optarg);
+            break;
+        case 'w':
+            timeout = atof(optarg);
+            break;
+        default:
+            usage();
+            return 1;
+        }
+    }
+
+    if(nchannels<=0 || timeout<=0.0) {
+        usage();
+        return 1;
+    }
+
+    try {
+        std::tr1::shared_ptr<pvas::StaticProvider> prov(new pvas::StaticProvider("connect"));
+        pvas::SharedPV::shared_pointer pv(pvas::SharedPV::buildReadOnly());
+        pv->open(type);
+
+        std::vector<std::string> names(nchannels);
+        for(int i=0; i<nchannels; i++) {
+            char buf[32];
+            sprintf(buf, "connect:%d", i);
+            names[i] = buf;
+            // one SharedPV may be added under many names
+            prov->add(names[i], pv);
+        }
+
+        pva::ServerContext::shared_pointer server(pva::ServerContext::create(pva::ServerContext::Config()
+                                                  .config(pva::ConfigurationBuilder()
+                                                          .add("EPICS_PVAS_INTF_ADDR_LIST", "127.0.0.1")
+                                                          .add("EPICS_PVA_ADDR_LIST", "127.0.0.1")
+                                                          .add("EPICS_PVA_AUTO_ADDR_LIST","0")
+                                                          .add("EPICS_PVA_SERVER_PORT", "0")
+                                                          .add("EPICS_PVA_BROADCAST_PORT", "0")
+                                                          .push_map()
+                                                          .build())
+                                                  .provider(prov->provider())));
+
+        // each run uses a new client context
+        measure("single", server->getCurrentConfig(), names, false, timeout);
+        measure("bulk", server->getCurrentConfig(), names, true, timeout);
+
+    } catch(std::exception& e) {
+        std::cerr<<"Error: "<<e.what()<<"\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,218 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+/* Measure the rate at which updates of many scalar channels are delivered
+ * from a local server, with monitor updates grouped into CMD_MULTIPLE_DATA,
+ * and with one CMD_MONITOR message per update (EPICS_PVAS_GROUP_MONITORS=NO).
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <stdexcept>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <epicsGetopt.h>
+#include <epicsTime.h>
+
+#include <pv/configuration.h>
+#include <pv/serverContext.h>
+#include <pva/server.h>
+#include <pva/sharedstate.h>
+#include <pva/client.h>
+
+#include <pv/codec.h>
+#include <pv/responseHandlers.h>
+#include <pv/serverContextImpl.h>
+
+namespace pvd = epics::pvData;
+namespace pva = epics::pvAccess;
+
+namespace {
+
+#define DEFAULT_CHANNELS 1000
+#define DEFAULT_ROUNDS 100
+#define DEFAULT_TIMEOUT 30.0
+
+const pvd::StructureConstPtr type(pvd::getFieldCreate()->createFieldBuilder()
+                                  ->add("value", pvd::pvInt)
+                                  ->createStructure());
+
+void usage (void)
+{
+    fprintf (stderr, "\nUsage: testMonitorGroupPerformance [options]\n\n"
+             "  -h: Help: Print this message\n"
+             "options:\n"
+             "  -c <channels>:     number of channels, default is '%d'\n"
+             "  -r <rounds>:       number of times every channel is updated, default is '%d'\n"
+             "  -w <sec>:          wait time, specifies timeout, default is %f second(s)\n\n"
+             , DEFAULT_CHANNELS, DEFAULT_ROUNDS, DEFAULT_TIMEOUT);
+}
+
+void post(pvas::SharedPV& pv, pvd::int32 val)
+{
+    pvd::PVStructurePtr inst(pvd::getPVDataCreate()->createPVStructure(type));
+    pvd::BitSet changed;
+    pvd::PVIntPtr value(inst->getSubFieldT<pvd::PVInt>("value"));
+    value->put(val);
+    changed.set(value->getFieldOffset());
+    pv.post(*inst, changed);
+}
+
+// wait until every subscription has seen the value 'expect'.
+// returns the number of updates received.
+size_t drain(std::vector<pvac::MonitorSync>& mons, pvd::int32 expect, double timeout)
+{
+    size_t nupdates = 0u;
+    for(size_t i=0; i<mons.size(); i++) {
+        pvac::MonitorSync& mon = mons[i];
+        pvd::int32 last = -1;
+        while(last!=expect) {
+            if(!mon.test() && !mon.wait(timeout))
+                throw std::runtime_error("Timeout");
+            while(mon.poll()) {
+                last = mon.root->getSubFieldT<pvd::PVInt>("value")->get();
+                nupdates++;
+            }
+        }
+    }
+    return nupdates;
+}
+
+pva::ServerMonitorGroup::Stats groupStats(const pva::ServerContext::shared_pointer& server)
+{
+    pva::ServerMonitorGroup::Stats ret = {0u, 0u, 0u};
+
+    pva::ServerContextImpl::shared_pointer impl(std::tr1::dynamic_pointer_cast<pva::ServerContextImpl>(server));
+    pva::TransportRegistry::transportVector_t transports;
+    impl->getTransportRegistry()->toArray(transports);
+
+    for(size_t i=0; i<transports.size(); i++) {
+        pva::detail::BlockingServerTCPTransportCodec *codec =
+                dynamic_cast<pva::detail::BlockingServerTCPTransportCodec*>(transports[i].get());
+        pva::ServerMonitorGroup::shared_pointer mgroup;
+        if(codec)
+            mgroup = codec->getMonitorGroup();
+        if(!mgroup)
+            continue;
+
+        pva::ServerMonitorGroup::Stats stats;
+        mgroup->stats(stats);
+        ret.nmessages += stats.nmessages;
+        ret.ngrouped += stats.ngrouped;
+        ret.nseparate += stats.nseparate;
+    }
+    return ret;
+}
+
+void measure(bool group, int nchannels, int rounds, double timeout)
+{
+    std::tr1::shared_ptr<pvas::StaticProvider> prov(new pvas::StaticProvider("monitorgroup"));
+
+    std::vector<pvas::SharedPV::shared_pointer> pvs(nchannels);
+    std::vector<std::string> names(nchannels);
+    for(int i=0; i<nchannels; i++) {
+        char buf[32];
+        sprintf(buf, "monitorgroup:%d", i);
+        names[i] = buf;
+        pvs[i] = pvas::SharedPV::buildReadOnly();
+        pvs[i]->open(type);
+        prov->add(names[i], pvs[i]);
+    }
+
+    pva::ServerContext::shared_pointer server(pva::ServerContext::create(pva::ServerContext::Config()
+                                              .config(pva::ConfigurationBuilder()
+                                                      .add("EPICS_PVAS_INTF_ADDR_LIST", "127.0.0.1")
+                                                      .add("EPICS_PVA_ADDR_LIST", "127.0.0.1")
+                                                      .add("EPICS_PVA_AUTO_ADDR_LIST","0")
+                                                      .add("EPICS_PVA_SERVER_PORT", "0")
+                                                      .add("EPICS_PVA_BROADCAST_PORT", "0")
+                                                      .add("EPICS_PVAS_GROUP_MONITORS", group ? "YES" : "NO")
+                                                      .push_map()
+                                                      .build())
+                                              .provider(prov->provider())));
+
+    pvac::ClientProvider client("pva", server->getCurrentConfig());
+
+    std::vector<pvac::MonitorSync> mons;
+    mons.reserve(nchannels);
+    for(int i=0; i<nchannels; i++)
+        mons.push_back(client.connect(names[i]).monitor());
+
+    // initial values
+    drain(mons, 0, timeout);
+
+    pva::ServerMonitorGroup::Stats before(groupStats(server));
+
+    epicsTimeStamp start, end;
+    epicsTimeGetCurrent(&start);
+
+    size_t nupdates = 0u;
+    for(int r=1; r<=rounds; r++) {
+        for(int i=0; i<nchannels; i++)
+            post(*pvs[i], r);
+        nupdates += drain(mons, r, timeout);
+    }
+
+    epicsTimeGetCurrent(&end);
+    double elapsed = epicsTimeDiffInSeconds(&end, &start);
+
+    pva::ServerMonitorGroup::Stats after(groupStats(server));
+    const size_t nmessages = after.nmessages - before.nmessages,
+                 ngrouped = after.ngrouped - before.ngrouped;
+
+    printf("%-12s %6d channels, %4d rounds, %10.0f updates/s, %8.3f ms per round",
+           group ? "grouped" : "not grouped", nchannels, rounds,
+           nupdates/elapsed, 1e3*elapsed/rounds);
+    if(group)
+        printf(", %.1f updates per CMD_MULTIPLE_DATA", nmessages ? double(ngrouped)/nmessages : 0.0);
+    printf("\n");
+}
+
+} // namespace
+
+int main (int argc, char *argv[])
+{
+    int nchannels = DEFAULT_CHANNELS;
+    int rounds = DEFAULT_ROUNDS;
+    double timeout = DEFAULT_TIMEOUT;
+
+    int opt;
+    while ((opt = getopt(argc, argv, ":hc:r:w:")) != -1) {
+        switch (opt) {
+        case 'h':
+            usage();
+            return 0;
+        case 'c':
+            nchannels = atoi(optarg);
+            break;
+        case 'r':
+            rounds = atoi(optarg);
+            break;
+        case 'w':
+            timeout = atof(optarg);
+            break;
+        default:
+            usage();
+            return 1;
+        }
+    }
+
+    if(nchannels<=0 || rounds<=0 || timeout<=0.0) {
+        usage();
+        return 1;
+    }
+
+    try {
+        measure(false, nchannels, rounds, timeout);
+        measure(true, nchannels, rounds, timeout);
+    } catch(std::exception& e) {
+        std::cerr<<"Error: "<<e.what()<<"\n";
+        return 1;
+    }
+    return 0;
+}
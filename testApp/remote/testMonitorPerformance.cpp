@@ -81,6 +81,9 @@ void usage (void)
              "                         output is a space separated list of get operations per second for each run, one line per test\n"
              "  -v                 enable verbose output when configuration is read from the file\n"
              "  -w <sec>:          wait time, specifies timeout, default is %f second(s)\n\n"
+             "Updates for many channels are grouped into CMD_MULTIPLE_DATA messages by default.\n"
+             "Compare with a server run with EPICS_PVAS_GROUP_MONITORS=NO to measure the gain,\n"
+             "or see testMonitorGroupPerformance which compares both against a local server.\n\n"
              , DEFAULT_REQUEST, DEFAULT_ITERATIONS, DEFAULT_CHANNELS, DEFAULT_ARRAY_SIZE, DEFAULT_RUNS, DEFAULT_TIMEOUT);
 }
 
@@ -0,0 +1,180 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+/* Measure the cost of cycling preallocated MonitorElements through
+ * a client side monitor queue.  A producer fills free elements,
+ * squashing into the newest queued element when none are free,
+ * and a consumer polls and releases them.  Compares pv/ringBuffer.h
+ * with std::queue at queue sizes 2 through 1024.
+ */
+
+#include <iostream>
+#include <vector>
+#include <queue>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <epicsGetopt.h>
+#include <epicsTime.h>
+
+#include <pv/pvData.h>
+#include <pv/bitSet.h>
+#include <pv/monitor.h>
+#include <pv/ringBuffer.h>
+
+namespace pvd = epics::pvData;
+namespace pva = epics::pvAccess;
+
+namespace {
+
+#define DEFAULT_UPDATES 1000000
+#define DEFAULT_BURST 2
+
+const pvd::StructureConstPtr type(pvd::getFieldCreate()->createFieldBuilder()
+                                  ->add("value", pvd::pvInt)
+                                  ->add("counter", pvd::pvLong)
+                                  ->createStructure());
+
+void usage (void)
+{
+    fprintf (stderr, "\nUsage: testMonitorQueuePerformance [options]\n\n"
+             "  -h: Help: Print this message\n"
+             "options:\n"
+             "  -u <updates>:      number of updates per measurement, default is '%d'\n"
+             "  -b <factor>:       updates per consumer wakeup, as a multiple of the queue size, default is '%d'\n\n"
+             , DEFAULT_UPDATES, DEFAULT_BURST);
+}
+
+// adapt std::queue to the ring_buffer interface
+template<typename T>
+struct std_queue
+{
+    std::queue<T> Q;
+    void reset(size_t) { while(!Q.empty()) Q.pop(); }
+    bool empty() const { return Q.empty(); }
+    T& front() { return Q.front(); }
+    T& back() { return Q.back(); }
+    void push_back(const T& v) { Q.push(v); }
+    void pop_front() { Q.pop(); }
+};
+
+template<typename Queue>
+struct Tester
+{
+    typedef std::vector<pva::MonitorElementPtr> free_t;
+
+    free_t freeQ;
+    Queue monitorQ;
+    pvd::BitSet changed;
+    size_t nsquash;
+
+    explicit Tester(size_t queueSize)
+        :nsquash(0u)
+    {
+        monitorQ.reset(queueSize);
+        freeQ.reserve(queueSize);
+        for(size_t i=0; i<queueSize; i++)
+            freeQ.push_back(pva::MonitorElementPtr(new pva::MonitorElement(pvd::getPVDataCreate()->createPVStructure(type))));
+        changed.set(1);
+    }
+
+    void push(pvd::int32 val)
+    {
+        if(freeQ.empty()) {
+            // squash into the newest element
+            pva::MonitorElement& elem = *monitorQ.back();
+            elem.pvStructurePtr->getSubFieldT<pvd::PVInt>(1)->put(val);
+            elem.overrunBitSet->or_and(*elem.changedBitSet, changed);
+            *elem.changedBitSet |= changed;
+            nsquash++;
+
+        } else {
+            pva::MonitorElementPtr elem(freeQ.back());
+            freeQ.pop_back();
+            elem->pvStructurePtr->getSubFieldT<pvd::PVInt>(1)->put(val);
+            *elem->changedBitSet = changed;
+            elem->overrunBitSet->clear();
+            monitorQ.push_back(elem);
+        }
+    }
+
+    size_t drain()
+    {
+        size_t n = 0u;
+        while(!monitorQ.empty()) {
+            pva::MonitorElementPtr elem(monitorQ.front());
+            monitorQ.pop_front();
+            freeQ.push_back(elem);
+            n++;
+        }
+        return n;
+    }
+};
+
+template<typename Queue>
+void measure(const char *label, size_t queueSize, size_t nupdates, size_t burst)
+{
+    Tester<Queue> tester(queueSize);
+
+    epicsTimeStamp start, end;
+    epicsTimeGetCurrent(&start);
+
+    size_t npolled = 0u;
+    for(size_t n=0; n<nupdates; ) {
+        for(size_t i=0; i<burst && n<nupdates; i++, n++)
+            tester.push(pvd::int32(n));
+        npolled += tester.drain();
+    }
+
+    epicsTimeGetCurrent(&end);
+    double elapsed = epicsTimeDiffInSeconds(&end, &start);
+
+    printf("%-10s queueSize %5u, %9u updates, %8.2f ns per update (%u polled, %u squashed)\n",
+           label, unsigned(queueSize), unsigned(nupdates), 1e9*elapsed/nupdates,
+           unsigned(npolled), unsigned(tester.nsquash));
+}
+
+} // namespace
+
+int main (int argc, char *argv[])
+{
+    int nupdates = DEFAULT_UPDATES;
+    int burst = DEFAULT_BURST;
+
+    int opt;
+    while ((opt = getopt(argc, argv, ":hu:b:")) != -1) {
+        switch (opt) {
+        case 'h':
+            usage();
+            return 0;
+        case 'u':
+            nupdates = atoi(optarg);
+            break;
+        case 'b':
+            burst = atoi(optarg);
+            break;
+        default:
+            usage();
+            return 1;
+        }
+    }
+
+    if(nupdates<=0 || burst<=0) {
+        usage();
+        return 1;
+    }
+
+    try {
+        for(size_t queueSize=2u; queueSize<=1024u; queueSize*=2u) {
+            measure<pva::ring_buffer<pva::MonitorElementPtr> >("ring", queueSize, nupdates, burst*queueSize);
+            measure<std_queue<pva::MonitorElementPtr> >("std::queue", queueSize, nupdates, burst*queueSize);
+        }
+    } catch(std::exception& e) {
+        std::cerr<<"Error: "<<e.what()<<"\n";
+        return 1;
+    }
+    return 0;
+}
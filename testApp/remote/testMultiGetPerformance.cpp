@@ -0,0 +1,202 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+/* Measure the time to read a snapshot of many channels from a local server,
+ * with one ClientChannel::get() per channel, all in flight together,
+ * and with a single ClientProvider::getMany().
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <epicsGetopt.h>
+#include <epicsTime.h>
+#include <epicsEvent.h>
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+
+#include <pv/configuration.h>
+#include <pv/serverContext.h>
+#include <pva/server.h>
+#include <pva/sharedstate.h>
+#include <pva/client.h>
+
+namespace pvd = epics::pvData;
+namespace pva = epics::pvAccess;
+
+typedef epicsGuard<epicsMutex> Guard;
+
+namespace {
+
+#define DEFAULT_CHANNELS 5000
+#define DEFAULT_ITERATIONS 10
+#define DEFAULT_TIMEOUT 30.0
+
+const pvd::StructureConstPtr type(pvd::getFieldCreate()->createFieldBuilder()
+                                  ->add("value", pvd::pvInt)
+                                  ->createStructure());
+
+void usage (void)
+{
+    fprintf (stderr, "\nUsage: testMultiGetPerformance [options]\n\n"
+             "  -h: Help: Print this message\n"
+             "options:\n"
+             "  -c <channels>:     number of channels, default is '%d'\n"
+             "  -i <iterations>:   number of snapshots, default is '%d'\n"
+             "  -w <sec>:          wait time, specifies timeout, default is %f second(s)\n\n"
+             , DEFAULT_CHANNELS, DEFAULT_ITERATIONS, DEFAULT_TIMEOUT);
+}
+
+struct Counter : public pvac::ClientChannel::GetCallback
+{
+    epicsMutex mutex;
+    epicsEvent done;
+    size_t completed, failed, expect;
+
+    explicit Counter(size_t expect) :completed(0u), failed(0u), expect(expect) {}
+    virtual ~Counter() {}
+
+    virtual void getDone(const pvac::GetEvent& evt)
+    {
+        bool last;
+        {
+            Guard G(mutex);
+            if(evt.event!=pvac::GetEvent::Success)
+                failed++;
+            last = ++completed==expect;
+        }
+        if(last)
+            done.signal();
+    }
+};
+
+// returns the number of successful gets
+size_t single(std::vector<pvac::ClientChannel>& channels, double timeout)
+{
+    Counter counter(channels.size());
+    std::vector<pvac::Operation> ops(channels.size());
+    for(size_t i=0; i<channels.size(); i++)
+        ops[i] = channels[i].get(&counter);
+
+    counter.done.wait(timeout);
+    for(size_t i=0; i<ops.size(); i++)
+        ops[i].cancel();
+
+    Guard G(counter.mutex);
+    return counter.completed - counter.failed;
+}
+
+size_t multi(pvac::ClientProvider& client, std::vector<pvac::ClientChannel>& channels, double timeout)
+{
+    std::vector<pvac::GetEvent> results(client.getMany(channels, timeout));
+    size_t good = 0u;
+    for(size_t i=0; i<results.size(); i++) {
+        if(results[i].event==pvac::GetEvent::Success)
+            good++;
+    }
+    return good;
+}
+
+void measure(const char *label, pvac::ClientProvider& client, std::vector<pvac::ClientChannel>& channels,
+             bool many, int iterations, double timeout)
+{
+    epicsTimeStamp start, end;
+    epicsTimeGetCurrent(&start);
+
+    size_t good = 0u;
+    for(int n=0; n<iterations; n++)
+        good += many ? multi(client, channels, timeout) : single(channels, timeout);
+
+    epicsTimeGetCurrent(&end);
+    double elapsed = epicsTimeDiffInSeconds(&end, &start);
+
+    printf("%-10s %8u channels, %4d snapshots, %8.3f ms per snapshot (%u of %u succeeded)\n",
+           label, unsigned(channels.size()), iterations, 1e3*elapsed/iterations,
+           unsigned(good), unsigned(channels.size()*iterations));
+}
+
+} // namespace
+
+int main (int argc, char *argv[])
+{
+    int nchannels = DEFAULT_CHANNELS;
+    int iterations = DEFAULT_ITERATIONS;
+    double timeout = DEFAULT_TIMEOUT;
+
+    int opt;
+    while ((opt = getopt(argc, argv, ":hc:i:w:")) != -1) {
+        switch (opt) {
+        case 'h':
+            usage();
+            return 0;
+        case 'c':
+            nchannels = atoi(optarg);
+            break;
+        case 'i':
+            iterations = atoi(optarg);
+            break;
+        case 'w':
+            timeout = atof(optarg);
+            break;
+        default:
+            usage();
+            return 1;
+        }
+    }
+
+    if(nchannels<=0 || iterations<=0 || timeout<=0.0) {
+        usage();
+        return 1;
+    }
+
+    try {
+        std::tr1::shared_ptr<pvas::StaticProvider> prov(new pvas::StaticProvider("multiget"));
+        pvas::SharedPV::shared_pointer pv(pvas::SharedPV::buildReadOnly());
+        pv->open(type);
+
+        std::vector<std::string> names(nchannels);
+        for(int i=0; i<nchannels; i++) {
+            char buf[32];
+            sprintf(buf, "multiget:%d", i);
+            names[i] = buf;
+            // one SharedPV may be added under many names
+            prov->add(names[i], pv);
+        }
+
+        pva::ServerContext::shared_pointer server(pva::ServerContext::create(pva::ServerContext::Config()
+                                                  .config(pva::ConfigurationBuilder()
+                                                          .add("EPICS_PVAS_INTF_ADDR_LIST", "127.0.0.1")
+                                                          .add("EPICS_PVA_ADDR_LIST", "127.0.0.1")
+                                                          .add("EPICS_PVA_AUTO_ADDR_LIST","0")
+                                                          .add("EPICS_PVA_SERVER_PORT", "0")
+                                                          .add("EPICS_PVA_BROADCAST_PORT", "0")
+                                                          .push_map()
+                                                          .build())
+                                                  .provider(prov->provider())));
+
+        pvac::ClientProvider client("pva", server->getCurrentConfig());
+        std::vector<pvac::ClientChannel> channels(client.connect(names));
+
+        // connect, and warm up the introspection caches
+        size_t connected = single(channels, timeout);
+        if(connected!=channels.size()) {
+            std::cerr<<"Error: only "<<connected<<" of "<<channels.size()<<" channels connected\n";
+            return 1;
+        }
+        multi(client, channels, timeout);
+
+        measure("single", client, channels, false, iterations, timeout);
+        measure("multi", client, channels, true, iterations, timeout);
+
+    } catch(std::exception& e) {
+        std::cerr<<"Error: "<<e.what()<<"\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,297 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+/* Measure the latency of scalar monitor updates while a large array
+ * is streamed to the same client over the same connection.
+ * The scalar value is the time at which it was posted, so latency is
+ * measured from SharedPV::post() on the server to the client callback.
+ * Compare with -a 0 (no array stream) for a baseline.
+ */
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <epicsGetopt.h>
+#include <epicsThread.h>
+#include <epicsTime.h>
+#include <epicsGuard.h>
+
+#include <pv/configuration.h>
+#include <pv/serverContext.h>
+#include <pva/client.h>
+#include <pva/server.h>
+#include <pva/sharedstate.h>
+
+namespace pvd = epics::pvData;
+namespace pva = epics::pvAccess;
+
+typedef epicsGuard<epicsMutex> Guard;
+
+namespace {
+
+#define DEFAULT_ARRAY_SIZE (4*1024*1024)
+#define DEFAULT_SAMPLES 1000
+#define DEFAULT_PERIOD 5
+
+const pvd::StructureConstPtr scalarType(pvd::getFieldCreate()->createFieldBuilder()
+                                        ->add("value", pvd::pvDouble)
+                                        ->createStructure());
+
+const pvd::StructureConstPtr arrayType(pvd::getFieldCreate()->createFieldBuilder()
+                                       ->addArray("value", pvd::pvDouble)
+                                       ->createStructure());
+
+epicsTimeStamp origin;
+
+double now()
+{
+    epicsTimeStamp ts;
+    epicsTimeGetCurrent(&ts);
+    return epicsTimeDiffInSeconds(&ts, &origin);
+}
+
+void usage (void)
+{
+    fprintf (stderr, "\nUsage: testSendPriorityLatency [options]\n\n"
+             "  -h: Help: Print this message\n"
+             "options:\n"
+             "  -a <elements>:     array size in doubles, 0 for no array stream, default is '%d'\n"
+             "  -n <samples>:      number of scalar updates, default is '%d'\n"
+             "  -p <ms>:           period of scalar updates, default is '%d'\n\n"
+             , DEFAULT_ARRAY_SIZE, DEFAULT_SAMPLES, DEFAULT_PERIOD);
+}
+
+// drain a subscription on a dedicated thread
+struct Consumer : public epicsThreadRunable
+{
+    pvac::MonitorSync mon;
+    volatile bool running;
+    epicsThread worker;
+
+    Consumer(const pvac::MonitorSync& mon)
+        :mon(mon)
+        ,running(true)
+        ,worker(*this, "consumer", epicsThreadGetStackSize(epicsThreadStackSmall))
+    {}
+    virtual ~Consumer() {}
+
+    void stop()
+    {
+        running = false;
+        mon.wake();
+        worker.exitWait();
+        mon.cancel();
+    }
+
+    virtual void update() =0;
+
+    virtual void run() OVERRIDE FINAL
+    {
+        while(running) {
+            if(!mon.wait() || mon.event.event!=pvac::MonitorEvent::Data)
+                continue;
+            while(mon.poll())
+                update();
+        }
+    }
+};
+
+struct ScalarConsumer : public Consumer
+{
+    epicsMutex mutex;
+    std::vector<double> latency;
+
+    ScalarConsumer(const pvac::MonitorSync& mon) :Consumer(mon) {}
+    virtual ~ScalarConsumer() {}
+
+    virtual void update() OVERRIDE FINAL
+    {
+        double sent = mon.root->getSubFieldT<pvd::PVDouble>("value")->get();
+        if(sent<=0.0)
+            return; // initial value
+        double lat = now() - sent;
+        Guard G(mutex);
+        latency.push_back(lat);
+    }
+};
+
+struct ArrayConsumer : public Consumer
+{
+    size_t nupdates;
+    size_t nbytes;
+
+    ArrayConsumer(const pvac::MonitorSync& mon) :Consumer(mon), nupdates(0u), nbytes(0u) {}
+    virtual ~ArrayConsumer() {}
+
+    virtual void update() OVERRIDE FINAL
+    {
+        nupdates++;
+        nbytes += mon.root->getSubFieldT<pvd::PVDoubleArray>("value")->getLength()*sizeof(double);
+    }
+};
+
+struct ArrayPoster : public epicsThreadRunable
+{
+    pvas::SharedPV::shared_pointer pv;
+    pvd::PVStructurePtr inst;
+    pvd::BitSet changed;
+    volatile bool running;
+    epicsThread worker;
+
+    ArrayPoster(const pvas::SharedPV::shared_pointer& pv, size_t nelem)
+        :pv(pv)
+        ,inst(pv->build())
+        ,running(true)
+        ,worker(*this, "arraypost", epicsThreadGetStackSize(epicsThreadStackSmall))
+    {
+        pvd::PVDoubleArrayPtr value(inst->getSubFieldT<pvd::PVDoubleArray>("value"));
+        pvd::shared_vector<double> arr(nelem, 1.0);
+        value->replace(pvd::freeze(arr));
+        changed.set(value->getFieldOffset());
+        worker.start();
+    }
+    virtual ~ArrayPoster()
+    {
+        running = false;
+        worker.exitWait();
+    }
+    virtual void run() OVERRIDE FINAL
+    {
+        // keep the server queue full.  Array data is shared, not copied
+        while(running) {
+            pv->post(*inst, changed);
+            epicsThreadSleep(0.001);
+        }
+    }
+};
+
+double percentile(const std::vector<double>& sorted, double pct)
+{
+    if(sorted.empty())
+        return 0.0;
+    size_t idx = size_t(pct/100.0*(sorted.size()-1u));
+    return sorted[idx];
+}
+
+} // namespace
+
+int main (int argc, char *argv[])
+{
+    int arraySize = DEFAULT_ARRAY_SIZE;
+    int nsamples = DEFAULT_SAMPLES;
+    int period = DEFAULT_PERIOD;
+
+    int opt;
+    while ((opt = getopt(argc, argv, ":ha:n:p:")) != -1) {
+        switch (opt) {
+        case 'h':
+            usage();
+            return 0;
+        case 'a':
+            arraySize = atoi(optarg);
+            break;
+        case 'n':
+            nsamples = atoi(optarg);
+            break;
+        case 'p':
+            period = atoi(optarg);
+            break;
+        default:
+            usage();
+            return 1;
+        }
+    }
+
+    if(arraySize<0 || nsamples<=0 || period<0) {
+        usage();
+        return 1;
+    }
+
+    try {
+        epicsTimeGetCurrent(&origin);
+
+        std::tr1::shared_ptr<pvas::StaticProvider> prov(new pvas::StaticProvider("latency"));
+
+        pvas::SharedPV::shared_pointer scalar(pvas::SharedPV::buildReadOnly());
+        scalar->open(scalarType);
+        prov->add("latency:scalar", scalar);
+
+        pvas::SharedPV::shared_pointer array(pvas::SharedPV::buildReadOnly());
+        array->open(arrayType);
+        prov->add("latency:array", array);
+
+        pva::ServerContext::shared_pointer server(pva::ServerContext::create(pva::ServerContext::Config()
+                                                  .config(pva::ConfigurationBuilder()
+                                                          .add("EPICS_PVAS_INTF_ADDR_LIST", "127.0.0.1")
+                                                          .add("EPICS_PVA_ADDR_LIST", "127.0.0.1")
+                                                          .add("EPICS_PVA_AUTO_ADDR_LIST","0")
+                                                          .add("EPICS_PVA_SERVER_PORT", "0")
+                                                          .add("EPICS_PVA_BROADCAST_PORT", "0")
+                                                          .push_map()
+                                                          .build())
+                                                  .provider(prov->provider())));
+
+        // both channels share one connection
+        pvac::ClientProvider cli("pva", server->getCurrentConfig());
+
+        ScalarConsumer scalarMon(cli.connect("latency:scalar").monitor());
+        scalarMon.worker.start();
+
+        std::tr1::shared_ptr<ArrayConsumer> arrayMon;
+        std::tr1::shared_ptr<ArrayPoster> poster;
+        if(arraySize>0) {
+            arrayMon.reset(new ArrayConsumer(cli.connect("latency:array").monitor()));
+            arrayMon->worker.start();
+            poster.reset(new ArrayPoster(array, arraySize));
+        }
+
+        // let the array stream start
+        epicsThreadSleep(1.0);
+
+        pvd::PVStructurePtr inst(scalar->build());
+        pvd::PVDoublePtr value(inst->getSubFieldT<pvd::PVDouble>("value"));
+        pvd::BitSet changed;
+        changed.set(value->getFieldOffset());
+
+        const double start = now();
+        for(int i=0; i<nsamples; i++) {
+            value->put(now());
+            scalar->post(*inst, changed);
+            epicsThreadSleep(period*1e-3);
+        }
+        // wait for stragglers
+        epicsThreadSleep(1.0);
+        const double elapsed = now() - start;
+
+        poster.reset();
+        if(arrayMon)
+            arrayMon->stop();
+        scalarMon.stop();
+
+        std::vector<double> lat;
+        {
+            Guard G(scalarMon.mutex);
+            lat = scalarMon.latency;
+        }
+        std::sort(lat.begin(), lat.end());
+
+        if(arrayMon)
+            printf("array %d elements, %u updates %.1f MB/s\n",
+                   arraySize, unsigned(arrayMon->nupdates), arrayMon->nbytes/elapsed/1e6);
+        printf("scalar %u of %d received, latency (ms) p50 %.3f p90 %.3f p99 %.3f max %.3f\n",
+               unsigned(lat.size()), nsamples,
+               1e3*percentile(lat, 50.0), 1e3*percentile(lat, 90.0),
+               1e3*percentile(lat, 99.0), lat.empty() ? 0.0 : 1e3*lat.back());
+
+    } catch(std::exception& e) {
+        std::cerr<<"Error: "<<e.what()<<"\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+/* Measure the cost of SharedPV::post() as the number of subscribers grows.
+ * Subscribers are local (no network), and never poll(), so after the first
+ * few updates each post() squashes into the last queued element.
+ * Half of the subscribers select one field, half select all fields,
+ * so each post() maps the update twice.
+ * With -f, subscribers are updated in shards by the SharedPV fanout workers,
+ * and a histogram of post-to-notify time is printed.
+ */
+
+#include <iostream>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <epicsGetopt.h>
+#include <epicsTime.h>
+#include <dbDefs.h>
+
+#include <pv/createRequest.h>
+#include <pva/server.h>
+#include <pva/sharedstate.h>
+
+namespace pvd = epics::pvData;
+namespace pva = epics::pvAccess;
+
+namespace {
+
+#define DEFAULT_SUBSCRIBERS 10000
+#define DEFAULT_UPDATES 1000
+
+const pvd::StructureConstPtr type(pvd::getFieldCreate()->createFieldBuilder()
+                                  ->add("value", pvd::pvDouble)
+                                  ->addNestedStructure("alarm")
+                                      ->add("severity", pvd::pvInt)
+                                      ->add("status", pvd::pvInt)
+                                      ->add("message", pvd::pvString)
+                                  ->endNested()
+                                  ->addNestedStructure("timeStamp")
+                                      ->add("secondsPastEpoch", pvd::pvLong)
+                                      ->add("nanoseconds", pvd::pvInt)
+                                      ->add("userTag", pvd::pvInt)
+                                  ->endNested()
+                                  ->createStructure());
+
+void usage (void)
+{
+    fprintf (stderr, "\nUsage: testSharedPVPostPerformance [options]\n\n"
+             "  -h: Help: Print this message\n"
+             "options:\n"
+             "  -s <subscribers>:  maximum number of subscribers, default is '%d'\n"
+             "  -u <updates>:      number of post() per measurement, default is '%d'\n"
+             "  -f <shardsize>:    parallel fanout with this many subscribers per shard, default is serial\n\n"
+             , DEFAULT_SUBSCRIBERS, DEFAULT_UPDATES);
+}
+
+struct Subscriber : public pva::MonitorRequester
+{
+    virtual ~Subscriber() {}
+    virtual std::string getRequesterName() OVERRIDE FINAL { return "Subscriber"; }
+    virtual void monitorConnect(pvd::Status const & status,
+                                pva::MonitorPtr const & monitor,
+                                pvd::StructureConstPtr const & structure) OVERRIDE FINAL
+    {
+        if(status.isSuccess())
+            monitor->start();
+    }
+    virtual void monitorEvent(pva::MonitorPtr const & monitor) OVERRIDE FINAL {}
+    virtual void unlisten(pva::MonitorPtr const & monitor) OVERRIDE FINAL {}
+};
+
+void measure(size_t nsubscribers, int nupdates, size_t shardSize)
+{
+    pvas::SharedPV::Config conf;
+    conf.fanoutShardSize = shardSize;
+
+    std::tr1::shared_ptr<pvas::StaticProvider> prov(new pvas::StaticProvider("postperf"));
+    pvas::SharedPV::shared_pointer pv(pvas::SharedPV::buildReadOnly(&conf));
+    pv->open(type);
+    prov->add("postperf", pv);
+
+    pva::Channel::shared_pointer chan(prov->provider()->createChannel("postperf"));
+
+    std::tr1::shared_ptr<Subscriber> sub(new Subscriber);
+    pvd::PVStructurePtr reqs[2] = {
+        pvd::createRequest("field(value)"),
+        pvd::createRequest("field()"),
+    };
+
+    std::vector<pva::MonitorPtr> mons(nsubscribers);
+    for(size_t i=0; i<nsubscribers; i++)
+        mons[i] = chan->createMonitor(sub, reqs[i%2u]);
+
+    pvd::PVStructurePtr inst(pv->build());
+    pvd::PVScalarPtr value(inst->getSubFieldT<pvd::PVScalar>("value"));
+    pvd::BitSet changed;
+    changed.set(value->getFieldOffset());
+
+    epicsTimeStamp start, end;
+    epicsTimeGetCurrent(&start);
+
+    for(int n=0; n<nupdates; n++) {
+        value->putFrom<pvd::int32>(n);
+        pv->post(*inst, changed);
+    }
+
+    epicsTimeGetCurrent(&end);
+    double elapsed = epicsTimeDiffInSeconds(&end, &start);
+
+    printf("%8u subscribers, %6d updates, %10.3f us per post(), %8.3f us per subscriber\n",
+           unsigned(nsubscribers), nupdates, 1e6*elapsed/nupdates,
+           1e6*elapsed/nupdates/nsubscribers);
+
+    if(shardSize) {
+        pvas::SharedPV::FanoutStats stats;
+        pv->fanoutStats(stats);
+        printf("         %u of %u parallel, up to %u shards.  post-to-notify (us):",
+               unsigned(stats.nparallel), unsigned(stats.nposts), unsigned(stats.maxShards));
+        for(size_t i=0; i<NELEMENTS(stats.postToNotify); i++) {
+            if(stats.postToNotify[i])
+                printf(" <%u:%u", 1u<<i, unsigned(stats.postToNotify[i]));
+        }
+        printf("\n");
+    }
+
+    for(size_t i=0; i<nsubscribers; i++)
+        mons[i]->destroy();
+    chan->destroy();
+    pv->close(true);
+}
+
+} // namespace
+
+int main (int argc, char *argv[])
+{
+    int nsubscribers = DEFAULT_SUBSCRIBERS;
+    int nupdates = DEFAULT_UPDATES;
+    int shardSize = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, ":hs:u:f:")) != -1) {
+        switch (opt) {
+        case 'h':
+            usage();
+            return 0;
+        case 's':
+            nsubscribers = atoi(optarg);
+            break;
+        case 'u':
+            nupdates = atoi(optarg);
+            break;
+        case 'f':
+            shardSize = atoi(optarg);
+            break;
+        default:
+            usage();
+            return 1;
+        }
+    }
+
+    if(nsubscribers<=0 || nupdates<=0 || shardSize<0) {
+        usage();
+        return 1;
+    }
+
+    try {
+        for(size_t n=1u; n<=size_t(nsubscribers); n*=10u)
+            measure(n, nupdates, shardSize);
+    } catch(std::exception& e) {
+        std::cerr<<"Error: "<<e.what()<<"\n";
+        return 1;
+    }
+    return 0;
+}
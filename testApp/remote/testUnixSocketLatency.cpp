@@ -0,0 +1,149 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+/* Compare get round trip latency of a local server reached through
+ * 127.0.0.1 with the same server reached through an AF_UNIX socket
+ * (EPICS_PVAS_UNIX_SOCKET and "unix:" client address).
+ */
+
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <string>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <epicsGetopt.h>
+#include <epicsTime.h>
+
+#include <pv/configuration.h>
+#include <pv/serverContext.h>
+#include <pva/server.h>
+#include <pva/sharedstate.h>
+#include <pva/client.h>
+
+namespace pvd = epics::pvData;
+namespace pva = epics::pvAccess;
+
+namespace {
+
+#define DEFAULT_ITERATIONS 10000
+#define DEFAULT_SOCKET "/tmp/pva-latency.sock"
+
+const pvd::StructureConstPtr type(pvd::getFieldCreate()->createFieldBuilder()
+                                  ->add("value", pvd::pvInt)
+                                  ->createStructure());
+
+void usage (void)
+{
+    fprintf (stderr, "\nUsage: testUnixSocketLatency [options]\n\n"
+             "  -h: Help: Print this message\n"
+             "options:\n"
+             "  -i <iterations>:   number of get operations per transport, default is '%d'\n"
+             "  -u <path>:         AF_UNIX socket path, default is '%s'\n\n"
+             , DEFAULT_ITERATIONS, DEFAULT_SOCKET);
+}
+
+void measure(const char *label, pvac::ClientChannel& chan, int iterations)
+{
+    // connect and warm up
+    for(int i=0; i<100; i++)
+        chan.get(5.0);
+
+    std::vector<double> samples(iterations);
+    epicsTimeStamp start, end;
+    epicsTimeGetCurrent(&start);
+
+    for(int i=0; i<iterations; i++) {
+        epicsTimeStamp t0, t1;
+        epicsTimeGetCurrent(&t0);
+        chan.get(5.0);
+        epicsTimeGetCurrent(&t1);
+        samples[i] = epicsTimeDiffInSeconds(&t1, &t0)*1e6;
+    }
+
+    epicsTimeGetCurrent(&end);
+    double total = epicsTimeDiffInSeconds(&end, &start);
+
+    std::sort(samples.begin(), samples.end());
+
+    printf("%-10s %8d gets, %10.1f gets/s, latency [us] min %7.1f median %7.1f p99 %7.1f max %7.1f\n",
+           label, iterations, iterations/total,
+           samples[0], samples[iterations/2], samples[(iterations*99)/100], samples[iterations-1]);
+}
+
+} // namespace
+
+int main (int argc, char *argv[])
+{
+    int iterations = DEFAULT_ITERATIONS;
+    std::string path(DEFAULT_SOCKET);
+
+    int opt;
+    while ((opt = getopt(argc, argv, ":hi:u:")) != -1) {
+        switch (opt) {
+        case 'h':
+            usage();
+            return 0;
+        case 'i':
+            iterations = atoi(optarg);
+            break;
+        case 'u':
+            path = optarg;
+            break;
+        default:
+            usage();
+            return 1;
+        }
+    }
+
+    if(iterations<=0) {
+        usage();
+        return 1;
+    }
+
+    try {
+        std::tr1::shared_ptr<pvas::StaticProvider> prov(new pvas::StaticProvider("latency"));
+        pvas::SharedPV::shared_pointer pv(pvas::SharedPV::buildReadOnly());
+        prov->add("latency", pv);
+        pv->open(type);
+
+        pva::ServerContext::shared_pointer server(pva::ServerContext::create(pva::ServerContext::Config()
+                                                  .config(pva::ConfigurationBuilder()
+                                                          .add("EPICS_PVAS_INTF_ADDR_LIST", "127.0.0.1")
+                                                          .add("EPICS_PVA_ADDR_LIST", "127.0.0.1")
+                                                          .add("EPICS_PVA_AUTO_ADDR_LIST","0")
+                                                          .add("EPICS_PVA_SERVER_PORT", "0")
+                                                          .add("EPICS_PVA_BROADCAST_PORT", "0")
+                                                          .add("EPICS_PVAS_UNIX_SOCKET", path)
+                                                          .push_map()
+                                                          .build())
+                                                  .provider(prov->provider())));
+
+        pvac::ClientProvider client("pva", server->getCurrentConfig());
+
+        pvac::ClientChannel::Options tcp;
+        {
+            char buf[32];
+            sprintf(buf, "127.0.0.1:%u", unsigned(server->getServerPort()));
+            tcp.address = buf;
+        }
+
+        pvac::ClientChannel::Options unx;
+        unx.address = "unix:" + path;
+
+        pvac::ClientChannel tcpChan(client.connect("latency", tcp));
+        pvac::ClientChannel unixChan(client.connect("latency", unx));
+
+        measure("tcp", tcpChan, iterations);
+        measure("unix", unixChan, iterations);
+
+    } catch(std::exception& e) {
+        std::cerr<<"Error: "<<e.what()<<"\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,341 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+/* Many clients connecting to a server at once, as after an IOC reboot.
+ * Clients are raw sockets, one thread each, which complete the connection
+ * validation handshake by hand, so that the server side is the only cost.
+ * All clients connect before any answers the validation request, so more
+ * are waiting than the server will validate at once.
+ */
+
+#include <vector>
+#include <algorithm>
+#include <sstream>
+
+#include <string.h>
+
+#include <osiSock.h>
+#include <epicsThread.h>
+#include <epicsEvent.h>
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+#include <epicsEndian.h>
+#include <epicsTime.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#  include <sys/resource.h>
+#  define HAVE_RLIMIT
+#endif
+
+#include <pv/pvUnitTest.h>
+#include <testMain.h>
+
+#include <pv/configuration.h>
+#include <pv/serverContext.h>
+#include <pv/pvaConstants.h>
+#include <pv/remote.h>
+#include <pva/server.h>
+#include <pv/current_function.h>
+
+#include <pv/codec.h>
+#include <pv/blockingTCP.h>
+#include <pv/serverContextImpl.h>
+
+namespace pvd = epics::pvData;
+namespace pva = epics::pvAccess;
+
+namespace {
+
+const size_t nconnections = 1000u;
+const size_t maxHandshakes = 32u;
+
+const pvd::int8 hostOrderFlag = EPICS_BYTE_ORDER==EPICS_ENDIAN_BIG ? 0x80 : 0x00;
+
+bool recvAll(SOCKET sock, char *buf, size_t len)
+{
+    while(len) {
+        int ret = ::recv(sock, buf, len, 0);
+        if(ret<=0)
+            return false;
+        buf += ret;
+        len -= ret;
+    }
+    return true;
+}
+
+// read the next application message, skipping control messages
+bool recvMessage(SOCKET sock, pvd::int8& command, std::vector<char>& payload)
+{
+    while(true) {
+        char header[pva::PVA_MESSAGE_HEADER_SIZE];
+        if(!recvAll(sock, header, sizeof(header)) || pvd::int8(header[0])!=pva::PVA_MAGIC)
+            return false;
+
+        command = header[3];
+        if(header[2]&0x01)
+            continue; // control message, no payload
+
+        // loopback, so the server byte order is ours
+        pvd::int32 size;
+        memcpy(&size, &header[4], 4);
+        payload.resize(size);
+        if(size && !recvAll(sock, &payload[0], size))
+            return false;
+        return true;
+    }
+}
+
+bool sendValidation(SOCKET sock)
+{
+    const char plugin[] = "anonymous";
+    std::vector<char> msg(pva::PVA_MESSAGE_HEADER_SIZE);
+
+    msg[0] = pva::PVA_MAGIC;
+    msg[1] = pva::PVA_VERSION;
+    msg[2] = hostOrderFlag; // application message from client
+    msg[3] = pva::CMD_CONNECTION_VALIDATION;
+
+    pvd::int32 rcvSize = pva::MAX_TCP_RECV;
+    pvd::int16 registrySize = 0x7FFF, qos = 0;
+    msg.insert(msg.end(), (char*)&rcvSize, (char*)&rcvSize + 4);
+    msg.insert(msg.end(), (char*)&registrySize, (char*)&registrySize + 2);
+    msg.insert(msg.end(), (char*)&qos, (char*)&qos + 2);
+    msg.push_back(char(sizeof(plugin)-1));
+    msg.insert(msg.end(), plugin, plugin + sizeof(plugin)-1);
+    msg.push_back(char(0xFF)); // NULL plugin data
+
+    pvd::int32 size = msg.size() - pva::PVA_MESSAGE_HEADER_SIZE;
+    memcpy(&msg[4], &size, 4);
+
+    return ::send(sock, &msg[0], msg.size(), 0)==int(msg.size());
+}
+
+// Released once, wakes all current and future waiters
+struct Gate {
+    epicsMutex lock;
+    epicsEvent evt;
+    bool open;
+
+    Gate() :open(false) {}
+
+    void wait()
+    {
+        while(true) {
+            {
+                epicsGuard<epicsMutex> G(lock);
+                if(open)
+                    break;
+            }
+            evt.wait();
+        }
+        evt.signal(); // wake the next waiter
+    }
+
+    void release()
+    {
+        {
+            epicsGuard<epicsMutex> G(lock);
+            open = true;
+        }
+        evt.signal();
+    }
+};
+
+// One thread per client connection, all connecting at once
+struct Storm {
+    osiSockAddr server;
+    size_t nclients;
+
+    Gate start,  // connect
+         answer, // reply to validation requests
+         finish; // close connections
+
+    epicsMutex lock;
+    size_t nconnected, nvalidated, nexited;
+    epicsEvent allConnected, allExited;
+
+    Storm() :nclients(0u), nconnected(0u), nvalidated(0u), nexited(0u) {}
+
+    void count(size_t& counter, epicsEvent& evt)
+    {
+        bool last;
+        {
+            epicsGuard<epicsMutex> G(lock);
+            last = ++counter==nclients;
+        }
+        if(last)
+            evt.signal();
+    }
+
+    static void run(void *raw)
+    {
+        Storm *self = static_cast<Storm*>(raw);
+        self->client();
+        self->count(self->nexited, self->allExited);
+    }
+
+    void client()
+    {
+        start.wait();
+
+        SOCKET sock = epicsSocketCreate(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        bool ok = sock!=INVALID_SOCKET && ::connect(sock, &server.sa, sizeof(server.ia))==0;
+
+        // completes while queued in the listen backlog
+        count(nconnected, allConnected);
+        answer.wait();
+
+        pvd::int8 cmd = 0;
+        std::vector<char> payload;
+
+        ok = ok && recvMessage(sock, cmd, payload) && cmd==pva::CMD_CONNECTION_VALIDATION
+                && sendValidation(sock)
+                // validated status, OK is serialized as 0xFF
+                && recvMessage(sock, cmd, payload) && cmd==pva::CMD_CONNECTION_VALIDATED
+                && !payload.empty() && payload[0]==char(0xFF);
+
+        if(ok) {
+            epicsGuard<epicsMutex> G(lock);
+            nvalidated++;
+        }
+
+        // connections are kept open until all are done
+        finish.wait();
+        if(sock!=INVALID_SOCKET)
+            epicsSocketDestroy(sock);
+    }
+};
+
+pva::detail::HandshakeLimit::Stats handshakeStats(const pva::ServerContext::shared_pointer& server)
+{
+    pva::ServerContextImpl::shared_pointer impl(std::tr1::dynamic_pointer_cast<pva::ServerContextImpl>(server));
+    pva::detail::HandshakeLimit::Stats ret;
+    impl->getAcceptor()->getHandshakeLimit()->stats(ret);
+    return ret;
+}
+
+size_t maxConnections()
+{
+    size_t nconn = nconnections;
+#ifdef HAVE_RLIMIT
+    // both ends of each connection are in this process
+    rlimit lim;
+    if(getrlimit(RLIMIT_NOFILE, &lim)==0) {
+        if(lim.rlim_cur!=RLIM_INFINITY && lim.rlim_cur < 2u*nconn+64u) {
+            lim.rlim_cur = lim.rlim_max==RLIM_INFINITY ? 2u*nconn+64u : std::min(lim.rlim_max, rlim_t(2u*nconn+64u));
+            (void)setrlimit(RLIMIT_NOFILE, &lim);
+            (void)getrlimit(RLIMIT_NOFILE, &lim);
+        }
+        if(lim.rlim_cur!=RLIM_INFINITY && lim.rlim_cur < 2u*nconn+64u)
+            nconn = lim.rlim_cur > 128u ? (lim.rlim_cur-64u)/2u : 32u;
+    }
+#endif
+    return nconn;
+}
+
+// limit==1 validates one connection at a time, as before handshake slots
+void testStorm(size_t nconn, size_t limit)
+{
+    testDiag("==== %s %u connections, %u handshakes at once ====", CURRENT_FUNCTION,
+             unsigned(nconn), unsigned(limit));
+
+    std::tr1::shared_ptr<pvas::StaticProvider> prov(new pvas::StaticProvider("test"));
+
+    std::ostringstream limitStr;
+    limitStr<<limit;
+
+    pva::ServerContext::shared_pointer server(pva::ServerContext::create(pva::ServerContext::Config()
+                                              .config(pva::ConfigurationBuilder()
+                                                      .add("EPICS_PVAS_INTF_ADDR_LIST", "127.0.0.1")
+                                                      .add("EPICS_PVA_ADDR_LIST", "127.0.0.1")
+                                                      .add("EPICS_PVA_AUTO_ADDR_LIST","0")
+                                                      .add("EPICS_PVA_SERVER_PORT", "0")
+                                                      .add("EPICS_PVA_BROADCAST_PORT", "0")
+                                                      .add("EPICS_PVAS_MAX_HANDSHAKES", limitStr.str())
+                                                      .push_map()
+                                                      .build())
+                                              .provider(prov->provider())));
+
+    Storm storm;
+    memset(&storm.server, 0, sizeof(storm.server));
+    storm.server.ia.sin_family = AF_INET;
+    storm.server.ia.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    storm.server.ia.sin_port = htons(server->getServerPort());
+    storm.nclients = nconn;
+
+    for(size_t i=0; i<nconn; i++) {
+        epicsThreadMustCreate("storm",
+                              epicsThreadPriorityMedium,
+                              epicsThreadGetStackSize(epicsThreadStackSmall),
+                              &Storm::run, &storm);
+    }
+
+    const epicsTime started(epicsTime::getCurrent());
+    storm.start.release();
+
+    // Every client connects before any answers, so the server has taken
+    // all handshake slots, with the remaining clients left in the backlog.
+    // Don't wait forever should the backlog be shorter than nconn.
+    if(!storm.allConnected.wait(2.0))
+        testDiag("Not all clients connected before answering");
+
+    storm.answer.release();
+
+    // all validated clients have been released by the server, wait for the last
+    pva::detail::HandshakeLimit::Stats stats;
+    double elapsed = -1.0;
+    {
+        bool done = false;
+        for(unsigned i=0; !done && i<300u; i++) {
+            {
+                epicsGuard<epicsMutex> G(storm.lock);
+                done = storm.nvalidated==nconn;
+            }
+            if(done && elapsed<0.0)
+                elapsed = epicsTime::getCurrent() - started;
+            stats = handshakeStats(server);
+            done = done && stats.pending==0u;
+            if(!done)
+                epicsThreadSleep(0.1);
+        }
+    }
+
+    storm.finish.release();
+    storm.allExited.wait();
+
+    testDiag("%u connections validated, %u accepted, at most %u at once, %u waited for a slot",
+             unsigned(storm.nvalidated), unsigned(stats.nacquired),
+             unsigned(stats.maxPending), unsigned(stats.nwaited));
+    if(elapsed>=0.0)
+        testDiag("All validated %.3f sec. after the first connect, limit %u", elapsed, unsigned(limit));
+    else
+        testDiag("Not all validated, limit %u", unsigned(limit));
+    testEqual(storm.nvalidated, nconn);
+    testEqual(stats.maxPending, limit);
+    testOk(stats.nwaited>0u, "acceptor waited for a handshake slot %u times", unsigned(stats.nwaited));
+    testEqual(stats.nacquired, nconn);
+    // every slot returned
+    testEqual(stats.pending, 0u);
+}
+
+} // namespace
+
+MAIN(testacceptstorm)
+{
+    testPlan(10);
+    osiSockAttach();
+    try {
+        const size_t nconn = maxConnections();
+        if(nconn!=nconnections)
+            testDiag("File descriptor limit allows only %u connections", unsigned(nconn));
+        // compare with validation one at a time
+        testStorm(nconn, 1u);
+        testStorm(nconn, std::min(maxHandshakes, nconn/2u));
+    }catch(std::exception& e){
+        testAbort("Unexpected exception: %s", e.what());
+    }
+    osiSockRelease();
+    return testDone();
+}
@@ -0,0 +1,170 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <sstream>
+#include <algorithm>
+
+#include <epicsThread.h>
+
+#include <pv/pvUnitTest.h>
+#include <testMain.h>
+
+#include <pv/configuration.h>
+#include <pv/serverContext.h>
+#include <pv/createRequest.h>
+#include <pva/client.h>
+#include <pva/server.h>
+#include <pva/sharedstate.h>
+#include <pv/current_function.h>
+
+#include <pv/codec.h>
+#include <pv/responseHandlers.h>
+#include <pv/serverContextImpl.h>
+
+namespace pvd = epics::pvData;
+namespace pva = epics::pvAccess;
+
+namespace {
+
+const pvd::StructureConstPtr type(pvd::getFieldCreate()->createFieldBuilder()
+                                  ->add("value", pvd::pvInt)
+                                  ->createStructure());
+
+const pvd::uint32 nupdates = 200u;
+
+// flow control state of the (only) monitor subscription on the server
+bool flowStats(const pva::ServerContext::shared_pointer& server, pva::ServerMonitorRequesterImpl::FlowStats& stats)
+{
+    pva::ServerContextImpl::shared_pointer impl(std::tr1::dynamic_pointer_cast<pva::ServerContextImpl>(server));
+    pva::TransportRegistry::transportVector_t transports;
+    impl->getTransportRegistry()->toArray(transports);
+
+    for(size_t i=0; i<transports.size(); i++) {
+        pva::detail::BlockingServerTCPTransportCodec *codec =
+                dynamic_cast<pva::detail::BlockingServerTCPTransportCodec*>(transports[i].get());
+        if(!codec)
+            continue;
+
+        std::vector<pva::ServerChannel::shared_pointer> channels;
+        codec->getChannels(channels);
+        for(size_t c=0; c<channels.size(); c++) {
+            pva::ServerChannel::requests_t requests;
+            channels[c]->getRequests(requests);
+            for(size_t r=0; r<requests.size(); r++) {
+                pva::ServerMonitorRequesterImpl *mon = dynamic_cast<pva::ServerMonitorRequesterImpl*>(requests[r].second.get());
+                if(mon) {
+                    mon->getFlowStats(stats);
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+// a consumer much slower than the producer
+void testSlowConsumer()
+{
+    testDiag("==== %s ====", CURRENT_FUNCTION);
+
+    pvas::SharedPV::shared_pointer pv(pvas::SharedPV::buildReadOnly());
+    pvd::PVStructurePtr inst(pvd::getPVDataCreate()->createPVStructure(type));
+    pvd::BitSet changed;
+    pvd::PVScalarPtr value(inst->getSubFieldT<pvd::PVScalar>("value"));
+    changed.set(value->getFieldOffset());
+    pv->open(*inst, changed);
+
+    std::tr1::shared_ptr<pvas::StaticProvider> prov(new pvas::StaticProvider("test"));
+    prov->add("pv:fast", pv);
+
+    pva::ServerContext::shared_pointer server(pva::ServerContext::create(pva::ServerContext::Config()
+                                              .config(pva::ConfigurationBuilder()
+                                                      .add("EPICS_PVAS_INTF_ADDR_LIST", "127.0.0.1")
+                                                      .add("EPICS_PVA_ADDR_LIST", "127.0.0.1")
+                                                      .add("EPICS_PVA_AUTO_ADDR_LIST","0")
+                                                      .add("EPICS_PVA_SERVER_PORT", "0")
+                                                      .add("EPICS_PVA_BROADCAST_PORT", "0")
+                                                      .push_map()
+                                                      .build())
+                                              .provider(prov->provider())));
+
+    pvac::ClientProvider cli("pva", server->getCurrentConfig());
+    pvac::ClientChannel chan(cli.connect("pv:fast"));
+
+    pvac::MonitorSync mon(chan.monitor(pvd::createRequest("record[pipeline=true,adaptive=true,queueSize=8]field()")));
+
+    testOk(mon.wait(5.0), "connected");
+    testEqual(mon.event.event, pvac::MonitorEvent::Data);
+
+    size_t nreceived = 0u;
+    bool ordered = true;
+    pvd::uint32 last = 0u;
+    bool posted = false;
+    // adaptive limit while the consumer is behind
+    size_t maxLimit = 0u;
+
+    while(last!=nupdates) {
+        while(mon.poll()) {
+            pvd::uint32 val = mon.root->getSubFieldT<pvd::PVScalar>("value")->getAs<pvd::uint32>();
+            ordered &= nreceived==0u || val>last;
+            last = val;
+            nreceived++;
+
+            if(!posted) {
+                // burst of updates after the initial value has arrived
+                for(pvd::uint32 i=1u; i<=nupdates; i++) {
+                    value->putFrom(i);
+                    pv->post(*inst, changed);
+                }
+                posted = true;
+            }
+
+            pva::ServerMonitorRequesterImpl::FlowStats stats;
+            if(flowStats(server, stats))
+                maxLimit = std::max(maxLimit, stats.limit);
+
+            epicsThreadSleep(0.005);
+        }
+        if(last!=nupdates && !mon.wait(5.0))
+            break;
+    }
+
+    testEqual(last, nupdates);
+    testOk(ordered, "updates in order");
+    testOk(nreceived<nupdates, "received %u of %u", unsigned(nreceived), unsigned(nupdates));
+
+    {
+        pva::ServerMonitorRequesterImpl::FlowStats stats;
+        testOk1(flowStats(server, stats));
+        testDiag("sent=%u held=%u overrun=%u, limit up to %u",
+                 unsigned(stats.nsent), unsigned(stats.nheld), unsigned(stats.noverrun), unsigned(maxLimit));
+        // the slow consumer limited what the server sent, the rest was squashed in its queue
+        testOk(stats.nheld>0u, "updates held back");
+        testOk(stats.noverrun>0u, "updates squashed on the server");
+        // the window is 8.  The limit should be set by the consumer's rate
+        testOk(maxLimit>0u && maxLimit<8u, "adaptive limit %u below window", unsigned(maxLimit));
+    }
+
+    {
+        std::ostringstream strm;
+        server->printInfo(strm, 3);
+        testDiag("%s", strm.str().c_str());
+        testOk(strm.str().find("monitor ioid=")!=std::string::npos, "subscription shown");
+        testOk(strm.str().find("window=")!=std::string::npos, "flow control shown");
+    }
+}
+
+} // namespace
+
+MAIN(testadaptivemonitor)
+{
+    testPlan(11);
+    try {
+        testSlowConsumer();
+    }catch(std::exception& e){
+        testAbort("Unexpected exception: %s", e.what());
+    }
+    return testDone();
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <vector>
+#include <string>
+
+#include <stdio.h>
+
+#include <pv/pvUnitTest.h>
+#include <testMain.h>
+
+#include <pv/configuration.h>
+#include <pv/serverContext.h>
+#include <pva/client.h>
+#include <pva/server.h>
+#include <pva/sharedstate.h>
+#include <pv/current_function.h>
+
+namespace pvd = epics::pvData;
+namespace pva = epics::pvAccess;
+
+namespace {
+
+const size_t npvs = 100u;
+
+const pvd::StructureConstPtr type(pvd::getFieldCreate()->createFieldBuilder()
+                                  ->add("value", pvd::pvInt)
+                                  ->createStructure());
+
+void testBulk()
+{
+    testDiag("==== %s ====", CURRENT_FUNCTION);
+
+    std::tr1::shared_ptr<pvas::StaticProvider> prov(new pvas::StaticProvider("test"));
+    std::vector<std::string> names;
+    for(size_t i=0; i<npvs; i++) {
+        char buf[32];
+        sprintf(buf, "pv:%u", unsigned(i));
+        names.push_back(buf);
+
+        pvas::SharedPV::shared_pointer pv(pvas::SharedPV::buildReadOnly());
+        pvd::PVStructurePtr inst(pvd::getPVDataCreate()->createPVStructure(type));
+        inst->getSubFieldT<pvd::PVScalar>("value")->putFrom<pvd::uint32>(i);
+        pv->open(*inst);
+        prov->add(buf, pv);
+    }
+
+    pva::ServerContext::shared_pointer server(pva::ServerContext::create(pva::ServerContext::Config()
+                                              .config(pva::ConfigurationBuilder()
+                                                      .add("EPICS_PVAS_INTF_ADDR_LIST", "127.0.0.1")
+                                                      .add("EPICS_PVA_ADDR_LIST", "127.0.0.1")
+                                                      .add("EPICS_PVA_AUTO_ADDR_LIST","0")
+                                                      .add("EPICS_PVA_SERVER_PORT", "0")
+                                                      .add("EPICS_PVA_BROADCAST_PORT", "0")
+                                                      .push_map()
+                                                      .build())
+                                              .provider(prov->provider())));
+
+    pvac::ClientProvider cli("pva", server->getCurrentConfig());
+
+    // already in the channel cache
+    pvac::ClientChannel first(cli.connect(names[0]));
+    testEqual(first.get(5.0)->getSubFieldT<pvd::PVScalar>("value")->getAs<pvd::uint32>(), 0u);
+
+    // includes a duplicate
+    names.push_back(names[1]);
+
+    std::vector<pvac::ClientChannel> chans(cli.connect(names));
+    testEqual(chans.size(), names.size());
+
+    size_t good = 0u;
+    for(size_t i=0; i<npvs; i++) {
+        if(chans[i].name()==names[i] &&
+                chans[i].get(5.0)->getSubFieldT<pvd::PVScalar>("value")->getAs<pvd::uint32>()==i)
+            good++;
+    }
+    testEqual(good, npvs);
+
+    testEqual(chans.back().get(5.0)->getSubFieldT<pvd::PVScalar>("value")->getAs<pvd::uint32>(), 1u);
+
+    {
+        std::vector<std::string> bad(1);
+        testThrows(std::logic_error, cli.connect(bad));
+    }
+}
+
+} // namespace
+
+MAIN(testbulkconnect)
+{
+    testPlan(5);
+    try {
+        testBulk();
+    }catch(std::exception& e){
+        testAbort("Unexpected exception: %s", e.what());
+    }
+    return testDone();
+}
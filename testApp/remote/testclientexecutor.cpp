@@ -0,0 +1,158 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <string.h>
+
+#include <epicsEvent.h>
+#include <epicsThread.h>
+
+#include <pv/pvUnitTest.h>
+#include <testMain.h>
+
+#include <pv/configuration.h>
+#include <pv/serverContext.h>
+#include <pva/client.h>
+#include <pva/server.h>
+#include <pva/sharedstate.h>
+#include <pv/current_function.h>
+
+namespace pvd = epics::pvData;
+namespace pva = epics::pvAccess;
+
+namespace {
+
+const pvd::StructureConstPtr type(pvd::getFieldCreate()->createFieldBuilder()
+                                  ->add("value", pvd::pvInt)
+                                  ->createStructure());
+
+// blocks during the first Data event until released
+struct Blocker : public pvac::ClientChannel::MonitorCallback
+{
+    epicsEvent entered, release;
+    pvac::Monitor *mon;
+    bool first;
+
+    Blocker() :mon(0), first(true) {}
+    virtual ~Blocker() {}
+
+    virtual void monitorEvent(const pvac::MonitorEvent& evt) OVERRIDE FINAL
+    {
+        if(evt.event!=pvac::MonitorEvent::Data)
+            return;
+        entered.signal();
+        if(first) {
+            first = false;
+            release.wait();
+        }
+        while(mon->poll()) {}
+    }
+};
+
+struct Getter : public pvac::ClientChannel::GetCallback
+{
+    epicsEvent done;
+    pvac::GetEvent result;
+    std::string thread;
+
+    virtual ~Getter() {}
+
+    virtual void getDone(const pvac::GetEvent& evt) OVERRIDE FINAL
+    {
+        result = evt;
+        thread = epicsThreadGetNameSelf();
+        done.signal();
+    }
+};
+
+void testBlockedChannel()
+{
+    testDiag("==== %s ====", CURRENT_FUNCTION);
+
+    pvas::SharedPV::shared_pointer slow(pvas::SharedPV::buildMailbox()),
+                                   fast(pvas::SharedPV::buildMailbox());
+    std::tr1::shared_ptr<pvas::StaticProvider> prov(new pvas::StaticProvider("test"));
+    prov->add("pv:slow", slow);
+    prov->add("pv:fast", fast);
+
+    pvd::PVStructurePtr inst(pvd::getPVDataCreate()->createPVStructure(type));
+    pvd::BitSet changed;
+    pvd::PVScalarPtr value(inst->getSubFieldT<pvd::PVScalar>("value"));
+    changed.set(value->getFieldOffset());
+    value->putFrom<pvd::int32>(1);
+    slow->open(*inst, changed);
+    fast->open(*inst, changed);
+
+    pva::ServerContext::shared_pointer server(pva::ServerContext::create(pva::ServerContext::Config()
+                                              .config(pva::ConfigurationBuilder()
+                                                      .add("EPICS_PVAS_INTF_ADDR_LIST", "127.0.0.1")
+                                                      .add("EPICS_PVA_ADDR_LIST", "127.0.0.1")
+                                                      .add("EPICS_PVA_AUTO_ADDR_LIST","0")
+                                                      .add("EPICS_PVA_SERVER_PORT", "0")
+                                                      .add("EPICS_PVA_BROADCAST_PORT", "0")
+                                                      .push_map()
+                                                      .build())
+                                              .provider(prov->provider())));
+
+    pvac::Executor::shared_pointer exec(pvac::Executor::createPool(2u));
+
+    pvac::ClientProvider cli("pva", server->getCurrentConfig());
+    cli.setExecutor(exec);
+
+    // both channels share one server connection
+    pvac::ClientChannel slowchan(cli.connect("pv:slow")),
+                        fastchan(cli.connect("pv:fast"));
+
+    Blocker blocker;
+    pvac::Monitor mon(slowchan.monitor(&blocker));
+    blocker.mon = &mon;
+
+    testOk(blocker.entered.wait(5.0), "slow callback entered");
+
+    // with the slow callback blocked, another channel still completes
+    Getter getter;
+    pvac::Operation op(fastchan.get(&getter));
+    testOk(getter.done.wait(5.0), "fast get completes");
+    testEqual(getter.result.event, pvac::GetEvent::Success);
+    testOk(strncmp(getter.thread.c_str(), "pvacCB", 6)==0, "callback thread '%s'", getter.thread.c_str());
+
+    // an update to the blocked channel waits in the executor
+    value->putFrom<pvd::int32>(2);
+    slow->post(*inst, changed);
+
+    pvac::Executor::Stats stats;
+    for(unsigned i=0; i<50u; i++) {
+        exec->stats(stats);
+        if(stats.queued>0u)
+            break;
+        epicsThreadSleep(0.1);
+    }
+    testOk(stats.queued>0u, "queued %u", unsigned(stats.queued));
+
+    blocker.release.signal();
+    testOk(blocker.entered.wait(5.0), "queued update delivered");
+
+    mon.cancel();
+    op.cancel();
+
+    exec->stats(stats);
+    testDiag("queued %u, max %u, executed %u",
+             unsigned(stats.queued), unsigned(stats.maxQueued), unsigned(stats.executed));
+    testEqual(stats.threads, 2u);
+    testOk1(stats.maxQueued>=1u);
+    testOk1(stats.executed>=3u);
+}
+
+} // namespace
+
+MAIN(testclientexecutor)
+{
+    testPlan(9);
+    try {
+        testBlockedChannel();
+    }catch(std::exception& e){
+        testAbort("Unexpected exception: %s", e.what());
+    }
+    return testDone();
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <sstream>
+
+#include <pv/pvUnitTest.h>
+#include <testMain.h>
+
+#include <pv/configuration.h>
+#include <pv/serverContext.h>
+#include <pv/pvAccess.h>
+#include <pva/client.h>
+#include <pva/server.h>
+#include <pva/sharedstate.h>
+#include <pv/current_function.h>
+
+namespace pvd = epics::pvData;
+namespace pva = epics::pvAccess;
+
+namespace {
+
+const pvd::StructureConstPtr scalarType(pvd::getFieldCreate()->createFieldBuilder()
+                                        ->add("value", pvd::pvInt)
+                                        ->createStructure());
+
+void testStats()
+{
+    testDiag("==== %s ====", CURRENT_FUNCTION);
+
+    std::tr1::shared_ptr<pvas::StaticProvider> prov(new pvas::StaticProvider("test"));
+
+    pvas::SharedPV::shared_pointer pv(pvas::SharedPV::buildMailbox());
+    pv->open(scalarType);
+    prov->add("pv:value", pv);
+
+    pva::ServerContext::shared_pointer server(pva::ServerContext::create(pva::ServerContext::Config()
+                                              .config(pva::ConfigurationBuilder()
+                                                      .add("EPICS_PVAS_INTF_ADDR_LIST", "127.0.0.1")
+                                                      .add("EPICS_PVA_ADDR_LIST", "127.0.0.1")
+                                                      .add("EPICS_PVA_AUTO_ADDR_LIST","0")
+                                                      .add("EPICS_PVA_SERVER_PORT", "0")
+                                                      .add("EPICS_PVA_BROADCAST_PORT", "0")
+                                                      .push_map()
+                                                      .build())
+                                              .provider(prov->provider())));
+
+    {
+        pvac::ClientProvider cli("pva", server->getCurrentConfig());
+        pvac::ClientChannel chan(cli.connect("pv:value"));
+        chan.get();
+
+        pva::ChannelStats stats;
+        chan.stats(stats);
+        testOk(!stats.enabled, "not collected by default");
+    }
+
+    pvac::ClientProvider cli("pva", pva::ConfigurationBuilder()
+                             .push_config(server->getCurrentConfig())
+                             .add("EPICS_PVA_CLIENT_STATS", "YES")
+                             .push_map()
+                             .build());
+    pvac::ClientChannel chan(cli.connect("pv:value"));
+
+    for(int i=0; i<3; i++)
+        chan.get();
+    for(int i=0; i<2; i++)
+        chan.put().set("value", i).exec();
+
+    pvac::MonitorSync mon(chan.monitor());
+
+    pvd::PVStructurePtr inst(pv->build());
+    pvd::PVIntPtr value(inst->getSubFieldT<pvd::PVInt>("value"));
+    pvd::BitSet changed;
+    changed.set(value->getFieldOffset());
+
+    pvd::int32 last = -1;
+    for(pvd::int32 i=10; i<=20; i++) {
+        value->put(i);
+        pv->post(*inst, changed);
+        // one update at a time, so none are squashed
+        while(last!=i && mon.wait(5.0)) {
+            while(mon.poll())
+                last = mon.root->getSubFieldT<pvd::PVInt>("value")->get();
+        }
+    }
+    testEqual(last, 20);
+
+    pva::ChannelStats stats;
+    chan.stats(stats);
+
+    testOk1(stats.enabled);
+    testEqual(stats.getLatency.count(), 3u);
+    testEqual(stats.putLatency.count(), 2u);
+    testOk(stats.nupdates>=11u, "nupdates %u", unsigned(stats.nupdates));
+    testOk(stats.decode.count()>=3u+2u+stats.nupdates, "decode %u", unsigned(stats.decode.count()));
+    testOk(stats.nrxBytes>0u, "nrxBytes %u", unsigned(stats.nrxBytes));
+    testOk(stats.updatePeriod>0.0, "updatePeriod %g", stats.updatePeriod);
+    testEqual(stats.noverrun, 0u);
+    testOk(stats.getLatency.percentile(0.5) <= stats.getLatency.percentile(0.99),
+           "p50 %g <= p99 %g", stats.getLatency.percentile(0.5), stats.getLatency.percentile(0.99));
+
+    std::ostringstream strm;
+    chan.show(strm);
+    testDiag("%s", strm.str().c_str());
+    testOk(strm.str().find("GET      : 3")!=std::string::npos, "show() includes statistics");
+}
+
+} // namespace
+
+MAIN(testclientstats)
+{
+    testPlan(12);
+    try {
+        testStats();
+    }catch(std::exception& e){
+        testAbort("Unexpected exception: %s", e.what());
+    }
+    return testDone();
+}
@@ -0,0 +1,202 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <vector>
+#include <sstream>
+
+#include <epicsThread.h>
+
+#include <pv/pvUnitTest.h>
+#include <testMain.h>
+
+#include <pv/configuration.h>
+#include <pv/serverContext.h>
+#include <pva/client.h>
+#include <pva/server.h>
+#include <pva/sharedstate.h>
+#include <pva/gateway.h>
+#include <pv/current_function.h>
+
+namespace pvd = epics::pvData;
+namespace pva = epics::pvAccess;
+
+namespace {
+
+const size_t nclients = 4u;
+
+const pvd::StructureConstPtr type(pvd::getFieldCreate()->createFieldBuilder()
+                                  ->add("value", pvd::pvInt)
+                                  ->createStructure());
+
+pva::Configuration::shared_pointer loopback()
+{
+    return pva::ConfigurationBuilder()
+            .add("EPICS_PVAS_INTF_ADDR_LIST", "127.0.0.1")
+            .add("EPICS_PVA_ADDR_LIST", "127.0.0.1")
+            .add("EPICS_PVA_AUTO_ADDR_LIST","0")
+            .add("EPICS_PVA_SERVER_PORT", "0")
+            .add("EPICS_PVA_BROADCAST_PORT", "0")
+            .push_map()
+            .build();
+}
+
+// returns the number of downstream updates received
+size_t testValue(std::vector<pvac::MonitorSync>& mons, pvd::uint32 expect)
+{
+    size_t count = 0u;
+    for(size_t i=0; i<mons.size(); i++) {
+        pvac::MonitorSync& mon = mons[i];
+        testOk1(mon.wait(5.0));
+        testEqual(mon.event.event, pvac::MonitorEvent::Data);
+        bool poll = mon.poll();
+        testOk1(poll);
+        if(poll) {
+            count++;
+            testEqual(mon.root->getSubFieldT<pvd::PVScalar>("value")->getAs<pvd::uint32>(), expect);
+        } else {
+            testSkip(1, "No data");
+        }
+    }
+    return count;
+}
+
+void testFanout()
+{
+    testDiag("==== %s ====", CURRENT_FUNCTION);
+
+    pvas::SharedPV::shared_pointer pv(pvas::SharedPV::buildMailbox());
+    std::tr1::shared_ptr<pvas::StaticProvider> prov(new pvas::StaticProvider("upstream"));
+    prov->add("pv:name", pv);
+
+    pvd::PVStructurePtr inst(pvd::getPVDataCreate()->createPVStructure(type));
+    pvd::BitSet changed;
+    pvd::PVScalarPtr value(inst->getSubFieldT<pvd::PVScalar>("value"));
+    value->putFrom<pvd::uint32>(42);
+    changed.set(value->getFieldOffset());
+    pv->open(*inst, changed);
+
+    pva::ServerContext::shared_pointer upserv(pva::ServerContext::create(pva::ServerContext::Config()
+                                              .config(loopback())
+                                              .provider(prov->provider())));
+
+    pvac::ClientProvider upcli("pva", upserv->getCurrentConfig());
+
+    pvas::GatewayProvider gw("gateway", upcli);
+
+    // downstream server uses a different (random) port
+    pva::ServerContext::shared_pointer gwserv(pva::ServerContext::create(pva::ServerContext::Config()
+                                              .config(loopback())
+                                              .provider(gw.provider())));
+
+    pvac::ClientProvider cli("pva", gwserv->getCurrentConfig());
+    pvac::ClientChannel chan(cli.connect("pv:name"));
+
+    size_t downstream = 0u;
+
+    std::vector<pvac::MonitorSync> mons;
+    for(size_t i=0; i<nclients; i++)
+        mons.push_back(chan.monitor());
+
+    downstream += testValue(mons, 42u);
+
+    // served from cache
+    testEqual(chan.get(5.0)->getSubFieldT<pvd::PVScalar>("value")->getAs<pvd::uint32>(), 42u);
+
+    value->putFrom<pvd::uint32>(43);
+    pv->post(*inst, changed);
+    downstream += testValue(mons, 43u);
+
+    value->putFrom<pvd::uint32>(44);
+    pv->post(*inst, changed);
+    downstream += testValue(mons, 44u);
+
+    {
+        pvas::GatewayProvider::Stats stats;
+        gw.stats(stats);
+        testDiag("upstream updates %u, downstream updates %u",
+                 unsigned(stats.upstreamUpdates), unsigned(downstream));
+        testEqual(stats.channels, 1u);
+        testEqual(stats.subscriptions, 1u);
+        testEqual(stats.upstreamUpdates, 3u);
+        testEqual(downstream, 3u*nclients);
+    }
+
+    // Put is forwarded upstream
+    chan.put().set("value", 45).exec();
+    {
+        pvd::PVStructurePtr cur(pvd::getPVDataCreate()->createPVStructure(type));
+        pvd::BitSet valid;
+        pv->fetch(*cur, valid);
+        testEqual(cur->getSubFieldT<pvd::PVScalar>("value")->getAs<pvd::uint32>(), 45u);
+    }
+    testValue(mons, 45u);
+
+    for(size_t i=0; i<nclients; i++)
+        mons[i].cancel();
+}
+
+struct FindRequester : public pva::ChannelFindRequester
+{
+    POINTER_DEFINITIONS(FindRequester);
+    size_t found;
+    FindRequester() :found(0u) {}
+    virtual ~FindRequester() {}
+    virtual void channelFindResult(const pvd::Status& status,
+                                   pva::ChannelFind::shared_pointer const & channelFind,
+                                   bool wasFound) OVERRIDE FINAL
+    {
+        if(wasFound)
+            found++;
+    }
+};
+
+void testSearchStorm()
+{
+    testDiag("==== %s ====", CURRENT_FUNCTION);
+
+    // no upstream server, so no name is ever connected
+    pvac::ClientProvider upcli("pva", loopback());
+
+    // 1 channel per second, so a burst of 10
+    pvas::GatewayProvider gw("gateway", upcli, 0.5, 1.0);
+    pva::ChannelProvider::shared_pointer prov(gw.provider());
+
+    FindRequester::shared_pointer req(new FindRequester);
+    for(size_t i=0; i<100u; i++) {
+        std::ostringstream name;
+        name<<"pv:storm"<<i;
+        prov->channelFind(name.str(), req);
+    }
+
+    pvas::GatewayProvider::Stats stats;
+    gw.stats(stats);
+    testOk(stats.channels>=10u && stats.channels<=11u, "created %u upstream channels", unsigned(stats.channels));
+    testEqual(stats.channels + stats.throttled, 100u);
+    testEqual(req->found, 0u);
+
+    // expired by the periodic sweep
+    for(unsigned i=0; i<100u; i++) {
+        gw.stats(stats);
+        if(stats.channels==0u)
+            break;
+        epicsThreadSleep(0.1);
+    }
+    testEqual(stats.channels, 0u);
+    testEqual(stats.expired, 100u - stats.throttled);
+}
+
+} // namespace
+
+MAIN(testgateway)
+{
+    testPlan(75);
+    try {
+        testFanout();
+        testSearchStorm();
+    }catch(std::exception& e){
+        testAbort("Unexpected exception: %s", e.what());
+    }
+    return testDone();
+}
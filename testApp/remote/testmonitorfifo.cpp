@@ -469,6 +469,12 @@ void checkSaturate()
     tester.mon->notify();
     tester.testTimeline({Tester::Event});
 
+    {
+        pva::Monitor::Stats stats;
+        tester.mon->getStats(stats);
+        testEqual(stats.noverrun, 1u);
+    }
+
     testPop(*tester.mon, 5);
     tester.testTimeline({});
     tester.post(9);
@@ -797,7 +803,7 @@ void checkBadRequest()
 
 MAIN(testmonitorfifo)
 {
-    testPlan(189);
+    testPlan(190);
     checkPlain();
     checkAfterClose();
     checkReOpenLost();
@@ -0,0 +1,422 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <vector>
+#include <sstream>
+
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+
+#include <pv/pvUnitTest.h>
+#include <testMain.h>
+
+#include <pv/configuration.h>
+#include <pv/serverContext.h>
+#include <pva/client.h>
+#include <pva/server.h>
+#include <pva/sharedstate.h>
+#include <pv/current_function.h>
+
+#include <pv/codec.h>
+#include <pv/responseHandlers.h>
+#include <pv/serverContextImpl.h>
+#include <pv/serverChannelImpl.h>
+
+namespace pvd = epics::pvData;
+namespace pva = epics::pvAccess;
+
+typedef epicsGuard<epicsMutex> Guard;
+
+namespace {
+
+const size_t nscalars = 100u;
+const size_t arraySize = 10000u;
+
+const pvd::StructureConstPtr scalarType(pvd::getFieldCreate()->createFieldBuilder()
+                                        ->add("value", pvd::pvInt)
+                                        ->createStructure());
+
+const pvd::StructureConstPtr arrayType(pvd::getFieldCreate()->createFieldBuilder()
+                                       ->addArray("value", pvd::pvDouble)
+                                       ->createStructure());
+
+// like NTEnum, only string arrays
+const pvd::StructureConstPtr enumType(pvd::getFieldCreate()->createFieldBuilder()
+                                      ->setId("epics:nt/NTEnum:1.0")
+                                      ->addNestedStructure("value")
+                                          ->setId("enum_t")
+                                          ->add("index", pvd::pvInt)
+                                          ->addArray("choices", pvd::pvString)
+                                      ->endNested()
+                                      ->addNestedStructure("display")
+                                          ->addNestedStructure("form")
+                                              ->setId("enum_t")
+                                              ->add("index", pvd::pvInt)
+                                              ->addArray("choices", pvd::pvString)
+                                          ->endNested()
+                                      ->endNested()
+                                      ->createStructure());
+
+// returns the number of subscriptions which received the expected value
+size_t checkScalars(std::vector<pvac::MonitorSync>& mons, pvd::int32 expect)
+{
+    size_t nok = 0u;
+    for(size_t i=0; i<mons.size(); i++) {
+        pvac::MonitorSync& mon = mons[i];
+        // the latest value
+        pvd::int32 last = -1;
+        while(mon.test() || (last!=expect && mon.wait(5.0))) {
+            while(mon.poll())
+                last = mon.root->getSubFieldT<pvd::PVScalar>("value")->getAs<pvd::int32>();
+        }
+        if(last==expect)
+            nok++;
+        else
+            testDiag("%u has %d", unsigned(i), int(last));
+    }
+    return nok;
+}
+
+size_t checkArray(pvac::MonitorSync& mon, double expect)
+{
+    size_t len = 0u;
+    if(mon.wait(5.0) && mon.poll()) {
+        pvd::shared_vector<const double> arr(mon.root->getSubFieldT<pvd::PVDoubleArray>("value")->view());
+        len = arr.size();
+        if(len && arr[len-1]!=expect)
+            len = 0u;
+    }
+    return len;
+}
+
+void post(const pvas::SharedPV::shared_pointer& pv, const pvd::StructureConstPtr& type, pvd::int32 val)
+{
+    pvd::PVStructurePtr inst(pvd::getPVDataCreate()->createPVStructure(type));
+    pvd::BitSet changed;
+    pvd::PVFieldPtr value(inst->getSubFieldT("value"));
+    changed.set(value->getFieldOffset());
+    if(pvd::PVScalarPtr scalar = std::tr1::dynamic_pointer_cast<pvd::PVScalar>(value)) {
+        scalar->putFrom(val);
+    } else {
+        pvd::shared_vector<double> arr(arraySize, double(val));
+        static_cast<pvd::PVDoubleArray&>(*value).replace(pvd::freeze(arr));
+    }
+    if(pv->isOpen())
+        pv->post(*inst, changed);
+    else
+        pv->open(*inst, changed);
+}
+
+// sum over all connections to the server
+pva::ServerMonitorGroup::Stats groupStats(const pva::ServerContext::shared_pointer& server)
+{
+    pva::ServerMonitorGroup::Stats ret = {0u, 0u, 0u};
+
+    pva::ServerContextImpl::shared_pointer impl(std::tr1::dynamic_pointer_cast<pva::ServerContextImpl>(server));
+    pva::TransportRegistry::transportVector_t transports;
+    impl->getTransportRegistry()->toArray(transports);
+
+    for(size_t i=0; i<transports.size(); i++) {
+        pva::detail::BlockingServerTCPTransportCodec *codec =
+                dynamic_cast<pva::detail::BlockingServerTCPTransportCodec*>(transports[i].get());
+        pva::ServerMonitorGroup::shared_pointer mgroup;
+        if(codec)
+            mgroup = codec->getMonitorGroup();
+        if(!mgroup)
+            continue;
+
+        pva::ServerMonitorGroup::Stats stats;
+        mgroup->stats(stats);
+        ret.nmessages += stats.nmessages;
+        ret.ngrouped += stats.ngrouped;
+        ret.nseparate += stats.nseparate;
+    }
+    return ret;
+}
+
+// send priority of the subscription to the named channel
+int monitorPriority(const pva::ServerContext::shared_pointer& server, const std::string& name)
+{
+    pva::ServerContextImpl::shared_pointer impl(std::tr1::dynamic_pointer_cast<pva::ServerContextImpl>(server));
+    pva::TransportRegistry::transportVector_t transports;
+    impl->getTransportRegistry()->toArray(transports);
+
+    for(size_t i=0; i<transports.size(); i++) {
+        pva::detail::BlockingServerTCPTransportCodec *codec =
+                dynamic_cast<pva::detail::BlockingServerTCPTransportCodec*>(transports[i].get());
+        if(!codec)
+            continue;
+
+        std::vector<pva::ServerChannel::shared_pointer> channels;
+        codec->getChannels(channels);
+        for(size_t c=0; c<channels.size(); c++) {
+            if(channels[c]->getChannel()->getChannelName()!=name)
+                continue;
+
+            pva::ServerChannel::requests_t requests;
+            channels[c]->getRequests(requests);
+            for(size_t r=0; r<requests.size(); r++) {
+                pva::ServerMonitorRequesterImpl::shared_pointer mon(
+                            std::tr1::dynamic_pointer_cast<pva::ServerMonitorRequesterImpl>(requests[r].second));
+                if(mon)
+                    return mon->getSendPriority();
+            }
+        }
+    }
+    return -1;
+}
+
+void testGroup(bool group)
+{
+    testDiag("==== %s %s ====", CURRENT_FUNCTION, group ? "grouped" : "not grouped");
+
+    std::tr1::shared_ptr<pvas::StaticProvider> prov(new pvas::StaticProvider("test"));
+
+    std::vector<pvas::SharedPV::shared_pointer> scalars(nscalars);
+    for(size_t i=0; i<nscalars; i++) {
+        std::ostringstream name;
+        name<<"pv:scalar:"<<i;
+        scalars[i] = pvas::SharedPV::buildReadOnly();
+        post(scalars[i], scalarType, 0);
+        prov->add(name.str(), scalars[i]);
+    }
+
+    // may carry an array, so sent with bulk priority and never grouped
+    pvas::SharedPV::shared_pointer array(pvas::SharedPV::buildReadOnly());
+    post(array, arrayType, 0);
+    prov->add("pv:array", array);
+
+    // string arrays are not bulk
+    pvas::SharedPV::shared_pointer enumpv(pvas::SharedPV::buildReadOnly());
+    enumpv->open(*pvd::getPVDataCreate()->createPVStructure(enumType), pvd::BitSet().set(0));
+    prov->add("pv:enum", enumpv);
+
+    pva::ServerContext::shared_pointer server(pva::ServerContext::create(pva::ServerContext::Config()
+                                              .config(pva::ConfigurationBuilder()
+                                                      .add("EPICS_PVAS_INTF_ADDR_LIST", "127.0.0.1")
+                                                      .add("EPICS_PVA_ADDR_LIST", "127.0.0.1")
+                                                      .add("EPICS_PVA_AUTO_ADDR_LIST","0")
+                                                      .add("EPICS_PVA_SERVER_PORT", "0")
+                                                      .add("EPICS_PVA_BROADCAST_PORT", "0")
+                                                      .add("EPICS_PVAS_GROUP_MONITORS", group ? "YES" : "NO")
+                                                      .push_map()
+                                                      .build())
+                                              .provider(prov->provider())));
+
+    pvac::ClientProvider cli("pva", server->getCurrentConfig());
+
+    std::vector<pvac::MonitorSync> mons;
+    for(size_t i=0; i<nscalars; i++) {
+        std::ostringstream name;
+        name<<"pv:scalar:"<<i;
+        mons.push_back(cli.connect(name.str()).monitor());
+    }
+    pvac::MonitorSync amon(cli.connect("pv:array").monitor());
+    pvac::MonitorSync emon(cli.connect("pv:enum").monitor());
+
+    testEqual(checkScalars(mons, 0), nscalars);
+    testEqual(checkArray(amon, 0.0), arraySize);
+
+    // update everything at once, so that updates are queued together
+    for(size_t i=0; i<nscalars; i++)
+        post(scalars[i], scalarType, 5);
+    post(array, arrayType, 5);
+
+    testEqual(checkScalars(mons, 5), nscalars);
+    testEqual(checkArray(amon, 5.0), arraySize);
+
+    pva::ServerMonitorGroup::Stats stats(groupStats(server));
+    testDiag("%u CMD_MULTIPLE_DATA with %u updates, %u sent separately",
+             unsigned(stats.nmessages), unsigned(stats.ngrouped), unsigned(stats.nseparate));
+    if(group) {
+        testOk(stats.ngrouped>=nscalars, "scalar updates grouped");
+        testOk(stats.nmessages>0u && stats.nmessages<stats.ngrouped, "more than one update per message");
+        testEqual(stats.nseparate, 0u); // array update bypasses the group
+    } else {
+        testEqual(stats.ngrouped, 0u);
+        testEqual(stats.nmessages, 0u);
+        testEqual(stats.nseparate, 0u);
+    }
+
+    testEqual(monitorPriority(server, "pv:array"), int(pva::SEND_PRIORITY_BULK));
+    testEqual(monitorPriority(server, "pv:scalar:0"), int(pva::SEND_PRIORITY_NORMAL));
+    testOk1(emon.wait(5.0) && emon.poll());
+    testEqual(monitorPriority(server, "pv:enum"), int(pva::SEND_PRIORITY_NORMAL));
+}
+
+// a Channel whose subscription is ended by the test while updates are queued
+struct FinishChannel : public pva::Channel
+{
+    POINTER_DEFINITIONS(FinishChannel);
+
+    const pva::ChannelProvider::weak_pointer provider;
+    const std::string name;
+    const pva::ChannelRequester::weak_pointer requester;
+
+    epicsMutex mutex;
+    pva::MonitorFIFO::shared_pointer fifo;
+
+    FinishChannel(const pva::ChannelProvider::shared_pointer& provider,
+                  const std::string& name,
+                  const pva::ChannelRequester::shared_pointer& requester)
+        :provider(provider), name(name), requester(requester)
+    {}
+    virtual ~FinishChannel() {}
+
+    virtual void destroy() OVERRIDE FINAL {}
+    virtual pva::ChannelProvider::shared_pointer getProvider() OVERRIDE FINAL { return pva::ChannelProvider::shared_pointer(provider); }
+    virtual std::string getRemoteAddress() OVERRIDE FINAL { return "finish"; }
+    virtual std::string getChannelName() OVERRIDE FINAL { return name; }
+    virtual pva::ChannelRequester::shared_pointer getChannelRequester() OVERRIDE FINAL { return pva::ChannelRequester::shared_pointer(requester); }
+
+    virtual pva::Monitor::shared_pointer createMonitor(pva::MonitorRequester::shared_pointer const & requester,
+                                                       pvd::PVStructure::shared_pointer const & pvRequest) OVERRIDE FINAL
+    {
+        pva::MonitorFIFO::Config conf;
+        conf.defCount = conf.maxCount = 4u;
+        pva::MonitorFIFO::shared_pointer ret(new pva::MonitorFIFO(requester, pvRequest, pva::MonitorFIFO::Source::shared_pointer(), &conf));
+        {
+            Guard G(mutex);
+            fifo = ret;
+        }
+        ret->open(scalarType);
+        postTo(*ret, 0);
+        ret->notify();
+        return ret;
+    }
+
+    static void postTo(pva::MonitorFIFO& mon, pvd::int32 val)
+    {
+        pvd::PVStructurePtr inst(pvd::getPVDataCreate()->createPVStructure(scalarType));
+        pvd::PVScalarPtr value(inst->getSubFieldT<pvd::PVScalar>("value"));
+        value->putFrom(val);
+        pvd::BitSet changed;
+        changed.set(value->getFieldOffset());
+        mon.post(*inst, changed);
+    }
+
+    // queue some updates, then unlisten() before the server has sent them
+    void end()
+    {
+        pva::MonitorFIFO::shared_pointer mon;
+        {
+            Guard G(mutex);
+            mon = fifo;
+        }
+        if(!mon)
+            testAbort("%s not subscribed", name.c_str());
+
+        for(pvd::int32 i=1; i<=3; i++)
+            postTo(*mon, i);
+        mon->notify();
+
+        pva::MonitorRequester::shared_pointer req(mon->getRequester());
+        if(req)
+            req->unlisten(mon);
+    }
+};
+
+struct FinishHandler : public pvas::DynamicProvider::Handler
+{
+    POINTER_DEFINITIONS(FinishHandler);
+
+    epicsMutex mutex;
+    std::vector<FinishChannel::shared_pointer> channels;
+
+    virtual ~FinishHandler() {}
+
+    virtual void hasChannels(pvas::DynamicProvider::search_type& names) OVERRIDE FINAL {
+        for(pvas::DynamicProvider::search_type::iterator it(names.begin()), end(names.end());
+            it != end; ++it)
+        {
+            if(it->name().find("pv:finish:")==0)
+                it->claim();
+        }
+    }
+
+    virtual std::tr1::shared_ptr<epics::pvAccess::Channel> createChannel(const std::tr1::shared_ptr<epics::pvAccess::ChannelProvider>& provider,
+                                                                         const std::string& name,
+                                                                         const std::tr1::shared_ptr<epics::pvAccess::ChannelRequester>& requester) OVERRIDE FINAL
+    {
+        FinishChannel::shared_pointer ret(new FinishChannel(provider, name, requester));
+        Guard G(mutex);
+        channels.push_back(ret);
+        return ret;
+    }
+};
+
+void testUnlisten()
+{
+    testDiag("==== %s ====", CURRENT_FUNCTION);
+
+    const size_t nchannels = 20u;
+
+    FinishHandler::shared_pointer handler(new FinishHandler);
+    pvas::DynamicProvider prov("finish", handler);
+
+    pva::ServerContext::shared_pointer server(pva::ServerContext::create(pva::ServerContext::Config()
+                                              .config(pva::ConfigurationBuilder()
+                                                      .add("EPICS_PVAS_INTF_ADDR_LIST", "127.0.0.1")
+                                                      .add("EPICS_PVA_ADDR_LIST", "127.0.0.1")
+                                                      .add("EPICS_PVA_AUTO_ADDR_LIST","0")
+                                                      .add("EPICS_PVA_SERVER_PORT", "0")
+                                                      .add("EPICS_PVA_BROADCAST_PORT", "0")
+                                                      .add("EPICS_PVAS_GROUP_MONITORS", "YES")
+                                                      .push_map()
+                                                      .build())
+                                              .provider(prov.provider())));
+
+    pvac::ClientProvider cli("pva", server->getCurrentConfig());
+
+    std::vector<pvac::MonitorSync> mons;
+    for(size_t i=0; i<nchannels; i++) {
+        std::ostringstream name;
+        name<<"pv:finish:"<<i;
+        mons.push_back(cli.connect(name.str()).monitor());
+    }
+
+    testEqual(checkScalars(mons, 0), nchannels);
+
+    std::vector<FinishChannel::shared_pointer> channels;
+    {
+        Guard G(handler->mutex);
+        channels = handler->channels;
+    }
+    for(size_t i=0; i<channels.size(); i++)
+        channels[i]->end();
+
+    // each subscription sees the end of the updates, and completes
+    size_t ncomplete = 0u;
+    for(size_t i=0; i<mons.size(); i++) {
+        pvac::MonitorSync& mon = mons[i];
+        while(!mon.complete() && mon.wait(5.0)) {
+            while(mon.poll()) {}
+        }
+        if(mon.complete())
+            ncomplete++;
+        else
+            testDiag("%s not complete", mon.name().c_str());
+    }
+    testEqual(ncomplete, nchannels);
+
+    pva::ServerMonitorGroup::Stats stats(groupStats(server));
+    testDiag("%u CMD_MULTIPLE_DATA with %u updates, %u sent separately",
+             unsigned(stats.nmessages), unsigned(stats.ngrouped), unsigned(stats.nseparate));
+}
+
+} // namespace
+
+MAIN(testmonitorgroup)
+{
+    testPlan(24);
+    try {
+        testGroup(true);
+        testGroup(false);
+        testUnlisten();
+    }catch(std::exception& e){
+        testAbort("Unexpected exception: %s", e.what());
+    }
+    return testDone();
+}
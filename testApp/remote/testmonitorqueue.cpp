@@ -0,0 +1,230 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <epicsEvent.h>
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+
+#include <pv/pvUnitTest.h>
+#include <testMain.h>
+
+#include <pv/configuration.h>
+#include <pv/serverContext.h>
+#include <pv/createRequest.h>
+#include <pva/client.h>
+#include <pva/server.h>
+#include <pva/sharedstate.h>
+#include <pv/current_function.h>
+
+namespace pvd = epics::pvData;
+namespace pva = epics::pvAccess;
+
+namespace {
+
+typedef epicsGuard<epicsMutex> Guard;
+
+const pvd::StructureConstPtr type(pvd::getFieldCreate()->createFieldBuilder()
+                                  ->addArray("value", pvd::pvDouble)
+                                  ->add("counter", pvd::pvInt)
+                                  ->createStructure());
+
+const size_t nelem = 100000u;
+const size_t arrayBytes = nelem*sizeof(double);
+
+struct QueueRequester : public pva::MonitorRequester
+{
+    POINTER_DEFINITIONS(QueueRequester);
+
+    epicsMutex lock;
+    epicsEvent wakeup;
+    bool connected;
+    size_t nevents;
+
+    QueueRequester() :connected(false), nevents(0u) {}
+    virtual ~QueueRequester() {}
+
+    virtual std::string getRequesterName() OVERRIDE FINAL { return "QueueRequester"; }
+
+    virtual void monitorConnect(pvd::Status const & status,
+                                pva::MonitorPtr const & monitor,
+                                pvd::StructureConstPtr const & structure) OVERRIDE FINAL
+    {
+        {
+            Guard G(lock);
+            connected = status.isSuccess();
+        }
+        wakeup.signal();
+    }
+
+    virtual void monitorEvent(pva::MonitorPtr const & monitor) OVERRIDE FINAL
+    {
+        {
+            Guard G(lock);
+            nevents++;
+        }
+        wakeup.signal();
+    }
+
+    virtual void unlisten(pva::MonitorPtr const & monitor) OVERRIDE FINAL {}
+
+    size_t events()
+    {
+        Guard G(lock);
+        return nevents;
+    }
+
+    // wait for events beyond n
+    bool waitEvents(size_t n)
+    {
+        while(events()<=n) {
+            if(!wakeup.wait(5.0))
+                return false;
+        }
+        return true;
+    }
+};
+
+// poll() and release() everything queued.  returns the last counter value, or -1
+pvd::int32 drain(const pva::MonitorPtr& mon)
+{
+    pvd::int32 last = -1;
+    pva::MonitorElementPtr elem;
+    while((elem = mon->poll())) {
+        last = elem->pvStructurePtr->getSubFieldT<pvd::PVInt>("counter")->get();
+        mon->release(elem);
+    }
+    return last;
+}
+
+size_t residentBytes(const pva::MonitorPtr& mon)
+{
+    pva::Monitor::Stats stats;
+    mon->getStats(stats);
+    return stats.nbytes;
+}
+
+void testShareArrays()
+{
+    testDiag("==== %s ====", CURRENT_FUNCTION);
+
+    pvas::SharedPV::shared_pointer pv(pvas::SharedPV::buildReadOnly());
+    pvd::PVStructurePtr inst(pvd::getPVDataCreate()->createPVStructure(type));
+    pvd::PVDoubleArrayPtr value(inst->getSubFieldT<pvd::PVDoubleArray>("value"));
+    pvd::PVIntPtr counter(inst->getSubFieldT<pvd::PVInt>("counter"));
+
+    pvd::BitSet changedAll, changedCounter;
+    changedAll.set(value->getFieldOffset());
+    changedAll.set(counter->getFieldOffset());
+    changedCounter.set(counter->getFieldOffset());
+
+    {
+        pvd::PVDoubleArray::svector arr(nelem, 0.0);
+        value->replace(pvd::freeze(arr));
+    }
+    pv->open(*inst, changedAll);
+
+    std::tr1::shared_ptr<pvas::StaticProvider> prov(new pvas::StaticProvider("test"));
+    prov->add("pv:array", pv);
+
+    pva::ServerContext::shared_pointer server(pva::ServerContext::create(pva::ServerContext::Config()
+                                              .config(pva::ConfigurationBuilder()
+                                                      .add("EPICS_PVAS_INTF_ADDR_LIST", "127.0.0.1")
+                                                      .add("EPICS_PVA_ADDR_LIST", "127.0.0.1")
+                                                      .add("EPICS_PVA_AUTO_ADDR_LIST","0")
+                                                      .add("EPICS_PVA_SERVER_PORT", "0")
+                                                      .add("EPICS_PVA_BROADCAST_PORT", "0")
+                                                      .push_map()
+                                                      .build())
+                                              .provider(prov->provider())));
+
+    pvac::ClientProvider cli("pva", server->getCurrentConfig());
+    pvac::ClientChannel chan(cli.connect("pv:array"));
+
+    QueueRequester::shared_pointer req(new QueueRequester);
+    pva::MonitorPtr mon(chan.getChannel()->createMonitor(req, pvd::createRequest("record[queueSize=8]field()")));
+
+    while(!req->connected) {
+        if(!req->wakeup.wait(5.0))
+            testAbort("Timeout connecting");
+    }
+    mon->start();
+
+    testOk1(req->waitEvents(0u));
+    testEqual(drain(mon), 0);
+
+    // each update has a new array, which is released before the next
+    for(pvd::int32 i=1; i<=8; i++) {
+        size_t n = req->events();
+        pvd::PVDoubleArray::svector arr(nelem, double(i));
+        value->replace(pvd::freeze(arr));
+        counter->put(i);
+        pv->post(*inst, changedAll);
+        if(!req->waitEvents(n))
+            testAbort("Timeout waiting for update %d", i);
+        drain(mon);
+    }
+    // only the most recent array is kept
+    testEqual(residentBytes(mon), arrayBytes);
+
+    // queued updates which only change the counter share one array
+    for(pvd::int32 i=9; i<=13; i++) {
+        size_t n = req->events();
+        counter->put(i);
+        pv->post(*inst, changedCounter);
+        if(!req->waitEvents(n))
+            testAbort("Timeout waiting for update %d", i);
+    }
+    {
+        pva::Monitor::Stats stats;
+        mon->getStats(stats);
+        testEqual(stats.nfilled, 5u);
+        testEqual(stats.nbytes, arrayBytes);
+    }
+
+    // a new array is not shared
+    {
+        size_t n = req->events();
+        pvd::PVDoubleArray::svector arr(nelem, 14.0);
+        value->replace(pvd::freeze(arr));
+        counter->put(14);
+        pv->post(*inst, changedAll);
+        if(!req->waitEvents(n))
+            testAbort("Timeout waiting for update 14");
+    }
+    testEqual(residentBytes(mon), 2u*arrayBytes);
+
+    // queued elements have the correct arrays
+    {
+        bool ok = true;
+        pvd::int32 last = -1;
+        pva::MonitorElementPtr elem;
+        while((elem = mon->poll())) {
+            last = elem->pvStructurePtr->getSubFieldT<pvd::PVInt>("counter")->get();
+            pvd::PVDoubleArray::const_svector arr(elem->pvStructurePtr->getSubFieldT<pvd::PVDoubleArray>("value")->view());
+            double expect = last<14 ? 8.0 : 14.0;
+            ok &= arr.size()==nelem && arr[0]==expect && arr[nelem-1]==expect;
+            mon->release(elem);
+        }
+        testEqual(last, 14);
+        testOk(ok, "array values");
+    }
+
+    testEqual(residentBytes(mon), arrayBytes);
+
+    mon->destroy();
+}
+
+} // namespace
+
+MAIN(testmonitorqueue)
+{
+    testPlan(9);
+    try {
+        testShareArrays();
+    }catch(std::exception& e){
+        testAbort("Unexpected exception: %s", e.what());
+    }
+    return testDone();
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <pv/pvUnitTest.h>
+#include <testMain.h>
+
+#include <pv/reftrack.h>
+#include <pv/configuration.h>
+#include <pv/serverContext.h>
+#include <pva/client.h>
+#include <pva/server.h>
+#include <pva/sharedstate.h>
+#include <pv/current_function.h>
+
+namespace pvd = epics::pvData;
+namespace pva = epics::pvAccess;
+
+namespace {
+
+const pvd::StructureConstPtr type(pvd::getFieldCreate()->createFieldBuilder()
+                                  ->add("value", pvd::pvInt)
+                                  ->createStructure());
+
+void testValue(pvac::MonitorSync& mon, pvd::uint32 expect)
+{
+    testOk1(mon.wait(5.0));
+    testEqual(mon.event.event, pvac::MonitorEvent::Data);
+    bool poll = mon.poll();
+    testOk1(poll);
+    if(poll) {
+        testEqual(mon.root->getSubFieldT<pvd::PVScalar>("value")->getAs<pvd::uint32>(), expect);
+    } else {
+        testSkip(1, "No data");
+    }
+}
+
+void testShare()
+{
+    testDiag("==== %s ====", CURRENT_FUNCTION);
+
+    std::tr1::shared_ptr<pvas::StaticProvider> prov(new pvas::StaticProvider("test"));
+    pvas::SharedPV::shared_pointer pv(pvas::SharedPV::buildReadOnly());
+    prov->add("pv:name", pv);
+
+    pvd::PVStructurePtr inst(pvd::getPVDataCreate()->createPVStructure(type));
+    pvd::BitSet changed;
+    pvd::PVScalarPtr value(inst->getSubFieldT<pvd::PVScalar>("value"));
+    value->putFrom<pvd::uint32>(42);
+    changed.set(value->getFieldOffset());
+    pv->open(*inst, changed);
+
+    pva::ServerContext::shared_pointer server(pva::ServerContext::create(pva::ServerContext::Config()
+                                              .config(pva::ConfigurationBuilder()
+                                                      .add("EPICS_PVAS_INTF_ADDR_LIST", "127.0.0.1")
+                                                      .add("EPICS_PVA_ADDR_LIST", "127.0.0.1")
+                                                      .add("EPICS_PVA_AUTO_ADDR_LIST","0")
+                                                      .add("EPICS_PVA_SERVER_PORT", "0")
+                                                      .add("EPICS_PVA_BROADCAST_PORT", "0")
+                                                      .push_map()
+                                                      .build())
+                                              .provider(prov->provider())));
+
+    pvac::ClientProvider cli("pva", pva::ConfigurationBuilder()
+                             .push_config(server->getCurrentConfig())
+                             .add("EPICS_PVA_SHARE_MONITORS", "YES")
+                             .push_map()
+                             .build());
+
+    pvac::ClientChannel chan(cli.connect("pv:name"));
+
+    pvac::MonitorSync mon1(chan.monitor());
+    testValue(mon1, 42u);
+
+    // second subscriber joins late and is primed with the current value
+    pvac::MonitorSync mon2(chan.monitor());
+    testValue(mon2, 42u);
+
+    testEqual(epics::readRefCounter("MonitorMux"), 1u);
+    testEqual(epics::readRefCounter("MonitorFIFO"), 1u);
+
+    value->putFrom<pvd::uint32>(43);
+    pv->post(*inst, changed);
+
+    testValue(mon1, 43u);
+    testValue(mon2, 43u);
+
+    // a stopped subscriber doesn't stop the other
+    mon1.cancel();
+
+    value->putFrom<pvd::uint32>(44);
+    pv->post(*inst, changed);
+
+    testValue(mon2, 44u);
+
+    mon2.cancel();
+}
+
+} // namespace
+
+MAIN(testmonitorshare)
+{
+    testPlan(22);
+    try {
+        testShare();
+    }catch(std::exception& e){
+        testAbort("Unexpected exception: %s", e.what());
+    }
+    return testDone();
+}
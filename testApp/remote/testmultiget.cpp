@@ -0,0 +1,194 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <vector>
+#include <string>
+
+#include <stdio.h>
+
+#include <epicsThread.h>
+
+#include <pv/pvUnitTest.h>
+#include <testMain.h>
+
+#include <pv/configuration.h>
+#include <pv/serverContext.h>
+#include <pva/client.h>
+#include <pva/server.h>
+#include <pva/sharedstate.h>
+#include <pv/current_function.h>
+
+#include <pv/codec.h>
+#include <pv/serverContextImpl.h>
+
+namespace pvd = epics::pvData;
+namespace pva = epics::pvAccess;
+
+namespace {
+
+const size_t npvs = 50u;
+
+const pvd::StructureConstPtr type(pvd::getFieldCreate()->createFieldBuilder()
+                                  ->add("value", pvd::pvInt)
+                                  ->createStructure());
+
+size_t countValues(const std::vector<pvac::GetEvent>& results, size_t count, pvd::uint32 offset)
+{
+    size_t good = 0u;
+    for(size_t i=0; i<count; i++) {
+        if(results[i].event==pvac::GetEvent::Success &&
+                results[i].value->getSubFieldT<pvd::PVScalar>("value")->getAs<pvd::uint32>()==i+offset)
+            good++;
+        else
+            testDiag("%u : %d '%s'", unsigned(i), int(results[i].event), results[i].message.c_str());
+    }
+    return good;
+}
+
+// number of messages with this command handled by the server
+size_t countHandled(const pva::ServerContext::shared_pointer& server, pvd::int8 command)
+{
+    pva::ServerContextImpl::shared_pointer impl(std::tr1::dynamic_pointer_cast<pva::ServerContextImpl>(server));
+    pva::TransportRegistry::transportVector_t transports;
+    impl->getTransportRegistry()->toArray(transports);
+
+    size_t count = 0u;
+    for(size_t i=0; i<transports.size(); i++) {
+        pva::detail::BlockingTCPTransportCodec *codec =
+                dynamic_cast<pva::detail::BlockingTCPTransportCodec*>(transports[i].get());
+        pva::detail::BlockingTCPTransportCodec::HandlerStats stats;
+        if(!codec || !codec->getHandlerStats(stats))
+            continue;
+        for(size_t b=0; b<pva::detail::BlockingTCPTransportCodec::HandlerStats::nbuckets; b++)
+            count += stats.latency[command][b];
+    }
+    return count;
+}
+
+// The server counts a message after its handler returns,
+// which may be after the response has been sent.
+size_t waitHandled(const pva::ServerContext::shared_pointer& server, pvd::int8 command, size_t expect)
+{
+    size_t count = 0u;
+    for(unsigned i=0; i<500u && (count=countHandled(server, command))<expect; i++)
+        epicsThreadSleep(0.01);
+    return count;
+}
+
+void testMulti()
+{
+    testDiag("==== %s ====", CURRENT_FUNCTION);
+
+    std::tr1::shared_ptr<pvas::StaticProvider> prov(new pvas::StaticProvider("test"));
+    std::vector<std::string> names;
+    for(size_t i=0; i<npvs; i++) {
+        char buf[32];
+        sprintf(buf, "pv:%u", unsigned(i));
+        names.push_back(buf);
+
+        pvas::SharedPV::shared_pointer pv(pvas::SharedPV::buildMailbox());
+        pvd::PVStructurePtr inst(pvd::getPVDataCreate()->createPVStructure(type));
+        inst->getSubFieldT<pvd::PVScalar>("value")->putFrom<pvd::uint32>(i);
+        pv->open(*inst);
+        prov->add(buf, pv);
+    }
+
+    pva::ServerContext::shared_pointer server(pva::ServerContext::create(pva::ServerContext::Config()
+                                              .config(pva::ConfigurationBuilder()
+                                                      .add("EPICS_PVAS_INTF_ADDR_LIST", "127.0.0.1")
+                                                      .add("EPICS_PVA_ADDR_LIST", "127.0.0.1")
+                                                      .add("EPICS_PVA_AUTO_ADDR_LIST","0")
+                                                      .add("EPICS_PVA_SERVER_PORT", "0")
+                                                      .add("EPICS_PVA_BROADCAST_PORT", "0")
+                                                      // collects the per-command counts used below
+                                                      .add("EPICS_PVAS_STATS_PREFIX", "testmultiget:")
+                                                      .push_map()
+                                                      .build())
+                                              .provider(prov->provider())));
+
+    pvac::ClientProvider cli("pva", server->getCurrentConfig());
+
+    std::vector<pvac::ClientChannel> chans(cli.connect(names));
+
+    // wait for all to connect, after which one request is sent to the server
+    for(size_t i=0; i<chans.size(); i++)
+        chans[i].get(5.0);
+
+    {
+        const size_t ngets = countHandled(server, pva::CMD_GET);
+
+        std::vector<pvac::GetEvent> results(cli.getMany(chans, 5.0));
+        testEqual(results.size(), npvs);
+        testEqual(countValues(results, npvs, 0u), npvs);
+
+        testEqual(waitHandled(server, pva::CMD_MULTI_GET, 1u), 1u);
+        testEqual(countHandled(server, pva::CMD_GET), ngets);
+
+        std::vector<pvd::PVStructure::const_shared_pointer> values(npvs);
+        for(size_t i=0; i<npvs; i++) {
+            pvd::PVStructurePtr val(pvd::getPVDataCreate()->createPVStructure(type));
+            val->getSubFieldT<pvd::PVScalar>("value")->putFrom<pvd::uint32>(i+100u);
+            values[i] = val;
+        }
+
+        std::vector<pvac::PutEvent> puts(cli.putMany(chans, values, 5.0));
+        size_t good = 0u;
+        for(size_t i=0; i<puts.size(); i++) {
+            if(puts[i].event==pvac::PutEvent::Success)
+                good++;
+        }
+        testEqual(good, npvs);
+        testEqual(waitHandled(server, pva::CMD_MULTI_PUT, 1u), 1u);
+    }
+
+    {
+        std::vector<pvac::GetEvent> results(cli.getMany(chans, 5.0));
+        testEqual(countValues(results, npvs, 100u), npvs);
+    }
+
+    {
+        // put of a value with the wrong type fails only that channel
+        std::vector<pvd::PVStructure::const_shared_pointer> values(2);
+        values[0] = pvd::getPVDataCreate()->createPVStructure(pvd::getFieldCreate()->createFieldBuilder()
+                                                              ->add("value", pvd::pvDouble)
+                                                              ->createStructure());
+        pvd::PVStructurePtr val(pvd::getPVDataCreate()->createPVStructure(type));
+        val->getSubFieldT<pvd::PVScalar>("value")->putFrom<pvd::uint32>(42u);
+        values[1] = val;
+
+        std::vector<pvac::ClientChannel> two(chans.begin(), chans.begin()+2);
+        std::vector<pvac::PutEvent> puts(cli.putMany(two, values, 5.0));
+        testEqual(puts[0].event, pvac::PutEvent::Fail);
+        testEqual(puts[1].event, pvac::PutEvent::Success);
+    }
+
+    {
+        // a channel which never connects times out, without delaying the rest
+        std::vector<pvac::ClientChannel> some(chans.begin(), chans.begin()+3);
+        some.push_back(cli.connect("pv:missing"));
+
+        std::vector<pvac::GetEvent> results(cli.getMany(some, 1.0));
+        testEqual(results[3].event, pvac::GetEvent::Fail);
+        size_t good = 0u;
+        for(size_t i=0; i<3u; i++) {
+            if(results[i].event==pvac::GetEvent::Success)
+                good++;
+        }
+        testEqual(good, 3u);
+    }
+}
+
+} // namespace
+
+MAIN(testmultiget)
+{
+    testPlan(11);
+    try {
+        testMulti();
+    }catch(std::exception& e){
+        testAbort("Unexpected exception: %s", e.what());
+    }
+    return testDone();
+}
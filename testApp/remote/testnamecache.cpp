@@ -0,0 +1,178 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <string.h>
+#include <stdio.h>
+
+#include <pv/pvUnitTest.h>
+#include <testMain.h>
+
+#include <pv/configuration.h>
+#include <pv/serverContext.h>
+#include <pv/nameCache.h>
+#include <pva/client.h>
+#include <pva/server.h>
+#include <pva/sharedstate.h>
+#include <pv/current_function.h>
+
+namespace pvd = epics::pvData;
+namespace pva = epics::pvAccess;
+
+namespace {
+
+const pvd::StructureConstPtr type(pvd::getFieldCreate()->createFieldBuilder()
+                                  ->add("value", pvd::pvInt)
+                                  ->createStructure());
+
+osiSockAddr loopback(unsigned short port)
+{
+    osiSockAddr addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.ia.sin_family = AF_INET;
+    addr.ia.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.ia.sin_port = htons(port);
+    return addr;
+}
+
+void testCache()
+{
+    testDiag("==== %s ====", CURRENT_FUNCTION);
+
+    const char *fname = "testnamecache.db";
+    remove(fname);
+
+    pva::NameCache::shared_pointer cache(pva::NameCache::open(fname, 64));
+    testOk1(!!cache);
+    if(!cache) {
+        testSkip(16, "No name cache on this target");
+        return;
+    }
+
+    pva::ServerGUID guid = {{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12}},
+                    other = {{12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1}},
+                    found;
+    osiSockAddr addr(loopback(5075)), result;
+
+    testOk1(!cache->lookup("pv:a", result, found));
+
+    cache->store("pv:a", addr, guid);
+    testOk1(cache->lookup("pv:a", result, found));
+    testEqual(result.ia.sin_addr.s_addr, addr.ia.sin_addr.s_addr);
+    testEqual(ntohs(result.ia.sin_port), 5075);
+    testOk1(memcmp(found.value, guid.value, sizeof(guid.value))==0);
+
+    // same server instance
+    testEqual(cache->invalidate(addr, guid), 0u);
+    // server restarted
+    testEqual(cache->invalidate(addr, other), 1u);
+    testOk1(!cache->lookup("pv:a", result, found));
+
+    cache->store("pv:b", addr, guid);
+    cache->remove("pv:b");
+    testOk1(!cache->lookup("pv:b", result, found));
+
+    cache->store("pv:c", addr, guid);
+    cache.reset();
+
+    // re-open keeps size and content
+    cache = pva::NameCache::open(fname, 8);
+    testEqual(cache->getSize(), 64u);
+    testOk1(cache->lookup("pv:c", result, found));
+
+    std::string longname(pva::NameCache::MAX_NAME_LENGTH, 'x');
+    cache->store(longname, addr, guid);
+    testOk1(!cache->lookup(longname, result, found));
+
+    // invalidate() finds pv:c through the index built by open()
+    osiSockAddr addr2(loopback(5076));
+    cache->store("pv:d", addr, guid);
+    cache->store("pv:d", addr2, guid); // moved to another server
+    cache->store("pv:e", addr2, guid);
+    testEqual(cache->invalidate(addr, other), 1u);
+    testOk1(!cache->lookup("pv:c", result, found));
+    testOk1(cache->lookup("pv:d", result, found) && ntohs(result.ia.sin_port)==5076);
+    testOk1(cache->lookup("pv:e", result, found));
+}
+
+void testClient()
+{
+    testDiag("==== %s ====", CURRENT_FUNCTION);
+
+    pvas::SharedPV::shared_pointer pv(pvas::SharedPV::buildReadOnly());
+    std::tr1::shared_ptr<pvas::StaticProvider> prov(new pvas::StaticProvider("test"));
+    prov->add("pv:cached", pv);
+    prov->add("pv:stale", pv);
+    {
+        pvd::PVStructurePtr inst(pvd::getPVDataCreate()->createPVStructure(type));
+        inst->getSubFieldT<pvd::PVScalar>("value")->putFrom<pvd::int32>(42);
+        pv->open(*inst);
+    }
+
+    pva::ServerContext::shared_pointer server(pva::ServerContext::create(pva::ServerContext::Config()
+                                              .config(pva::ConfigurationBuilder()
+                                                      .add("EPICS_PVAS_INTF_ADDR_LIST", "127.0.0.1")
+                                                      .add("EPICS_PVA_ADDR_LIST", "127.0.0.1")
+                                                      .add("EPICS_PVA_AUTO_ADDR_LIST","0")
+                                                      .add("EPICS_PVA_SERVER_PORT", "0")
+                                                      .add("EPICS_PVA_BROADCAST_PORT", "0")
+                                                      .push_map()
+                                                      .build())
+                                              .provider(prov->provider())));
+
+    const char *fname = "testnamecache2.db";
+    remove(fname);
+
+    pva::NameCache::shared_pointer cache(pva::NameCache::open(fname, 64));
+    if(!cache) {
+        testSkip(3, "No name cache on this target");
+        return;
+    }
+    cache->store("pv:cached", loopback(server->getServerPort()), server->getGUID());
+    // nothing listening on the server UDP port
+    cache->store("pv:stale", loopback(server->getBroadcastPort()), server->getGUID());
+
+    {
+        // no search destinations, so only the name cache can connect
+        pvac::ClientProvider cli("pva", pva::ConfigurationBuilder()
+                                 .add("EPICS_PVA_ADDR_LIST", "")
+                                 .add("EPICS_PVA_AUTO_ADDR_LIST","0")
+                                 .add("EPICS_PVA_BROADCAST_PORT", "0")
+                                 .add("EPICS_PVA_NAME_CACHE", fname)
+                                 .push_map()
+                                 .build());
+
+        testEqual(cli.connect("pv:cached").get(5.0)->getSubFieldT<pvd::PVScalar>("value")->getAs<pvd::int32>(), 42);
+    }
+
+    {
+        // stale entry falls back to search, which updates the cache
+        pvac::ClientProvider cli("pva", pva::ConfigurationBuilder()
+                                 .push_config(server->getCurrentConfig())
+                                 .add("EPICS_PVA_NAME_CACHE", fname)
+                                 .push_map()
+                                 .build());
+
+        testEqual(cli.connect("pv:stale").get(5.0)->getSubFieldT<pvd::PVScalar>("value")->getAs<pvd::int32>(), 42);
+    }
+
+    osiSockAddr result;
+    pva::ServerGUID found;
+    testOk1(cache->lookup("pv:stale", result, found) &&
+            ntohs(result.ia.sin_port)==server->getServerPort());
+}
+
+} // namespace
+
+MAIN(testnamecache)
+{
+    testPlan(20);
+    try {
+        testCache();
+        testClient();
+    }catch(std::exception& e){
+        testAbort("Unexpected exception: %s", e.what());
+    }
+    return testDone();
+}
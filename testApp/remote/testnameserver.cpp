@@ -0,0 +1,199 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <sstream>
+#include <stdexcept>
+
+#include <pv/pvUnitTest.h>
+#include <testMain.h>
+#include <osiSock.h>
+
+#include <pv/configuration.h>
+#include <pv/serverContext.h>
+#include <pva/client.h>
+#include <pva/server.h>
+#include <pva/sharedstate.h>
+#include <pv/current_function.h>
+
+namespace pvd = epics::pvData;
+namespace pva = epics::pvAccess;
+
+namespace {
+
+const size_t nchannels = 500u;
+
+const pvd::StructureConstPtr type(pvd::getFieldCreate()->createFieldBuilder()
+                                  ->add("value", pvd::pvInt)
+                                  ->createStructure());
+
+struct TestServer {
+    pvas::SharedPV::shared_pointer pv;
+    std::tr1::shared_ptr<pvas::StaticProvider> prov;
+    pva::ServerContext::shared_pointer server;
+
+    TestServer()
+        :pv(pvas::SharedPV::buildReadOnly())
+        ,prov(new pvas::StaticProvider("test"))
+    {
+        prov->add("pv:single", pv);
+        for(size_t i=0; i<nchannels; i++) {
+            std::ostringstream name;
+            name<<"pv:many:"<<i;
+            prov->add(name.str(), pv);
+        }
+
+        pvd::PVStructurePtr inst(pvd::getPVDataCreate()->createPVStructure(type));
+        inst->getSubFieldT<pvd::PVScalar>("value")->putFrom<pvd::int32>(42);
+        pv->open(*inst);
+
+        server = pva::ServerContext::create(pva::ServerContext::Config()
+                                            .config(pva::ConfigurationBuilder()
+                                                    .add("EPICS_PVAS_INTF_ADDR_LIST", "127.0.0.1")
+                                                    .add("EPICS_PVA_ADDR_LIST", "127.0.0.1")
+                                                    .add("EPICS_PVA_AUTO_ADDR_LIST","0")
+                                                    .add("EPICS_PVA_SERVER_PORT", "0")
+                                                    .add("EPICS_PVA_BROADCAST_PORT", "0")
+                                                    .push_map()
+                                                    .build())
+                                            .provider(prov->provider()));
+    }
+
+    std::string address(unsigned short port) const
+    {
+        std::ostringstream strm;
+        strm<<"127.0.0.1:"<<port;
+        return strm.str();
+    }
+};
+
+// TCP socket which listens, but never accepts.
+// So connections are established, but never validated.
+struct SilentListener {
+    SOCKET sock;
+    unsigned short port;
+
+    SilentListener()
+        :sock(epicsSocketCreate(AF_INET, SOCK_STREAM, IPPROTO_TCP))
+        ,port(0u)
+    {
+        if(sock==INVALID_SOCKET)
+            throw std::runtime_error("Unable to create socket");
+
+        osiSockAddr addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.ia.sin_family = AF_INET;
+        addr.ia.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.ia.sin_port = 0;
+        osiSocklen_t alen = sizeof(addr);
+
+        if(bind(sock, &addr.sa, sizeof(addr.ia))
+                || listen(sock, 4)
+                || getsockname(sock, &addr.sa, &alen))
+        {
+            epicsSocketDestroy(sock);
+            throw std::runtime_error("Unable to listen");
+        }
+        port = ntohs(addr.ia.sin_port);
+    }
+    ~SilentListener()
+    {
+        epicsSocketDestroy(sock);
+    }
+};
+
+// no search destinations, so only name servers can resolve
+pvac::ClientProvider nameServerClient(const std::string& nameServers)
+{
+    return pvac::ClientProvider("pva", pva::ConfigurationBuilder()
+                                .add("EPICS_PVA_ADDR_LIST", "")
+                                .add("EPICS_PVA_AUTO_ADDR_LIST","0")
+                                .add("EPICS_PVA_BROADCAST_PORT", "0")
+                                .add("EPICS_PVA_NAME_SERVERS", nameServers)
+                                .push_map()
+                                .build());
+}
+
+void testSingle()
+{
+    testDiag("==== %s ====", CURRENT_FUNCTION);
+
+    TestServer serv;
+    pvac::ClientProvider cli(nameServerClient(serv.address(serv.server->getServerPort())));
+
+    testEqual(cli.connect("pv:single").get(5.0)->getSubFieldT<pvd::PVScalar>("value")->getAs<pvd::int32>(), 42);
+}
+
+void testMany()
+{
+    testDiag("==== %s ====", CURRENT_FUNCTION);
+
+    TestServer serv;
+    pvac::ClientProvider cli(nameServerClient(serv.address(serv.server->getServerPort())));
+
+    // searches for all channels are batched
+    std::vector<pvac::ClientChannel> chans;
+    chans.reserve(nchannels);
+    for(size_t i=0; i<nchannels; i++) {
+        std::ostringstream name;
+        name<<"pv:many:"<<i;
+        chans.push_back(cli.connect(name.str()));
+    }
+
+    size_t nok = 0u;
+    for(size_t i=0; i<nchannels; i++) {
+        try {
+            if(chans[i].get(5.0)->getSubFieldT<pvd::PVScalar>("value")->getAs<pvd::int32>()==42)
+                nok++;
+        }catch(std::exception& e){
+            testDiag("%s : %s", chans[i].name().c_str(), e.what());
+        }
+    }
+    testEqual(nok, nchannels);
+}
+
+void testUnreachable()
+{
+    testDiag("==== %s ====", CURRENT_FUNCTION);
+
+    TestServer serv;
+    // nothing listening for TCP on the server UDP port
+    pvac::ClientProvider cli(nameServerClient(serv.address(serv.server->getBroadcastPort())+" "+
+                                              serv.address(serv.server->getServerPort())));
+
+    testEqual(cli.connect("pv:single").get(5.0)->getSubFieldT<pvd::PVScalar>("value")->getAs<pvd::int32>(), 42);
+}
+
+void testBlackhole()
+{
+    testDiag("==== %s ====", CURRENT_FUNCTION);
+
+    TestServer serv;
+    SilentListener silent;
+    // connecting to the silent name server waits for validation, which never comes.
+    // This must not hold up the context timer, which connects the other name server.
+    pvac::ClientProvider cli(nameServerClient(serv.address(silent.port)+" "+
+                                              serv.address(serv.server->getServerPort())));
+
+    testEqual(cli.connect("pv:single").get(5.0)->getSubFieldT<pvd::PVScalar>("value")->getAs<pvd::int32>(), 42);
+}
+
+} // namespace
+
+MAIN(testnameserver)
+{
+    testPlan(4);
+    try {
+        testSingle();
+        testMany();
+        testUnreachable();
+        testBlackhole();
+    }catch(std::exception& e){
+        testAbort("Unexpected exception: %s", e.what());
+    }
+    return testDone();
+}
@@ -0,0 +1,183 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <algorithm>
+
+#include <epicsEvent.h>
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+
+#include <pv/pvUnitTest.h>
+#include <testMain.h>
+
+#include <pv/configuration.h>
+#include <pv/serverContext.h>
+#include <pv/createRequest.h>
+#include <pva/client.h>
+#include <pva/server.h>
+#include <pva/sharedstate.h>
+#include <pv/current_function.h>
+
+namespace pvd = epics::pvData;
+namespace pva = epics::pvAccess;
+
+typedef epicsGuard<epicsMutex> Guard;
+typedef epicsGuardRelease<epicsMutex> UnGuard;
+
+namespace {
+
+const pvd::StructureConstPtr type(pvd::getFieldCreate()->createFieldBuilder()
+                                  ->add("value", pvd::pvInt)
+                                  ->createStructure());
+
+// issues 'total' puts, keeping up to 'window' in flight
+struct Streamer : public pva::ChannelPutRequester
+{
+    epicsMutex mutex;
+    epicsEvent connected, done;
+    pvd::Status connectStatus;
+    pva::ChannelPut::shared_pointer op;
+
+    pvd::PVStructurePtr value;
+    pvd::BitSetPtr changed;
+
+    size_t total, sent, completed, failed;
+    // most puts issued, but not complete, at once
+    size_t maxInFlight;
+
+    explicit Streamer(size_t total)
+        :changed(new pvd::BitSet)
+        ,total(total), sent(0u), completed(0u), failed(0u), maxInFlight(0u)
+    {}
+    virtual ~Streamer() {}
+
+    virtual std::string getRequesterName() OVERRIDE FINAL { return "Streamer"; }
+
+    virtual void channelPutConnect(const pvd::Status& status,
+                                   pva::ChannelPut::shared_pointer const & channelPut,
+                                   pvd::StructureConstPtr const & structure) OVERRIDE FINAL
+    {
+        {
+            Guard G(mutex);
+            connectStatus = status;
+            op = channelPut;
+            if(status.isSuccess()) {
+                value = pvd::getPVDataCreate()->createPVStructure(structure);
+                changed->set(value->getSubFieldT<pvd::PVScalar>("value")->getFieldOffset());
+            }
+        }
+        connected.signal();
+    }
+
+    // call with mutex locked
+    void putNext(Guard& G)
+    {
+        pvd::int32 next = ++sent;
+        maxInFlight = std::max(maxInFlight, sent-completed);
+        value->getSubFieldT<pvd::PVScalar>("value")->putFrom(next);
+        pva::ChannelPut::shared_pointer put(op);
+        UnGuard U(G);
+        // the value is copied before put() returns
+        put->put(value, changed);
+    }
+
+    void start(size_t window)
+    {
+        Guard G(mutex);
+        for(size_t i=0; i<window && sent<total; i++)
+            putNext(G);
+    }
+
+    virtual void putDone(const pvd::Status& status,
+                         pva::ChannelPut::shared_pointer const & /*channelPut*/) OVERRIDE FINAL
+    {
+        bool last;
+        {
+            Guard G(mutex);
+            completed++;
+            if(!status.isSuccess()) {
+                failed++;
+                testDiag("put %u fails: %s", unsigned(completed), status.getMessage().c_str());
+            }
+            if(sent<total)
+                putNext(G);
+            last = completed==total;
+        }
+        if(last)
+            done.signal();
+    }
+
+    virtual void getDone(const pvd::Status& /*status*/,
+                         pva::ChannelPut::shared_pointer const & /*channelPut*/,
+                         pvd::PVStructure::shared_pointer const & /*pvStructure*/,
+                         pvd::BitSet::shared_pointer const & /*bitSet*/) OVERRIDE FINAL
+    {}
+};
+
+void testStream(pvac::ClientChannel& chan, const char *request, size_t window, size_t total)
+{
+    testDiag("==== %s %s ====", CURRENT_FUNCTION, request);
+
+    std::tr1::shared_ptr<Streamer> streamer(new Streamer(total));
+    pva::ChannelPut::shared_pointer op(chan.getChannel()->createChannelPut(streamer, pvd::createRequest(request)));
+
+    testOk(streamer->connected.wait(5.0), "connected");
+    testOk(streamer->connectStatus.isSuccess(), "%s", streamer->connectStatus.getMessage().c_str());
+
+    streamer->start(window);
+
+    testOk(streamer->done.wait(10.0), "all puts complete");
+    {
+        Guard G(streamer->mutex);
+        testEqual(streamer->completed, total);
+        testEqual(streamer->failed, 0u);
+        testDiag("up to %u in flight", unsigned(streamer->maxInFlight));
+        if(window>1u)
+            testOk(streamer->maxInFlight>1u && streamer->maxInFlight<=window, "more than one put in flight");
+        else
+            testEqual(streamer->maxInFlight, 1u);
+    }
+
+    // the last put is applied last
+    testEqual(chan.get(5.0)->getSubFieldT<pvd::PVScalar>("value")->getAs<pvd::uint32>(), total);
+
+    op->destroy();
+}
+
+} // namespace
+
+MAIN(testpipelineput)
+{
+    testPlan(14);
+    try {
+        pvas::SharedPV::shared_pointer pv(pvas::SharedPV::buildMailbox());
+        pv->open(type);
+        std::tr1::shared_ptr<pvas::StaticProvider> prov(new pvas::StaticProvider("test"));
+        prov->add("pv:setpoint", pv);
+
+        pva::ServerContext::shared_pointer server(pva::ServerContext::create(pva::ServerContext::Config()
+                                                  .config(pva::ConfigurationBuilder()
+                                                          .add("EPICS_PVAS_INTF_ADDR_LIST", "127.0.0.1")
+                                                          .add("EPICS_PVA_ADDR_LIST", "127.0.0.1")
+                                                          .add("EPICS_PVA_AUTO_ADDR_LIST","0")
+                                                          .add("EPICS_PVA_SERVER_PORT", "0")
+                                                          .add("EPICS_PVA_BROADCAST_PORT", "0")
+                                                          .push_map()
+                                                          .build())
+                                                  .provider(prov->provider())));
+
+        pvac::ClientProvider cli("pva", server->getCurrentConfig());
+        pvac::ClientChannel chan(cli.connect("pv:setpoint"));
+        chan.get(5.0);
+
+        // one put at a time
+        testStream(chan, "field()", 1u, 20u);
+        // eight in flight
+        testStream(chan, "record[pipeline=true,queueSize=8]field()", 8u, 1000u);
+    }catch(std::exception& e){
+        testAbort("Unexpected exception: %s", e.what());
+    }
+    return testDone();
+}
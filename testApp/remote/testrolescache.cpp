@@ -0,0 +1,256 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <pv/pvUnitTest.h>
+#include <testMain.h>
+
+#include <epicsThread.h>
+#include <epicsTime.h>
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+
+#include <pv/configuration.h>
+#include <pv/serverContext.h>
+#include <pv/security.h>
+#include <pva/client.h>
+#include <pva/server.h>
+#include <pva/sharedstate.h>
+#include <pv/current_function.h>
+
+namespace pvd = epics::pvData;
+namespace pva = epics::pvAccess;
+
+namespace {
+
+typedef epicsGuard<epicsMutex> Guard;
+
+epicsMutex resolverLock;
+size_t resolved;
+double resolverDelay;
+
+// stand in for a slow directory service
+void testResolver(const std::string& account, pva::PeerInfo::roles_t& roles)
+{
+    double delay;
+    {
+        Guard G(resolverLock);
+        delay = resolverDelay;
+    }
+    if(delay>0.0)
+        epicsThreadSleep(delay);
+
+    roles.insert("testgroup");
+    roles.insert(account+"group");
+
+    Guard G(resolverLock);
+    resolved++;
+}
+
+void setDelay(double delay)
+{
+    Guard G(resolverLock);
+    resolverDelay = delay;
+}
+
+size_t nresolved()
+{
+    Guard G(resolverLock);
+    return resolved;
+}
+
+bool waitResolved(size_t n)
+{
+    for(int i=0; i<100 && nresolved()<n; i++)
+        epicsThreadSleep(0.05);
+    return nresolved()>=n;
+}
+
+void testCache()
+{
+    testDiag("==== %s ====", CURRENT_FUNCTION);
+
+    setDelay(0.0);
+    const size_t initial = nresolved();
+
+    pva::RolesCache cache(&testResolver);
+    cache.setTimeout(5.0);
+
+    pva::PeerInfo::roles_t roles;
+    testOk1(cache.get("alice", roles));
+    testOk1(roles.count("testgroup")==1u && roles.count("alicegroup")==1u);
+
+    roles.clear();
+    testOk1(cache.get("alice", roles));
+    testOk1(roles.count("alicegroup")==1u);
+
+    pva::RolesCache::Stats stats;
+    cache.stats(stats);
+    testEqual(stats.entries, 1u);
+    testEqual(stats.misses, 1u);
+    testEqual(stats.hits, 1u);
+    testEqual(nresolved()-initial, 1u);
+
+    // an expired entry is used, and refreshed in the background
+    cache.setTTL(0.0);
+    roles.clear();
+    testOk1(cache.get("alice", roles));
+    testOk1(roles.count("alicegroup")==1u);
+    testOk1(waitResolved(initial+2u));
+
+    cache.stats(stats);
+    testEqual(stats.stale, 1u);
+
+    cache.clear();
+    cache.stats(stats);
+    testEqual(stats.entries, 0u);
+}
+
+void testSlowResolver()
+{
+    testDiag("==== %s ====", CURRENT_FUNCTION);
+
+    setDelay(1.0);
+    const size_t initial = nresolved();
+
+    pva::RolesCache cache(&testResolver);
+    cache.setTimeout(0.1);
+
+    pva::PeerInfo::roles_t roles;
+    epicsTime start(epicsTime::getCurrent());
+    testOk1(!cache.get("bob", roles));
+    double elapsed = epicsTime::getCurrent() - start;
+    testOk(elapsed < 0.5, "miss waits only for the timeout %g", elapsed);
+    testOk1(roles.empty());
+
+    testOk1(waitResolved(initial+1u));
+
+    cache.setTTL(0.0);
+    start = epicsTime::getCurrent();
+    testOk1(cache.get("bob", roles));
+    elapsed = epicsTime::getCurrent() - start;
+    testOk(elapsed < 0.5, "stale entry used while refreshing %g", elapsed);
+    testOk1(roles.count("bobgroup")==1u);
+
+    pva::RolesCache::Stats stats;
+    cache.stats(stats);
+    testEqual(stats.timeouts, 1u);
+
+    testOk1(waitResolved(initial+2u));
+}
+
+struct PeerHandler : public pvas::SharedPV::Handler
+{
+    epicsMutex lock;
+    bool identified;
+    pva::PeerInfo::roles_t roles;
+
+    PeerHandler() :identified(false) {}
+    virtual ~PeerHandler() {}
+    virtual void onPut(const pvas::SharedPV::shared_pointer& pv, pvas::Operation& op) OVERRIDE FINAL
+    {
+        {
+            Guard G(lock);
+            const pva::PeerInfo *peer = op.peer();
+            identified = peer && peer->identified;
+            roles.clear();
+            if(peer)
+                roles = peer->roles;
+        }
+        pv->post(op.value(), op.changed());
+        op.complete();
+    }
+};
+
+const pvd::StructureConstPtr scalarType(pvd::getFieldCreate()->createFieldBuilder()
+                                        ->add("value", pvd::pvInt)
+                                        ->createStructure());
+
+// time to connect a new client, and complete one put()
+double timePut(const pva::Configuration::const_shared_pointer& conf)
+{
+    epicsTime start(epicsTime::getCurrent());
+    pvac::ClientProvider cli("pva", conf);
+    pvac::ClientChannel chan(cli.connect("pv:value"));
+    chan.put().set("value", 1).exec();
+    return epicsTime::getCurrent() - start;
+}
+
+void testConnect()
+{
+    testDiag("==== %s ====", CURRENT_FUNCTION);
+
+    // longer than the client waits for a put()
+    setDelay(4.0);
+    const size_t initial = nresolved();
+
+    pva::RolesCache& cache = pva::RolesCache::instance();
+    cache.setResolver(&testResolver);
+    cache.setTimeout(0.2);
+    cache.setTTL(60.0);
+
+    std::tr1::shared_ptr<pvas::StaticProvider> prov(new pvas::StaticProvider("test"));
+    std::tr1::shared_ptr<PeerHandler> handler(new PeerHandler);
+    pvas::SharedPV::shared_pointer pv(pvas::SharedPV::build(handler));
+    pv->open(scalarType);
+    prov->add("pv:value", pv);
+
+    pva::ServerContext::shared_pointer server(pva::ServerContext::create(pva::ServerContext::Config()
+                                              .config(pva::ConfigurationBuilder()
+                                                      .add("EPICS_PVAS_INTF_ADDR_LIST", "127.0.0.1")
+                                                      .add("EPICS_PVA_ADDR_LIST", "127.0.0.1")
+                                                      .add("EPICS_PVA_AUTO_ADDR_LIST","0")
+                                                      .add("EPICS_PVA_SERVER_PORT", "0")
+                                                      .add("EPICS_PVA_BROADCAST_PORT", "0")
+                                                      .push_map()
+                                                      .build())
+                                              .provider(prov->provider())));
+
+    // the first connection does not wait for the lookup to complete
+    double elapsed = timePut(server->getCurrentConfig());
+    testOk(elapsed < 2.0, "first connect %g", elapsed);
+    {
+        Guard G(handler->lock);
+        testOk1(handler->identified);
+        testOk1(handler->roles.empty());
+    }
+
+    testOk1(waitResolved(initial+1u));
+
+    // later connections use the cached roles
+    elapsed = timePut(server->getCurrentConfig());
+    testOk(elapsed < 2.0, "second connect %g", elapsed);
+    {
+        Guard G(handler->lock);
+        testOk1(handler->roles.count("testgroup")==1u);
+    }
+
+    // and are not delayed by a refresh
+    cache.setTTL(0.0);
+    elapsed = timePut(server->getCurrentConfig());
+    testOk(elapsed < 2.0, "connect while refreshing %g", elapsed);
+    {
+        Guard G(handler->lock);
+        testOk1(handler->roles.count("testgroup")==1u);
+    }
+
+    cache.setResolver(&pva::osdGetRoles);
+    cache.setTTL(60.0);
+    cache.setTimeout(1.0);
+}
+
+} // namespace
+
+MAIN(testrolescache)
+{
+    testPlan(30);
+    try {
+        testCache();
+        testSlowResolver();
+        testConnect();
+    }catch(std::exception& e){
+        testAbort("Unexpected exception: %s", e.what());
+    }
+    return testDone();
+}
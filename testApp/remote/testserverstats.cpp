@@ -0,0 +1,172 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <stdexcept>
+
+#include <pv/pvUnitTest.h>
+#include <testMain.h>
+
+#include <epicsThread.h>
+
+#include <pv/configuration.h>
+#include <pv/serverContext.h>
+#include <pva/client.h>
+#include <pva/server.h>
+#include <pva/sharedstate.h>
+#include <pv/current_function.h>
+
+namespace pvd = epics::pvData;
+namespace pva = epics::pvAccess;
+
+namespace {
+
+const pvd::StructureConstPtr scalarType(pvd::getFieldCreate()->createFieldBuilder()
+                                        ->add("value", pvd::pvInt)
+                                        ->createStructure());
+
+// index of the row of an NTTable with column[name]==value, or -1
+int findRow(const pvd::PVStructure::const_shared_pointer& table, const char *column, const std::string& value)
+{
+    pvd::PVStringArray::const_svector col(table->getSubFieldT<pvd::PVStringArray>(std::string("value.")+column)->view());
+    for(size_t i=0; i<col.size(); i++) {
+        if(col[i]==value)
+            return int(i);
+    }
+    return -1;
+}
+
+template<typename T>
+T cell(const pvd::PVStructure::const_shared_pointer& table, const char *column, int row)
+{
+    typename pvd::PVValueArray<T>::const_svector col(table->getSubFieldT<pvd::PVValueArray<T> >(std::string("value.")+column)->view());
+    return row>=0 && size_t(row)<col.size() ? col[row] : T();
+}
+
+void testStats()
+{
+    testDiag("==== %s ====", CURRENT_FUNCTION);
+
+    std::tr1::shared_ptr<pvas::StaticProvider> prov(new pvas::StaticProvider("test"));
+
+    pvas::SharedPV::shared_pointer pv(pvas::SharedPV::buildReadOnly());
+    pv->open(scalarType);
+    prov->add("pv:value", pv);
+
+    pva::ServerContext::shared_pointer server(pva::ServerContext::create(pva::ServerContext::Config()
+                                              .config(pva::ConfigurationBuilder()
+                                                      .add("EPICS_PVAS_INTF_ADDR_LIST", "127.0.0.1")
+                                                      .add("EPICS_PVA_ADDR_LIST", "127.0.0.1")
+                                                      .add("EPICS_PVA_AUTO_ADDR_LIST","0")
+                                                      .add("EPICS_PVA_SERVER_PORT", "0")
+                                                      .add("EPICS_PVA_BROADCAST_PORT", "0")
+                                                      .add("EPICS_PVAS_STATS_PREFIX", "stats:")
+                                                      .add("EPICS_PVAS_STATS_PERIOD", "0.1")
+                                                      .push_map()
+                                                      .build())
+                                              .provider(prov->provider())));
+
+    // our provider is not among those named
+    testEqual(server->getCurrentConfig()->getPropertyAsString("EPICS_PVAS_PROVIDER_NAMES", ""), "test");
+
+    pvac::ClientProvider cli("pva", server->getCurrentConfig());
+
+    pvac::MonitorSync mon(cli.connect("pv:value").monitor());
+
+    pvd::PVStructurePtr inst(pv->build());
+    pvd::PVIntPtr value(inst->getSubFieldT<pvd::PVInt>("value"));
+    pvd::BitSet changed;
+    changed.set(value->getFieldOffset());
+
+    for(pvd::int32 i=1; i<=10; i++) {
+        value->put(i);
+        pv->post(*inst, changed);
+    }
+
+    pvd::int32 last = -1;
+    while(last!=10 && mon.wait(5.0)) {
+        while(mon.poll())
+            last = mon.root->getSubFieldT<pvd::PVInt>("value")->get();
+    }
+    testEqual(last, 10);
+
+    // wait for an update of the statistics which includes the monitor updates
+    pvac::ClientChannel statChan(cli.connect("stats:channels"));
+    pvd::PVStructure::const_shared_pointer channels;
+    int row = -1;
+    for(int n=0; n<50; n++) {
+        channels = statChan.get();
+        row = findRow(channels, "channel", "pv:value");
+        if(row>=0 && cell<pvd::uint64>(channels, "updates", row)>0u)
+            break;
+        epicsThreadSleep(0.1);
+    }
+
+    testOk(row>=0, "channels has row %d for pv:value", row);
+    testEqual(cell<pvd::uint32>(channels, "monitors", row), 1u);
+    testOk(cell<pvd::uint64>(channels, "updates", row)>0u, "updates %u",
+           unsigned(cell<pvd::uint64>(channels, "updates", row)));
+
+    pvd::PVStructure::const_shared_pointer transports(cli.connect("stats:transports").get());
+    pvd::PVStringArray::const_svector remotes(transports->getSubFieldT<pvd::PVStringArray>("value.remote")->view());
+    // all channels are on one connection
+    testEqual(remotes.size(), 1u);
+    testOk(cell<pvd::uint64>(transports, "bytesIn", 0)>0u, "bytesIn %u",
+           unsigned(cell<pvd::uint64>(transports, "bytesIn", 0)));
+    testOk(cell<pvd::uint64>(transports, "bytesOut", 0)>0u, "bytesOut %u",
+           unsigned(cell<pvd::uint64>(transports, "bytesOut", 0)));
+    testOk(cell<pvd::uint64>(transports, "messagesIn", 0)>0u, "messagesIn %u",
+           unsigned(cell<pvd::uint64>(transports, "messagesIn", 0)));
+
+    pvd::PVStructure::const_shared_pointer latency(cli.connect("stats:latency").get());
+    int create = findRow(latency, "command", "createChannel");
+    int monitor = findRow(latency, "command", "monitor");
+    testOk(create>=0 && cell<pvd::uint64>(latency, "count", create)>=1u, "createChannel handled %u times",
+           unsigned(cell<pvd::uint64>(latency, "count", create)));
+    testOk(monitor>=0 && cell<pvd::uint64>(latency, "count", monitor)>=1u, "monitor handled %u times",
+           unsigned(cell<pvd::uint64>(latency, "count", monitor)));
+
+    // commands handled for a client which has since disconnected are still counted
+    {
+        pvac::ClientProvider other("pva", server->getCurrentConfig());
+        testEqual(other.connect("pv:value").get()->getSubFieldT<pvd::PVInt>("value")->get(), 10);
+        // only this client puts.  pv:value is read-only, so fails
+        try {
+            other.connect("pv:value").put().set("value", 1).exec();
+            testFail("put to read-only PV succeeds");
+        } catch(std::runtime_error& e) {
+            testPass("put fails: %s", e.what());
+        }
+    }
+
+    size_t nremotes = 0u;
+    for(int n=0; n<50; n++) {
+        transports = cli.connect("stats:transports").get();
+        nremotes = transports->getSubFieldT<pvd::PVStringArray>("value.remote")->view().size();
+        if(nremotes==1u)
+            break;
+        epicsThreadSleep(0.1);
+    }
+    testEqual(nremotes, 1u);
+
+    // the table of a later update
+    epicsThreadSleep(0.2);
+    latency = cli.connect("stats:latency").get();
+    int put = findRow(latency, "command", "put");
+    testOk(put>=0 && cell<pvd::uint64>(latency, "count", put)>=1u, "put handled %u times",
+           unsigned(cell<pvd::uint64>(latency, "count", put)));
+}
+
+} // namespace
+
+MAIN(testserverstats)
+{
+    testPlan(15);
+    try {
+        testStats();
+    }catch(std::exception& e){
+        testAbort("Unexpected exception: %s", e.what());
+    }
+    return testDone();
+}
@@ -3,9 +3,14 @@
  * found in the file LICENSE that is included with the distribution
  */
 
+#include <vector>
+
+#include <dbDefs.h>
+
 #include <pv/pvUnitTest.h>
 #include <testMain.h>
 
+#include <pv/createRequest.h>
 #include <pva/client.h>
 #include <pva/sharedstate.h>
 #include <pv/current_function.h>
@@ -186,16 +191,133 @@ void testPutRPC()
     testEqual(reply->getSubFieldT<pvd::PVScalar>("value")->getAs<pvd::uint32>(), 100u);
 }
 
+// subscribers with the same field selection share one mapping of each update
+void testMonitorGroups()
+{
+    testDiag("==== %s ====", CURRENT_FUNCTION);
+
+    pvd::StructureConstPtr type2(pvd::getFieldCreate()->createFieldBuilder()
+                                 ->add("value", pvd::pvInt)
+                                 ->add("extra", pvd::pvInt)
+                                 ->createStructure());
+
+    std::tr1::shared_ptr<pvas::StaticProvider> prov(new pvas::StaticProvider("test"));
+    std::tr1::shared_ptr<pvas::SharedPV> pv(pvas::SharedPV::buildReadOnly());
+
+    prov->add("pv:name", pv);
+
+    pv->open(type2);
+
+    pvac::ClientProvider cli(prov->provider());
+
+    pvac::ClientChannel chan(cli.connect("pv:name"));
+
+    pvac::MonitorSync A(chan.monitor(pvd::createRequest("field(value)")));
+    pvac::MonitorSync B(chan.monitor(pvd::createRequest("record[queueSize=2]field(value)")));
+    pvac::MonitorSync C(chan.monitor(pvd::createRequest("field()")));
+
+    // initial updates
+    testOk1(A.poll());
+    testOk1(B.poll());
+    testOk1(C.poll());
+
+    pvd::PVStructurePtr inst(pvd::getPVDataCreate()->createPVStructure(type2));
+    pvd::BitSet changed;
+
+    inst->getSubFieldT<pvd::PVScalar>("extra")->putFrom<pvd::uint32>(7);
+    changed.set(inst->getSubFieldT<pvd::PVScalar>("extra")->getFieldOffset());
+    pv->post(*inst, changed);
+
+    testOk(!A.poll(), "A ignores extra");
+    testOk(!B.poll(), "B ignores extra");
+    testOk(C.poll(), "C sees extra");
+    testEqual(C.root->getSubFieldT<pvd::PVScalar>("extra")->getAs<pvd::uint32>(), 7u);
+
+    changed.clear();
+    inst->getSubFieldT<pvd::PVScalar>("value")->putFrom<pvd::uint32>(5);
+    changed.set(inst->getSubFieldT<pvd::PVScalar>("value")->getFieldOffset());
+    pv->post(*inst, changed);
+
+    testOk1(A.poll());
+    testEqual(A.root->getSubFieldT<pvd::PVScalar>("value")->getAs<pvd::uint32>(), 5u);
+    testOk1(!A.root->getSubField("extra"));
+    testOk1(B.poll());
+    testEqual(B.root->getSubFieldT<pvd::PVScalar>("value")->getAs<pvd::uint32>(), 5u);
+    testOk1(C.poll());
+    testEqual(C.root->getSubFieldT<pvd::PVScalar>("value")->getAs<pvd::uint32>(), 5u);
+}
+
+void testFanout()
+{
+    testDiag("==== %s ====", CURRENT_FUNCTION);
+
+    pvas::SharedPV::Config conf;
+    conf.fanoutShardSize = 2u;
+
+    std::tr1::shared_ptr<pvas::StaticProvider> prov(new pvas::StaticProvider("test"));
+    std::tr1::shared_ptr<pvas::SharedPV> pv(pvas::SharedPV::buildReadOnly(&conf));
+
+    prov->add("pv:name", pv);
+
+    pv->open(type);
+
+    pvac::ClientProvider cli(prov->provider());
+
+    pvac::ClientChannel chan(cli.connect("pv:name"));
+
+    std::vector<pvac::MonitorSync> mons(9);
+    for(size_t i=0; i<mons.size(); i++) {
+        mons[i] = chan.monitor();
+        mons[i].poll(); // initial update
+    }
+
+    pvd::PVStructurePtr inst(pvd::getPVDataCreate()->createPVStructure(type));
+    pvd::BitSet changed;
+    pvd::PVScalarPtr value(inst->getSubFieldT<pvd::PVScalar>("value"));
+    changed.set(value->getFieldOffset());
+
+    for(pvd::uint32 n=1u; n<=3u; n++) {
+        value->putFrom(n);
+        pv->post(*inst, changed);
+    }
+
+    size_t good = 0u;
+    for(size_t i=0; i<mons.size(); i++) {
+        pvd::uint32 last = 0u;
+        while(mons[i].poll())
+            last = mons[i].root->getSubFieldT<pvd::PVScalar>("value")->getAs<pvd::uint32>();
+        if(last==3u)
+            good++;
+    }
+    testEqual(good, mons.size());
+
+    pvas::SharedPV::FanoutStats stats;
+    pv->fanoutStats(stats, true);
+    testEqual(stats.nposts, 3u);
+    testEqual(stats.nparallel, 3u);
+    testOk(stats.maxShards>1u, "maxShards=%u", unsigned(stats.maxShards));
+
+    size_t total = 0u;
+    for(size_t i=0; i<NELEMENTS(stats.postToNotify); i++)
+        total += stats.postToNotify[i];
+    testEqual(total, 3u);
+
+    pv->fanoutStats(stats);
+    testEqual(stats.nposts, 0u);
+}
+
 } // namespace
 
 MAIN(testsharedstate)
 {
-    testPlan(19);
+    testPlan(39);
     try {
         testNoClient();
         testGetMon();
         testPutRPCCancel();
         testPutRPC();
+        testMonitorGroups();
+        testFanout();
     }catch(std::exception& e){
         testAbort("Unexpected exception: %s", e.what());
     }
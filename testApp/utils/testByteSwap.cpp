@@ -0,0 +1,83 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <vector>
+#include <stdexcept>
+
+#include <string.h>
+#include <stdlib.h>
+
+#include <pv/pvUnitTest.h>
+#include <testMain.h>
+
+#include <pv/byteSwap.h>
+
+namespace pva = epics::pvAccess;
+
+namespace {
+
+// reverse each element one byte at a time
+bool expected(const char *dest, const char *src, size_t count, size_t elementSize)
+{
+    for(size_t i=0; i<count; i++)
+        for(size_t b=0; b<elementSize; b++)
+            if(dest[i*elementSize+b]!=src[i*elementSize+elementSize-1u-b])
+                return false;
+    return true;
+}
+
+void testSwap(size_t elementSize)
+{
+    testDiag("==== testSwap(%u) ====", unsigned(elementSize));
+
+    bool copyOk = true, inplaceOk = true;
+
+    // all remainders after whole vectors, and unaligned
+    for(size_t count=0; count<200u; count++) {
+        for(size_t offset=0; offset<3u; offset++) {
+            // one extra, so that &src[0] is valid when empty
+            std::vector<char> src(count*elementSize+offset+1u), dest(src.size()), inplace;
+            for(size_t i=0; i<src.size(); i++)
+                src[i] = char(rand());
+
+            pva::swapCopy(&dest[0]+offset, &src[0]+offset, count, elementSize);
+            copyOk &= expected(&dest[0]+offset, &src[0]+offset, count, elementSize);
+
+            inplace = src;
+            pva::swapCopy(&inplace[0]+offset, &inplace[0]+offset, count, elementSize);
+            inplaceOk &= expected(&inplace[0]+offset, &src[0]+offset, count, elementSize);
+        }
+    }
+
+    testOk(copyOk, "copy");
+    testOk(inplaceOk, "in place");
+}
+
+void testNoSwap()
+{
+    testDiag("==== testNoSwap ====");
+
+    const char src[] = "abcdefghijklmnopqrstuvwxyz0123456789";
+    char dest[sizeof(src)];
+    pva::swapCopy(dest, src, sizeof(src), 1u);
+    testOk1(memcmp(dest, src, sizeof(src))==0);
+
+    testThrows(std::invalid_argument, pva::swapCopy(dest, src, 1u, 3u));
+}
+
+} // namespace
+
+MAIN(testByteSwap)
+{
+    testPlan(8);
+    testDiag("Using %s", pva::swapCopyImpl());
+    srand(42);
+    testSwap(2u);
+    testSwap(4u);
+    testSwap(8u);
+    testNoSwap();
+    return testDone();
+}
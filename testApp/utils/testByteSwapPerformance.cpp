@@ -0,0 +1,111 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+/* Measure byte swapping of arrays, as when client and server have different byte order.
+ * Compares swapCopy() from pv/byteSwap.h with swapping one element at a time
+ * for element sizes 2, 4, and 8 bytes.
+ */
+
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <epicsGetopt.h>
+#include <epicsTime.h>
+
+#include <pv/byteSwap.h>
+
+namespace pva = epics::pvAccess;
+
+namespace {
+
+#define DEFAULT_ELEMENTS (16*1024*1024)
+
+void usage (void)
+{
+    fprintf (stderr, "\nUsage: testByteSwapPerformance [options]\n\n"
+             "  -h: Help: Print this message\n"
+             "options:\n"
+             "  -n <elements>:     largest array, default is '%d'\n\n"
+             , DEFAULT_ELEMENTS);
+}
+
+typedef void (*swap_t)(void *dest, const void *src, size_t count, size_t elementSize);
+
+// MB/s, repeating until at least 0.1 sec. has elapsed
+double measure(swap_t fn, std::vector<char>& dest, const std::vector<char>& src,
+               size_t count, size_t elementSize)
+{
+    const size_t nbytes = count*elementSize;
+    size_t total = 0u;
+    epicsTime start(epicsTime::getCurrent());
+    double elapsed;
+    do {
+        for(unsigned i=0; i<8u; i++) {
+            (*fn)(&dest[0], &src[0], count, elementSize);
+            total += nbytes;
+        }
+        elapsed = epicsTime::getCurrent() - start;
+    } while(elapsed < 0.1);
+
+    return total/elapsed/1e6;
+}
+
+} // namespace
+
+int main (int argc, char *argv[])
+{
+    int nelements = DEFAULT_ELEMENTS;
+
+    int opt;
+    while ((opt = getopt(argc, argv, ":hn:")) != -1) {
+        switch (opt) {
+        case 'h':
+            usage();
+            return 0;
+        case 'n':
+            nelements = atoi(optarg);
+            break;
+        case '?':
+            fprintf(stderr, "Unrecognized option: '-%c'.\n", optopt);
+            usage();
+            return 1;
+        case ':':
+            fprintf(stderr, "Option '-%c' requires an argument.\n", optopt);
+            usage();
+            return 1;
+        }
+    }
+
+    if(nelements<=0) {
+        usage();
+        return 1;
+    }
+
+    printf("swapCopy() using %s\n", pva::swapCopyImpl());
+
+    std::vector<size_t> counts;
+    for(size_t n=16u; n<size_t(nelements); n*=16u)
+        counts.push_back(n);
+    counts.push_back(nelements);
+
+    std::vector<char> src(size_t(nelements)*8u), dest(src.size());
+    for(size_t i=0; i<src.size(); i++)
+        src[i] = char(i);
+
+    for(size_t elementSize=2u; elementSize<=8u; elementSize*=2u) {
+        for(size_t c=0; c<counts.size(); c++) {
+            const size_t count = counts[c];
+            double scalar = measure(&pva::swapCopyScalar, dest, src, count, elementSize);
+            double vector = measure(&pva::swapCopy, dest, src, count, elementSize);
+            printf("%u bytes x %9u elements  scalar %9.1f MB/s  swapCopy %9.1f MB/s  (x%.1f)\n",
+                   unsigned(elementSize), unsigned(count), scalar, vector, vector/scalar);
+        }
+    }
+
+    return 0;
+}
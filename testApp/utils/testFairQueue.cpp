@@ -67,9 +67,47 @@ void testOrder()
     }
 }
 
+static
+void testBackground()
+{
+    typedef epics::pvAccess::fair_queue<Qnode> queue_t;
+    queue_t Q;
+    queue_t::value_type bulk(new Qnode(0)), A(new Qnode(1)), B(new Qnode(2));
+
+    testDiag("Background");
+
+    Q.push_back(bulk, true);
+    Q.push_back(bulk); // already queued, remains background
+    for(unsigned i=0; i<20u; i++) {
+        Q.push_back(A);
+        Q.push_back(B);
+    }
+
+    std::vector<unsigned> outputs;
+    {
+        queue_t::value_type E;
+        while(Q.pop_front_try(E))
+            outputs.push_back(E->i);
+    }
+
+    testOk(outputs.size()==42u, "size %u", (unsigned)outputs.size());
+
+    std::vector<unsigned> bulkAt;
+    for(unsigned i=0; i<outputs.size(); i++) {
+        if(outputs[i]==0u)
+            bulkAt.push_back(i);
+    }
+    testOk(bulkAt.size()==2u
+           && bulkAt[0]==queue_t::background_interval
+           && bulkAt[1]==2u*queue_t::background_interval+1u,
+           "background entry interleaved after %u others", queue_t::background_interval);
+    testOk1(Q.empty());
+}
+
 MAIN(testFairQueue)
 {
-    testPlan(12);
+    testPlan(15);
     testOrder();
+    testBackground();
     return testDone();
 }
@@ -88,6 +88,19 @@ void test_getSocketAddressList()
     getSocketAddressList(vec3, "   ", 1111);
     testOk1(static_cast<size_t>(0) == vec3.size());
 
+    // unix: only where allowed (TCP server lists)
+    InetAddrVector vec5;
+    getSocketAddressList(vec5, "unix:/tmp/test.sock 127.0.0.1", 1111);
+    testOk1(static_cast<size_t>(1) == vec5.size());
+    getSocketAddressList(vec5, "unix:/tmp/test.sock 127.0.0.1", 1111, NULL, true);
+#ifdef PVA_UNIX_SOCKET
+    testOk1(static_cast<size_t>(2) == vec5.size());
+    testOk1(vec5.size()==2u && "unix:/tmp/test.sock" == inetAddressToString(vec5[0]));
+#else
+    testOk1(static_cast<size_t>(1) == vec5.size());
+    testSkip(1, "No AF_UNIX");
+#endif
+
     // leading spaces
     InetAddrVector vec4;
     getSocketAddressList(vec4, "     127.0.0.1   10.10.12.11:1234 192.168.3.4", 555);
@@ -303,7 +316,7 @@ void test_multicastLoopback()
 
 MAIN(testInetAddressUtils)
 {
-    testPlan(63);
+    testPlan(66);
     testDiag("Tests for InetAddress utils");
 
     test_getSocketAddressList();
@@ -0,0 +1,105 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <pv/logger.h>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+using namespace epics::pvAccess;
+
+static
+void testRateLimit()
+{
+    testDiag("testRateLimit");
+
+    pvAccessSetLogRateLimit(5u);
+    size_t before = pvAccessLogDropped();
+
+    for(int i=0; i<100; i++)
+        LOG(logLevelInfo, "testRateLimit %d", i);
+
+    // may span the start of a second
+    size_t dropped = pvAccessLogDropped() - before;
+    testOk(dropped>=90u && dropped<=95u, "dropped %u of 100", unsigned(dropped));
+
+    pvAccessLogFlush();
+}
+
+static
+void testSites()
+{
+    testDiag("testSites");
+
+    pvAccessSetLogRateLimit(5u);
+    size_t before = pvAccessLogDropped();
+
+    // each call site has its own limit
+    for(int i=0; i<3; i++) {
+        LOG(logLevelInfo, "testSites first %d", i);
+        LOG(logLevelInfo, "testSites second %d", i);
+    }
+
+    testOk1(pvAccessLogDropped()==before);
+
+    pvAccessLogFlush();
+}
+
+static
+void testLevel()
+{
+    testDiag("testLevel");
+
+    pvAccessSetLogRateLimit(5u);
+    size_t before = pvAccessLogDropped();
+
+    // not loggable is not counted
+    SET_LOG_LEVEL(logLevelError);
+    for(int i=0; i<100; i++)
+        LOG(logLevelInfo, "testLevel %d", i);
+    SET_LOG_LEVEL(logLevelInfo);
+
+    testOk1(!IS_LOGGABLE(logLevelDebug));
+    testOk1(pvAccessLogDropped()==before);
+}
+
+static
+void testOverflow()
+{
+    testDiag("testOverflow");
+
+    pvAccessSetLogRateLimit(0u);
+    pvAccessLogFlush();
+    size_t before = pvAccessLogDropped();
+
+    // many times what the queue holds, faster than it is printed,
+    // even though the writer is woken by the first message
+    const int nmessages = 4096;
+    for(int i=0; i<nmessages; i++)
+        LOG(logLevelInfo, "testOverflow %d", i);
+
+    size_t dropped = pvAccessLogDropped() - before;
+    testOk(dropped>0u && dropped<size_t(nmessages), "dropped %u of %d", unsigned(dropped), nmessages);
+
+    pvAccessLogFlush();
+    before = pvAccessLogDropped();
+
+    LOG(logLevelInfo, "testOverflow after flush");
+    testOk1(pvAccessLogDropped()==before);
+
+    pvAccessLogFlush();
+    pvAccessSetLogRateLimit(10u);
+}
+
+MAIN(testLogger)
+{
+    testPlan(6);
+    testRateLimit();
+    testSites();
+    testLevel();
+    testOverflow();
+    return testDone();
+}
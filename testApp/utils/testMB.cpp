@@ -0,0 +1,179 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <vector>
+#include <sstream>
+#include <cmath>
+
+#include <pv/pvUnitTest.h>
+#include <testMain.h>
+
+#include <pv/pvAccessMB.h>
+
+namespace pva = epics::pvAccess;
+
+namespace {
+
+struct Row {
+    unsigned thread;
+    epicsUInt64 id;
+    unsigned stage;
+    double usec;
+};
+
+// parse csvExport() output
+std::vector<Row> exportRows(const pva::MBEntity& mb)
+{
+    std::ostringstream strm;
+    mb.csvExport(strm);
+
+    std::vector<Row> rows;
+    std::istringstream lines(strm.str());
+    std::string line;
+    while(std::getline(lines, line)) {
+        std::istringstream lstrm(line);
+        Row R;
+        char c1, c2, c3;
+        if(lstrm>>R.thread>>c1>>R.id>>c2>>R.stage>>c3>>R.usec)
+            rows.push_back(R);
+        else
+            testDiag("Bad line '%s'", line.c_str());
+    }
+    return rows;
+}
+
+void testWrap()
+{
+    testDiag("testWrap");
+
+    // more samples than the ring holds
+    pva::MBEntity mb("wrap", 8u);
+    for(unsigned i=0; i<20u; i++)
+        mb.point(i, 0, "wrap");
+
+    std::vector<Row> rows(exportRows(mb));
+    testEqual(rows.size(), 8u);
+    // the oldest are overwritten
+    if(!rows.empty()) {
+        testEqual(rows.front().id, epicsUInt64(12u));
+        testEqual(rows.back().id, epicsUInt64(19u));
+    } else {
+        testSkip(2, "no samples");
+    }
+}
+
+void testReset()
+{
+    testDiag("testReset");
+
+    pva::MBEntity mb("reset", 8u);
+    for(unsigned i=0; i<5u; i++)
+        mb.point(i, 0, "reset");
+
+    mb.reset();
+    testEqual(exportRows(mb).size(), 0u);
+
+    mb.point(100u, 0, "reset");
+    mb.point(101u, 0, "reset");
+
+    std::vector<Row> rows(exportRows(mb));
+    testEqual(rows.size(), 2u);
+    testEqual(rows.empty() ? epicsUInt64(0u) : rows.front().id, epicsUInt64(100u));
+}
+
+void testCSVRoundTrip()
+{
+    testDiag("testCSVRoundTrip");
+
+    pva::MBEntity orig("orig", 16u);
+    orig.normalize();
+    for(unsigned i=0; i<4u; i++) {
+        orig.point(i, 0, "first");
+        orig.point(i, 1, "second");
+        orig.point(i, 2, "third");
+    }
+
+    std::ostringstream out;
+    orig.csvExport(out);
+
+    pva::MBEntity copy("copy", 16u);
+    copy.normalize();
+    {
+        std::istringstream in(out.str());
+        copy.csvImport(in);
+    }
+
+    std::vector<Row> expect(exportRows(orig)),
+                     actual(exportRows(copy));
+
+    testEqual(expect.size(), 12u);
+    testEqual(actual.size(), expect.size());
+
+    bool match = actual.size()==expect.size();
+    for(size_t i=0; match && i<expect.size(); i++) {
+        // only thread in each, so both are thread 0
+        match = actual[i].thread==expect[i].thread
+                && actual[i].id==expect[i].id
+                && actual[i].stage==expect[i].stage
+                && std::fabs(actual[i].usec-expect[i].usec) < 0.01;
+        if(!match)
+            testDiag("%u differs: %u,%u,%u,%f != %u,%u,%u,%f", unsigned(i),
+                     actual[i].thread, unsigned(actual[i].id), actual[i].stage, actual[i].usec,
+                     expect[i].thread, unsigned(expect[i].id), expect[i].stage, expect[i].usec);
+    }
+    testOk(match, "import of export is unchanged");
+}
+
+void testStats()
+{
+    testDiag("testStats");
+
+    pva::MBEntity mb("stats", 64u);
+    for(unsigned i=0; i<10u; i++) {
+        mb.point(i, 0, "first");
+        mb.point(i, 1, "second");
+        mb.point(i, 2, "third");
+    }
+
+    std::ostringstream strm;
+    mb.stats(strm);
+    testDiag("%s", strm.str().c_str());
+
+    // stage description count ndelta ...
+    std::vector<size_t> count(3u), ndelta(3u);
+    std::istringstream lines(strm.str());
+    std::string line;
+    while(std::getline(lines, line)) {
+        std::istringstream lstrm(line);
+        unsigned stage;
+        std::string desc;
+        size_t C, N;
+        if(lstrm>>stage>>desc>>C>>N && stage<3u) {
+            count[stage] = C;
+            ndelta[stage] = N;
+        }
+    }
+
+    // the first stage of each id has no preceding stage
+    testEqual(count[0], 10u);
+    testEqual(ndelta[0], 0u);
+    testEqual(count[1], 10u);
+    testEqual(ndelta[1], 10u);
+    testEqual(count[2], 10u);
+    testEqual(ndelta[2], 10u);
+}
+
+} // namespace
+
+MAIN(testMB)
+{
+    testPlan(15);
+    testWrap();
+    testReset();
+    testCSVRoundTrip();
+    testStats();
+    return testDone();
+}
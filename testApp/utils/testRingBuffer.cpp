@@ -0,0 +1,116 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <stdexcept>
+
+#include <pv/sharedPtr.h>
+#include <pv/ringBuffer.h>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+typedef epics::pvAccess::ring_buffer<int> ring_t;
+
+static
+void testEmpty()
+{
+    testDiag("testEmpty");
+
+    ring_t R;
+    testOk1(R.capacity()==0u);
+    testOk1(R.empty());
+    testOk1(R.full());
+
+    try {
+        R.push_back(1);
+        testFail("push_back() on zero capacity ring succeeds");
+    } catch(std::logic_error& e) {
+        testPass("push_back() on zero capacity ring throws: %s", e.what());
+    }
+}
+
+static
+void testWrap()
+{
+    testDiag("testWrap");
+
+    ring_t R(3);
+    testOk1(R.capacity()==3u);
+    testOk1(R.empty());
+
+    // advance the head so that later pushes wrap around
+    R.push_back(0);
+    R.push_back(1);
+    R.pop_front();
+    R.pop_front();
+    testOk1(R.empty());
+
+    R.push_back(2);
+    R.push_back(3);
+    R.push_back(4);
+    testOk1(R.full());
+    testOk1(R.size()==3u);
+
+    testOk(R.front()==2, "front %d == 2", R.front());
+    testOk(R.back()==4, "back %d == 4", R.back());
+    testOk(R[1]==3, "[1] %d == 3", R[1]);
+
+    try {
+        R.push_back(5);
+        testFail("push_back() on full ring succeeds");
+    } catch(std::logic_error& e) {
+        testPass("push_back() on full ring throws: %s", e.what());
+    }
+
+    // modify in place
+    R.back() = 5;
+
+    bool ordered = true;
+    for(int expect=2; !R.empty(); expect++) {
+        if(expect==4) expect = 5;
+        ordered &= R.front()==expect;
+        R.pop_front();
+    }
+    testOk(ordered, "FIFO order");
+    testOk1(R.size()==0u);
+}
+
+static
+void testRelease()
+{
+    testDiag("testRelease");
+
+    typedef std::tr1::shared_ptr<int> value_type;
+    epics::pvAccess::ring_buffer<value_type> R;
+    R.reset(2);
+
+    value_type V(new int(42));
+    R.push_back(V);
+    R.push_back(V);
+    testOk1(V.use_count()==3);
+
+    R.pop_front();
+    testOk(V.use_count()==2, "pop_front() releases %d", int(V.use_count()));
+
+    R.clear();
+    testOk1(R.empty());
+    testOk(V.use_count()==1, "clear() releases %d", int(V.use_count()));
+
+    R.push_back(V);
+    R.reset(4);
+    testOk1(R.empty());
+    testOk1(R.capacity()==4u);
+    testOk(V.use_count()==1, "reset() releases %d", int(V.use_count()));
+}
+
+MAIN(testRingBuffer)
+{
+    testPlan(22);
+    testEmpty();
+    testWrap();
+    testRelease();
+    return testDone();
+}
@@ -0,0 +1,213 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <vector>
+#include <stdexcept>
+
+#include <epicsEvent.h>
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+#include <epicsThread.h>
+#include <epicsTime.h>
+
+#include <pv/pvUnitTest.h>
+#include <testMain.h>
+
+#include <pv/timerWheel.h>
+
+namespace pvd = epics::pvData;
+namespace pva = epics::pvAccess;
+
+namespace {
+
+typedef epicsGuard<epicsMutex> Guard;
+
+// order in which callbacks ran
+epicsMutex orderLock;
+std::vector<int> order;
+
+struct TestCallback : public pvd::TimerCallback
+{
+    POINTER_DEFINITIONS(TestCallback);
+
+    const int id;
+    epicsMutex lock;
+    epicsEvent fired;
+    unsigned count, stopped;
+    epicsTime last;
+    // when set, reschedule from callback() until count reaches again
+    pva::TimerWheel *wheel;
+    unsigned again;
+
+    explicit TestCallback(int id = 0) :id(id), count(0u), stopped(0u), wheel(0), again(0u) {}
+    virtual ~TestCallback() {}
+
+    virtual void callback() OVERRIDE FINAL
+    {
+        bool resched;
+        {
+            Guard G(lock);
+            count++;
+            last = epicsTime::getCurrent();
+            resched = wheel && count<again;
+        }
+        {
+            Guard G(orderLock);
+            order.push_back(id);
+        }
+        if(resched)
+            wheel->scheduleAfterDelay(self.lock(), 0.01);
+        fired.signal();
+    }
+    virtual void timerStopped() OVERRIDE FINAL
+    {
+        Guard G(lock);
+        stopped++;
+    }
+
+    unsigned getCount() { Guard G(lock); return count; }
+    unsigned getStopped() { Guard G(lock); return stopped; }
+    epicsTime getLast() { Guard G(lock); return last; }
+
+    std::tr1::weak_ptr<TestCallback> self;
+
+    static shared_pointer build(int id = 0)
+    {
+        shared_pointer ret(new TestCallback(id));
+        ret->self = ret;
+        return ret;
+    }
+};
+
+void testOneShot()
+{
+    testDiag("==== testOneShot ====");
+
+    pva::TimerWheel wheel("testTimer", pvd::lowPriority);
+    TestCallback::shared_pointer cb(TestCallback::build());
+
+    epicsTime start(epicsTime::getCurrent());
+    wheel.scheduleAfterDelay(cb, 0.1);
+    testOk1(wheel.isScheduled(cb));
+    testEqual(wheel.size(), 1u);
+
+    testOk1(cb->fired.wait(5.0));
+    double delay = cb->getLast() - start;
+    testOk(delay>=0.1 && delay<1.0, "ran after %g", delay);
+    testOk1(!wheel.isScheduled(cb));
+    testEqual(wheel.size(), 0u);
+
+    // may reschedule itself
+    cb->wheel = &wheel;
+    cb->again = 3u;
+    wheel.scheduleAfterDelay(cb, 0.0);
+    for(int i=0; i<50 && cb->getCount()<3u; i++)
+        epicsThreadSleep(0.05);
+    testEqual(cb->getCount(), 3u);
+}
+
+void testPeriodic()
+{
+    testDiag("==== testPeriodic ====");
+
+    pva::TimerWheel wheel("testTimer", pvd::lowPriority);
+    TestCallback::shared_pointer cb(TestCallback::build());
+
+    wheel.schedulePeriodic(cb, 0.0, 0.02);
+    for(int i=0; i<100 && cb->getCount()<5u; i++)
+        epicsThreadSleep(0.02);
+    testOk(cb->getCount()>=5u, "ran %u times", cb->getCount());
+    testOk1(wheel.isScheduled(cb));
+
+    testOk1(wheel.cancel(cb));
+    epicsThreadSleep(0.05); // in case it was running
+    unsigned count = cb->getCount();
+    epicsThreadSleep(0.1);
+    testEqual(cb->getCount(), count);
+}
+
+void testCancel()
+{
+    testDiag("==== testCancel ====");
+
+    pva::TimerWheel wheel("testTimer", pvd::lowPriority);
+    TestCallback::shared_pointer cb(TestCallback::build());
+
+    wheel.scheduleAfterDelay(cb, 0.2);
+    testThrows(std::logic_error, wheel.scheduleAfterDelay(cb, 0.1));
+    testOk1(wheel.cancel(cb));
+    testOk1(!wheel.cancel(cb));
+    epicsThreadSleep(0.4);
+    testEqual(cb->getCount(), 0u);
+
+    // may be scheduled again
+    wheel.scheduleAfterDelay(cb, 0.0);
+    testOk1(cb->fired.wait(5.0));
+}
+
+void testOrder()
+{
+    testDiag("==== testOrder ====");
+
+    {
+        Guard G(orderLock);
+        order.clear();
+    }
+
+    // with short ticks, so that the longer delays are cascaded from the higher levels
+    pva::TimerWheel wheel("testTimer", pvd::lowPriority, 1e-5);
+
+    std::vector<TestCallback::shared_pointer> cbs;
+    const double delays[] = {0.3, 0.001, 1.0, 0.1, 0.01};
+    const int expect[] = {1, 4, 3, 0, 2};
+    for(int i=0; i<5; i++) {
+        cbs.push_back(TestCallback::build(i));
+        wheel.scheduleAfterDelay(cbs.back(), delays[i]);
+    }
+
+    testOk1(cbs[2]->fired.wait(5.0));
+
+    Guard G(orderLock);
+    testEqual(order.size(), 5u);
+    bool ok = order.size()==5u;
+    for(size_t i=0; ok && i<5u; i++)
+        ok = order[i]==expect[i];
+    testOk(ok, "run in order of expiration");
+}
+
+void testClose()
+{
+    testDiag("==== testClose ====");
+
+    TestCallback::shared_pointer cb(TestCallback::build());
+    TestCallback::shared_pointer late(TestCallback::build());
+    {
+        pva::TimerWheel wheel("testTimer", pvd::lowPriority);
+        wheel.scheduleAfterDelay(cb, 10.0);
+        wheel.close();
+
+        testEqual(cb->getStopped(), 1u);
+
+        wheel.scheduleAfterDelay(late, 0.0);
+        testEqual(late->getStopped(), 1u);
+        testOk1(!wheel.isScheduled(late));
+    }
+    testEqual(cb->getCount(), 0u);
+    testEqual(late->getCount(), 0u);
+}
+
+} // namespace
+
+MAIN(testTimerWheel)
+{
+    testPlan(24);
+    testOneShot();
+    testPeriodic();
+    testCancel();
+    testOrder();
+    testClose();
+    return testDone();
+}
@@ -0,0 +1,138 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvAccessCPP is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+/* Measure the cost of scheduling and cancelling many timers,
+ * as with one heartbeat per connection and one search timer per channel.
+ * Compares epics::pvData::Timer (a sorted list) with pv/timerWheel.h.
+ * Delays are long enough that no timer expires during a measurement.
+ */
+
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <epicsGetopt.h>
+#include <epicsTime.h>
+
+#include <pv/timer.h>
+#include <pv/timerWheel.h>
+
+namespace pvd = epics::pvData;
+namespace pva = epics::pvAccess;
+
+namespace {
+
+#define DEFAULT_TIMERS 100000
+
+void usage (void)
+{
+    fprintf (stderr, "\nUsage: testTimerWheelPerformance [options]\n\n"
+             "  -h: Help: Print this message\n"
+             "options:\n"
+             "  -n <timers>:       number of timers, default is '%d'\n\n"
+             , DEFAULT_TIMERS);
+}
+
+struct NullCallback : public pvd::TimerCallback
+{
+    virtual ~NullCallback() {}
+    virtual void callback() OVERRIDE FINAL {}
+    virtual void timerStopped() OVERRIDE FINAL {}
+};
+
+typedef std::vector<pvd::TimerCallbackPtr> callbacks_t;
+
+template<typename Timer>
+void measure(const char *label, Timer& timer, const callbacks_t& callbacks, const std::vector<double>& delays)
+{
+    const size_t N = callbacks.size();
+
+    epicsTime start(epicsTime::getCurrent());
+    for(size_t i=0; i<N; i++)
+        timer.scheduleAfterDelay(callbacks[i], delays[i]);
+    epicsTime scheduled(epicsTime::getCurrent());
+
+    // re-arm, as for a heartbeat on each message received
+    for(size_t i=0; i<N; i++) {
+        timer.cancel(callbacks[i]);
+        timer.scheduleAfterDelay(callbacks[i], delays[N-1-i]);
+    }
+    epicsTime rearmed(epicsTime::getCurrent());
+
+    for(size_t i=0; i<N; i++)
+        timer.cancel(callbacks[i]);
+    epicsTime cancelled(epicsTime::getCurrent());
+
+    printf("%-12s %8u timers  schedule %8.3f us  re-arm %8.3f us  cancel %8.3f us\n",
+           label, unsigned(N),
+           (scheduled-start)/N*1e6,
+           (rearmed-scheduled)/N*1e6,
+           (cancelled-rearmed)/N*1e6);
+}
+
+} // namespace
+
+int main (int argc, char *argv[])
+{
+    int ntimers = DEFAULT_TIMERS;
+
+    int opt;
+    while ((opt = getopt(argc, argv, ":hn:")) != -1) {
+        switch (opt) {
+        case 'h':
+            usage();
+            return 0;
+        case 'n':
+            ntimers = atoi(optarg);
+            break;
+        case '?':
+            fprintf(stderr, "Unrecognized option: '-%c'.\n", optopt);
+            usage();
+            return 1;
+        case ':':
+            fprintf(stderr, "Option '-%c' requires an argument.\n", optopt);
+            usage();
+            return 1;
+        }
+    }
+
+    if(ntimers<=0) {
+        usage();
+        return 1;
+    }
+
+    // between 100 and 1100 seconds, like connection timeouts
+    srand(42);
+    std::vector<double> delays(ntimers);
+    for(size_t i=0; i<delays.size(); i++)
+        delays[i] = 100.0 + 1000.0*double(rand())/RAND_MAX;
+
+    std::vector<size_t> sizes;
+    for(size_t n=1000u; n<delays.size(); n*=10u)
+        sizes.push_back(n);
+    sizes.push_back(delays.size());
+
+    for(size_t s=0; s<sizes.size(); s++) {
+        const size_t n = sizes[s];
+        callbacks_t callbacks;
+        callbacks.reserve(n);
+        for(size_t i=0; i<n; i++)
+            callbacks.push_back(pvd::TimerCallbackPtr(new NullCallback));
+        std::vector<double> D(delays.begin(), delays.begin()+n);
+
+        {
+            pvd::Timer timer("perfTimer", pvd::lowPriority);
+            measure("pvData Timer", timer, callbacks, D);
+        }
+        {
+            pva::TimerWheel timer("perfWheel", pvd::lowPriority);
+            measure("TimerWheel", timer, callbacks, D);
+        }
+    }
+
+    return 0;
+}